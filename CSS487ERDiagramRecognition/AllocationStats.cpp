@@ -0,0 +1,298 @@
+// AllocationStats.cpp
+// Purpose: measure how much memory recognition allocates, to confirm that a reused recognizer
+//	stops allocating once its buffers have grown, and how much it holds at its peak, to size the
+//	memory of workers
+// Functionality: CountingMatAllocator wraps OpenCV's allocator and counts every Mat buffer
+//	created through it, along with the bytes alive and the most ever alive at once. When the
+//	program is built with ERD_COUNT_ALLOCATIONS defined, the global operator new is also replaced
+//	so every other heap allocation (vectors, strings, ...) is counted the same way. The peak
+//	resident memory of the whole process is read from the operating system
+// Assumptions:
+//	Counts are global to the process; measure one recognition at a time for per image numbers
+//	Mats created before install are not counted, so they are never taken off the live bytes
+// Authors: Allan Genari Gaarden, Tommy Ni, Joshua Medvinsky
+
+#include "AllocationStats.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+// totals shared by every thread; atomics never allocate, so they are safe to use from operator new
+static atomic<long long> matAllocations(0);
+static atomic<long long> matBytes(0);
+static atomic<long long> matLiveBytes(0);
+static atomic<long long> matPeakBytes(0);
+static atomic<long long> heapAllocations(0);
+static atomic<long long> heapBytes(0);
+static atomic<long long> heapLiveBytes(0);
+static atomic<long long> heapPeakBytes(0);
+
+// ------------------------------------ raisePeak --------------------------------------
+
+// purpose: keep the most bytes alive at once
+// preconditions: none
+// postconditions: peak is at least live
+
+// --------------------------------------------------------------------------------------
+static void raisePeak(atomic<long long>& peak, long long live)
+{
+	long long seen = peak.load(memory_order_relaxed);
+	while (live > seen && !peak.compare_exchange_weak(seen, live, memory_order_relaxed))
+	{
+	}
+}
+
+#ifdef ERD_COUNT_ALLOCATIONS
+// every block starts with its size, so delete can take it off the live bytes; the header keeps
+//	the rest of the block as aligned as malloc made it
+static const size_t HEAP_HEADER_BYTES = alignof(max_align_t);
+
+void* operator new(size_t size)
+{
+	AllocationStats::recordHeap(size);
+	void* block = malloc(size + HEAP_HEADER_BYTES);
+	if (block == nullptr) throw bad_alloc();
+	*(size_t*)block = size;
+	return (char*)block + HEAP_HEADER_BYTES;
+}
+
+void* operator new[](size_t size)
+{
+	return operator new(size);
+}
+
+void operator delete(void* p) noexcept
+{
+	if (p == nullptr) return;
+	char* block = (char*)p - HEAP_HEADER_BYTES;
+	AllocationStats::releaseHeap(*(size_t*)block);
+	free(block);
+}
+
+void operator delete[](void* p) noexcept
+{
+	operator delete(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+	operator delete(p);
+}
+
+void operator delete[](void* p, size_t) noexcept
+{
+	operator delete(p);
+}
+#endif
+
+// ------------------------------------ CountingMatAllocator --------------------------------------
+
+// purpose: count the allocations made through another allocator
+// preconditions: wrapped outlives this allocator
+// postconditions: allocations are passed to wrapped and counted
+
+// --------------------------------------------------------------------------------------
+CountingMatAllocator::CountingMatAllocator(MatAllocator* wrapped)
+{
+	this->wrapped = wrapped;
+}
+
+// ------------------------------------ allocate --------------------------------------
+
+// purpose: allocate the buffer of a new Mat
+// preconditions: same as MatAllocator::allocate
+// postconditions: the buffer comes from the wrapped allocator and is counted; it is released
+//	through this allocator again
+
+// --------------------------------------------------------------------------------------
+UMatData* CountingMatAllocator::allocate(int dims, const int* sizes, int type, void* data,
+	size_t* step, AccessFlag flags, UMatUsageFlags usageFlags) const
+{
+	UMatData* u = wrapped->allocate(dims, sizes, type, data, step, flags, usageFlags);
+	// a Mat wrapping user memory does not allocate a buffer of its own
+	if (u != nullptr && data == nullptr) AllocationStats::recordMat(u->size);
+	if (u != nullptr) u->currAllocator = this;
+	return u;
+}
+
+// ------------------------------------ allocate --------------------------------------
+
+// purpose: allocate the buffer of existing Mat data
+// preconditions: same as MatAllocator::allocate
+// postconditions: the wrapped allocator's result is returned
+
+// --------------------------------------------------------------------------------------
+bool CountingMatAllocator::allocate(UMatData* data, AccessFlag accessflags,
+	UMatUsageFlags usageFlags) const
+{
+	return wrapped->allocate(data, accessflags, usageFlags);
+}
+
+// ------------------------------------ deallocate --------------------------------------
+
+// purpose: release a buffer created by allocate
+// preconditions: data was allocated by this allocator
+// postconditions: the buffer is released by the wrapped allocator
+
+// --------------------------------------------------------------------------------------
+void CountingMatAllocator::deallocate(UMatData* data) const
+{
+	if (data == nullptr) return;
+	// only buffers allocate counted, i.e. not wrapping user memory, come off the live bytes
+	if ((data->flags & UMatData::USER_ALLOCATED) == 0) AllocationStats::releaseMat(data->size);
+	data->currAllocator = wrapped;
+	wrapped->deallocate(data);
+}
+
+// ------------------------------------ install --------------------------------------
+
+// purpose: start counting the Mat buffers allocated by OpenCV
+// preconditions: none
+// postconditions: every Mat created afterwards is allocated through a CountingMatAllocator;
+//	calling install again has no effect
+
+// --------------------------------------------------------------------------------------
+void AllocationStats::install()
+{
+	// lives for the rest of the program, Mats allocated through it may outlive any scope
+	static CountingMatAllocator allocator(Mat::getStdAllocator());
+	Mat::setDefaultAllocator(&allocator);
+}
+
+// ------------------------------------ current --------------------------------------
+
+// purpose: get the allocations counted so far
+// preconditions: none
+// postconditions: returns the totals; subtract two results to get the allocations in between
+
+// --------------------------------------------------------------------------------------
+AllocationCounts AllocationStats::current()
+{
+	AllocationCounts counts;
+	counts.matAllocations = matAllocations.load();
+	counts.matBytes = matBytes.load();
+	counts.matLiveBytes = matLiveBytes.load();
+	counts.matPeakBytes = matPeakBytes.load();
+	counts.heapAllocations = heapAllocations.load();
+	counts.heapBytes = heapBytes.load();
+	counts.heapLiveBytes = heapLiveBytes.load();
+	counts.heapPeakBytes = heapPeakBytes.load();
+	return counts;
+}
+
+// ------------------------------------ countsHeap --------------------------------------
+
+// purpose: tell whether heap allocations outside of Mat are counted
+// preconditions: none
+// postconditions: returns true if the program was built with ERD_COUNT_ALLOCATIONS
+
+// --------------------------------------------------------------------------------------
+bool AllocationStats::countsHeap()
+{
+#ifdef ERD_COUNT_ALLOCATIONS
+	return true;
+#else
+	return false;
+#endif
+}
+
+// ------------------------------------ recordMat --------------------------------------
+
+// purpose: count one Mat buffer
+// preconditions: none
+// postconditions: the Mat totals include an allocation of the given size
+
+// --------------------------------------------------------------------------------------
+void AllocationStats::recordMat(size_t bytes)
+{
+	matAllocations.fetch_add(1, memory_order_relaxed);
+	matBytes.fetch_add((long long)bytes, memory_order_relaxed);
+	raisePeak(matPeakBytes, matLiveBytes.fetch_add((long long)bytes, memory_order_relaxed) + (long long)bytes);
+}
+
+// ------------------------------------ recordHeap --------------------------------------
+
+// purpose: count one heap allocation
+// preconditions: none
+// postconditions: the heap totals include an allocation of the given size
+
+// --------------------------------------------------------------------------------------
+void AllocationStats::recordHeap(size_t bytes)
+{
+	heapAllocations.fetch_add(1, memory_order_relaxed);
+	heapBytes.fetch_add((long long)bytes, memory_order_relaxed);
+	raisePeak(heapPeakBytes, heapLiveBytes.fetch_add((long long)bytes, memory_order_relaxed) + (long long)bytes);
+}
+
+// ------------------------------------ releaseMat --------------------------------------
+
+// purpose: count one Mat buffer being freed
+// preconditions: the buffer was counted by recordMat
+// postconditions: the live Mat bytes no longer include it
+
+// --------------------------------------------------------------------------------------
+void AllocationStats::releaseMat(size_t bytes)
+{
+	matLiveBytes.fetch_sub((long long)bytes, memory_order_relaxed);
+}
+
+// ------------------------------------ releaseHeap --------------------------------------
+
+// purpose: count one heap allocation being freed
+// preconditions: the allocation was counted by recordHeap
+// postconditions: the live heap bytes no longer include it
+
+// --------------------------------------------------------------------------------------
+void AllocationStats::releaseHeap(size_t bytes)
+{
+	heapLiveBytes.fetch_sub((long long)bytes, memory_order_relaxed);
+}
+
+// ------------------------------------ resetPeaks --------------------------------------
+
+// purpose: start measuring the peaks again, e.g. before each image
+// preconditions: none
+// postconditions: the Mat and heap peaks are the bytes alive now
+
+// --------------------------------------------------------------------------------------
+void AllocationStats::resetPeaks()
+{
+	matPeakBytes.store(matLiveBytes.load());
+	heapPeakBytes.store(heapLiveBytes.load());
+}
+
+// ------------------------------------ peakResidentBytes --------------------------------------
+
+// purpose: get the most physical memory the process has used at once
+// preconditions: none
+// postconditions: returns the peak resident set (working set on Windows) since the process
+//	started, in bytes, or 0 if the operating system does not report it
+
+// --------------------------------------------------------------------------------------
+long long AllocationStats::peakResidentBytes()
+{
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters;
+	if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return 0;
+	return (long long)counters.PeakWorkingSetSize;
+#else
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#ifdef __APPLE__
+	return (long long)usage.ru_maxrss;
+#else
+	// in kilobytes on Linux
+	return (long long)usage.ru_maxrss * 1024;
+#endif
+#endif
+}
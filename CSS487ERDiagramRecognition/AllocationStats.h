@@ -0,0 +1,159 @@
+// AllocationStats.h
+// Purpose: measure how much memory recognition allocates, to confirm that a reused recognizer
+//	stops allocating once its buffers have grown, and how much it holds at its peak, to size the
+//	memory of workers
+// Functionality: CountingMatAllocator wraps OpenCV's allocator and counts every Mat buffer
+//	created through it, along with the bytes alive and the most ever alive at once. When the
+//	program is built with ERD_COUNT_ALLOCATIONS defined, the global operator new is also replaced
+//	so every other heap allocation (vectors, strings, ...) is counted the same way. The peak
+//	resident memory of the whole process is read from the operating system
+// Assumptions:
+//	Counts are global to the process; measure one recognition at a time for per image numbers
+//	Mats created before install are not counted, so they are never taken off the live bytes
+// Authors: Allan Genari Gaarden, Tommy Ni, Joshua Medvinsky
+
+#ifndef ALLOCATION_STATS_H
+#define ALLOCATION_STATS_H
+
+#include <opencv2/core.hpp>
+using namespace std;
+using namespace cv;
+
+// number of allocations and bytes allocated since the program started, the bytes still alive,
+//	and the most bytes alive at once since the peaks were last reset
+struct AllocationCounts
+{
+	long long matAllocations = 0;
+	long long matBytes = 0;
+	long long matLiveBytes = 0;
+	long long matPeakBytes = 0;
+	long long heapAllocations = 0;
+	long long heapBytes = 0;
+	long long heapLiveBytes = 0;
+	long long heapPeakBytes = 0;
+};
+
+class CountingMatAllocator : public MatAllocator
+{
+public:
+	// default constructor not allowed
+	CountingMatAllocator() = delete;
+	// ------------------------------------ parameter constructor --------------------------------------
+
+// purpose: count the allocations made through another allocator
+// preconditions: wrapped outlives this allocator
+// postconditions: allocations are passed to wrapped and counted
+
+// --------------------------------------------------------------------------------------
+	CountingMatAllocator(MatAllocator* wrapped);
+	// ------------------------------------ allocate --------------------------------------
+
+// purpose: allocate the buffer of a new Mat
+// preconditions: same as MatAllocator::allocate
+// postconditions: the buffer comes from the wrapped allocator and is counted; it is released
+//	through this allocator again
+
+// --------------------------------------------------------------------------------------
+	UMatData* allocate(int dims, const int* sizes, int type, void* data, size_t* step,
+		AccessFlag flags, UMatUsageFlags usageFlags) const override;
+	// ------------------------------------ allocate --------------------------------------
+
+// purpose: allocate the buffer of existing Mat data
+// preconditions: same as MatAllocator::allocate
+// postconditions: the wrapped allocator's result is returned
+
+// --------------------------------------------------------------------------------------
+	bool allocate(UMatData* data, AccessFlag accessflags, UMatUsageFlags usageFlags) const override;
+	// ------------------------------------ deallocate --------------------------------------
+
+// purpose: release a buffer created by allocate
+// preconditions: data was allocated by this allocator
+// postconditions: the buffer is released by the wrapped allocator
+
+// --------------------------------------------------------------------------------------
+	void deallocate(UMatData* data) const override;
+
+private:
+	MatAllocator* wrapped;
+};
+
+class AllocationStats
+{
+public:
+	// ------------------------------------ install --------------------------------------
+
+// purpose: start counting the Mat buffers allocated by OpenCV
+// preconditions: none
+// postconditions: every Mat created afterwards is allocated through a CountingMatAllocator;
+//	calling install again has no effect
+
+// --------------------------------------------------------------------------------------
+	static void install();
+	// ------------------------------------ current --------------------------------------
+
+// purpose: get the allocations counted so far
+// preconditions: none
+// postconditions: returns the totals; subtract two results to get the allocations in between
+
+// --------------------------------------------------------------------------------------
+	static AllocationCounts current();
+	// ------------------------------------ countsHeap --------------------------------------
+
+// purpose: tell whether heap allocations outside of Mat are counted
+// preconditions: none
+// postconditions: returns true if the program was built with ERD_COUNT_ALLOCATIONS
+
+// --------------------------------------------------------------------------------------
+	static bool countsHeap();
+	// ------------------------------------ recordMat --------------------------------------
+
+// purpose: count one Mat buffer
+// preconditions: none
+// postconditions: the Mat totals include an allocation of the given size
+
+// --------------------------------------------------------------------------------------
+	static void recordMat(size_t bytes);
+	// ------------------------------------ recordHeap --------------------------------------
+
+// purpose: count one heap allocation
+// preconditions: none
+// postconditions: the heap totals include an allocation of the given size
+
+// --------------------------------------------------------------------------------------
+	static void recordHeap(size_t bytes);
+	// ------------------------------------ releaseMat --------------------------------------
+
+// purpose: count one Mat buffer being freed
+// preconditions: the buffer was counted by recordMat
+// postconditions: the live Mat bytes no longer include it
+
+// --------------------------------------------------------------------------------------
+	static void releaseMat(size_t bytes);
+	// ------------------------------------ releaseHeap --------------------------------------
+
+// purpose: count one heap allocation being freed
+// preconditions: the allocation was counted by recordHeap
+// postconditions: the live heap bytes no longer include it
+
+// --------------------------------------------------------------------------------------
+	static void releaseHeap(size_t bytes);
+	// ------------------------------------ resetPeaks --------------------------------------
+
+// purpose: start measuring the peaks again, e.g. before each image
+// preconditions: none
+// postconditions: the Mat and heap peaks are the bytes alive now
+
+// --------------------------------------------------------------------------------------
+	static void resetPeaks();
+	// ------------------------------------ peakResidentBytes --------------------------------------
+
+// purpose: get the most physical memory the process has used at once
+// preconditions: none
+// postconditions: returns the peak resident set (working set on Windows) since the process
+//	started, in bytes, or 0 if the operating system does not report it
+
+// --------------------------------------------------------------------------------------
+	static long long peakResidentBytes();
+};
+
+#endif
@@ -0,0 +1,132 @@
+// AsyncImageWriter.cpp
+// Purpose: write annotated result images without stalling recognition
+// Functionality: images handed to write are queued and encoded to disk by a background thread,
+//	so the caller can recognize the next diagram while the previous one is being encoded
+// Assumptions:
+//	The file extension of each path is one imwrite can encode (e.g. .png or .jpg)
+// Authors: Allan Genari Gaarden, Tommy Ni, Joshua Medvinsky
+
+#include "AsyncImageWriter.h"
+
+// ------------------------------------ parameter constructor --------------------------------------
+
+// purpose: start the background writer thread
+// preconditions: maxQueued is at least 1
+// postconditions: the writer thread is waiting for images; at most maxQueued images are held
+//	in memory at once, write blocks when that limit is reached
+
+// --------------------------------------------------------------------------------------
+AsyncImageWriter::AsyncImageWriter(int maxQueued) : maxQueued(max(1, maxQueued))
+{
+	writer = thread(&AsyncImageWriter::writerLoop, this);
+}
+
+// ------------------------------------ destructor --------------------------------------
+
+// purpose: make sure every queued image reaches the disk
+// preconditions: none
+// postconditions: calls finish
+
+// --------------------------------------------------------------------------------------
+AsyncImageWriter::~AsyncImageWriter()
+{
+	finish();
+}
+
+// ------------------------------------ write --------------------------------------
+
+// purpose: queue an image to be written to fileName
+// preconditions: finish has not been called
+// postconditions: the image is queued, blocking while the queue is full; the caller must not
+//	modify the image afterwards since its pixels are shared, not copied
+
+// --------------------------------------------------------------------------------------
+void AsyncImageWriter::write(const string& fileName, const Mat& image)
+{
+	unique_lock<mutex> guard(lock);
+	// bounding the queue keeps memory flat when encoding is slower than recognition
+	notFull.wait(guard, [this] { return queue.size() < maxQueued; });
+	queue.push_back(PendingImage{ fileName, image });
+	notEmpty.notify_one();
+}
+
+// ------------------------------------ finish --------------------------------------
+
+// purpose: wait until every queued image has been written and stop the writer thread
+// preconditions: none
+// postconditions: the queue is empty and the writer thread has exited
+
+// --------------------------------------------------------------------------------------
+void AsyncImageWriter::finish()
+{
+	{
+		lock_guard<mutex> guard(lock);
+		stopping = true;
+	}
+	notEmpty.notify_one();
+	if (writer.joinable()) writer.join();
+}
+
+// ------------------------------------ writerLoop --------------------------------------
+
+// purpose: encode queued images until finish is called and the queue is drained
+// preconditions: runs on the writer thread only
+// postconditions: every queued image has been written (or counted as failed)
+
+// --------------------------------------------------------------------------------------
+void AsyncImageWriter::writerLoop()
+{
+	while (true)
+	{
+		PendingImage pending;
+		{
+			unique_lock<mutex> guard(lock);
+			notEmpty.wait(guard, [this] { return !queue.empty() || stopping; });
+			if (queue.empty()) return;
+			pending = queue.front();
+			queue.pop_front();
+		}
+		notFull.notify_one();
+
+		// encoding happens outside the lock so write never waits on a slow encode
+		bool written = false;
+		try
+		{
+			written = imwrite(pending.fileName, pending.image);
+		}
+		catch (const cv::Exception&)
+		{
+			written = false;
+		}
+
+		lock_guard<mutex> guard(lock);
+		if (written) numWritten++;
+		else numFailed++;
+	}
+}
+
+// ------------------------------------ getNumWritten --------------------------------------
+
+// purpose: get the number of images successfully written
+// preconditions: none
+// postconditions: returns the number of images imwrite succeeded on
+
+// --------------------------------------------------------------------------------------
+int AsyncImageWriter::getNumWritten()
+{
+	lock_guard<mutex> guard(lock);
+	return numWritten;
+}
+
+// ------------------------------------ getNumFailed --------------------------------------
+
+// purpose: get the number of images that could not be written
+// preconditions: none
+// postconditions: returns the number of images imwrite failed on
+
+// --------------------------------------------------------------------------------------
+int AsyncImageWriter::getNumFailed()
+{
+	lock_guard<mutex> guard(lock);
+	return numFailed;
+}
@@ -0,0 +1,101 @@
+// AsyncImageWriter.h
+// Purpose: write annotated result images without stalling recognition
+// Functionality: images handed to write are queued and encoded to disk by a background thread,
+//	so the caller can recognize the next diagram while the previous one is being encoded
+// Assumptions:
+//	The file extension of each path is one imwrite can encode (e.g. .png or .jpg)
+// Authors: Allan Genari Gaarden, Tommy Ni, Joshua Medvinsky
+
+#ifndef ASYNC_IMAGE_WRITER_H
+#define ASYNC_IMAGE_WRITER_H
+
+#include "RecognizeERDiagram.h"
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+class AsyncImageWriter
+{
+public:
+	// default constructor not allowed
+	AsyncImageWriter() = delete;
+	// ------------------------------------ parameter constructor --------------------------------------
+
+// purpose: start the background writer thread
+// preconditions: maxQueued is at least 1
+// postconditions: the writer thread is waiting for images; at most maxQueued images are held
+//	in memory at once, write blocks when that limit is reached
+
+// --------------------------------------------------------------------------------------
+	AsyncImageWriter(int maxQueued);
+	// ------------------------------------ destructor --------------------------------------
+
+// purpose: make sure every queued image reaches the disk
+// preconditions: none
+// postconditions: calls finish
+
+// --------------------------------------------------------------------------------------
+	~AsyncImageWriter();
+	// ------------------------------------ write --------------------------------------
+
+// purpose: queue an image to be written to fileName
+// preconditions: finish has not been called
+// postconditions: the image is queued, blocking while the queue is full; the caller must not
+//	modify the image afterwards since its pixels are shared, not copied
+
+// --------------------------------------------------------------------------------------
+	void write(const string& fileName, const Mat& image);
+	// ------------------------------------ finish --------------------------------------
+
+// purpose: wait until every queued image has been written and stop the writer thread
+// preconditions: none
+// postconditions: the queue is empty and the writer thread has exited
+
+// --------------------------------------------------------------------------------------
+	void finish();
+	// ------------------------------------ getNumWritten --------------------------------------
+
+// purpose: get the number of images successfully written
+// preconditions: none
+// postconditions: returns the number of images imwrite succeeded on
+
+// --------------------------------------------------------------------------------------
+	int getNumWritten();
+	// ------------------------------------ getNumFailed --------------------------------------
+
+// purpose: get the number of images that could not be written
+// preconditions: none
+// postconditions: returns the number of images imwrite failed on
+
+// --------------------------------------------------------------------------------------
+	int getNumFailed();
+
+private:
+	struct PendingImage
+	{
+		string fileName;
+		Mat image;
+	};
+
+	deque<PendingImage> queue;
+	size_t maxQueued;
+	bool stopping = false;
+	int numWritten = 0;
+	int numFailed = 0;
+	mutex lock;
+	condition_variable notEmpty;
+	condition_variable notFull;
+	thread writer;
+
+	// ------------------------------------ writerLoop --------------------------------------
+
+// purpose: encode queued images until finish is called and the queue is drained
+// preconditions: runs on the writer thread only
+// postconditions: every queued image has been written (or counted as failed)
+
+// --------------------------------------------------------------------------------------
+	void writerLoop();
+};
+
+#endif
@@ -0,0 +1,190 @@
+// BatchRunner.cpp
+// Purpose: recognize a whole directory (or list) of ER diagram images using every core
+// Functionality: runs RecognizeERDiagram on each image through a WorkStealingScheduler, keeps the
+//	six type counts of every image in input order and reports the overall throughput
+// Assumptions:
+//	A directory contains only the images to recognize (other files fail to load and are reported)
+//	A file list has one image path per line
+// Authors: Allan Genari Gaarden, Tommy Ni, Joshua Medvinsky
+
+#include "BatchRunner.h"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+
+// ------------------------------------ parameter constructor --------------------------------------
+
+// purpose: prepare a batch over the given images
+// preconditions: none
+// postconditions: image names are stored in the order given, numThreads < 1 means all cores
+
+// --------------------------------------------------------------------------------------
+BatchRunner::BatchRunner(const vector<string>& imageNames, int numThreads) :
+	imageNames(imageNames), scheduler(numThreads)
+{
+}
+
+// ------------------------------------ collectImages --------------------------------------
+
+// purpose: turn a directory or a file list into the list of images to recognize
+// preconditions: path is a directory or a text file with one image path per line
+// postconditions: returns the image paths; directories are sorted by name so the order is stable
+
+// --------------------------------------------------------------------------------------
+vector<string> BatchRunner::collectImages(const string& path)
+{
+	vector<string> images;
+	if (filesystem::is_directory(path))
+	{
+		for (const filesystem::directory_entry& entry : filesystem::directory_iterator(path))
+		{
+			if (entry.is_regular_file()) images.push_back(entry.path().string());
+		}
+		// directory iteration order is unspecified, sort so results are reproducible
+		sort(images.begin(), images.end());
+	}
+	else
+	{
+		ifstream list(path);
+		string line;
+		while (getline(list, line))
+		{
+			// tolerate lists written on Windows and blank lines
+			if (!line.empty() && line.back() == '\r') line.pop_back();
+			if (!line.empty()) images.push_back(line);
+		}
+	}
+	return images;
+}
+
+// ------------------------------------ setArchive --------------------------------------
+
+// purpose: also keep the shapes of every image in an archive
+// preconditions: archive outlives run, or is nullptr
+// postconditions: run appends one record per recognized image to archive, in the order the
+//	images finish; an image whose record cannot be written counts as not recognized
+
+// --------------------------------------------------------------------------------------
+void BatchRunner::setArchive(ResultArchiveWriter* archive)
+{
+	this->archive = archive;
+}
+
+// ------------------------------------ run --------------------------------------
+
+// purpose: recognize every image of the batch
+// preconditions: none
+// postconditions: results holds one entry per image, in input order, and the elapsed time is stored
+
+// --------------------------------------------------------------------------------------
+void BatchRunner::run()
+{
+	results.assign(imageNames.size(), BatchResult());
+
+	// every core already runs its own image, so keep OpenCV from spawning threads of its own
+	int openCVThreads = getNumThreads();
+	setNumThreads(1);
+
+	auto start = chrono::steady_clock::now();
+	scheduler.run((int)imageNames.size(), [this](int index) { recognizeOne(index); });
+	auto end = chrono::steady_clock::now();
+	elapsedSeconds = chrono::duration<double>(end - start).count();
+
+	setNumThreads(openCVThreads);
+}
+
+// ------------------------------------ recognizeOne --------------------------------------
+
+// purpose: recognize a single image of the batch and store its counts
+// preconditions: index is a valid position in imageNames
+// postconditions: results[index] holds the counts, or recognized is false if the image failed
+
+// --------------------------------------------------------------------------------------
+void BatchRunner::recognizeOne(int index)
+{
+	BatchResult& result = results[index];
+	result.imageName = imageNames[index];
+
+	auto start = chrono::steady_clock::now();
+	try
+	{
+		RecognizeERDiagram rec(imageNames[index]);
+		result.attributes = rec.getNumAttributes();
+		result.entities = rec.getNumEntities();
+		result.relationships = rec.getNumRelationships();
+		result.weakEntities = rec.getNumWeakEntities();
+		result.weakRelationships = rec.getNumWeakRelationships();
+		result.multivaluedAttributes = rec.getNumMultivaluedAttributes();
+		// the writer serializes the workers itself
+		if (archive != nullptr) archive->write(imageNames[index], rec.getImageSize(), rec.getShapes());
+		result.recognized = true;
+	}
+	catch (const cv::Exception&)
+	{
+		// an unreadable image must not take the rest of the batch down with it
+		result.recognized = false;
+	}
+	auto end = chrono::steady_clock::now();
+	result.milliseconds = chrono::duration<double, milli>(end - start).count();
+}
+
+// ------------------------------------ printResults --------------------------------------
+
+// purpose: output the counts of every image followed by the overall throughput
+// preconditions: run has been called
+// postconditions: one line per image in input order, then a summary line, is written to out
+
+// --------------------------------------------------------------------------------------
+void BatchRunner::printResults(ostream& out)
+{
+	int numFailed = 0;
+	out << "Image, Attributes, Entities, Relationships, Weak Entities, Weak Relationships, "
+		"Multivalued Attributes, Milliseconds" << endl;
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		const BatchResult& result = results[i];
+		if (!result.recognized)
+		{
+			out << result.imageName << ", could not be recognized" << endl;
+			numFailed++;
+			continue;
+		}
+		out << result.imageName << ", " << result.attributes << ", " << result.entities << ", " <<
+			result.relationships << ", " << result.weakEntities << ", " << result.weakRelationships <<
+			", " << result.multivaluedAttributes << ", " << fixed << setprecision(1) <<
+			result.milliseconds << endl;
+	}
+
+	out << "\nImages    : " << results.size() << " (" << numFailed << " failed)" << endl;
+	out << "Threads   : " << scheduler.getNumThreads() << " (" << scheduler.getNumSteals() <<
+		" tasks stolen)" << endl;
+	out << "Seconds   : " << fixed << setprecision(3) << elapsedSeconds << endl;
+	out << "Images/sec: " << fixed << setprecision(2) << getImagesPerSecond() << endl;
+}
+
+// ------------------------------------ getResults --------------------------------------
+
+// purpose: get the counts of every image
+// preconditions: run has been called
+// postconditions: returns the results in input order
+
+// --------------------------------------------------------------------------------------
+const vector<BatchResult>& BatchRunner::getResults()
+{
+	return results;
+}
+
+// ------------------------------------ getImagesPerSecond --------------------------------------
+
+// purpose: get the throughput of the last run
+// preconditions: run has been called
+// postconditions: returns the number of images recognized per second of wall time
+
+// --------------------------------------------------------------------------------------
+double BatchRunner::getImagesPerSecond()
+{
+	if (elapsedSeconds <= 0) return 0;
+	return results.size() / elapsedSeconds;
+}
@@ -0,0 +1,111 @@
+// BatchRunner.h
+// Purpose: recognize a whole directory (or list) of ER diagram images using every core
+// Functionality: runs RecognizeERDiagram on each image through a WorkStealingScheduler, keeps the
+//	six type counts of every image in input order and reports the overall throughput
+// Assumptions:
+//	A directory contains only the images to recognize (other files fail to load and are reported)
+//	A file list has one image path per line
+// Authors: Allan Genari Gaarden, Tommy Ni, Joshua Medvinsky
+
+#ifndef BATCH_RUNNER_H
+#define BATCH_RUNNER_H
+
+#include "RecognizeERDiagram.h"
+#include "WorkStealingScheduler.h"
+#include "ResultArchive.h"
+
+// counts recognized in a single image of the batch
+struct BatchResult
+{
+	string imageName;
+	bool recognized = false;
+	int attributes = 0;
+	int entities = 0;
+	int relationships = 0;
+	int weakEntities = 0;
+	int weakRelationships = 0;
+	int multivaluedAttributes = 0;
+	double milliseconds = 0;
+};
+
+class BatchRunner
+{
+public:
+	// default constructor not allowed
+	BatchRunner() = delete;
+	// ------------------------------------ parameter constructor --------------------------------------
+
+// purpose: prepare a batch over the given images
+// preconditions: none
+// postconditions: image names are stored in the order given, numThreads < 1 means all cores
+
+// --------------------------------------------------------------------------------------
+	BatchRunner(const vector<string>& imageNames, int numThreads);
+	// ------------------------------------ collectImages --------------------------------------
+
+// purpose: turn a directory or a file list into the list of images to recognize
+// preconditions: path is a directory or a text file with one image path per line
+// postconditions: returns the image paths; directories are sorted by name so the order is stable
+
+// --------------------------------------------------------------------------------------
+	static vector<string> collectImages(const string& path);
+	// ------------------------------------ setArchive --------------------------------------
+
+// purpose: also keep the shapes of every image in an archive
+// preconditions: archive outlives run, or is nullptr
+// postconditions: run appends one record per recognized image to archive, in the order the
+//	images finish; an image whose record cannot be written counts as not recognized
+
+// --------------------------------------------------------------------------------------
+	void setArchive(ResultArchiveWriter* archive);
+	// ------------------------------------ run --------------------------------------
+
+// purpose: recognize every image of the batch
+// preconditions: none
+// postconditions: results holds one entry per image, in input order, and the elapsed time is stored
+
+// --------------------------------------------------------------------------------------
+	void run();
+	// ------------------------------------ printResults --------------------------------------
+
+// purpose: output the counts of every image followed by the overall throughput
+// preconditions: run has been called
+// postconditions: one line per image in input order, then a summary line, is written to out
+
+// --------------------------------------------------------------------------------------
+	void printResults(ostream& out);
+	// ------------------------------------ getResults --------------------------------------
+
+// purpose: get the counts of every image
+// preconditions: run has been called
+// postconditions: returns the results in input order
+
+// --------------------------------------------------------------------------------------
+	const vector<BatchResult>& getResults();
+	// ------------------------------------ getImagesPerSecond --------------------------------------
+
+// purpose: get the throughput of the last run
+// preconditions: run has been called
+// postconditions: returns the number of images recognized per second of wall time
+
+// --------------------------------------------------------------------------------------
+	double getImagesPerSecond();
+
+private:
+	vector<string> imageNames;
+	vector<BatchResult> results;
+	WorkStealingScheduler scheduler;
+	double elapsedSeconds = 0;
+	ResultArchiveWriter* archive = nullptr;
+
+	// ------------------------------------ recognizeOne --------------------------------------
+
+// purpose: recognize a single image of the batch and store its counts
+// preconditions: index is a valid position in imageNames
+// postconditions: results[index] holds the counts, or recognized is false if the image failed
+
+// --------------------------------------------------------------------------------------
+	void recognizeOne(int index);
+};
+
+#endif
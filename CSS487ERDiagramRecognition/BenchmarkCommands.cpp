@@ -0,0 +1,878 @@
+// BenchmarkCommands.cpp
+// Purpose: time and check the stages of recognition, and gate changes on accuracy and latency
+// Functionality: the graycheck, graybench, profilebench, components, cascade, instrument, graphbench,
+//	bench and gate modes of the program: each command reads its arguments and runs its driver,
+//	which checks a kernel against OpenCV, times a stage, counts what a stage drops, or runs the
+//	regression gate over the bundled tests or a manifest
+// Assumptions:
+//	Times are only compared between runs on the same machine
+// Authors: Allan Genari Gaarden, Tommy Ni, Joshua Medvinsky
+
+#include "BenchmarkCommands.h"
+#include "MemoryCommands.h"
+#include "RecognizeERDiagram.h"
+#include "AllocationStats.h"
+#include "GrayThreshold.h"
+#include "CascadeStats.h"
+#include "RecognitionBenchmark.h"
+#include "DiagramGenerator.h"
+#include "RecognitionTrace.h"
+#include "ConnectorExtractor.h"
+#include "RegressionGate.h"
+#include <cfloat>
+#include <chrono>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+
+// ------------------------------------ runGrayCheck --------------------------------------
+
+// purpose: check that every GrayThreshold kernel matches cvtColor followed by threshold
+// preconditions: imageNames are valid images, or empty
+// postconditions: every color there is, a view of it with gaps between the rows and each image
+//	are thresholded at several levels by both paths; outputs the number of differing pixels per
+//	case and returns 1 if any differ
+
+// --------------------------------------------------------------------------------------
+int runGrayCheck(const vector<string>& imageNames)
+{
+	// 4096 x 4096 pixels hold each of the 2^24 colors once
+	Mat allColors(4096, 4096, CV_8UC3);
+	for (int y = 0; y < allColors.rows; y++)
+	{
+		for (int x = 0; x < allColors.cols; x++)
+		{
+			int color = y * allColors.cols + x;
+			allColors.at<Vec3b>(y, x) = Vec3b((uchar)(color >> 16), (uchar)(color >> 8), (uchar)color);
+		}
+	}
+
+	vector<pair<string, Mat>> images;
+	images.push_back(make_pair(string("all colors"), allColors));
+	// an odd width leaves a partly filled vector at the end of every row
+	images.push_back(make_pair(string("all colors, 1001 wide view"), allColors(Rect(3, 5, 1001, 777))));
+	for (size_t i = 0; i < imageNames.size(); i++)
+	{
+		Mat image = imread(imageNames[i]);
+		if (image.empty())
+		{
+			cerr << imageNames[i] << " could not be read" << endl;
+			return 1;
+		}
+		images.push_back(make_pair(imageNames[i], image));
+	}
+
+	const int levels[] = { -1, 0, 1, 100, 150, 200, 254, 255 };
+	const GrayThresholdKernel kernels[] = { GrayThresholdKernel::Scalar, GrayThresholdKernel::SSSE3,
+		GrayThresholdKernel::AVX2 };
+	Mat gray, expected, actual;
+	int numFailed = 0;
+
+	cout << "Image, Threshold, Kernel, Differing Pixels" << endl;
+	for (size_t i = 0; i < images.size(); i++)
+	{
+		for (int level : levels)
+		{
+			// a maximum other than 255 checks that the value written is not just the mask
+			int maxValue = level == 100 ? 7 : 255;
+			cvtColor(images[i].second, gray, COLOR_BGR2GRAY);
+			threshold(gray, expected, level, maxValue, THRESH_BINARY);
+
+			for (GrayThresholdKernel kernel : kernels)
+			{
+				if (!GrayThreshold::isSupported(kernel)) continue;
+				GrayThreshold::apply(images[i].second, actual, level, maxValue, kernel);
+				int differing = countNonZero(actual != expected);
+				cout << images[i].first << ", " << level << ", " << GrayThreshold::kernelName(kernel) <<
+					", " << differing << endl;
+				if (differing > 0) numFailed++;
+			}
+		}
+	}
+
+	cout << (numFailed == 0 ? "All kernels match" : "Kernels differ from cvtColor and threshold") << endl;
+	return numFailed == 0 ? 0 : 1;
+}
+
+// ------------------------------------ graycheckCommand --------------------------------------
+
+// purpose: check the threshold kernels from the command line
+// preconditions: argv[1] is graycheck
+// postconditions: the arguments after argv[1] are read and the mode is run; returns its exit
+//	code, or USAGE_ERROR if the arguments are wrong
+
+// --------------------------------------------------------------------------------------
+int graycheckCommand(int argc, char* argv[])
+{
+	return runGrayCheck(vector<string>(argv + 2, argv + argc));
+}
+
+// ------------------------------------ runGrayBench --------------------------------------
+
+// purpose: compare the speed of cvtColor followed by threshold with each GrayThreshold kernel
+// preconditions: imageName is a valid image, repetitions is at least 1
+// postconditions: outputs the fastest of repetitions runs of each path on the image, in
+//	milliseconds, and how many times faster than the two step path it is
+
+// --------------------------------------------------------------------------------------
+int runGrayBench(const string& imageName, int repetitions)
+{
+	Mat image = imread(imageName);
+	if (image.empty())
+	{
+		cerr << imageName << " could not be read" << endl;
+		return 1;
+	}
+
+	RecognitionParams params;
+	Mat gray, binary;
+	TickMeter timer;
+
+	// the outputs are created before timing so every run writes into existing buffers
+	cvtColor(image, gray, COLOR_BGR2GRAY);
+	threshold(gray, binary, params.minThreshold, params.maxThreshold, THRESH_BINARY);
+	double twoStep = DBL_MAX;
+	for (int i = 0; i < repetitions; i++)
+	{
+		timer.reset();
+		timer.start();
+		cvtColor(image, gray, COLOR_BGR2GRAY);
+		threshold(gray, binary, params.minThreshold, params.maxThreshold, THRESH_BINARY);
+		timer.stop();
+		twoStep = min(twoStep, timer.getTimeMilli());
+	}
+
+	cout << "Image: " << imageName << " (" << image.cols << " x " << image.rows << ")" << endl;
+	cout << "Path, Best ms, Speedup" << endl;
+	cout << "cvtColor + threshold, " << twoStep << ", 1" << endl;
+
+	const GrayThresholdKernel kernels[] = { GrayThresholdKernel::Scalar, GrayThresholdKernel::SSSE3,
+		GrayThresholdKernel::AVX2 };
+	for (GrayThresholdKernel kernel : kernels)
+	{
+		if (!GrayThreshold::isSupported(kernel)) continue;
+		double best = DBL_MAX;
+		for (int i = 0; i < repetitions; i++)
+		{
+			timer.reset();
+			timer.start();
+			GrayThreshold::apply(image, binary, params.minThreshold, params.maxThreshold, kernel);
+			timer.stop();
+			best = min(best, timer.getTimeMilli());
+		}
+		cout << GrayThreshold::kernelName(kernel) << (kernel == GrayThreshold::bestKernel() ?
+			" (used)" : "") << ", " << best << ", " << twoStep / best << endl;
+	}
+	return 0;
+}
+
+// ------------------------------------ graybenchCommand --------------------------------------
+
+// purpose: time the threshold kernels from the command line
+// preconditions: argv[1] is graybench and argc is at least 3
+// postconditions: the arguments after argv[1] are read and the mode is run; returns its exit
+//	code, or USAGE_ERROR if the arguments are wrong
+
+// --------------------------------------------------------------------------------------
+int graybenchCommand(int argc, char* argv[])
+{
+	int repetitions = argc >= 4 ? max(1, atoi(argv[3])) : 50;
+	return runGrayBench(argv[2], repetitions);
+}
+
+// ------------------------------------ runProfileBench --------------------------------------
+
+// purpose: compare the classification compiled for each profile with the one reading its limits
+//	at run time
+// preconditions: imageNames are valid images, repetitions is at least 1
+// postconditions: each image is recognized with the parameters of every profile, then its
+//	candidate contours are classified repetitions times by each path; outputs the fastest run of
+//	each in milliseconds, how many times faster the specialized one is and whether both classified
+//	every contour the same. Returns 1 if any differ or an image could not be read
+
+// --------------------------------------------------------------------------------------
+int runProfileBench(const vector<string>& imageNames, int repetitions)
+{
+	const RecognitionProfile profiles[] = { RecognitionProfile::Digital, RecognitionProfile::Photo,
+		RecognitionProfile::Scan };
+	RecognitionScratch scratch;
+	RecognitionResult result;
+	int numFailed = 0;
+
+	cout << "Image, Profile, Candidates, Generic ms, Specialized ms, Speedup, Same" << endl;
+	for (size_t i = 0; i < imageNames.size(); i++)
+	{
+		Mat image = imread(imageNames[i], IMREAD_COLOR);
+		if (image.empty())
+		{
+			cerr << imageNames[i] << " could not be read" << endl;
+			numFailed++;
+			continue;
+		}
+		for (int p = 0; p < 3; p++)
+		{
+			// leaves the contours of the image and its candidates in scratch
+			RecognitionParams params = profileParams(profiles[p]);
+			RecognitionCore::recognize(image, params, scratch, result);
+
+			double times[2] = { DBL_MAX, DBL_MAX };
+			vector<ShapeType> types[2];
+			vector<CascadeStage> stages[2];
+			for (int r = 0; r < repetitions; r++)
+			{
+				// the two paths take turns so neither is favored by a warmer cache
+				for (int specialize = 0; specialize < 2; specialize++)
+				{
+					auto start = chrono::steady_clock::now();
+					RecognitionCore::classifyCandidates(params, specialize == 1, scratch);
+					auto end = chrono::steady_clock::now();
+					times[specialize] = min(times[specialize], chrono::duration<double, milli>(end - start).count());
+					types[specialize] = scratch.candidateTypes;
+					stages[specialize] = scratch.candidateStages;
+				}
+			}
+
+			bool same = types[0] == types[1] && stages[0] == stages[1];
+			if (!same) numFailed++;
+			cout << imageNames[i] << ", " << profileName(profiles[p]) << ", " <<
+				scratch.candidateContours.size() << ", " << times[0] << ", " << times[1] << ", " <<
+				times[0] / max(times[1], 1e-9) << ", " << (same ? "yes" : "no") << endl;
+		}
+	}
+	return numFailed == 0 ? 0 : 1;
+}
+
+// ------------------------------------ profilebenchCommand --------------------------------------
+
+// purpose: time the specialized profiles against the generic code from the command line
+// preconditions: argv[1] is profilebench and argc is at least 3
+// postconditions: the arguments after argv[1] are read and the mode is run; returns its exit
+//	code, or USAGE_ERROR if the arguments are wrong
+
+// --------------------------------------------------------------------------------------
+int profilebenchCommand(int argc, char* argv[])
+{
+	int repetitions = 20;
+	vector<string> imageNames;
+	for (int i = 2; i < argc; i++)
+	{
+		if (string(argv[i]) == "--runs" && i + 1 < argc) repetitions = max(1, atoi(argv[++i]));
+		else imageNames.push_back(argv[i]);
+	}
+	return runProfileBench(imageNames, repetitions);
+}
+
+// ------------------------------------ runComponents --------------------------------------
+
+// purpose: compare finding the contours with the component extractor against findContours
+// preconditions: imageNames are valid images; noiseLevels are fractions between 0 and 1;
+//	repetitions is at least 1
+// postconditions: each image, and for every noise level a generated diagram with that fraction of
+//	its pixels turned into specks, is recognized repetitions times with each backend; outputs
+//	the regions of the threshold, how many were traced, the fastest recognition with each
+//	backend in milliseconds, how many times faster the extractor is and whether both found the
+//	same shapes. Returns 1 if any differ or an image could not be read
+
+// --------------------------------------------------------------------------------------
+int runComponents(const vector<string>& imageNames, const vector<double>& noiseLevels, int repetitions)
+{
+	vector<string> names;
+	vector<Mat> images;
+	for (size_t i = 0; i < imageNames.size(); i++)
+	{
+		Mat image = imread(imageNames[i], IMREAD_COLOR);
+		if (image.empty())
+		{
+			cerr << imageNames[i] << " could not be read" << endl;
+			return 1;
+		}
+		names.push_back(imageNames[i]);
+		images.push_back(image);
+	}
+	// speckled pages, where almost every region is a speck findContours would trace
+	for (size_t i = 0; i < noiseLevels.size(); i++)
+	{
+		DiagramSpec spec = DiagramGenerator::mix(40);
+		spec.noise = noiseLevels[i];
+		try
+		{
+			images.push_back(DiagramGenerator::generate(spec));
+		}
+		catch (const cv::Exception& e)
+		{
+			cerr << e.err << endl;
+			return 1;
+		}
+		ostringstream name;
+		name << "generated noise " << noiseLevels[i];
+		names.push_back(name.str());
+	}
+
+	RecognitionParams params[2];
+	params[1].contourBackend = ContourBackend::Components;
+	RecognitionScratch scratch[2];
+	RecognitionResult result[2];
+	int numFailed = 0;
+
+	cout << "Image, Regions, Traced, FindContours ms, Components ms, Speedup, Same" << endl;
+	for (size_t i = 0; i < images.size(); i++)
+	{
+		double times[2] = { DBL_MAX, DBL_MAX };
+		for (int r = 0; r < repetitions; r++)
+		{
+			// the two backends take turns so neither is favored by a warmer cache
+			for (int b = 0; b < 2; b++)
+			{
+				auto start = chrono::steady_clock::now();
+				RecognitionCore::recognize(images[i], params[b], scratch[b], result[b]);
+				auto end = chrono::steady_clock::now();
+				times[b] = min(times[b], chrono::duration<double, milli>(end - start).count());
+			}
+		}
+
+		bool same = sameShapes(result[0].shapes, result[1].shapes);
+		if (!same) numFailed++;
+		cout << names[i] << ", " << scratch[1].components.getNumComponents() << ", " <<
+			scratch[1].contours.size() << ", " << times[0] << ", " << times[1] << ", " <<
+			times[0] / max(times[1], 1e-9) << ", " << (same ? "yes" : "no") << endl;
+	}
+	return numFailed == 0 ? 0 : 1;
+}
+
+// ------------------------------------ componentsCommand --------------------------------------
+
+// purpose: compare the component extractor with findContours from the command line
+// preconditions: argv[1] is components
+// postconditions: the arguments after argv[1] are read and the mode is run; returns its exit
+//	code, or USAGE_ERROR if the arguments are wrong
+
+// --------------------------------------------------------------------------------------
+int componentsCommand(int argc, char* argv[])
+{
+	int repetitions = 10;
+	vector<double> noiseLevels;
+	vector<string> imageNames;
+	for (int i = 2; i < argc; i++)
+	{
+		if (string(argv[i]) == "--runs" && i + 1 < argc) repetitions = max(1, atoi(argv[++i]));
+		else if (string(argv[i]) == "--noise" && i + 1 < argc) noiseLevels.push_back(atof(argv[++i]));
+		else imageNames.push_back(argv[i]);
+	}
+	// without arguments, the bundled images and pages from clean to heavily speckled
+	if (imageNames.empty() && noiseLevels.empty())
+	{
+		imageNames = { "paintTestSimple1.png", "paintTestSimple2.png", "paintTestIntermediate1.png",
+			"paintTestIntermediate2.png", "paintTestIntermediate3.png", "paintTestIntermediate4.png",
+			"paintTestAdvance1.png", "paintTestAdvance2.png", "paintTestAdvance3.png",
+			"picasso2Refurbished.png" };
+		noiseLevels = { 0, 0.01, 0.05 };
+	}
+	return runComponents(imageNames, noiseLevels, repetitions);
+}
+
+// ------------------------------------ runCascade --------------------------------------
+
+// purpose: show at which stage of classification the contours of each image are dropped
+// preconditions: imageNames are valid images
+// postconditions: outputs one line per image with the number of contours classified, how many
+//	each stage rejected and how many became shapes
+
+// --------------------------------------------------------------------------------------
+int runCascade(const vector<string>& imageNames)
+{
+	RecognizeERDiagram rec;
+	int numFailed = 0;
+
+	cout << "Image, Contours";
+	for (int stage = 0; stage < NUM_CASCADE_STAGES; stage++)
+	{
+		cout << ", " << cascadeStageName((CascadeStage)stage);
+	}
+	cout << endl;
+
+	for (size_t i = 0; i < imageNames.size(); i++)
+	{
+		try
+		{
+			rec.recognize(imread(imageNames[i]));
+		}
+		catch (const cv::Exception&)
+		{
+			cerr << imageNames[i] << " could not be recognized" << endl;
+			numFailed++;
+			continue;
+		}
+
+		const CascadeStats& stats = rec.getCascadeStats();
+		cout << imageNames[i] << ", " << stats.total();
+		for (int stage = 0; stage < NUM_CASCADE_STAGES; stage++)
+		{
+			cout << ", " << stats.counts[stage];
+		}
+		cout << endl;
+	}
+	return numFailed == 0 ? 0 : 1;
+}
+
+// ------------------------------------ cascadeCommand --------------------------------------
+
+// purpose: count the contours each classification stage drops from the command line
+// preconditions: argv[1] is cascade and argc is at least 3
+// postconditions: the arguments after argv[1] are read and the mode is run; returns its exit
+//	code, or USAGE_ERROR if the arguments are wrong
+
+// --------------------------------------------------------------------------------------
+int cascadeCommand(int argc, char* argv[])
+{
+	return runCascade(vector<string>(argv + 2, argv + argc));
+}
+
+// ------------------------------------ runInstrument --------------------------------------
+
+// purpose: show where the time and memory of recognizing each image go
+// preconditions: imageNames are valid image files; the program was built with ERD_INSTRUMENT
+// postconditions: each image is recognized from its encoded bytes; unless json is true, one line
+//	per image with its trace is output. The histograms of every trace are then output as a table,
+//	or as JSON if json is true. The contours are found with backend
+
+// --------------------------------------------------------------------------------------
+int runInstrument(const vector<string>& imageNames, bool json, int pyramidLevels, ContourBackend backend)
+{
+	if (!RecognitionTrace::enabled())
+	{
+		cerr << "Build with ERD_INSTRUMENT defined to trace recognition" << endl;
+		return 1;
+	}
+	AllocationStats::install();
+
+	RecognizeERDiagram rec;
+	RecognitionParams params;
+	params.pyramidLevels = pyramidLevels;
+	params.contourBackend = backend;
+	rec.setParams(params);
+	TraceHistograms histograms;
+	int numFailed = 0;
+
+	if (!json)
+	{
+		cout << "Image, Width, Height, Total ms";
+		for (int counter = 0; counter < NUM_TRACE_COUNTERS; counter++)
+		{
+			cout << ", " << traceCounterName((TraceCounter)counter);
+		}
+		cout << endl;
+	}
+
+	for (size_t i = 0; i < imageNames.size(); i++)
+	{
+		ifstream file(imageNames[i], ios::binary);
+		vector<uchar> encoded((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+		try
+		{
+			rec.recognizeEncoded(encoded.data(), encoded.size());
+		}
+		catch (const cv::Exception&)
+		{
+			cerr << imageNames[i] << " could not be recognized" << endl;
+			numFailed++;
+			continue;
+		}
+
+		const RecognitionTrace& trace = rec.getTrace();
+		histograms.add(trace);
+		if (json) continue;
+
+		cout << imageNames[i] << ", " << trace.imageSize.width << ", " << trace.imageSize.height << ", " <<
+			trace.stageMs[(int)TraceStage::Total];
+		for (int counter = 0; counter < NUM_TRACE_COUNTERS; counter++)
+		{
+			cout << ", " << trace.counts[counter];
+		}
+		cout << endl;
+	}
+
+	if (json)
+	{
+		histograms.writeJson(cout);
+	}
+	else
+	{
+		cout << endl;
+		histograms.writeText(cout);
+	}
+	return numFailed == 0 ? 0 : 1;
+}
+
+// ------------------------------------ instrumentCommand --------------------------------------
+
+// purpose: time each stage of recognizing images from the command line
+// preconditions: argv[1] is instrument and argc is at least 3
+// postconditions: the arguments after argv[1] are read and the mode is run; returns its exit
+//	code, or USAGE_ERROR if the arguments are wrong
+
+// --------------------------------------------------------------------------------------
+int instrumentCommand(int argc, char* argv[])
+{
+	bool json = false;
+	int pyramidLevels = 0;
+	ContourBackend backend = ContourBackend::FindContours;
+	vector<string> imageNames;
+	for (int i = 2; i < argc; i++)
+	{
+		if (string(argv[i]) == "--json") json = true;
+		else if (string(argv[i]) == "--pyramid" && i + 1 < argc) pyramidLevels = max(0, atoi(argv[++i]));
+		else if (string(argv[i]) == "--backend" && i + 1 < argc)
+		{
+			if (!parseContourBackend(argv[++i], backend))
+			{
+				cerr << "unknown backend " << argv[i] << endl;
+				return 1;
+			}
+		}
+		else imageNames.push_back(argv[i]);
+	}
+	return runInstrument(imageNames, json, pyramidLevels, backend);
+}
+
+// ------------------------------------ runGraphBench --------------------------------------
+
+// purpose: time connector extraction on generated diagrams of growing size
+// preconditions: shapeCounts are at least 1 and repetitions is at least 1
+// postconditions: for each count, a diagram of that many shapes is generated, recognized and has
+//	its connectors extracted repetitions times; one line gives the nodes, the connectors found
+//	against the lines drawn, what happened to the other strokes and the fastest time. Returns 1
+//	unless every diagram gave the connectors drawn
+
+// --------------------------------------------------------------------------------------
+int runGraphBench(const vector<int>& shapeCounts, int repetitions)
+{
+	RecognizeERDiagram rec;
+	ConnectorExtractor extractor;
+	const RecognitionParams& params = rec.getParams();
+	Mat binary;
+	int numMismatched = 0;
+
+	cout << "Shapes, Megapixels, Nodes, Connectors, Expected, Strokes, Too Short, Unattached, " <<
+		"Self Loops, Recognize ms, Extract ms, Extract us per Shape" << endl;
+	for (size_t i = 0; i < shapeCounts.size(); i++)
+	{
+		DiagramSpec spec = DiagramGenerator::mix(shapeCounts[i]);
+		Mat page;
+		try
+		{
+			page = DiagramGenerator::generate(spec);
+		}
+		catch (const cv::Exception& e)
+		{
+			cerr << e.err << endl;
+			return 1;
+		}
+
+		auto start = chrono::steady_clock::now();
+		GrayThreshold::apply(page, binary, params.minThreshold, params.maxThreshold);
+		rec.recognizeThresholded(page, binary);
+		auto end = chrono::steady_clock::now();
+		double recognizeMs = chrono::duration<double, milli>(end - start).count();
+
+		// the first run sizes the buffers, the rest reuse them as a long running service would
+		double extractMs = DBL_MAX;
+		for (int run = 0; run < repetitions; run++)
+		{
+			start = chrono::steady_clock::now();
+			extractor.extract(binary, rec.getShapes(), params);
+			end = chrono::steady_clock::now();
+			extractMs = min(extractMs, chrono::duration<double, milli>(end - start).count());
+		}
+
+		const ShapeTable& shapes = rec.getShapes();
+		const ConnectorStats& stats = extractor.getStats();
+		int numConnectors = (int)extractor.getConnectors().size();
+		int expected = DiagramGenerator::expectedConnectors(spec);
+		if (numConnectors != expected) numMismatched++;
+		cout << shapeCounts[i] << ", " << page.total() / 1e6 << ", " <<
+			shapes.size() - shapes.count(ShapeType::Discarded) << ", " << numConnectors << ", " << expected <<
+			", " << stats.strokes << ", " << stats.tooShort << ", " << stats.unattached << ", " <<
+			stats.selfLoops << ", " << recognizeMs << ", " << extractMs << ", " <<
+			extractMs * 1000 / shapeCounts[i] << endl;
+	}
+	return numMismatched == 0 ? 0 : 1;
+}
+
+// ------------------------------------ graphbenchCommand --------------------------------------
+
+// purpose: time the connector extraction on generated pages from the command line
+// preconditions: argv[1] is graphbench
+// postconditions: the arguments after argv[1] are read and the mode is run; returns its exit
+//	code, or USAGE_ERROR if the arguments are wrong
+
+// --------------------------------------------------------------------------------------
+int graphbenchCommand(int argc, char* argv[])
+{
+	int repetitions = 5;
+	vector<int> shapeCounts;
+	for (int i = 2; i < argc; i++)
+	{
+		if (string(argv[i]) == "--runs" && i + 1 < argc) repetitions = max(1, atoi(argv[++i]));
+		else if (atoi(argv[i]) > 0) shapeCounts.push_back(atoi(argv[i]));
+	}
+	// pages of about 1, 8 and 32 megapixels
+	if (shapeCounts.empty()) shapeCounts = { 30, 300, 1200 };
+	return runGraphBench(shapeCounts, repetitions);
+}
+
+// ------------------------------------ runBenchmark --------------------------------------
+
+// purpose: time recognition and each of its stages for comparison between builds
+// preconditions: imageNames are valid images, or empty to use the bundled test images;
+//	mosaicSizes and generatedSizes are at least 1; outFile is empty or a writable path
+// postconditions: each image, for every mosaic size n a page of n by n of the images, and for
+//	every generated size n a generated diagram of n shapes, is timed repetitions times; the JSON
+//	results are written to outFile, or output if it is empty
+
+// --------------------------------------------------------------------------------------
+int runBenchmark(vector<string> imageNames, const vector<int>& mosaicSizes,
+	const vector<int>& generatedSizes, int repetitions, const string& outFile)
+{
+	if (imageNames.empty())
+	{
+		imageNames = { "paintTestSimple1.png", "paintTestSimple2.png", "paintTestIntermediate1.png",
+			"paintTestIntermediate2.png", "paintTestIntermediate3.png", "paintTestIntermediate4.png",
+			"paintTestAdvance1.png", "paintTestAdvance2.png", "paintTestAdvance3.png",
+			"picasso2Refurbished.png" };
+	}
+
+	RecognitionBenchmark benchmark(repetitions);
+	vector<Mat> images;
+	for (size_t i = 0; i < imageNames.size(); i++)
+	{
+		Mat image = imread(imageNames[i]);
+		if (image.empty())
+		{
+			cerr << imageNames[i] << " could not be read" << endl;
+			return 1;
+		}
+		images.push_back(image);
+		benchmark.addImage(imageNames[i], image);
+	}
+	// larger pages than any bundled image, with the same drawings repeated across them
+	for (size_t i = 0; i < mosaicSizes.size(); i++)
+	{
+		int n = mosaicSizes[i];
+		benchmark.addImage("mosaic " + to_string(n) + "x" + to_string(n),
+			RecognitionBenchmark::mosaic(images, n, n));
+	}
+	// pages with many more shapes than any bundled image, none of them repeated
+	for (size_t i = 0; i < generatedSizes.size(); i++)
+	{
+		int n = generatedSizes[i];
+		benchmark.addImage("generated " + to_string(n), DiagramGenerator::generate(DiagramGenerator::mix(n)));
+	}
+
+	try
+	{
+		benchmark.run();
+	}
+	catch (const cv::Exception&)
+	{
+		cerr << "the benchmark images could not be recognized" << endl;
+		return 1;
+	}
+
+	if (outFile.empty())
+	{
+		benchmark.writeJson(cout);
+		return 0;
+	}
+	ofstream out(outFile);
+	benchmark.writeJson(out);
+	if (!out)
+	{
+		cerr << outFile << " could not be written" << endl;
+		return 1;
+	}
+	return 0;
+}
+
+// ------------------------------------ benchCommand --------------------------------------
+
+// purpose: benchmark every stage from the command line
+// preconditions: argv[1] is bench
+// postconditions: the arguments after argv[1] are read and the mode is run; returns its exit
+//	code, or USAGE_ERROR if the arguments are wrong
+
+// --------------------------------------------------------------------------------------
+int benchCommand(int argc, char* argv[])
+{
+	int repetitions = 10;
+	vector<int> mosaicSizes;
+	vector<int> generatedSizes;
+	bool mosaicGiven = false;
+	string outFile;
+	vector<string> imageNames;
+	for (int i = 2; i < argc; i++)
+	{
+		if (string(argv[i]) == "--runs" && i + 1 < argc) repetitions = max(1, atoi(argv[++i]));
+		else if (string(argv[i]) == "--mosaic" && i + 1 < argc)
+		{
+			mosaicGiven = true;
+			int n = atoi(argv[++i]);
+			if (n > 0) mosaicSizes.push_back(n);
+		}
+		else if (string(argv[i]) == "--generated" && i + 1 < argc)
+		{
+			int n = atoi(argv[++i]);
+			if (n > 0) generatedSizes.push_back(n);
+		}
+		else if (string(argv[i]) == "--out" && i + 1 < argc) outFile = argv[++i];
+		else imageNames.push_back(argv[i]);
+	}
+	// pages of about 2800 x 1900 and 5600 x 3800 pixels from the bundled images
+	if (!mosaicGiven) mosaicSizes = { 2, 4 };
+	return runBenchmark(imageNames, mosaicSizes, generatedSizes, repetitions, outFile);
+}
+
+// ------------------------------------ bundledTests --------------------------------------
+
+// purpose: get the tests of the images that come with the project
+// preconditions: none
+// postconditions: returns the image name and the expected count of each type of every bundled image
+
+// --------------------------------------------------------------------------------------
+vector<Test> bundledTests()
+{
+	vector<Test> testCases;
+
+	//Test Structure is: {"imageName.png", attribute, entity, relationship, weak entity,
+	//					  weak relationship, multivalue attribute}
+	testCases.push_back(Test{ "paintTestSimple1.png", 0, 2, 1, 0, 0, 0 });
+	testCases.push_back(Test{ "paintTestSimple2.png", 4, 2, 1, 0, 0, 1 });
+	testCases.push_back(Test{ "paintTestIntermediate1.png", 3, 2, 1, 1, 1, 1 });
+	testCases.push_back(Test{ "paintTestIntermediate2.png", 3, 2, 1, 1, 1, 0 });
+	testCases.push_back(Test{ "paintTestIntermediate3.png", 5, 2, 1, 0, 0, 0 });
+	testCases.push_back(Test{ "paintTestIntermediate4.png", 5, 1, 0, 1, 1, 0 });
+	testCases.push_back(Test{ "paintTestAdvance2.png", 11, 2, 1, 1, 1, 1 });
+	testCases.push_back(Test{ "paintTestAdvance3.png", 10, 3, 2, 2, 2, 1 });
+	testCases.push_back(Test{ "paintTestAdvance1.png", 13, 3, 3, 1, 1, 0 });
+	return testCases;
+}
+
+// ------------------------------------ runGate --------------------------------------
+
+// purpose: check that a change did not make recognition less accurate or slower
+// preconditions: the images of tests are readable; baselineName and saveName are empty or
+//	paths of baseline files
+// postconditions: every test image is recognized repetitions times and its counts, latency
+//	percentiles and peak memory are output with the number of images that had each count right;
+//	if baselineName is given, every regression against it is output and 1 is returned if there
+//	is any. If saveName is given the results are written there as the next baseline. Returns 1
+//	if an image could not be recognized or a baseline could not be read or written
+
+// --------------------------------------------------------------------------------------
+int runGate(const vector<Test>& tests, int repetitions, const RecognitionParams& params,
+	const string& baselineName, const string& saveName, double tolerance, double slackMs)
+{
+	RegressionGate gate(repetitions, params);
+	for (size_t i = 0; i < tests.size(); i++)
+	{
+		gate.addTest(tests[i]);
+	}
+	gate.run();
+	gate.writeText(cout);
+
+	bool failed = false;
+	const vector<RegressionResult>& results = gate.getResults();
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		failed = failed || !results[i].recognized;
+	}
+
+	try
+	{
+		if (!baselineName.empty())
+		{
+			cout << endl;
+			int numRegressions = gate.compare(baselineName, tolerance, slackMs, cout);
+			cout << numRegressions << " regressions against " << baselineName << " (tolerance " <<
+				tolerance * 100 << "% + " << slackMs << " ms)" << endl;
+			failed = failed || numRegressions > 0;
+		}
+		// written even after a regression, so the new numbers can be looked at or taken on purpose
+		if (!saveName.empty())
+		{
+			gate.writeBaseline(saveName);
+			cout << "baseline written to " << saveName << endl;
+		}
+	}
+	catch (const cv::Exception& e)
+	{
+		cerr << e.err << endl;
+		return 1;
+	}
+	return failed ? 1 : 0;
+}
+
+// ------------------------------------ gateCommand --------------------------------------
+
+// purpose: run the regression gate from the command line
+// preconditions: argv[1] is gate
+// postconditions: the arguments after argv[1] are read and the mode is run; returns its exit
+//	code, or USAGE_ERROR if the arguments are wrong
+
+// --------------------------------------------------------------------------------------
+int gateCommand(int argc, char* argv[])
+{
+	int repetitions = 20;
+	string baselineName;
+	string saveName;
+	// fraction a percentile may grow by, and milliseconds on top for the jitter of tiny images
+	double tolerance = 0.10;
+	double slackMs = 0.5;
+	RecognitionProfile profile = RecognitionProfile::Digital;
+	ContourBackend backend = ContourBackend::FindContours;
+	vector<string> manifestNames;
+	for (int i = 2; i < argc; i++)
+	{
+		if (string(argv[i]) == "--runs" && i + 1 < argc) repetitions = max(1, atoi(argv[++i]));
+		else if (string(argv[i]) == "--baseline" && i + 1 < argc) baselineName = argv[++i];
+		else if (string(argv[i]) == "--save" && i + 1 < argc) saveName = argv[++i];
+		else if (string(argv[i]) == "--tolerance" && i + 1 < argc) tolerance = max(0.0, atof(argv[++i]));
+		else if (string(argv[i]) == "--slack" && i + 1 < argc) slackMs = max(0.0, atof(argv[++i]));
+		else if (string(argv[i]) == "--profile" && i + 1 < argc)
+		{
+			if (!parseProfile(argv[++i], profile))
+			{
+				cerr << "unknown profile " << argv[i] << endl;
+				return 1;
+			}
+		}
+		else if (string(argv[i]) == "--backend" && i + 1 < argc)
+		{
+			if (!parseContourBackend(argv[++i], backend))
+			{
+				cerr << "unknown backend " << argv[i] << endl;
+				return 1;
+			}
+		}
+		else manifestNames.push_back(argv[i]);
+	}
+
+	// without a manifest, the tests of the bundled images
+	vector<Test> tests;
+	if (manifestNames.empty()) tests = bundledTests();
+	try
+	{
+		for (size_t i = 0; i < manifestNames.size(); i++)
+		{
+			RegressionGate::loadManifest(manifestNames[i], tests);
+		}
+	}
+	catch (const cv::Exception& e)
+	{
+		cerr << e.err << endl;
+		return 1;
+	}
+
+	RecognitionParams params = profileParams(profile);
+	params.contourBackend = backend;
+	return runGate(tests, repetitions, params, baselineName, saveName, tolerance, slackMs);
+}
@@ -0,0 +1,117 @@
+// BenchmarkCommands.h
+// Purpose: time and check the stages of recognition, and gate changes on accuracy and latency
+// Functionality: the graycheck, graybench, profilebench, components, cascade, instrument, graphbench,
+//	bench and gate modes of the program: each command reads its arguments and runs its driver,
+//	which checks a kernel against OpenCV, times a stage, counts what a stage drops, or runs the
+//	regression gate over the bundled tests or a manifest
+// Assumptions:
+//	Times are only compared between runs on the same machine
+// Authors: Allan Genari Gaarden, Tommy Ni, Joshua Medvinsky
+
+#ifndef BENCHMARK_COMMANDS_H
+#define BENCHMARK_COMMANDS_H
+
+#include "Command.h"
+#include "DiagramTest.h"
+#include <vector>
+
+// ------------------------------------ bundledTests --------------------------------------
+
+// purpose: get the tests of the images that come with the project
+// preconditions: none
+// postconditions: returns the image name and the expected count of each type of every bundled image
+
+// --------------------------------------------------------------------------------------
+vector<Test> bundledTests();
+
+// ------------------------------------ graycheckCommand --------------------------------------
+
+// purpose: check the threshold kernels from the command line
+// preconditions: argv[1] is graycheck
+// postconditions: the arguments after argv[1] are read and the mode is run; returns its exit
+//	code, or USAGE_ERROR if the arguments are wrong
+
+// --------------------------------------------------------------------------------------
+int graycheckCommand(int argc, char* argv[]);
+
+// ------------------------------------ graybenchCommand --------------------------------------
+
+// purpose: time the threshold kernels from the command line
+// preconditions: argv[1] is graybench and argc is at least 3
+// postconditions: the arguments after argv[1] are read and the mode is run; returns its exit
+//	code, or USAGE_ERROR if the arguments are wrong
+
+// --------------------------------------------------------------------------------------
+int graybenchCommand(int argc, char* argv[]);
+
+// ------------------------------------ profilebenchCommand --------------------------------------
+
+// purpose: time the specialized profiles against the generic code from the command line
+// preconditions: argv[1] is profilebench and argc is at least 3
+// postconditions: the arguments after argv[1] are read and the mode is run; returns its exit
+//	code, or USAGE_ERROR if the arguments are wrong
+
+// --------------------------------------------------------------------------------------
+int profilebenchCommand(int argc, char* argv[]);
+
+// ------------------------------------ componentsCommand --------------------------------------
+
+// purpose: compare the component extractor with findContours from the command line
+// preconditions: argv[1] is components
+// postconditions: the arguments after argv[1] are read and the mode is run; returns its exit
+//	code, or USAGE_ERROR if the arguments are wrong
+
+// --------------------------------------------------------------------------------------
+int componentsCommand(int argc, char* argv[]);
+
+// ------------------------------------ cascadeCommand --------------------------------------
+
+// purpose: count the contours each classification stage drops from the command line
+// preconditions: argv[1] is cascade and argc is at least 3
+// postconditions: the arguments after argv[1] are read and the mode is run; returns its exit
+//	code, or USAGE_ERROR if the arguments are wrong
+
+// --------------------------------------------------------------------------------------
+int cascadeCommand(int argc, char* argv[]);
+
+// ------------------------------------ instrumentCommand --------------------------------------
+
+// purpose: time each stage of recognizing images from the command line
+// preconditions: argv[1] is instrument and argc is at least 3
+// postconditions: the arguments after argv[1] are read and the mode is run; returns its exit
+//	code, or USAGE_ERROR if the arguments are wrong
+
+// --------------------------------------------------------------------------------------
+int instrumentCommand(int argc, char* argv[]);
+
+// ------------------------------------ graphbenchCommand --------------------------------------
+
+// purpose: time the connector extraction on generated pages from the command line
+// preconditions: argv[1] is graphbench
+// postconditions: the arguments after argv[1] are read and the mode is run; returns its exit
+//	code, or USAGE_ERROR if the arguments are wrong
+
+// --------------------------------------------------------------------------------------
+int graphbenchCommand(int argc, char* argv[]);
+
+// ------------------------------------ benchCommand --------------------------------------
+
+// purpose: benchmark every stage from the command line
+// preconditions: argv[1] is bench
+// postconditions: the arguments after argv[1] are read and the mode is run; returns its exit
+//	code, or USAGE_ERROR if the arguments are wrong
+
+// --------------------------------------------------------------------------------------
+int benchCommand(int argc, char* argv[]);
+
+// ------------------------------------ gateCommand --------------------------------------
+
+// purpose: run the regression gate from the command line
+// preconditions: argv[1] is gate
+// postconditions: the arguments after argv[1] are read and the mode is run; returns its exit
+//	code, or USAGE_ERROR if the arguments are wrong
+
+// --------------------------------------------------------------------------------------
+int gateCommand(int argc, char* argv[]);
+
+#endif
@@ -0,0 +1,312 @@
+// BoundedQueue.h
+// Purpose: hand items from one pipeline stage to the next without locks, holding back the
+//	faster stage when the slower one falls behind
+// Functionality: a fixed ring of slots with one producer thread and one consumer thread. The
+//	producer only writes the tail and the consumer only writes the head, so neither ever takes a
+//	lock. push waits while the queue is full and pop while it is empty; the time each side waited,
+//	how often it had to, and how full the queue was are kept as QueueStats
+// Assumptions:
+//	Exactly one thread pushes and exactly one thread pops
+//	T can be moved, and a moved from T can be assigned again
+//	The stats are only read once both threads are done with the queue
+// Authors: Allan Genari Gaarden, Tommy Ni, Joshua Medvinsky
+
+#ifndef BOUNDED_QUEUE_H
+#define BOUNDED_QUEUE_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <utility>
+#include <vector>
+using namespace std;
+
+// how a queue was used
+struct QueueStats
+{
+	int capacity = 0;
+	long long numPushed = 0;
+	// the most items held at once, and the sum of the items held after each push
+	int maxDepth = 0;
+	long long depthSum = 0;
+	// how often and how long the producer waited for a free slot (the consumer was behind)
+	long long numFullWaits = 0;
+	double fullWaitMs = 0;
+	// how often and how long the consumer waited for an item (the producer was behind)
+	long long numEmptyWaits = 0;
+	double emptyWaitMs = 0;
+};
+
+template <typename T>
+class BoundedQueue
+{
+public:
+	// default constructor not allowed
+	BoundedQueue() = delete;
+	// ------------------------------------ parameter constructor --------------------------------------
+
+// purpose: create an empty queue
+// preconditions: capacity is at least 1
+// postconditions: at most capacity items can be held at once
+
+// --------------------------------------------------------------------------------------
+	BoundedQueue(int capacity);
+	// ------------------------------------ push --------------------------------------
+
+// purpose: hand an item to the consumer, waiting while the queue is full
+// preconditions: called by the producer only, and not after close
+// postconditions: returns true once item has been moved into the queue, or false without moving
+//	it if the queue was cancelled
+
+// --------------------------------------------------------------------------------------
+	bool push(T& item);
+	// ------------------------------------ tryPush --------------------------------------
+
+// purpose: hand an item to the consumer only if there is room
+// preconditions: called by the producer only, and not after close
+// postconditions: returns true if item was moved into the queue; never waits
+
+// --------------------------------------------------------------------------------------
+	bool tryPush(T& item);
+	// ------------------------------------ pop --------------------------------------
+
+// purpose: take the oldest item, waiting while the queue is empty
+// preconditions: called by the consumer only
+// postconditions: returns true with the item moved into item, or false once the queue was closed
+//	and is empty, or was cancelled
+
+// --------------------------------------------------------------------------------------
+	bool pop(T& item);
+	// ------------------------------------ tryPop --------------------------------------
+
+// purpose: take the oldest item only if there is one
+// preconditions: called by the consumer only
+// postconditions: returns true with the item moved into item; never waits
+
+// --------------------------------------------------------------------------------------
+	bool tryPop(T& item);
+	// ------------------------------------ close --------------------------------------
+
+// purpose: tell the consumer no more items are coming
+// preconditions: called by the producer only
+// postconditions: pop returns false once the items still held are taken
+
+// --------------------------------------------------------------------------------------
+	void close();
+	// ------------------------------------ cancel --------------------------------------
+
+// purpose: stop both sides at once, e.g. when a stage fails
+// preconditions: none; safe from any thread
+// postconditions: waiting and later calls to push and pop return false
+
+// --------------------------------------------------------------------------------------
+	void cancel();
+	// ------------------------------------ getStats --------------------------------------
+
+// purpose: get how the queue was used
+// preconditions: neither side is using the queue any more
+// postconditions: returns the waits and depths since the queue was created
+
+// --------------------------------------------------------------------------------------
+	const QueueStats& getStats() const;
+
+private:
+	// a wait spins this many times before it starts sleeping, since a stage usually finishes
+	//	its item in less time than a sleep takes
+	static const int SPIN_LIMIT = 64;
+
+	// one slot more than the capacity, so a full queue can be told from an empty one
+	vector<T> slots;
+	// the next slot to pop, written by the consumer only, and the next slot to push, written by
+	//	the producer only; apart so the two threads do not share a cache line
+	alignas(64) atomic<size_t> head{ 0 };
+	alignas(64) atomic<size_t> tail{ 0 };
+	atomic<bool> closed{ false };
+	atomic<bool> cancelled{ false };
+	// the push side is written by the producer, the pop side by the consumer
+	QueueStats stats;
+
+	// ------------------------------------ pause --------------------------------------
+
+// purpose: wait a little before checking the queue again
+// preconditions: attempt counts the checks made so far by this wait
+// postconditions: the thread yielded, or slept once the wait has spun SPIN_LIMIT times
+
+// --------------------------------------------------------------------------------------
+	static void pause(int attempt);
+};
+
+// ------------------------------------ parameter constructor --------------------------------------
+
+// purpose: create an empty queue
+// preconditions: capacity is at least 1
+// postconditions: at most capacity items can be held at once
+
+// --------------------------------------------------------------------------------------
+template <typename T>
+BoundedQueue<T>::BoundedQueue(int capacity) : slots((size_t)max(1, capacity) + 1)
+{
+	stats.capacity = (int)slots.size() - 1;
+}
+
+// ------------------------------------ push --------------------------------------
+
+// purpose: hand an item to the consumer, waiting while the queue is full
+// preconditions: called by the producer only, and not after close
+// postconditions: returns true once item has been moved into the queue, or false without moving
+//	it if the queue was cancelled
+
+// --------------------------------------------------------------------------------------
+template <typename T>
+bool BoundedQueue<T>::push(T& item)
+{
+	if (tryPush(item)) return true;
+
+	// the clock is only read when the queue is full, so a pipeline that keeps up pays nothing
+	stats.numFullWaits++;
+	auto start = chrono::steady_clock::now();
+	bool pushed = false;
+	for (int attempt = 0; !pushed && !cancelled.load(memory_order_relaxed); attempt++)
+	{
+		pause(attempt);
+		pushed = tryPush(item);
+	}
+	stats.fullWaitMs += chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+	return pushed;
+}
+
+// ------------------------------------ tryPush --------------------------------------
+
+// purpose: hand an item to the consumer only if there is room
+// preconditions: called by the producer only, and not after close
+// postconditions: returns true if item was moved into the queue; never waits
+
+// --------------------------------------------------------------------------------------
+template <typename T>
+bool BoundedQueue<T>::tryPush(T& item)
+{
+	if (cancelled.load(memory_order_relaxed)) return false;
+
+	size_t currentTail = tail.load(memory_order_relaxed);
+	size_t nextTail = currentTail + 1 == slots.size() ? 0 : currentTail + 1;
+	// acquire: the consumer has finished moving out of the slot before it is reused
+	size_t currentHead = head.load(memory_order_acquire);
+	if (nextTail == currentHead) return false;
+
+	slots[currentTail] = move(item);
+	// release: the item is in its slot before the consumer can see it
+	tail.store(nextTail, memory_order_release);
+
+	int depth = (int)(nextTail >= currentHead ? nextTail - currentHead : nextTail + slots.size() - currentHead);
+	stats.numPushed++;
+	stats.depthSum += depth;
+	stats.maxDepth = max(stats.maxDepth, depth);
+	return true;
+}
+
+// ------------------------------------ pop --------------------------------------
+
+// purpose: take the oldest item, waiting while the queue is empty
+// preconditions: called by the consumer only
+// postconditions: returns true with the item moved into item, or false once the queue was closed
+//	and is empty, or was cancelled
+
+// --------------------------------------------------------------------------------------
+template <typename T>
+bool BoundedQueue<T>::pop(T& item)
+{
+	if (tryPop(item)) return true;
+
+	stats.numEmptyWaits++;
+	auto start = chrono::steady_clock::now();
+	bool popped = false;
+	for (int attempt = 0; !popped && !cancelled.load(memory_order_relaxed); attempt++)
+	{
+		// closed is read before trying again, so an item pushed just before close is still taken
+		bool wasClosed = closed.load(memory_order_acquire);
+		popped = tryPop(item);
+		if (popped || wasClosed) break;
+		pause(attempt);
+	}
+	stats.emptyWaitMs += chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+	return popped;
+}
+
+// ------------------------------------ tryPop --------------------------------------
+
+// purpose: take the oldest item only if there is one
+// preconditions: called by the consumer only
+// postconditions: returns true with the item moved into item; never waits
+
+// --------------------------------------------------------------------------------------
+template <typename T>
+bool BoundedQueue<T>::tryPop(T& item)
+{
+	if (cancelled.load(memory_order_relaxed)) return false;
+
+	size_t currentHead = head.load(memory_order_relaxed);
+	// acquire: the item is in its slot once the producer has moved the tail past it
+	if (currentHead == tail.load(memory_order_acquire)) return false;
+
+	item = move(slots[currentHead]);
+	// release: the slot is empty before the producer can reuse it
+	head.store(currentHead + 1 == slots.size() ? 0 : currentHead + 1, memory_order_release);
+	return true;
+}
+
+// ------------------------------------ close --------------------------------------
+
+// purpose: tell the consumer no more items are coming
+// preconditions: called by the producer only
+// postconditions: pop returns false once the items still held are taken
+
+// --------------------------------------------------------------------------------------
+template <typename T>
+void BoundedQueue<T>::close()
+{
+	closed.store(true, memory_order_release);
+}
+
+// ------------------------------------ cancel --------------------------------------
+
+// purpose: stop both sides at once, e.g. when a stage fails
+// preconditions: none; safe from any thread
+// postconditions: waiting and later calls to push and pop return false
+
+// --------------------------------------------------------------------------------------
+template <typename T>
+void BoundedQueue<T>::cancel()
+{
+	cancelled.store(true, memory_order_relaxed);
+}
+
+// ------------------------------------ getStats --------------------------------------
+
+// purpose: get how the queue was used
+// preconditions: neither side is using the queue any more
+// postconditions: returns the waits and depths since the queue was created
+
+// --------------------------------------------------------------------------------------
+template <typename T>
+const QueueStats& BoundedQueue<T>::getStats() const
+{
+	return stats;
+}
+
+// ------------------------------------ pause --------------------------------------
+
+// purpose: wait a little before checking the queue again
+// preconditions: attempt counts the checks made so far by this wait
+// postconditions: the thread yielded, or slept once the wait has spun SPIN_LIMIT times
+
+// --------------------------------------------------------------------------------------
+template <typename T>
+void BoundedQueue<T>::pause(int attempt)
+{
+	// sleeping leaves the cores to the stage that is behind, which classifies on all of them
+	if (attempt < SPIN_LIMIT) this_thread::yield();
+	else this_thread::sleep_for(chrono::microseconds(100));
+}
+
+#endif
@@ -0,0 +1,75 @@
+// CascadeStats.cpp
+// Purpose: show where contours are dropped while they are classified
+// Functionality: names the stages of the classification cascade, cheapest first, and counts how
+//	many contours each stage rejects and how many pass them all
+// Assumptions:
+//	The counts cover the contours that do not touch the border of the image; those are filtered
+//	out before classification
+// Authors: Allan Genari Gaarden, Tommy Ni, Joshua Medvinsky
+
+#include "CascadeStats.h"
+
+// ------------------------------------ add --------------------------------------
+
+// purpose: count one more contour
+// preconditions: none
+// postconditions: the count of stage is one higher
+
+// --------------------------------------------------------------------------------------
+void CascadeStats::add(CascadeStage stage)
+{
+	counts[(int)stage]++;
+}
+
+// ------------------------------------ clear --------------------------------------
+
+// purpose: start counting again
+// preconditions: none
+// postconditions: every count is 0
+
+// --------------------------------------------------------------------------------------
+void CascadeStats::clear()
+{
+	for (int i = 0; i < NUM_CASCADE_STAGES; i++)
+	{
+		counts[i] = 0;
+	}
+}
+
+// ------------------------------------ total --------------------------------------
+
+// purpose: get how many contours were classified
+// preconditions: none
+// postconditions: returns the sum of the counts of every stage
+
+// --------------------------------------------------------------------------------------
+long long CascadeStats::total() const
+{
+	long long sum = 0;
+	for (int i = 0; i < NUM_CASCADE_STAGES; i++)
+	{
+		sum += counts[i];
+	}
+	return sum;
+}
+
+// ------------------------------------ cascadeStageName --------------------------------------
+
+// purpose: get the label used for a cascade stage
+// preconditions: none
+// postconditions: returns the human readable name of stage (e.g. "Bounding Box Area")
+
+// --------------------------------------------------------------------------------------
+const char* cascadeStageName(CascadeStage stage)
+{
+	switch (stage)
+	{
+	case CascadeStage::PointCount: return "Point Count";
+	case CascadeStage::BoundingBoxArea: return "Bounding Box Area";
+	case CascadeStage::AspectRatio: return "Aspect Ratio";
+	case CascadeStage::PolygonVertices: return "Polygon Vertices";
+	case CascadeStage::PolygonArea: return "Polygon Area";
+	case CascadeStage::Convexity: return "Convexity";
+	default: return "Accepted";
+	}
+}
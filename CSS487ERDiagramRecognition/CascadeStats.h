@@ -0,0 +1,69 @@
+// CascadeStats.h
+// Purpose: show where contours are dropped while they are classified
+// Functionality: names the stages of the classification cascade, cheapest first, and counts how
+//	many contours each stage rejects and how many pass them all
+// Assumptions:
+//	The counts cover the contours that do not touch the border of the image; those are filtered
+//	out before classification
+// Authors: Allan Genari Gaarden, Tommy Ni, Joshua Medvinsky
+
+#ifndef CASCADE_STATS_H
+#define CASCADE_STATS_H
+
+// the tests a contour goes through, in the order they run; a contour stops at the first test it
+//	fails, Accepted means it passed them all
+enum class CascadeStage
+{
+	PointCount,
+	BoundingBoxArea,
+	AspectRatio,
+	PolygonVertices,
+	PolygonArea,
+	Convexity,
+	Accepted
+};
+
+// number of CascadeStage values, used to size per stage arrays
+const int NUM_CASCADE_STAGES = (int)CascadeStage::Accepted + 1;
+
+// number of contours that stopped at each stage
+struct CascadeStats
+{
+	long long counts[NUM_CASCADE_STAGES] = {};
+
+	// ------------------------------------ add --------------------------------------
+
+// purpose: count one more contour
+// preconditions: none
+// postconditions: the count of stage is one higher
+
+// --------------------------------------------------------------------------------------
+	void add(CascadeStage stage);
+	// ------------------------------------ clear --------------------------------------
+
+// purpose: start counting again
+// preconditions: none
+// postconditions: every count is 0
+
+// --------------------------------------------------------------------------------------
+	void clear();
+	// ------------------------------------ total --------------------------------------
+
+// purpose: get how many contours were classified
+// preconditions: none
+// postconditions: returns the sum of the counts of every stage
+
+// --------------------------------------------------------------------------------------
+	long long total() const;
+};
+
+// ------------------------------------ cascadeStageName --------------------------------------
+
+// purpose: get the label used for a cascade stage
+// preconditions: none
+// postconditions: returns the human readable name of stage (e.g. "Bounding Box Area")
+
+// --------------------------------------------------------------------------------------
+const char* cascadeStageName(CascadeStage stage);
+
+#endif
@@ -0,0 +1,32 @@
+// Command.h
+// Purpose: describe a mode of the program, so main can pick it by name from a single table
+// Functionality: a Command holds the name of a mode, the number of arguments it needs after its
+//	name, its usage and what it does, and the function that reads its arguments and runs it. The
+//	functions are in OutputCommands, MemoryCommands, BenchmarkCommands and StreamCommands; the
+//	table of every mode, which the usage is printed from, is in main.cpp
+// Assumptions:
+//	A command is given the whole command line, argv[1] being its name
+// Authors: Allan Genari Gaarden, Tommy Ni, Joshua Medvinsky
+
+#ifndef COMMAND_H
+#define COMMAND_H
+
+// returned by a command whose arguments are wrong, so main prints the usage and exits with 1
+const int USAGE_ERROR = -1;
+
+// a mode of the program, named by the first argument
+struct Command
+{
+	// the name given as the first argument
+	const char* name;
+	// the fewest arguments the mode takes after its name
+	int minArguments;
+	// the arguments after the name, as printed in the usage
+	const char* usage;
+	// what the mode does, in a few words
+	const char* summary;
+	// reads the arguments and runs the mode; returns the exit code, or USAGE_ERROR
+	int (*run)(int argc, char* argv[]);
+};
+
+#endif
@@ -0,0 +1,386 @@
+// ComponentExtractor.cpp
+// Purpose: find the regions of a thresholded image, with their sizes and nesting, without tracing
+//	the border of every one of them
+// Functionality: one pass over the rows splits each row into runs of paper and ink and joins the
+//	runs of consecutive rows that touch, the way findContours connects pixels (paper 8-connected,
+//	ink 4-connected), with a union-find over run labels. Each region gets its bounding box, area,
+//	perimeter, the region it lies inside of, and its first pixel in row order. Every region is one
+//	contour of findContours: a paper region is the outer border traced around it and an ink
+//	region the hole border traced around it in the paper it lies in, so the regions come out in
+//	the same order and with the same parents as the contours of RETR_TREE. traceContour traces
+//	the border of one region from its runs alone, giving exactly the contour findContours gives,
+//	so only the regions that pass the size tests are ever traced
+// Assumptions:
+//	The image is 8 bit with one channel; nonzero pixels are paper and zero pixels ink, and the
+//	ink regions touching the edge of the image are part of the frame findContours puts around it,
+//	which is not a region
+// Authors: Allan Genari Gaarden, Tommy Ni, Joshua Medvinsky
+
+#include "ComponentExtractor.h"
+#include <algorithm>
+#include <climits>
+#include <cstring>
+
+// ------------------------------------ extract --------------------------------------
+
+// purpose: find every region of a thresholded image
+// preconditions: binary is an 8 bit image with one channel
+// postconditions: the regions are numbered in the order findContours with RETR_TREE lists their
+//	contours, every parent before its children; the buffers keep their memory between images
+//	and binary is not kept
+
+// --------------------------------------------------------------------------------------
+void ComponentExtractor::extract(const Mat& binary)
+{
+	if (binary.type() != CV_8UC1) CV_Error(Error::StsBadArg, "regions are found in an 8 bit image with one channel");
+
+	imageSize = binary.size();
+	runs.clear();
+	rowStarts.clear();
+	labelParent.clear();
+	labels.clear();
+	newLabel(true, Point(-1, -1), FRAME);
+
+	for (int y = 0; y < binary.rows; y++)
+	{
+		const uchar* row = binary.ptr<uchar>(y);
+		int rowStart = (int)runs.size();
+		int prevStart = y == 0 ? rowStart : rowStarts.back();
+		rowStarts.push_back(rowStart);
+		// the runs of both rows are in order, so the first run above that can touch a run only
+		//	moves right
+		int next = prevStart;
+		int x = 0;
+		while (x < binary.cols)
+		{
+			bool ink = row[x] == 0;
+			int start = x;
+			while (x < binary.cols && (row[x] == 0) == ink) x++;
+			int end = x;
+
+			// paper touches the runs above it diagonally too, ink only straight up
+			int low = ink ? start : start - 1;
+			int high = ink ? end : end + 1;
+			while (next < rowStart && runs[next].end <= low) next++;
+
+			int label = -1;
+			int enclosing = FRAME;
+			int sharedSides = 0;
+			for (int i = next; i < rowStart && runs[i].start < high; i++)
+			{
+				const Run& above = runs[i];
+				if (above.start <= start && start < above.end) enclosing = above.label;
+				if (above.ink != ink) continue;
+				label = label == -1 ? above.label : join(label, above.label);
+				sharedSides += max(0, min(end, above.end) - max(start, above.start));
+			}
+			// ink on the edge of the image is joined to the frame around it
+			if (ink && (y == 0 || y == binary.rows - 1 || start == 0 || end == binary.cols))
+			{
+				label = label == -1 ? FRAME : join(label, FRAME);
+			}
+			if (label == -1) label = newLabel(ink, Point(start, y), enclosing);
+
+			// the stats go to whichever label the run has, and are summed per region at the end
+			LabelStats& stats = labels[label];
+			stats.minX = min(stats.minX, start);
+			stats.maxX = max(stats.maxX, end);
+			stats.minY = min(stats.minY, y);
+			stats.maxY = max(stats.maxY, y);
+			stats.area += end - start;
+			// every pixel has 4 sides; the sides shared with pixels of the run or the run above
+			//	are inside the region
+			stats.perimeter += 2 * (end - start) + 2 - 2 * sharedSides;
+			runs.push_back({ start, end, label, ink });
+		}
+	}
+	rowStarts.push_back((int)runs.size());
+
+	gatherComponents();
+}
+
+// ------------------------------------ getNumComponents --------------------------------------
+
+// purpose: get the number of regions found
+// preconditions: none
+// postconditions: returns the number of regions of the last image extracted, 0 if none
+
+// --------------------------------------------------------------------------------------
+int ComponentExtractor::getNumComponents() const
+{
+	return (int)components.size();
+}
+
+// ------------------------------------ getComponent --------------------------------------
+
+// purpose: get one region
+// preconditions: id is at least 0 and less than getNumComponents()
+// postconditions: returns the region numbered id
+
+// --------------------------------------------------------------------------------------
+const Component& ComponentExtractor::getComponent(int id) const
+{
+	return components[id];
+}
+
+// ------------------------------------ contourBox --------------------------------------
+
+// purpose: get the bounding box of the contour of a region without tracing it
+// preconditions: id is at least 0 and less than getNumComponents()
+// postconditions: returns boundingRect of the contour traceContour gives: the box of a paper
+//	region, or the box of an ink region grown by a pixel on every side
+
+// --------------------------------------------------------------------------------------
+Rect ComponentExtractor::contourBox(int id) const
+{
+	const Component& component = components[id];
+	if (!component.ink) return component.box;
+	// the hole border runs along the paper pixels around the ink
+	return Rect(component.box.x - 1, component.box.y - 1, component.box.width + 2, component.box.height + 2);
+}
+
+// ------------------------------------ traceContour --------------------------------------
+
+// purpose: trace the border of one region
+// preconditions: id is at least 0 and less than getNumComponents(); method is CHAIN_APPROX_NONE
+//	or CHAIN_APPROX_SIMPLE
+// postconditions: contour holds the points findContours gives for the contour of the region when
+//	run with method on the whole image; only the pixels around the region are read. Throws
+//	cv::Exception if the runs do not hold the region, which would be a bug
+
+// --------------------------------------------------------------------------------------
+void ComponentExtractor::traceContour(int id, int method, vector<Point>& contour)
+{
+	const Component& component = components[id];
+	// the border is traced along paper: the region itself, or the paper an ink region lies in.
+	//	The tracing only looks at the pixels next to the border, which are that paper or not
+	//	paper at all, so drawing just that paper gives the border traced in the whole image
+	int paper = component.ink ? component.parent : id;
+	Rect box = contourBox(id);
+	Rect crop = Rect(box.x - 1, box.y - 1, box.width + 2, box.height + 2) & Rect(Point(0, 0), imageSize);
+
+	mask.create(crop.size(), CV_8UC1);
+	mask.setTo(Scalar(0));
+	int cropEnd = crop.x + crop.width;
+	for (int y = crop.y; y < crop.y + crop.height; y++)
+	{
+		uchar* row = mask.ptr<uchar>(y - crop.y);
+		// a noisy row has many runs, so the first one reaching the crop is searched for
+		vector<Run>::const_iterator run = lower_bound(runs.begin() + rowStarts[y], runs.begin() + rowStarts[y + 1],
+			crop.x, [](const Run& r, int x) { return r.end <= x; });
+		for (; run != runs.begin() + rowStarts[y + 1] && run->start < cropEnd; ++run)
+		{
+			if (run->label != paper) continue;
+			int start = max(run->start, crop.x);
+			int end = min(run->end, cropEnd);
+			memset(row + start - crop.x, 255, end - start);
+		}
+	}
+
+	// a paper region is the only one drawn, so its outer border is the only one; the paper
+	//	around an ink region can have other holes in the crop, but only this one has its box
+	findContours(mask, traced, tracedHierarchy, component.ink ? RETR_CCOMP : RETR_EXTERNAL, method, crop.tl());
+	for (size_t i = 0; i < traced.size(); i++)
+	{
+		bool hole = tracedHierarchy[i][3] >= 0;
+		if (hole == component.ink && boundingRect(traced[i]) == box)
+		{
+			contour.assign(traced[i].begin(), traced[i].end());
+			return;
+		}
+	}
+	CV_Error(Error::StsError, "the border of a region was not found around its runs");
+}
+
+// ------------------------------------ release --------------------------------------
+
+// purpose: free the buffers
+// preconditions: none
+// postconditions: no region is held and the buffers hold no memory
+
+// --------------------------------------------------------------------------------------
+void ComponentExtractor::release()
+{
+	// swapping with an empty vector frees the memory, which clear would keep
+	vector<Run>().swap(runs);
+	vector<int>().swap(rowStarts);
+	vector<int>().swap(labelParent);
+	vector<LabelStats>().swap(labels);
+	vector<int>().swap(labelToComponent);
+	vector<Component>().swap(components);
+	vector<int>().swap(childStarts);
+	vector<int>().swap(children);
+	vector<int>().swap(stack);
+	vector<int>().swap(newIndex);
+	vector<Component>().swap(sorted);
+	vector<vector<Point>>().swap(traced);
+	vector<Vec4i>().swap(tracedHierarchy);
+	mask.release();
+}
+
+// ------------------------------------ newLabel --------------------------------------
+
+// purpose: start a label at a run that touches no run of its color above it
+// preconditions: none
+// postconditions: returns the new label, a root of its own with no pixels yet
+
+// --------------------------------------------------------------------------------------
+int ComponentExtractor::newLabel(bool ink, Point first, int enclosing)
+{
+	int label = (int)labels.size();
+	labelParent.push_back(label);
+	labels.push_back({ INT_MAX, INT_MAX, INT_MIN, INT_MIN, 0, 0, enclosing, ink, first });
+	return label;
+}
+
+// ------------------------------------ findRoot --------------------------------------
+
+// purpose: find the label standing for all the labels joined with one
+// preconditions: label was returned by newLabel
+// postconditions: returns the smallest label joined with label; the path is shortened
+
+// --------------------------------------------------------------------------------------
+int ComponentExtractor::findRoot(int label)
+{
+	while (labelParent[label] != label)
+	{
+		// pointing each label at its grandparent halves the path every time it is walked
+		labelParent[label] = labelParent[labelParent[label]];
+		label = labelParent[label];
+	}
+	return label;
+}
+
+// ------------------------------------ join --------------------------------------
+
+// purpose: join the labels of two touching runs into one region
+// preconditions: label1 and label2 were returned by newLabel
+// postconditions: both have the smaller of their roots as root, which is returned, so a root is
+//	always the label whose first pixel comes first in row order
+
+// --------------------------------------------------------------------------------------
+int ComponentExtractor::join(int label1, int label2)
+{
+	int root1 = findRoot(label1);
+	int root2 = findRoot(label2);
+	if (root1 < root2)
+	{
+		labelParent[root2] = root1;
+		return root1;
+	}
+	labelParent[root1] = root2;
+	return root2;
+}
+
+// ------------------------------------ gatherComponents --------------------------------------
+
+// purpose: turn the labels into regions once every row has been read
+// preconditions: every run has a label
+// postconditions: components holds one region per root but the frame, in the order of
+//	findContours, with the stats of its labels summed; each run holds its region instead of its
+//	label
+
+// --------------------------------------------------------------------------------------
+void ComponentExtractor::gatherComponents()
+{
+	int numLabels = (int)labels.size();
+	labelToComponent.assign(numLabels, -1);
+	components.clear();
+
+	// a root comes before every label joined to it and after the label it lies inside of (which
+	//	is on an earlier row), so one pass in label order finds every region before its labels
+	//	and its parent before it. That is also the order findContours finds the borders in, since
+	//	it scans the rows for the first pixel of each
+	for (int label = FRAME + 1; label < numLabels; label++)
+	{
+		int root = findRoot(label);
+		if (root == FRAME) continue;
+
+		const LabelStats& stats = labels[label];
+		Rect box(stats.minX, stats.minY, stats.maxX - stats.minX, stats.maxY - stats.minY + 1);
+		if (root == label)
+		{
+			labelToComponent[label] = (int)components.size();
+			Component component;
+			component.box = box;
+			component.area = stats.area;
+			component.perimeter = stats.perimeter;
+			component.parent = labelToComponent[findRoot(stats.enclosing)];
+			component.ink = stats.ink;
+			component.first = stats.first;
+			components.push_back(component);
+		}
+		else
+		{
+			labelToComponent[label] = labelToComponent[root];
+			Component& component = components[labelToComponent[root]];
+			component.box |= box;
+			component.area += stats.area;
+			component.perimeter += stats.perimeter;
+		}
+	}
+
+	orderLikeFindContours();
+	for (size_t i = 0; i < labelToComponent.size(); i++)
+	{
+		if (labelToComponent[i] >= 0) labelToComponent[i] = newIndex[labelToComponent[i]];
+	}
+	for (size_t i = 0; i < runs.size(); i++)
+	{
+		runs[i].label = labelToComponent[runs[i].label];
+	}
+}
+
+// ------------------------------------ orderLikeFindContours --------------------------------------
+
+// purpose: put the regions in the order findContours lists their contours
+// preconditions: components is in row order of the first pixels, every parent before its children
+// postconditions: components is reordered and its parents renumbered; newIndex gives the new
+//	number of each region by its row order number
+
+// --------------------------------------------------------------------------------------
+void ComponentExtractor::orderLikeFindContours()
+{
+	int numComponents = (int)components.size();
+
+	// findContours puts each border it finds in front of the borders already found inside the
+	//	same parent, then lists the tree depth first, so the children of each region come right
+	//	after it, last found first. The children of region c (the regions on the frame for c = -1)
+	//	are children[childStarts[c + 1]] up to children[childStarts[c + 2]], in row order
+	childStarts.assign(numComponents + 2, 0);
+	for (int c = 0; c < numComponents; c++)
+	{
+		childStarts[components[c].parent + 2]++;
+	}
+	for (int i = 1; i < numComponents + 2; i++)
+	{
+		childStarts[i] += childStarts[i - 1];
+	}
+	children.resize(numComponents);
+	for (int c = 0; c < numComponents; c++)
+	{
+		children[childStarts[components[c].parent + 1]++] = c;
+	}
+	// filling moved each start to the end of its children, so they are moved back a slot
+	for (int i = numComponents + 1; i > 0; i--)
+	{
+		childStarts[i] = childStarts[i - 1];
+	}
+	childStarts[0] = 0;
+
+	// a stack pops the children of a region last found first
+	newIndex.resize(numComponents);
+	sorted.clear();
+	stack.assign(children.begin(), children.begin() + childStarts[1]);
+	while (!stack.empty())
+	{
+		int c = stack.back();
+		stack.pop_back();
+		newIndex[c] = (int)sorted.size();
+		sorted.push_back(components[c]);
+		// the parent was listed before the region, so it already has its new number
+		if (sorted.back().parent >= 0) sorted.back().parent = newIndex[sorted.back().parent];
+		stack.insert(stack.end(), children.begin() + childStarts[c + 1], children.begin() + childStarts[c + 2]);
+	}
+	components.swap(sorted);
+}
@@ -0,0 +1,198 @@
+// ComponentExtractor.h
+// Purpose: find the regions of a thresholded image, with their sizes and nesting, without tracing
+//	the border of every one of them
+// Functionality: one pass over the rows splits each row into runs of paper and ink and joins the
+//	runs of consecutive rows that touch, the way findContours connects pixels (paper 8-connected,
+//	ink 4-connected), with a union-find over run labels. Each region gets its bounding box, area,
+//	perimeter, the region it lies inside of, and its first pixel in row order. Every region is one
+//	contour of findContours: a paper region is the outer border traced around it and an ink
+//	region the hole border traced around it in the paper it lies in, so the regions come out in
+//	the same order and with the same parents as the contours of RETR_TREE. traceContour traces
+//	the border of one region from its runs alone, giving exactly the contour findContours gives,
+//	so only the regions that pass the size tests are ever traced
+// Assumptions:
+//	The image is 8 bit with one channel; nonzero pixels are paper and zero pixels ink, and the
+//	ink regions touching the edge of the image are part of the frame findContours puts around it,
+//	which is not a region
+// Authors: Allan Genari Gaarden, Tommy Ni, Joshua Medvinsky
+
+#ifndef COMPONENT_EXTRACTOR_H
+#define COMPONENT_EXTRACTOR_H
+
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+#include <vector>
+using namespace std;
+using namespace cv;
+
+// one connected region of paper or ink
+struct Component
+{
+	// bounding box of the pixels of the region
+	Rect box;
+	// number of pixels of the region
+	int area = 0;
+	// number of pixel sides between the region and the pixels around and inside it
+	int perimeter = 0;
+	// index of the region this one lies inside of, or -1 if it lies on the frame
+	int parent = -1;
+	// true for ink, whose contour is the hole border around it
+	bool ink = false;
+	// the topmost pixel of the region, the leftmost of its row
+	Point first;
+};
+
+class ComponentExtractor
+{
+public:
+	// ------------------------------------ extract --------------------------------------
+
+// purpose: find every region of a thresholded image
+// preconditions: binary is an 8 bit image with one channel
+// postconditions: the regions are numbered in the order findContours with RETR_TREE lists their
+//	contours, every parent before its children; the buffers keep their memory between images
+//	and binary is not kept
+
+// --------------------------------------------------------------------------------------
+	void extract(const Mat& binary);
+	// ------------------------------------ getNumComponents --------------------------------------
+
+// purpose: get the number of regions found
+// preconditions: none
+// postconditions: returns the number of regions of the last image extracted, 0 if none
+
+// --------------------------------------------------------------------------------------
+	int getNumComponents() const;
+	// ------------------------------------ getComponent --------------------------------------
+
+// purpose: get one region
+// preconditions: id is at least 0 and less than getNumComponents()
+// postconditions: returns the region numbered id
+
+// --------------------------------------------------------------------------------------
+	const Component& getComponent(int id) const;
+	// ------------------------------------ contourBox --------------------------------------
+
+// purpose: get the bounding box of the contour of a region without tracing it
+// preconditions: id is at least 0 and less than getNumComponents()
+// postconditions: returns boundingRect of the contour traceContour gives: the box of a paper
+//	region, or the box of an ink region grown by a pixel on every side
+
+// --------------------------------------------------------------------------------------
+	Rect contourBox(int id) const;
+	// ------------------------------------ traceContour --------------------------------------
+
+// purpose: trace the border of one region
+// preconditions: id is at least 0 and less than getNumComponents(); method is CHAIN_APPROX_NONE
+//	or CHAIN_APPROX_SIMPLE
+// postconditions: contour holds the points findContours gives for the contour of the region when
+//	run with method on the whole image; only the pixels around the region are read. Throws
+//	cv::Exception if the runs do not hold the region, which would be a bug
+
+// --------------------------------------------------------------------------------------
+	void traceContour(int id, int method, vector<Point>& contour);
+	// ------------------------------------ release --------------------------------------
+
+// purpose: free the buffers
+// preconditions: none
+// postconditions: no region is held and the buffers hold no memory
+
+// --------------------------------------------------------------------------------------
+	void release();
+
+private:
+	// a horizontal run of pixels of one color, [start, end) on its row
+	struct Run
+	{
+		int start;
+		int end;
+		// the label while extracting, then the region (-1 for the frame)
+		int label;
+		bool ink;
+	};
+
+	// what is known of a label while extracting; several labels can end up one region
+	struct LabelStats
+	{
+		int minX;
+		int minY;
+		int maxX;
+		int maxY;
+		int area;
+		int perimeter;
+		// the label of the pixel above the first pixel of the label, which it lies inside of
+		int enclosing;
+		bool ink;
+		Point first;
+	};
+
+	// label of the frame around the image, joined by every ink run touching the edge
+	static const int FRAME = 0;
+
+	Size imageSize;
+	// every run of the image, row after row, and where each row starts
+	vector<Run> runs;
+	vector<int> rowStarts;
+	// the union-find forest of labels, and what is known of each label
+	vector<int> labelParent;
+	vector<LabelStats> labels;
+	vector<int> labelToComponent;
+	vector<Component> components;
+	// buffers used to put the regions in the order of findContours
+	vector<int> childStarts;
+	vector<int> children;
+	vector<int> stack;
+	vector<int> newIndex;
+	vector<Component> sorted;
+	// buffers used to trace a contour
+	Mat mask;
+	vector<vector<Point>> traced;
+	vector<Vec4i> tracedHierarchy;
+
+	// ------------------------------------ newLabel --------------------------------------
+
+// purpose: start a label at a run that touches no run of its color above it
+// preconditions: none
+// postconditions: returns the new label, a root of its own with no pixels yet
+
+// --------------------------------------------------------------------------------------
+	int newLabel(bool ink, Point first, int enclosing);
+	// ------------------------------------ findRoot --------------------------------------
+
+// purpose: find the label standing for all the labels joined with one
+// preconditions: label was returned by newLabel
+// postconditions: returns the smallest label joined with label; the path is shortened
+
+// --------------------------------------------------------------------------------------
+	int findRoot(int label);
+	// ------------------------------------ join --------------------------------------
+
+// purpose: join the labels of two touching runs into one region
+// preconditions: label1 and label2 were returned by newLabel
+// postconditions: both have the smaller of their roots as root, which is returned, so a root is
+//	always the label whose first pixel comes first in row order
+
+// --------------------------------------------------------------------------------------
+	int join(int label1, int label2);
+	// ------------------------------------ gatherComponents --------------------------------------
+
+// purpose: turn the labels into regions once every row has been read
+// preconditions: every run has a label
+// postconditions: components holds one region per root but the frame, in the order of
+//	findContours, with the stats of its labels summed; each run holds its region instead of its
+//	label
+
+// --------------------------------------------------------------------------------------
+	void gatherComponents();
+	// ------------------------------------ orderLikeFindContours --------------------------------------
+
+// purpose: put the regions in the order findContours lists their contours
+// preconditions: components is in row order of the first pixels, every parent before its children
+// postconditions: components is reordered and its parents renumbered; newIndex gives the new
+//	number of each region by its row order number
+
+// --------------------------------------------------------------------------------------
+	void orderLikeFindContours();
+};
+
+#endif
@@ -0,0 +1,184 @@
+// ConnectorExtractor.cpp
+// Purpose: find the lines joining the shapes of an ER diagram, so the diagram can be read as a
+//	graph of entities, relationships and attributes instead of a list of shapes
+// Functionality: erases the outline and inside of every classified shape from the ink of the
+//	thresholded image, so only the strokes between shapes are left, and traces each stroke once.
+//	The two ends of a stroke are the two of its points farthest apart, and each end is joined to
+//	the closest outline around it, found through a spatial grid of the shapes instead of by
+//	comparing with every shape. Strokes too short to be lines (specks, writing) and strokes that
+//	do not join two different shapes are counted and left out
+// Assumptions:
+//	Every connector is one stroke joining two shapes; strokes that cross or branch are joined to
+//	their two farthest ends only
+//	The outline of a shape is at most params.connectorOutlineWidth pixels thick
+// Authors: Allan Genari Gaarden, Tommy Ni, Joshua Medvinsky
+
+#include "ConnectorExtractor.h"
+#include <cfloat>
+
+// width and height of a cell of the grid of shapes; about the size of a small shape, so an end
+//	is looked up among a handful of shapes
+static const int NODE_CELL_SIZE = 128;
+
+// ------------------------------------ extract --------------------------------------
+
+// purpose: find the connectors between the shapes of an image
+// preconditions: binary is the 8 bit threshold the shapes were recognized in (paper nonzero, ink
+//	0) and shapes are in its coordinates
+// postconditions: the connectors of the image replace those of the previous one; every connector
+//	joins two different shapes that are not discarded. The buffers keep their memory, so the next
+//	image of the same size allocates almost nothing
+
+// --------------------------------------------------------------------------------------
+void ConnectorExtractor::extract(const Mat& binary, const ShapeTable& shapes, const RecognitionParams& params)
+{
+	connectors.clear();
+	stats = ConnectorStats();
+
+	// the ink, as findContours traces nonzero pixels
+	compare(binary, Scalar(0), strokeMask, CMP_EQ);
+
+	Rect page(Point(0, 0), binary.size());
+	nodes.reset(page, NODE_CELL_SIZE);
+	erasedWidths.assign(shapes.size(), 0);
+	for (int id = 0; id < shapes.size(); id++)
+	{
+		if (shapes.getType(id) == ShapeType::Discarded) continue;
+
+		// the polygon runs along the inside of the outline, and approximating it cut corners off
+		//	by up to the approximation tolerance, so that much more is erased on top of the
+		//	outline itself
+		const Point* points = shapes.getPoints(id);
+		int numPoints = shapes.getNumPoints(id);
+		Mat polygon(numPoints, 1, CV_32SC2, (void*)points);
+		int width = params.connectorOutlineWidth +
+			(int)ceil(arcLength(polygon, true) * params.approxEpsilonFraction);
+		erasedWidths[id] = width;
+		fillPoly(strokeMask, &points, &numPoints, 1, Scalar(0));
+		polylines(strokeMask, &points, &numPoints, 1, true, Scalar(0), 2 * width + 1);
+
+		// an end is only ever looked up in the cell it lies in, so each shape is registered in
+		//	every cell an end joined to it could lie in
+		int reach = width + params.connectorSnapDistance;
+		const Rect& box = shapes.getBoundingBox(id);
+		nodes.insert(id, Rect(box.x - reach, box.y - reach, box.width + 2 * reach, box.height + 2 * reach));
+	}
+
+	// only the outside of each stroke is needed to find its ends
+	findContours(strokeMask, strokes, RETR_EXTERNAL, CHAIN_APPROX_NONE);
+	stats.strokes = (int)strokes.size();
+	for (size_t i = 0; i < strokes.size(); i++)
+	{
+		// the outside of a thin stroke runs along both of its sides
+		double length = arcLength(strokes[i], true) / 2;
+		if (length < params.minConnectorLength)
+		{
+			stats.tooShort++;
+			continue;
+		}
+
+		// the point farthest from any point of a line is one of its ends, and the point farthest
+		//	from that end is the other
+		Point fromPoint = farthestPoint(strokes[i], farthestPoint(strokes[i], strokes[i][0]));
+		Point toPoint = farthestPoint(strokes[i], fromPoint);
+		int from = nearestShape(shapes, fromPoint, params.connectorSnapDistance);
+		int to = nearestShape(shapes, toPoint, params.connectorSnapDistance);
+		if (from < 0 || to < 0)
+		{
+			stats.unattached++;
+			continue;
+		}
+		if (from == to)
+		{
+			stats.selfLoops++;
+			continue;
+		}
+
+		Connector connector;
+		connector.from = from;
+		connector.to = to;
+		connector.fromPoint = fromPoint;
+		connector.toPoint = toPoint;
+		connector.length = length;
+		connectors.push_back(connector);
+	}
+}
+
+// ------------------------------------ getConnectors --------------------------------------
+
+// purpose: get the connectors found by the last extract
+// preconditions: none
+// postconditions: returns the connectors in the order their strokes were traced
+
+// --------------------------------------------------------------------------------------
+const vector<Connector>& ConnectorExtractor::getConnectors() const
+{
+	return connectors;
+}
+
+// ------------------------------------ getStats --------------------------------------
+
+// purpose: get how many strokes the last extract found and why the others were left out
+// preconditions: none
+// postconditions: returns the stroke counts of the last image
+
+// --------------------------------------------------------------------------------------
+const ConnectorStats& ConnectorExtractor::getStats() const
+{
+	return stats;
+}
+
+// ------------------------------------ farthestPoint --------------------------------------
+
+// purpose: get the point of a stroke farthest from a given point
+// preconditions: stroke is not empty
+// postconditions: returns the point of stroke with the largest distance to from
+
+// --------------------------------------------------------------------------------------
+Point ConnectorExtractor::farthestPoint(const vector<Point>& stroke, Point from)
+{
+	Point farthest = stroke[0];
+	long long farthestDistance = -1;
+	for (size_t i = 0; i < stroke.size(); i++)
+	{
+		long long dx = stroke[i].x - from.x;
+		long long dy = stroke[i].y - from.y;
+		long long distance = dx * dx + dy * dy;
+		if (distance > farthestDistance)
+		{
+			farthest = stroke[i];
+			farthestDistance = distance;
+		}
+	}
+	return farthest;
+}
+
+// ------------------------------------ nearestShape --------------------------------------
+
+// purpose: find the shape an end of a stroke is joined to
+// preconditions: nodes and erasedWidths were filled for shapes
+// postconditions: returns the id of the shape whose outline is closest to end, or -1 if no
+//	outline is within snapDistance of the erased part around it
+
+// --------------------------------------------------------------------------------------
+int ConnectorExtractor::nearestShape(const ShapeTable& shapes, Point end, int snapDistance) const
+{
+	int nearest = -1;
+	double nearestGap = DBL_MAX;
+	const vector<int>& candidates = nodes.cellAt(end);
+	for (size_t i = 0; i < candidates.size(); i++)
+	{
+		int id = candidates[i];
+		Mat polygon(shapes.getNumPoints(id), 1, CV_32SC2, (void*)shapes.getPoints(id));
+		// how far the end stopped beyond what was erased around the polygon; the ends of a
+		//	stroke were never erased, so they lie outside every polygon
+		double gap = fabs(pointPolygonTest(polygon, Point2f((float)end.x, (float)end.y), true)) -
+			erasedWidths[id];
+		if (gap <= snapDistance && gap < nearestGap)
+		{
+			nearest = id;
+			nearestGap = gap;
+		}
+	}
+	return nearest;
+}
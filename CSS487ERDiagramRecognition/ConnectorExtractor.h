@@ -0,0 +1,114 @@
+// ConnectorExtractor.h
+// Purpose: find the lines joining the shapes of an ER diagram, so the diagram can be read as a
+//	graph of entities, relationships and attributes instead of a list of shapes
+// Functionality: erases the outline and inside of every classified shape from the ink of the
+//	thresholded image, so only the strokes between shapes are left, and traces each stroke once.
+//	The two ends of a stroke are the two of its points farthest apart, and each end is joined to
+//	the closest outline around it, found through a spatial grid of the shapes instead of by
+//	comparing with every shape. Strokes too short to be lines (specks, writing) and strokes that
+//	do not join two different shapes are counted and left out
+// Assumptions:
+//	Every connector is one stroke joining two shapes; strokes that cross or branch are joined to
+//	their two farthest ends only
+//	The outline of a shape is at most params.connectorOutlineWidth pixels thick
+// Authors: Allan Genari Gaarden, Tommy Ni, Joshua Medvinsky
+
+#ifndef CONNECTOR_EXTRACTOR_H
+#define CONNECTOR_EXTRACTOR_H
+
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+#include <vector>
+#include "ShapeTable.h"
+#include "SpatialGrid.h"
+#include "RecognitionParams.h"
+using namespace std;
+using namespace cv;
+
+// a line joining two shapes, i.e. an edge of the diagram's graph
+struct Connector
+{
+	// ids of the shapes joined, from being the one at the end found first
+	int from = -1;
+	int to = -1;
+	// where the stroke stops next to each shape
+	Point fromPoint;
+	Point toPoint;
+	// length of the stroke in pixels, measured along it
+	double length = 0;
+};
+
+// what happened to the strokes of the last image
+struct ConnectorStats
+{
+	int strokes = 0;
+	// shorter than params.minConnectorLength
+	int tooShort = 0;
+	// an end was not near any shape
+	int unattached = 0;
+	// both ends were near the same shape
+	int selfLoops = 0;
+};
+
+class ConnectorExtractor
+{
+public:
+	// ------------------------------------ extract --------------------------------------
+
+// purpose: find the connectors between the shapes of an image
+// preconditions: binary is the 8 bit threshold the shapes were recognized in (paper nonzero, ink
+//	0) and shapes are in its coordinates
+// postconditions: the connectors of the image replace those of the previous one; every connector
+//	joins two different shapes that are not discarded. The buffers keep their memory, so the next
+//	image of the same size allocates almost nothing
+
+// --------------------------------------------------------------------------------------
+	void extract(const Mat& binary, const ShapeTable& shapes, const RecognitionParams& params);
+	// ------------------------------------ getConnectors --------------------------------------
+
+// purpose: get the connectors found by the last extract
+// preconditions: none
+// postconditions: returns the connectors in the order their strokes were traced
+
+// --------------------------------------------------------------------------------------
+	const vector<Connector>& getConnectors() const;
+	// ------------------------------------ getStats --------------------------------------
+
+// purpose: get how many strokes the last extract found and why the others were left out
+// preconditions: none
+// postconditions: returns the stroke counts of the last image
+
+// --------------------------------------------------------------------------------------
+	const ConnectorStats& getStats() const;
+
+private:
+	// the ink left once the shapes are erased, and the strokes traced in it
+	Mat strokeMask;
+	vector<vector<Point>> strokes;
+	// how far outside each shape's polygon its outline was erased, by shape id
+	vector<int> erasedWidths;
+	// every shape that can be joined, registered over its outline plus the snap distance
+	SpatialGrid nodes;
+	vector<Connector> connectors;
+	ConnectorStats stats;
+
+	// ------------------------------------ farthestPoint --------------------------------------
+
+// purpose: get the point of a stroke farthest from a given point
+// preconditions: stroke is not empty
+// postconditions: returns the point of stroke with the largest distance to from
+
+// --------------------------------------------------------------------------------------
+	static Point farthestPoint(const vector<Point>& stroke, Point from);
+	// ------------------------------------ nearestShape --------------------------------------
+
+// purpose: find the shape an end of a stroke is joined to
+// preconditions: nodes and erasedWidths were filled for shapes
+// postconditions: returns the id of the shape whose outline is closest to end, or -1 if no
+//	outline is within snapDistance of the erased part around it
+
+// --------------------------------------------------------------------------------------
+	int nearestShape(const ShapeTable& shapes, Point end, int snapDistance) const;
+};
+
+#endif
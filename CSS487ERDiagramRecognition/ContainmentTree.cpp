@@ -0,0 +1,347 @@
+// ContainmentTree.cpp
+// Purpose: find the weak entities, weak relationships and multivalued attributes of an ER diagram
+// Functionality: works out which classified shape each shape is drawn inside of, for all types
+//	at once. The tree findContours builds with RETR_TREE already nests every contour inside the
+//	contours around it, so the closest enclosing shape of each type is inherited down the tree in
+//	a single pass. A shape with a shape of its own type drawn inside it is weak (a double line),
+//	and the inner line is discarded. When the hierarchy is missing or inconsistent with the shapes,
+//	the same result is found from the bounding boxes using a spatial grid instead
+// Assumptions:
+//	Only shapes tagged Entity, Relationship or Attribute take part; every containing shape is
+//	confirmed with its bounding box, so a wrong hierarchy never nests two shapes that do not nest
+// Authors: Allan Genari Gaarden, Tommy Ni, Joshua Medvinsky
+
+#include "ContainmentTree.h"
+#include <algorithm>
+#include <cmath>
+
+// ------------------------------------ resolve --------------------------------------
+
+// purpose: tag the weak types and record which shape each shape is nested in
+// preconditions: shapes holds the shapes found in the contours that produced hierarchy; hierarchy
+//	may be empty
+// postconditions: every Entity, Relationship and Attribute drawn around another shape of its own
+//	type is retagged WeakEntity, WeakRelationship or MultivaluedAttribute, the shapes nested in
+//	it are tagged Discarded, and every remaining shape's parent is the closest remaining shape
+//	it is drawn inside of (or -1)
+
+// --------------------------------------------------------------------------------------
+void ContainmentTree::resolve(ShapeTable& shapes, const vector<Vec4i>& hierarchy)
+{
+	strongIds.clear();
+	numNestedCalls = 0;
+	for (int id = 0; id < shapes.size(); id++)
+	{
+		shapes.setParent(id, -1);
+		if (isStrongType(shapes.getType(id))) strongIds.push_back(id);
+	}
+
+	container.assign(shapes.size(), -1);
+	anyParent.assign(shapes.size(), -1);
+
+	hierarchyUsed = hierarchyUsable(shapes, hierarchy);
+	if (hierarchyUsed)
+	{
+		findContainersFromHierarchy(shapes, hierarchy);
+	}
+	else
+	{
+		findContainersFromBoxes(shapes);
+	}
+
+	retag(shapes);
+}
+
+// ------------------------------------ usedHierarchy --------------------------------------
+
+// purpose: tell which method the last resolve used
+// preconditions: none
+// postconditions: returns true if the contour hierarchy was used, false if the bounding box
+//	fallback was used
+
+// --------------------------------------------------------------------------------------
+bool ContainmentTree::usedHierarchy() const
+{
+	return hierarchyUsed;
+}
+
+// ------------------------------------ getNumNestedCalls --------------------------------------
+
+// purpose: tell how much comparing of bounding boxes the last resolve did
+// preconditions: none
+// postconditions: returns the number of isNested calls the last resolve made; always 0 unless
+//	the program was built with ERD_INSTRUMENT
+
+// --------------------------------------------------------------------------------------
+long long ContainmentTree::getNumNestedCalls() const
+{
+	return numNestedCalls;
+}
+
+// ------------------------------------ hierarchyUsable --------------------------------------
+
+// purpose: check that the hierarchy can be trusted for a single forward pass
+// preconditions: none
+// postconditions: returns true if hierarchy is non-empty, covers every shape's contour and lists
+//	every parent before its children
+
+// --------------------------------------------------------------------------------------
+bool ContainmentTree::hierarchyUsable(const ShapeTable& shapes, const vector<Vec4i>& hierarchy) const
+{
+	if (hierarchy.empty()) return false;
+
+	int numContours = (int)hierarchy.size();
+	for (int id = 0; id < shapes.size(); id++)
+	{
+		int contourIndex = shapes.getContourIndex(id);
+		if (contourIndex < 0 || contourIndex >= numContours) return false;
+	}
+
+	// findContours lists every parent before its children; anything else means the hierarchy
+	//	does not belong to these contours
+	for (int i = 0; i < numContours; i++)
+	{
+		if (hierarchy[i][3] >= i) return false;
+	}
+	return true;
+}
+
+// ------------------------------------ findContainersFromHierarchy --------------------------------------
+
+// purpose: find each strong shape's closest container of its own type and of any type
+// preconditions: hierarchyUsable(shapes, hierarchy) is true, strongIds is in id order
+// postconditions: container and anyParent are set for every id in strongIds
+
+// --------------------------------------------------------------------------------------
+void ContainmentTree::findContainersFromHierarchy(const ShapeTable& shapes, const vector<Vec4i>& hierarchy)
+{
+	int numContours = (int)hierarchy.size();
+	contourToShape.assign(numContours, -1);
+	for (size_t i = 0; i < strongIds.size(); i++)
+	{
+		contourToShape[shapes.getContourIndex(strongIds[i])] = strongIds[i];
+	}
+
+	// enclosing[contour * NUM_SLOTS + slot] is the closest shape around the contour of each strong
+	//	type (slot is the type) and of any type (ANY_SLOT). parents come first, so one forward
+	//	pass inherits the slots of the parent and overrides the slots of the parent's own shape
+	enclosing.assign((size_t)numContours * NUM_SLOTS, -1);
+	for (int i = 0; i < numContours; i++)
+	{
+		int parentContour = hierarchy[i][3];
+		if (parentContour < 0) continue;
+
+		int* slots = &enclosing[(size_t)i * NUM_SLOTS];
+		const int* parentSlots = &enclosing[(size_t)parentContour * NUM_SLOTS];
+		for (int slot = 0; slot < NUM_SLOTS; slot++)
+		{
+			slots[slot] = parentSlots[slot];
+		}
+
+		int parentShape = contourToShape[parentContour];
+		if (parentShape != -1)
+		{
+			slots[(int)shapes.getType(parentShape)] = parentShape;
+			slots[ANY_SLOT] = parentShape;
+		}
+	}
+
+	for (size_t i = 0; i < strongIds.size(); i++)
+	{
+		int id = strongIds[i];
+		const Rect& box = shapes.getBoundingBox(id);
+		int typeSlot = (int)shapes.getType(id);
+
+		// the hierarchy only says the contour lies inside the other one's region; the bounding
+		//	boxes must agree, otherwise keep walking up to the next shape of the same kind
+		int candidate = enclosing[(size_t)shapes.getContourIndex(id) * NUM_SLOTS + typeSlot];
+		while (candidate != -1 && !countedNested(box, shapes.getBoundingBox(candidate)))
+		{
+			candidate = enclosing[(size_t)shapes.getContourIndex(candidate) * NUM_SLOTS + typeSlot];
+		}
+		container[id] = candidate;
+
+		candidate = enclosing[(size_t)shapes.getContourIndex(id) * NUM_SLOTS + ANY_SLOT];
+		while (candidate != -1 && !countedNested(box, shapes.getBoundingBox(candidate)))
+		{
+			candidate = enclosing[(size_t)shapes.getContourIndex(candidate) * NUM_SLOTS + ANY_SLOT];
+		}
+		anyParent[id] = candidate;
+	}
+}
+
+// ------------------------------------ findContainersFromBoxes --------------------------------------
+
+// purpose: find each strong shape's closest container of its own type and of any type without a
+//	hierarchy
+// preconditions: strongIds holds the strong shapes
+// postconditions: strongIds is sorted from largest to smallest bounding box, and container and
+//	anyParent are set for every id in it
+
+// --------------------------------------------------------------------------------------
+void ContainmentTree::findContainersFromBoxes(const ShapeTable& shapes)
+{
+	if (strongIds.empty()) return;
+
+	// a container is strictly larger than what it contains, so largest first means every
+	//	container is already in the grid when the shapes inside it are looked up
+	stable_sort(strongIds.begin(), strongIds.end(), [&shapes](int a, int b) {
+		return shapes.getBoundingBox(a).area() > shapes.getBoundingBox(b).area();
+	});
+
+	Rect bounds = shapes.getBoundingBox(strongIds[0]);
+	double totalArea = 0;
+	for (size_t i = 0; i < strongIds.size(); i++)
+	{
+		const Rect& box = shapes.getBoundingBox(strongIds[i]);
+		bounds |= box;
+		totalArea += box.area();
+	}
+	int cellSize = max(16, (int)sqrt(totalArea / strongIds.size()));
+	grid.reset(bounds, cellSize);
+
+	for (size_t i = 0; i < strongIds.size(); i++)
+	{
+		int id = strongIds[i];
+		const Rect& box = shapes.getBoundingBox(id);
+		ShapeType type = shapes.getType(id);
+
+		// any box strictly containing this one also contains its top left corner, so only the
+		//	shapes registered in that corner's cell need to be checked
+		int bestSame = -1;
+		int bestAny = -1;
+		const vector<int>& candidates = grid.cellAt(box.tl());
+		for (size_t j = 0; j < candidates.size(); j++)
+		{
+			int candidate = candidates[j];
+			const Rect& candidateBox = shapes.getBoundingBox(candidate);
+			if (!countedNested(box, candidateBox)) continue;
+
+			if (bestAny == -1 || candidateBox.area() < shapes.getBoundingBox(bestAny).area())
+			{
+				bestAny = candidate;
+			}
+			if (shapes.getType(candidate) == type &&
+				(bestSame == -1 || candidateBox.area() < shapes.getBoundingBox(bestSame).area()))
+			{
+				bestSame = candidate;
+			}
+		}
+		container[id] = bestSame;
+		anyParent[id] = bestAny;
+
+		grid.insert(id, box);
+	}
+}
+
+// ------------------------------------ retag --------------------------------------
+
+// purpose: turn the containers found into weak types, discarded inner lines and parents
+// preconditions: container and anyParent are set, and every container comes before the shapes
+//	inside it in strongIds
+// postconditions: shapes are retagged and their parents set as described for resolve
+
+// --------------------------------------------------------------------------------------
+void ContainmentTree::retag(ShapeTable& shapes)
+{
+	root.assign(shapes.size(), -1);
+	weak.assign(shapes.size(), 0);
+	inner.assign(shapes.size(), 0);
+
+	// the outermost shape of a chain of same typed shapes is the weak one, every line inside it
+	//	belongs to it
+	for (size_t i = 0; i < strongIds.size(); i++)
+	{
+		int id = strongIds[i];
+		int c = container[id];
+		if (c == -1) continue;
+
+		root[id] = root[c] != -1 ? root[c] : c;
+		weak[root[id]] = 1;
+		inner[id] = 1;
+	}
+
+	for (size_t i = 0; i < strongIds.size(); i++)
+	{
+		int id = strongIds[i];
+		if (weak[id]) shapes.setType(id, weakTypeOf(shapes.getType(id)));
+		else if (inner[id]) shapes.setType(id, ShapeType::Discarded);
+	}
+
+	for (size_t i = 0; i < strongIds.size(); i++)
+	{
+		int id = strongIds[i];
+		if (shapes.getType(id) == ShapeType::Discarded) continue;
+
+		int parent = anyParent[id];
+		while (parent != -1 && shapes.getType(parent) == ShapeType::Discarded)
+		{
+			parent = anyParent[parent];
+		}
+		shapes.setParent(id, parent);
+	}
+}
+
+// ------------------------------------ isNested --------------------------------------
+
+// purpose: determines if the shape with bounding box box1 is inside the shape with bounding box box2
+// preconditions: box1 and box2 are the bounding boxes of valid shapes
+// postconditions: returns true if box1 is strictly inside box2, false if not
+
+// --------------------------------------------------------------------------------------
+bool ContainmentTree::isNested(const Rect& box1, const Rect& box2)
+{
+	// check if nested
+	if (box2.x < box1.x && box2.y < box1.y && box2.x + box2.width > box1.x + box1.width &&
+		box2.y + box2.height > box1.y + box1.height)
+	{
+		return true;
+	}
+
+	return false;
+}
+
+// ------------------------------------ countedNested --------------------------------------
+
+// purpose: call isNested, counting the call when instrumented
+// preconditions: same as isNested
+// postconditions: returns isNested(box1, box2)
+
+// --------------------------------------------------------------------------------------
+bool ContainmentTree::countedNested(const Rect& box1, const Rect& box2)
+{
+#ifdef ERD_INSTRUMENT
+	numNestedCalls++;
+#endif
+	return isNested(box1, box2);
+}
+
+// ------------------------------------ isStrongType --------------------------------------
+
+// purpose: check whether a type can have a weak counterpart
+// preconditions: none
+// postconditions: returns true for Entity, Relationship and Attribute
+
+// --------------------------------------------------------------------------------------
+bool ContainmentTree::isStrongType(ShapeType type)
+{
+	return type == ShapeType::Entity || type == ShapeType::Relationship ||
+		type == ShapeType::Attribute;
+}
+
+// ------------------------------------ weakTypeOf --------------------------------------
+
+// purpose: get the weak counterpart of a strong type
+// preconditions: isStrongType(type) is true
+// postconditions: returns WeakEntity, WeakRelationship or MultivaluedAttribute
+
+// --------------------------------------------------------------------------------------
+ShapeType ContainmentTree::weakTypeOf(ShapeType type)
+{
+	switch (type)
+	{
+	case ShapeType::Entity: return ShapeType::WeakEntity;
+	case ShapeType::Relationship: return ShapeType::WeakRelationship;
+	default: return ShapeType::MultivaluedAttribute;
+	}
+}
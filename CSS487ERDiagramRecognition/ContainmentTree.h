@@ -0,0 +1,147 @@
+// ContainmentTree.h
+// Purpose: find the weak entities, weak relationships and multivalued attributes of an ER diagram
+// Functionality: works out which classified shape each shape is drawn inside of, for all types
+//	at once. The tree findContours builds with RETR_TREE already nests every contour inside the
+//	contours around it, so the closest enclosing shape of each type is inherited down the tree in
+//	a single pass. A shape with a shape of its own type drawn inside it is weak (a double line),
+//	and the inner line is discarded. When the hierarchy is missing or inconsistent with the shapes,
+//	the same result is found from the bounding boxes using a spatial grid instead
+// Assumptions:
+//	Only shapes tagged Entity, Relationship or Attribute take part; every containing shape is
+//	confirmed with its bounding box, so a wrong hierarchy never nests two shapes that do not nest
+// Authors: Allan Genari Gaarden, Tommy Ni, Joshua Medvinsky
+
+#ifndef CONTAINMENT_TREE_H
+#define CONTAINMENT_TREE_H
+
+#include <opencv2/core.hpp>
+#include <vector>
+#include "ShapeTable.h"
+#include "SpatialGrid.h"
+using namespace std;
+using namespace cv;
+
+class ContainmentTree
+{
+public:
+	// ------------------------------------ resolve --------------------------------------
+
+// purpose: tag the weak types and record which shape each shape is nested in
+// preconditions: shapes holds the shapes found in the contours that produced hierarchy; hierarchy
+//	may be empty
+// postconditions: every Entity, Relationship and Attribute drawn around another shape of its own
+//	type is retagged WeakEntity, WeakRelationship or MultivaluedAttribute, the shapes nested in
+//	it are tagged Discarded, and every remaining shape's parent is the closest remaining shape
+//	it is drawn inside of (or -1)
+
+// --------------------------------------------------------------------------------------
+	void resolve(ShapeTable& shapes, const vector<Vec4i>& hierarchy);
+	// ------------------------------------ usedHierarchy --------------------------------------
+
+// purpose: tell which method the last resolve used
+// preconditions: none
+// postconditions: returns true if the contour hierarchy was used, false if the bounding box
+//	fallback was used
+
+// --------------------------------------------------------------------------------------
+	bool usedHierarchy() const;
+	// ------------------------------------ getNumNestedCalls --------------------------------------
+
+// purpose: tell how much comparing of bounding boxes the last resolve did
+// preconditions: none
+// postconditions: returns the number of isNested calls the last resolve made; always 0 unless
+//	the program was built with ERD_INSTRUMENT
+
+// --------------------------------------------------------------------------------------
+	long long getNumNestedCalls() const;
+	// ------------------------------------ isNested --------------------------------------
+
+// purpose: determines if the shape with bounding box box1 is inside the shape with bounding box box2
+// preconditions: box1 and box2 are the bounding boxes of valid shapes
+// postconditions: returns true if box1 is strictly inside box2, false if not
+
+// --------------------------------------------------------------------------------------
+	static bool isNested(const Rect& box1, const Rect& box2);
+
+private:
+	// number of containment slots kept per contour: one per strong type plus one for any type
+	static const int NUM_SLOTS = 4;
+	static const int ANY_SLOT = 3;
+
+	// scratch buffers, kept between calls so resolving stops allocating after the first image
+	vector<int> strongIds;
+	vector<int> contourToShape;
+	vector<int> enclosing;
+	vector<int> container;
+	vector<int> anyParent;
+	vector<int> root;
+	vector<char> weak;
+	vector<char> inner;
+	SpatialGrid grid;
+	bool hierarchyUsed = false;
+	// counted only when instrumented
+	long long numNestedCalls = 0;
+
+	// ------------------------------------ hierarchyUsable --------------------------------------
+
+// purpose: check that the hierarchy can be trusted for a single forward pass
+// preconditions: none
+// postconditions: returns true if hierarchy is non-empty, covers every shape's contour and lists
+//	every parent before its children
+
+// --------------------------------------------------------------------------------------
+	bool hierarchyUsable(const ShapeTable& shapes, const vector<Vec4i>& hierarchy) const;
+	// ------------------------------------ findContainersFromHierarchy --------------------------------------
+
+// purpose: find each strong shape's closest container of its own type and of any type
+// preconditions: hierarchyUsable(shapes, hierarchy) is true, strongIds is in id order
+// postconditions: container and anyParent are set for every id in strongIds
+
+// --------------------------------------------------------------------------------------
+	void findContainersFromHierarchy(const ShapeTable& shapes, const vector<Vec4i>& hierarchy);
+	// ------------------------------------ findContainersFromBoxes --------------------------------------
+
+// purpose: find each strong shape's closest container of its own type and of any type without a
+//	hierarchy
+// preconditions: strongIds holds the strong shapes
+// postconditions: strongIds is sorted from largest to smallest bounding box, and container and
+//	anyParent are set for every id in it
+
+// --------------------------------------------------------------------------------------
+	void findContainersFromBoxes(const ShapeTable& shapes);
+	// ------------------------------------ retag --------------------------------------
+
+// purpose: turn the containers found into weak types, discarded inner lines and parents
+// preconditions: container and anyParent are set, and every container comes before the shapes
+//	inside it in strongIds
+// postconditions: shapes are retagged and their parents set as described for resolve
+
+// --------------------------------------------------------------------------------------
+	void retag(ShapeTable& shapes);
+	// ------------------------------------ countedNested --------------------------------------
+
+// purpose: call isNested, counting the call when instrumented
+// preconditions: same as isNested
+// postconditions: returns isNested(box1, box2)
+
+// --------------------------------------------------------------------------------------
+	bool countedNested(const Rect& box1, const Rect& box2);
+	// ------------------------------------ isStrongType --------------------------------------
+
+// purpose: check whether a type can have a weak counterpart
+// preconditions: none
+// postconditions: returns true for Entity, Relationship and Attribute
+
+// --------------------------------------------------------------------------------------
+	static bool isStrongType(ShapeType type);
+	// ------------------------------------ weakTypeOf --------------------------------------
+
+// purpose: get the weak counterpart of a strong type
+// preconditions: isStrongType(type) is true
+// postconditions: returns WeakEntity, WeakRelationship or MultivaluedAttribute
+
+// --------------------------------------------------------------------------------------
+	static ShapeType weakTypeOf(ShapeType type);
+};
+
+#endif
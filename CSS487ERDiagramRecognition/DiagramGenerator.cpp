@@ -0,0 +1,221 @@
+// DiagramGenerator.cpp
+// Purpose: draw ER diagrams of any size whose correct recognition is known, for scale and
+//	accuracy testing beyond the bundled test images
+// Functionality: draws the requested number of entities (rectangles), relationships (diamonds)
+//	and attributes (ellipses), plus their weak and multivalued versions (the same shape drawn
+//	twice, one inside the other), in random order on a grid. Neighbouring shapes are joined by
+//	lines that never cross a shape or close a loop, and dark specks can be added as noise. The
+//	expected counts are given as a Test
+// Assumptions:
+//	The drawings are recognized with the default RecognitionParams, which limits the shape size
+//	and stroke width that can be used (see DiagramSpec)
+//	The page is held in memory as a BGR image, 3 bytes per pixel
+// Authors: Allan Genari Gaarden, Tommy Ni, Joshua Medvinsky
+
+#include "DiagramGenerator.h"
+#include <cmath>
+
+// ------------------------------------ generate --------------------------------------
+
+// purpose: draw a diagram
+// preconditions: spec is within the limits given in DiagramSpec
+// postconditions: returns a white BGR page with the shapes of spec drawn in black; the same spec
+//	always gives the same page. Throws cv::Exception if spec is out of its limits or the shapes
+//	do not fit on spec.pageSize
+
+// --------------------------------------------------------------------------------------
+Mat DiagramGenerator::generate(const DiagramSpec& spec)
+{
+	int size = spec.shapeSize;
+	int stroke = spec.strokeWidth;
+	if (size < 40 || size > 100) CV_Error(Error::StsBadArg, "shape size must be between 40 and 100");
+	if (stroke < 2 || stroke > size / 8)
+	{
+		CV_Error(Error::StsBadArg, "stroke width must be between 2 and an eighth of the shape size");
+	}
+
+	vector<ShapeType> types;
+	types.insert(types.end(), max(0, spec.numEntities), ShapeType::Entity);
+	types.insert(types.end(), max(0, spec.numRelationships), ShapeType::Relationship);
+	types.insert(types.end(), max(0, spec.numAttributes), ShapeType::Attribute);
+	types.insert(types.end(), max(0, spec.numWeakEntities), ShapeType::WeakEntity);
+	types.insert(types.end(), max(0, spec.numWeakRelationships), ShapeType::WeakRelationship);
+	types.insert(types.end(), max(0, spec.numMultivaluedAttributes), ShapeType::MultivaluedAttribute);
+
+	// shuffles the shapes so every kind appears all over the page
+	RNG rng((uint64)spec.seed);
+	for (int i = (int)types.size() - 1; i > 0; i--)
+	{
+		swap(types[i], types[rng.uniform(0, i + 1)]);
+	}
+
+	// every shape sits in the middle of a cell, with room around it for the joining lines
+	int numShapes = max(1, (int)types.size());
+	int cellWidth = 3 * size;
+	int cellHeight = 5 * size / 2;
+	int columns, rows;
+	if (spec.pageSize.empty())
+	{
+		// the number of columns that makes the page about square
+		columns = max(1, (int)ceil(sqrt((double)numShapes * cellHeight / cellWidth)));
+		rows = (numShapes + columns - 1) / columns;
+	}
+	else
+	{
+		columns = spec.pageSize.width / cellWidth;
+		rows = spec.pageSize.height / cellHeight;
+		if ((long long)columns * rows < numShapes)
+		{
+			CV_Error(Error::StsBadArg, "the shapes do not fit on the page");
+		}
+	}
+	Size pageSize = spec.pageSize.empty() ? Size(columns * cellWidth, rows * cellHeight) : spec.pageSize;
+	Mat page(pageSize, CV_8UC3, Scalar(255, 255, 255));
+
+	// half the size of each outline, and how far inside it the second outline of a weak shape is
+	Size entityHalf(size, size / 2);
+	Size relationshipHalf(7 * size / 10, 7 * size / 10);
+	int gap = stroke + max(4, size / 8);
+
+	vector<Point> centers(types.size());
+	vector<Size> halves(types.size());
+	for (size_t i = 0; i < types.size(); i++)
+	{
+		int row = (int)i / columns;
+		int column = (int)i % columns;
+		Point center(column * cellWidth + cellWidth / 2, row * cellHeight + cellHeight / 2);
+		ShapeType outline = outlineOf(types[i]);
+		Size half = outline == ShapeType::Relationship ? relationshipHalf : entityHalf;
+		centers[i] = center;
+		halves[i] = half;
+
+		drawShape(page, outline, center, half, stroke);
+		if (outline != types[i])
+		{
+			// the sides of a diamond are slanted, so it needs a larger inset for the same gap
+			int inset = outline == ShapeType::Relationship ? gap * 3 / 2 : gap;
+			drawShape(page, outline, center, Size(half.width - inset, half.height - inset), stroke);
+		}
+
+		// joins each shape to the one on its left, or the first of a row to the one above it;
+		//	the lines run between outlines only and form a tree, so they enclose no paper that
+		//	could be taken for a shape
+		if (column > 0)
+		{
+			Point left = centers[i - 1];
+			line(page, Point(left.x + halves[i - 1].width, left.y), Point(center.x - half.width, center.y),
+				Scalar(0, 0, 0), stroke);
+		}
+		else if (row > 0)
+		{
+			Point above = centers[i - columns];
+			line(page, Point(above.x, above.y + halves[i - columns].height),
+				Point(center.x, center.y - half.height), Scalar(0, 0, 0), stroke);
+		}
+	}
+
+	// dark specks like those of a photographed page, at random places
+	long long numSpecks = (long long)(spec.noise * page.total());
+	for (long long i = 0; i < numSpecks; i++)
+	{
+		page.at<Vec3b>(rng.uniform(0, page.rows), rng.uniform(0, page.cols)) = Vec3b(0, 0, 0);
+	}
+	return page;
+}
+
+// ------------------------------------ expectedCounts --------------------------------------
+
+// purpose: get what recognition should find in a generated diagram
+// preconditions: none
+// postconditions: returns the counts of spec as a Test for the image named imageName
+
+// --------------------------------------------------------------------------------------
+Test DiagramGenerator::expectedCounts(const DiagramSpec& spec, const string& imageName)
+{
+	return Test{ imageName, spec.numAttributes, spec.numEntities, spec.numRelationships,
+		spec.numWeakEntities, spec.numWeakRelationships, spec.numMultivaluedAttributes };
+}
+
+// ------------------------------------ expectedConnectors --------------------------------------
+
+// purpose: get how many connectors should be found in a generated diagram
+// preconditions: none
+// postconditions: returns the number of lines drawn, one fewer than the shapes since the lines
+//	form a tree joining every shape
+
+// --------------------------------------------------------------------------------------
+int DiagramGenerator::expectedConnectors(const DiagramSpec& spec)
+{
+	int numShapes = max(0, spec.numEntities) + max(0, spec.numRelationships) + max(0, spec.numAttributes) +
+		max(0, spec.numWeakEntities) + max(0, spec.numWeakRelationships) + max(0, spec.numMultivaluedAttributes);
+	return max(0, numShapes - 1);
+}
+
+// ------------------------------------ mix --------------------------------------
+
+// purpose: get a spec with a given number of shapes in proportions like the test images
+// preconditions: numShapes is at least 0
+// postconditions: returns a spec with numShapes shapes: about half attributes, the rest
+//	entities, relationships and their weak and multivalued versions
+
+// --------------------------------------------------------------------------------------
+DiagramSpec DiagramGenerator::mix(int numShapes)
+{
+	DiagramSpec spec;
+	spec.numEntities = numShapes * 15 / 100;
+	spec.numRelationships = numShapes * 10 / 100;
+	spec.numWeakEntities = numShapes * 5 / 100;
+	spec.numWeakRelationships = numShapes * 5 / 100;
+	spec.numMultivaluedAttributes = numShapes * 15 / 100;
+	// the shapes lost to rounding are attributes
+	spec.numAttributes = numShapes - spec.numEntities - spec.numRelationships -
+		spec.numWeakEntities - spec.numWeakRelationships - spec.numMultivaluedAttributes;
+	return spec;
+}
+
+// ------------------------------------ drawShape --------------------------------------
+
+// purpose: draw the outline of one shape
+// preconditions: type is Entity, Relationship or Attribute
+// postconditions: a rectangle, diamond or ellipse reaching halfSize from center on each side is
+//	drawn on page
+
+// --------------------------------------------------------------------------------------
+void DiagramGenerator::drawShape(Mat& page, ShapeType type, Point center, Size halfSize,
+	int strokeWidth)
+{
+	Scalar ink(0, 0, 0);
+	if (type == ShapeType::Entity)
+	{
+		rectangle(page, center - Point(halfSize.width, halfSize.height),
+			center + Point(halfSize.width, halfSize.height), ink, strokeWidth);
+	}
+	else if (type == ShapeType::Relationship)
+	{
+		vector<Point> corners = { center - Point(0, halfSize.height), center + Point(halfSize.width, 0),
+			center + Point(0, halfSize.height), center - Point(halfSize.width, 0) };
+		polylines(page, corners, true, ink, strokeWidth);
+	}
+	else
+	{
+		ellipse(page, center, halfSize, 0, 0, 360, ink, strokeWidth);
+	}
+}
+
+// ------------------------------------ outlineOf --------------------------------------
+
+// purpose: get the strong type whose outline a shape type is drawn with
+// preconditions: none
+// postconditions: returns Entity, Relationship or Attribute
+
+// --------------------------------------------------------------------------------------
+ShapeType DiagramGenerator::outlineOf(ShapeType type)
+{
+	switch (type)
+	{
+	case ShapeType::WeakEntity: return ShapeType::Entity;
+	case ShapeType::WeakRelationship: return ShapeType::Relationship;
+	case ShapeType::MultivaluedAttribute: return ShapeType::Attribute;
+	default: return type;
+	}
+}
@@ -0,0 +1,109 @@
+// DiagramGenerator.h
+// Purpose: draw ER diagrams of any size whose correct recognition is known, for scale and
+//	accuracy testing beyond the bundled test images
+// Functionality: draws the requested number of entities (rectangles), relationships (diamonds)
+//	and attributes (ellipses), plus their weak and multivalued versions (the same shape drawn
+//	twice, one inside the other), in random order on a grid. Neighbouring shapes are joined by
+//	lines that never cross a shape or close a loop, and dark specks can be added as noise. The
+//	expected counts are given as a Test
+// Assumptions:
+//	The drawings are recognized with the default RecognitionParams, which limits the shape size
+//	and stroke width that can be used (see DiagramSpec)
+//	The page is held in memory as a BGR image, 3 bytes per pixel
+// Authors: Allan Genari Gaarden, Tommy Ni, Joshua Medvinsky
+
+#ifndef DIAGRAM_GENERATOR_H
+#define DIAGRAM_GENERATOR_H
+
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+#include "DiagramTest.h"
+#include "ShapeTable.h"
+using namespace std;
+using namespace cv;
+
+// what to draw
+struct DiagramSpec
+{
+	int numEntities = 2;
+	int numRelationships = 1;
+	int numAttributes = 4;
+	int numWeakEntities = 0;
+	int numWeakRelationships = 0;
+	int numMultivaluedAttributes = 0;
+	// height of an entity in pixels, between 40 and 100; entities and attributes are twice as
+	//	wide and relationships 1.4 times as tall. Smaller shapes fall under the area limits and
+	//	larger attributes are taken for the outer contour of the diagram
+	int shapeSize = 60;
+	// width of every line in pixels, between 2 and shapeSize / 8; thinner lines leave gaps the
+	//	paper inside a shape leaks through, thicker ones fill the gap of weak shapes
+	int strokeWidth = 2;
+	// fraction of the pixels of the page turned into dark specks
+	double noise = 0;
+	// size of the page; an empty size gives the smallest page that holds every shape
+	Size pageSize;
+	// seed of the random order of the shapes and of the noise
+	int seed = 1;
+};
+
+class DiagramGenerator
+{
+public:
+	// ------------------------------------ generate --------------------------------------
+
+// purpose: draw a diagram
+// preconditions: spec is within the limits given in DiagramSpec
+// postconditions: returns a white BGR page with the shapes of spec drawn in black; the same spec
+//	always gives the same page. Throws cv::Exception if spec is out of its limits or the shapes
+//	do not fit on spec.pageSize
+
+// --------------------------------------------------------------------------------------
+	static Mat generate(const DiagramSpec& spec);
+	// ------------------------------------ expectedCounts --------------------------------------
+
+// purpose: get what recognition should find in a generated diagram
+// preconditions: none
+// postconditions: returns the counts of spec as a Test for the image named imageName
+
+// --------------------------------------------------------------------------------------
+	static Test expectedCounts(const DiagramSpec& spec, const string& imageName);
+	// ------------------------------------ expectedConnectors --------------------------------------
+
+// purpose: get how many connectors should be found in a generated diagram
+// preconditions: none
+// postconditions: returns the number of lines drawn, one fewer than the shapes since the lines
+//	form a tree joining every shape
+
+// --------------------------------------------------------------------------------------
+	static int expectedConnectors(const DiagramSpec& spec);
+	// ------------------------------------ mix --------------------------------------
+
+// purpose: get a spec with a given number of shapes in proportions like the test images
+// preconditions: numShapes is at least 0
+// postconditions: returns a spec with numShapes shapes: about half attributes, the rest
+//	entities, relationships and their weak and multivalued versions
+
+// --------------------------------------------------------------------------------------
+	static DiagramSpec mix(int numShapes);
+
+private:
+	// ------------------------------------ drawShape --------------------------------------
+
+// purpose: draw the outline of one shape
+// preconditions: type is Entity, Relationship or Attribute
+// postconditions: a rectangle, diamond or ellipse reaching halfSize from center on each side is
+//	drawn on page
+
+// --------------------------------------------------------------------------------------
+	static void drawShape(Mat& page, ShapeType type, Point center, Size halfSize, int strokeWidth);
+	// ------------------------------------ outlineOf --------------------------------------
+
+// purpose: get the strong type whose outline a shape type is drawn with
+// preconditions: none
+// postconditions: returns Entity, Relationship or Attribute
+
+// --------------------------------------------------------------------------------------
+	static ShapeType outlineOf(ShapeType type);
+};
+
+#endif
@@ -0,0 +1,27 @@
+// DiagramTest.h
+// Purpose: describe what a correct recognition of an ER diagram image finds
+// Functionality: holds an image name together with the number of shapes of each type it
+//	contains, for the bundled test images and for generated diagrams alike
+// Assumptions:
+//	The counts are those of the drawing, not of any recognition
+// Authors: Allan Genari Gaarden, Tommy Ni, Joshua Medvinsky
+
+#ifndef DIAGRAM_TEST_H
+#define DIAGRAM_TEST_H
+
+#include <string>
+using namespace std;
+
+// test structure for ease of adding tests
+struct Test
+{
+	string imageName;
+	int expectedAttributes;
+	int expectedEntities;
+	int expectedRelationships;
+	int expectedWeakEntities;
+	int expectedWeakRelationships;
+	int expectedMultivaluedAttributes;
+};
+
+#endif
@@ -0,0 +1,350 @@
+// GrayThreshold.cpp
+// Purpose: turn a color scan into the black and white image contours are found in, in one pass
+// Functionality: computes the gray level of every pixel with the same fixed point weights as
+//	cvtColor(COLOR_BGR2GRAY) and compares it with the threshold as threshold(THRESH_BINARY) does,
+//	without writing the gray image in between. A plain loop, an SSSE3 and an AVX2 version are
+//	provided; apply picks the fastest one the processor supports when the program runs
+// Assumptions:
+//	Images are 8 bit BGR; the result is identical to cvtColor followed by threshold
+//	The SSSE3 and AVX2 versions only exist on x86 builds, elsewhere the plain loop is used
+// Authors: Allan Genari Gaarden, Tommy Ni, Joshua Medvinsky
+
+#include "GrayThreshold.h"
+#include <climits>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define GRAY_THRESHOLD_X86
+#include <immintrin.h>
+#endif
+
+// gcc and clang only accept vector instructions in functions marked for them; Visual Studio
+//	accepts them anywhere
+#if defined(__GNUC__)
+#define GRAY_THRESHOLD_TARGET(instructions) __attribute__((target(instructions)))
+#else
+#define GRAY_THRESHOLD_TARGET(instructions)
+#endif
+
+// OpenCV's fixed point weights for COLOR_BGR2GRAY; they add up to 2^WEIGHT_SHIFT. OpenCV 5 moved
+//	from 14 to 15 bits, the weights of the version built against are used so the result matches
+#if CV_VERSION_MAJOR >= 5
+static const int BLUE_WEIGHT = 3735;
+static const int GREEN_WEIGHT = 19235;
+static const int RED_WEIGHT = 9798;
+static const int WEIGHT_SHIFT = 15;
+#else
+static const int BLUE_WEIGHT = 1868;
+static const int GREEN_WEIGHT = 9617;
+static const int RED_WEIGHT = 4899;
+static const int WEIGHT_SHIFT = 14;
+#endif
+
+// the most pixels handed to a row kernel at once, a multiple of the 32 pixels the widest kernel
+//	takes per step so only the last piece has a partly filled vector
+static const size_t MAX_RUN = INT_MAX / 32 * 32;
+
+// ------------------------------------ weightedLimit --------------------------------------
+
+// purpose: turn a gray level threshold into a threshold on the weighted sum of a pixel
+// preconditions: none
+// postconditions: returns the limit such that a pixel whose unrounded weighted sum
+//	b * BLUE_WEIGHT + g * GREEN_WEIGHT + r * RED_WEIGHT is above it has a gray level above thresh
+
+// --------------------------------------------------------------------------------------
+static int weightedLimit(int thresh)
+{
+	// cvtColor rounds, gray = (sum + half) >> WEIGHT_SHIFT, so gray > thresh exactly when
+	//	sum >= ((thresh + 1) << WEIGHT_SHIFT) - half; thresholds outside the gray levels pass
+	//	every pixel (below 0) or none (255 and above), as threshold does
+	thresh = min(max(thresh, -1), 255);
+	return ((thresh + 1) << WEIGHT_SHIFT) - (1 << (WEIGHT_SHIFT - 1)) - 1;
+}
+
+// ------------------------------------ rowScalar --------------------------------------
+
+// purpose: threshold the gray level of a run of pixels one at a time
+// preconditions: src holds width BGR pixels, dst has room for width values
+// postconditions: dst[x] is maxValue if the weighted sum of pixel x is above limit, 0 otherwise
+
+// --------------------------------------------------------------------------------------
+static void rowScalar(const uchar* src, uchar* dst, int width, int limit, uchar maxValue)
+{
+	for (int x = 0; x < width; x++, src += 3)
+	{
+		int sum = src[0] * BLUE_WEIGHT + src[1] * GREEN_WEIGHT + src[2] * RED_WEIGHT;
+		dst[x] = sum > limit ? maxValue : 0;
+	}
+}
+
+#ifdef GRAY_THRESHOLD_X86
+// ------------------------------------ deinterleave --------------------------------------
+
+// purpose: split 16 BGR pixels into one vector per channel
+// preconditions: src holds at least 48 bytes
+// postconditions: blue, green and red hold the 16 values of their channel, in pixel order
+
+// --------------------------------------------------------------------------------------
+GRAY_THRESHOLD_TARGET("ssse3")
+static inline void deinterleave(const uchar* src, __m128i& blue, __m128i& green, __m128i& red)
+{
+	// each shuffle picks the bytes of one channel found in one 16 byte load (-1 gives 0), the
+	//	three parts are then combined
+	const __m128i blue0 = _mm_setr_epi8(0, 3, 6, 9, 12, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+	const __m128i blue1 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, 2, 5, 8, 11, 14, -1, -1, -1, -1, -1);
+	const __m128i blue2 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 1, 4, 7, 10, 13);
+	const __m128i green0 = _mm_setr_epi8(1, 4, 7, 10, 13, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+	const __m128i green1 = _mm_setr_epi8(-1, -1, -1, -1, -1, 0, 3, 6, 9, 12, 15, -1, -1, -1, -1, -1);
+	const __m128i green2 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 2, 5, 8, 11, 14);
+	const __m128i red0 = _mm_setr_epi8(2, 5, 8, 11, 14, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+	const __m128i red1 = _mm_setr_epi8(-1, -1, -1, -1, -1, 1, 4, 7, 10, 13, -1, -1, -1, -1, -1, -1);
+	const __m128i red2 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 0, 3, 6, 9, 12, 15);
+
+	__m128i a = _mm_loadu_si128((const __m128i*)src);
+	__m128i b = _mm_loadu_si128((const __m128i*)(src + 16));
+	__m128i c = _mm_loadu_si128((const __m128i*)(src + 32));
+	blue = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(a, blue0), _mm_shuffle_epi8(b, blue1)),
+		_mm_shuffle_epi8(c, blue2));
+	green = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(a, green0), _mm_shuffle_epi8(b, green1)),
+		_mm_shuffle_epi8(c, green2));
+	red = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(a, red0), _mm_shuffle_epi8(b, red1)),
+		_mm_shuffle_epi8(c, red2));
+}
+
+// ------------------------------------ maskSSSE3 --------------------------------------
+
+// purpose: compare the weighted sums of 8 pixels with the limit
+// preconditions: blue, green and red hold the 8 values of their channel as 16 bit numbers
+// postconditions: returns 8 16 bit values, -1 where the weighted sum is above limit, 0 elsewhere
+
+// --------------------------------------------------------------------------------------
+GRAY_THRESHOLD_TARGET("ssse3")
+static inline __m128i maskSSSE3(__m128i blue, __m128i green, __m128i red, __m128i limit)
+{
+	// pairing blue with green lets one multiply-add give b * BLUE_WEIGHT + g * GREEN_WEIGHT;
+	//	red is paired with 0
+	const __m128i blueGreenWeights = _mm_set1_epi32((GREEN_WEIGHT << 16) | BLUE_WEIGHT);
+	const __m128i redWeights = _mm_set1_epi32(RED_WEIGHT);
+	const __m128i zero = _mm_setzero_si128();
+
+	__m128i sum0 = _mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(blue, green), blueGreenWeights),
+		_mm_madd_epi16(_mm_unpacklo_epi16(red, zero), redWeights));
+	__m128i sum1 = _mm_add_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(blue, green), blueGreenWeights),
+		_mm_madd_epi16(_mm_unpackhi_epi16(red, zero), redWeights));
+	return _mm_packs_epi32(_mm_cmpgt_epi32(sum0, limit), _mm_cmpgt_epi32(sum1, limit));
+}
+
+// ------------------------------------ rowSSSE3 --------------------------------------
+
+// purpose: threshold the gray level of a run of pixels 16 at a time
+// preconditions: same as rowScalar
+// postconditions: same as rowScalar
+
+// --------------------------------------------------------------------------------------
+GRAY_THRESHOLD_TARGET("ssse3")
+static void rowSSSE3(const uchar* src, uchar* dst, int width, int limit, uchar maxValue)
+{
+	const __m128i limits = _mm_set1_epi32(limit);
+	const __m128i maxValues = _mm_set1_epi8((char)maxValue);
+	const __m128i zero = _mm_setzero_si128();
+
+	int x = 0;
+	for (; x + 16 <= width; x += 16)
+	{
+		__m128i blue, green, red;
+		deinterleave(src + x * 3, blue, green, red);
+		__m128i low = maskSSSE3(_mm_unpacklo_epi8(blue, zero), _mm_unpacklo_epi8(green, zero),
+			_mm_unpacklo_epi8(red, zero), limits);
+		__m128i high = maskSSSE3(_mm_unpackhi_epi8(blue, zero), _mm_unpackhi_epi8(green, zero),
+			_mm_unpackhi_epi8(red, zero), limits);
+		__m128i mask = _mm_packs_epi16(low, high);
+		_mm_storeu_si128((__m128i*)(dst + x), _mm_and_si128(mask, maxValues));
+	}
+	rowScalar(src + x * 3, dst + x, width - x, limit, maxValue);
+}
+
+// ------------------------------------ maskAVX2 --------------------------------------
+
+// purpose: compare the weighted sums of 16 pixels with the limit
+// preconditions: src holds at least 48 bytes
+// postconditions: returns 16 16 bit values in pixel order, -1 where the weighted sum is above
+//	limit, 0 elsewhere
+
+// --------------------------------------------------------------------------------------
+GRAY_THRESHOLD_TARGET("avx2")
+static inline __m256i maskAVX2(const uchar* src, __m256i limit)
+{
+	const __m256i blueGreenWeights = _mm256_set1_epi32((GREEN_WEIGHT << 16) | BLUE_WEIGHT);
+	const __m256i redWeights = _mm256_set1_epi32(RED_WEIGHT);
+	const __m256i zero = _mm256_setzero_si256();
+
+	__m128i blue8, green8, red8;
+	deinterleave(src, blue8, green8, red8);
+	__m256i blue = _mm256_cvtepu8_epi16(blue8);
+	__m256i green = _mm256_cvtepu8_epi16(green8);
+	__m256i red = _mm256_cvtepu8_epi16(red8);
+
+	// unpack and pack both work within each 128 bit half, so packing undoes the reordering done
+	//	by unpacking and the pixels come back in order
+	__m256i sum0 = _mm256_add_epi32(
+		_mm256_madd_epi16(_mm256_unpacklo_epi16(blue, green), blueGreenWeights),
+		_mm256_madd_epi16(_mm256_unpacklo_epi16(red, zero), redWeights));
+	__m256i sum1 = _mm256_add_epi32(
+		_mm256_madd_epi16(_mm256_unpackhi_epi16(blue, green), blueGreenWeights),
+		_mm256_madd_epi16(_mm256_unpackhi_epi16(red, zero), redWeights));
+	return _mm256_packs_epi32(_mm256_cmpgt_epi32(sum0, limit), _mm256_cmpgt_epi32(sum1, limit));
+}
+
+// ------------------------------------ rowAVX2 --------------------------------------
+
+// purpose: threshold the gray level of a run of pixels 32 at a time
+// preconditions: same as rowScalar
+// postconditions: same as rowScalar
+
+// --------------------------------------------------------------------------------------
+GRAY_THRESHOLD_TARGET("avx2")
+static void rowAVX2(const uchar* src, uchar* dst, int width, int limit, uchar maxValue)
+{
+	const __m256i limits = _mm256_set1_epi32(limit);
+	const __m256i maxValues = _mm256_set1_epi8((char)maxValue);
+
+	int x = 0;
+	for (; x + 32 <= width; x += 32)
+	{
+		__m256i first = maskAVX2(src + x * 3, limits);
+		__m256i second = maskAVX2(src + x * 3 + 48, limits);
+		// packing interleaves the 8 pixel halves of the two masks, the permute puts them back
+		//	in order
+		__m256i mask = _mm256_permute4x64_epi64(_mm256_packs_epi16(first, second), 0xD8);
+		_mm256_storeu_si256((__m256i*)(dst + x), _mm256_and_si256(mask, maxValues));
+	}
+	rowSSSE3(src + x * 3, dst + x, width - x, limit, maxValue);
+}
+#endif
+
+// ------------------------------------ apply --------------------------------------
+
+// purpose: threshold the gray level of a color image
+// preconditions: image is CV_8UC3 in BGR order
+// postconditions: binary is CV_8UC1 of the same size, maxValue where the gray level of image is
+//	above thresh and 0 elsewhere; uses the fastest kernel the processor supports
+
+// --------------------------------------------------------------------------------------
+void GrayThreshold::apply(const Mat& image, Mat& binary, int thresh, int maxValue)
+{
+	apply(image, binary, thresh, maxValue, bestKernel());
+}
+
+// ------------------------------------ apply --------------------------------------
+
+// purpose: threshold the gray level of a color image with a given kernel
+// preconditions: image is CV_8UC3 in BGR order, kernel is supported
+// postconditions: same as apply above; throws cv::Exception if image is not CV_8UC3 or kernel
+//	cannot run on this processor
+
+// --------------------------------------------------------------------------------------
+void GrayThreshold::apply(const Mat& image, Mat& binary, int thresh, int maxValue,
+	GrayThresholdKernel kernel)
+{
+	if (image.type() != CV_8UC3)
+	{
+		CV_Error(Error::StsBadArg, "GrayThreshold needs an 8 bit BGR image");
+	}
+	if (!isSupported(kernel))
+	{
+		CV_Error(Error::StsBadArg, string("the ") + kernelName(kernel) +
+			" kernel cannot run on this processor");
+	}
+
+	void (*row)(const uchar*, uchar*, int, int, uchar) = rowScalar;
+#ifdef GRAY_THRESHOLD_X86
+	if (kernel == GrayThresholdKernel::SSSE3) row = rowSSSE3;
+	if (kernel == GrayThresholdKernel::AVX2) row = rowAVX2;
+#endif
+
+	binary.create(image.size(), CV_8UC1);
+	int limit = weightedLimit(thresh);
+	uchar value = saturate_cast<uchar>(maxValue);
+
+	// without gaps between the rows the whole image is one long row, which leaves a single
+	//	partly filled vector at the end instead of one per row
+	if (!image.isContinuous() || !binary.isContinuous())
+	{
+		for (int y = 0; y < image.rows; y++)
+		{
+			row(image.ptr<uchar>(y), binary.ptr<uchar>(y), image.cols, limit, value);
+		}
+		return;
+	}
+
+	// a page can hold more than INT_MAX pixels, so the long row is handed to the kernel in
+	//	pieces its int width can count
+	const uchar* src = image.ptr<uchar>();
+	uchar* dst = binary.ptr<uchar>();
+	size_t total = image.total();
+	for (size_t done = 0; done < total; done += MAX_RUN)
+	{
+		int width = (int)min(total - done, MAX_RUN);
+		row(src + 3 * done, dst + done, width, limit, value);
+	}
+}
+
+// ------------------------------------ bestKernel --------------------------------------
+
+// purpose: get the kernel apply uses
+// preconditions: none
+// postconditions: returns the fastest kernel both compiled in and supported by the processor
+
+// --------------------------------------------------------------------------------------
+GrayThresholdKernel GrayThreshold::bestKernel()
+{
+	// the processor does not change while the program runs, so it is only asked once
+	static const GrayThresholdKernel best =
+		isSupported(GrayThresholdKernel::AVX2) ? GrayThresholdKernel::AVX2 :
+		isSupported(GrayThresholdKernel::SSSE3) ? GrayThresholdKernel::SSSE3 :
+		GrayThresholdKernel::Scalar;
+	return best;
+}
+
+// ------------------------------------ isSupported --------------------------------------
+
+// purpose: check whether a kernel can run here
+// preconditions: none
+// postconditions: returns true if kernel was compiled in and the processor has its instructions
+
+// --------------------------------------------------------------------------------------
+bool GrayThreshold::isSupported(GrayThresholdKernel kernel)
+{
+	switch (kernel)
+	{
+	case GrayThresholdKernel::Scalar:
+		return true;
+#ifdef GRAY_THRESHOLD_X86
+	case GrayThresholdKernel::SSSE3:
+		return checkHardwareSupport(CV_CPU_SSSE3);
+	case GrayThresholdKernel::AVX2:
+		return checkHardwareSupport(CV_CPU_AVX2);
+#endif
+	default:
+		return false;
+	}
+}
+
+// ------------------------------------ kernelName --------------------------------------
+
+// purpose: get the name of a kernel
+// preconditions: none
+// postconditions: returns "scalar", "ssse3" or "avx2"
+
+// --------------------------------------------------------------------------------------
+const char* GrayThreshold::kernelName(GrayThresholdKernel kernel)
+{
+	switch (kernel)
+	{
+	case GrayThresholdKernel::SSSE3:
+		return "ssse3";
+	case GrayThresholdKernel::AVX2:
+		return "avx2";
+	default:
+		return "scalar";
+	}
+}
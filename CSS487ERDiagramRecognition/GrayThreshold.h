@@ -0,0 +1,75 @@
+// GrayThreshold.h
+// Purpose: turn a color scan into the black and white image contours are found in, in one pass
+// Functionality: computes the gray level of every pixel with the same fixed point weights as
+//	cvtColor(COLOR_BGR2GRAY) and compares it with the threshold as threshold(THRESH_BINARY) does,
+//	without writing the gray image in between. A plain loop, an SSSE3 and an AVX2 version are
+//	provided; apply picks the fastest one the processor supports when the program runs
+// Assumptions:
+//	Images are 8 bit BGR; the result is identical to cvtColor followed by threshold
+//	The SSSE3 and AVX2 versions only exist on x86 builds, elsewhere the plain loop is used
+// Authors: Allan Genari Gaarden, Tommy Ni, Joshua Medvinsky
+
+#ifndef GRAY_THRESHOLD_H
+#define GRAY_THRESHOLD_H
+
+#include <opencv2/core.hpp>
+using namespace std;
+using namespace cv;
+
+// the versions of the conversion, slowest first
+enum class GrayThresholdKernel
+{
+	Scalar,
+	SSSE3,
+	AVX2
+};
+
+class GrayThreshold
+{
+public:
+	// ------------------------------------ apply --------------------------------------
+
+// purpose: threshold the gray level of a color image
+// preconditions: image is CV_8UC3 in BGR order
+// postconditions: binary is CV_8UC1 of the same size, maxValue where the gray level of image is
+//	above thresh and 0 elsewhere; uses the fastest kernel the processor supports
+
+// --------------------------------------------------------------------------------------
+	static void apply(const Mat& image, Mat& binary, int thresh, int maxValue);
+	// ------------------------------------ apply --------------------------------------
+
+// purpose: threshold the gray level of a color image with a given kernel
+// preconditions: image is CV_8UC3 in BGR order, kernel is supported
+// postconditions: same as apply above; throws cv::Exception if image is not CV_8UC3 or kernel
+//	cannot run on this processor
+
+// --------------------------------------------------------------------------------------
+	static void apply(const Mat& image, Mat& binary, int thresh, int maxValue,
+		GrayThresholdKernel kernel);
+	// ------------------------------------ bestKernel --------------------------------------
+
+// purpose: get the kernel apply uses
+// preconditions: none
+// postconditions: returns the fastest kernel both compiled in and supported by the processor
+
+// --------------------------------------------------------------------------------------
+	static GrayThresholdKernel bestKernel();
+	// ------------------------------------ isSupported --------------------------------------
+
+// purpose: check whether a kernel can run here
+// preconditions: none
+// postconditions: returns true if kernel was compiled in and the processor has its instructions
+
+// --------------------------------------------------------------------------------------
+	static bool isSupported(GrayThresholdKernel kernel);
+	// ------------------------------------ kernelName --------------------------------------
+
+// purpose: get the name of a kernel
+// preconditions: none
+// postconditions: returns "scalar", "ssse3" or "avx2"
+
+// --------------------------------------------------------------------------------------
+	static const char* kernelName(GrayThresholdKernel kernel);
+};
+
+#endif
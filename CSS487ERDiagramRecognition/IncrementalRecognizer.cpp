@@ -0,0 +1,376 @@
+// IncrementalRecognizer.cpp
+// Purpose: recognize a live sequence of whiteboard frames in time that depends on how much of the
+//	board changed, not on the size of the frame
+// Functionality: compares each frame with the last one block by block, groups the changed blocks
+//	into regions, and only thresholds, finds the contours of and classifies those regions (grown
+//	by a margin so shapes reaching into them are traced whole). Shapes touching a changed region
+//	are replaced by the ones found again; shapes anywhere else are kept from earlier frames. The
+//	weak types and the outer contour are then decided again from the bounding boxes of every
+//	shape, which takes time in the number of shapes only
+// Assumptions:
+//	No shape is larger than the margin in either direction; larger shapes are not found, as for
+//	TiledRecognizer (the outer contour of a diagram is usually one of them, and is discarded anyway)
+//	Frames of one sequence have the same size; a frame of another size starts a new sequence
+//	Comparing a frame with the last one still reads every pixel once; everything after that
+//	depends only on the changed blocks
+// Authors: Allan Genari Gaarden, Tommy Ni, Joshua Medvinsky
+
+#include "IncrementalRecognizer.h"
+
+// ------------------------------------ parameter constructor --------------------------------------
+
+// purpose: set up incremental recognition
+// preconditions: blockSize is at least 1, margin is larger than the biggest shape, tolerance is
+//	between 0 and 255
+// postconditions: frames are compared in blockSize by blockSize blocks; a block changed if any
+//	channel of any pixel differs from the last frame by more than tolerance (0 for rendered
+//	frames, higher for camera noise)
+
+// --------------------------------------------------------------------------------------
+IncrementalRecognizer::IncrementalRecognizer(int blockSize, int margin, int tolerance)
+{
+	this->blockSize = max(1, blockSize);
+	this->margin = max(0, margin);
+	this->tolerance = min(max(0, tolerance), 255);
+}
+
+// ------------------------------------ update --------------------------------------
+
+// purpose: recognize the next frame of the sequence
+// preconditions: frame is a valid 8 bit BGR image
+// postconditions: the shape table holds the shapes of frame; only the changed regions were
+//	recognized again, or the whole frame if it is the first or its size changed. Throws
+//	cv::Exception if frame is empty or not 8 bit BGR
+
+// --------------------------------------------------------------------------------------
+void IncrementalRecognizer::update(const Mat& frame)
+{
+	if (frame.empty() || frame.type() != CV_8UC3)
+	{
+		CV_Error(Error::StsBadArg, "frame must be an 8 bit BGR image");
+	}
+
+	changedRegions.clear();
+	cascadeStats.clear();
+	Rect page(Point(0, 0), frame.size());
+	if (previous.size() != frame.size())
+	{
+		// a new sequence: everything changed
+		frame.copyTo(previous);
+		found.clear();
+		numReplaced = 0;
+		foundGrid.reset(page, max(16, margin));
+		changedRegions.push_back(page);
+	}
+	else
+	{
+		findChangedRegions(frame);
+		// nothing changed, so the shapes of the last frame still hold
+		if (changedRegions.empty()) return;
+		replaceShapes();
+	}
+
+	for (size_t i = 0; i < changedRegions.size(); i++)
+	{
+		recognizeRegion(frame, changedRegions[i]);
+	}
+	compact();
+	resolveShapes();
+}
+
+// ------------------------------------ findChangedRegions --------------------------------------
+
+// purpose: compare a frame with the last one
+// preconditions: previous has the size and type of frame
+// postconditions: changedRegions holds the bounding rectangle of every group of neighbouring
+//	changed blocks, and those blocks of previous are updated to frame
+
+// --------------------------------------------------------------------------------------
+void IncrementalRecognizer::findChangedRegions(const Mat& frame)
+{
+	int blocksX = (frame.cols + blockSize - 1) / blockSize;
+	int blocksY = (frame.rows + blockSize - 1) / blockSize;
+	changedBlocks.assign((size_t)blocksX * blocksY, 0);
+
+	for (int by = 0; by < blocksY; by++)
+	{
+		for (int bx = 0; bx < blocksX; bx++)
+		{
+			Rect block(bx * blockSize, by * blockSize, min(blockSize, frame.cols - bx * blockSize),
+				min(blockSize, frame.rows - by * blockSize));
+			if (norm(frame(block), previous(block), NORM_INF) <= tolerance) continue;
+
+			changedBlocks[(size_t)by * blocksX + bx] = 1;
+			// only the changed blocks are copied, so keeping the last frame costs what changed
+			Mat previousBlock = previous(block);
+			frame(block).copyTo(previousBlock);
+		}
+	}
+
+	// groups the changed blocks that share a side, so a stroke across several blocks is
+	//	recognized once instead of once per block; grouped blocks are marked 2
+	for (int start = 0; start < (int)changedBlocks.size(); start++)
+	{
+		if (changedBlocks[start] != 1) continue;
+
+		int minX = start % blocksX, maxX = minX;
+		int minY = start / blocksX, maxY = minY;
+		changedBlocks[start] = 2;
+		blockStack.clear();
+		blockStack.push_back(start);
+		while (!blockStack.empty())
+		{
+			int block = blockStack.back();
+			blockStack.pop_back();
+			int bx = block % blocksX;
+			int by = block / blocksX;
+			minX = min(minX, bx);
+			maxX = max(maxX, bx);
+			minY = min(minY, by);
+			maxY = max(maxY, by);
+
+			int neighbours[4] = { bx > 0 ? block - 1 : -1, bx < blocksX - 1 ? block + 1 : -1,
+				by > 0 ? block - blocksX : -1, by < blocksY - 1 ? block + blocksX : -1 };
+			for (int n = 0; n < 4; n++)
+			{
+				if (neighbours[n] == -1 || changedBlocks[neighbours[n]] != 1) continue;
+				changedBlocks[neighbours[n]] = 2;
+				blockStack.push_back(neighbours[n]);
+			}
+		}
+
+		Rect region(minX * blockSize, minY * blockSize, (maxX - minX + 1) * blockSize,
+			(maxY - minY + 1) * blockSize);
+		changedRegions.push_back(region & Rect(Point(0, 0), frame.size()));
+	}
+}
+
+// ------------------------------------ replaceShapes --------------------------------------
+
+// purpose: drop the shapes a changed region may have altered
+// preconditions: changedRegions is set
+// postconditions: every shape of found touching a changed region, or next to one, is tagged
+//	Discarded
+
+// --------------------------------------------------------------------------------------
+void IncrementalRecognizer::replaceShapes()
+{
+	for (size_t i = 0; i < changedRegions.size(); i++)
+	{
+		const Rect& region = changedRegions[i];
+		nearby.clear();
+		foundGrid.query(Rect(region.x - 1, region.y - 1, region.width + 2, region.height + 2), nearby);
+		for (size_t j = 0; j < nearby.size(); j++)
+		{
+			int id = nearby[j];
+			if (found.getType(id) == ShapeType::Discarded) continue;
+			if (!touches(found.getBoundingBox(id), region)) continue;
+
+			found.setType(id, ShapeType::Discarded);
+			numReplaced++;
+		}
+	}
+}
+
+// ------------------------------------ recognizeRegion --------------------------------------
+
+// purpose: find the shapes of one changed region again
+// preconditions: region is a changed region of frame, and the shapes around it were replaced
+// postconditions: every shape next to or touching region that lies inside region grown by the
+//	margin, and was not already found, is added to found
+
+// --------------------------------------------------------------------------------------
+void IncrementalRecognizer::recognizeRegion(const Mat& frame, const Rect& region)
+{
+	// a shape reaching into the region is traced whole as long as it is no larger than the margin
+	Rect area = Rect(region.x - margin, region.y - margin, region.width + 2 * margin,
+		region.height + 2 * margin) & Rect(Point(0, 0), frame.size());
+	GrayThreshold::apply(frame(area), thresh, params.minThreshold, params.maxThreshold);
+	// the nesting is decided from the bounding boxes afterwards, so a flat list of contours is enough
+	findContours(thresh, contours, RETR_LIST, CHAIN_APPROX_NONE);
+
+	Point offset = area.tl();
+	for (size_t i = 0; i < contours.size(); i++)
+	{
+		// a contour touching the edge of the area is cut off by it, or touches the edge of the frame
+		if (RecognitionCore::contourTouchesBorder(contours[i], area.size())) continue;
+
+		CascadeStage stage;
+		ShapeType type = RecognitionCore::classifyContour(contours[i], approx, params, false, stage);
+		cascadeStats.add(stage);
+		if (type == ShapeType::Discarded) continue;
+
+		framePolygon.resize(approx.size());
+		for (size_t j = 0; j < approx.size(); j++)
+		{
+			framePolygon[j] = approx[j] + offset;
+		}
+		Rect box = boundingRect(framePolygon);
+
+		// shapes away from the region did not change and were kept
+		if (!touches(box, region)) continue;
+
+		// the areas of neighbouring regions overlap, and a shape found from both is traced from
+		//	the same pixels, so with the same type and bounding box
+		bool alreadyFound = false;
+		const vector<int>& candidates = foundGrid.cellAt(box.tl());
+		for (size_t j = 0; j < candidates.size() && !alreadyFound; j++)
+		{
+			alreadyFound = found.getType(candidates[j]) == type && found.getBoundingBox(candidates[j]) == box;
+		}
+		if (alreadyFound) continue;
+
+		int id = found.addShape(framePolygon, type, -1);
+		foundGrid.insert(id, box);
+	}
+}
+
+// ------------------------------------ compact --------------------------------------
+
+// purpose: drop the replaced shapes from found once they outnumber the others
+// preconditions: none
+// postconditions: if more than half of found was replaced, found holds only the others and
+//	foundGrid is rebuilt
+
+// --------------------------------------------------------------------------------------
+void IncrementalRecognizer::compact()
+{
+	// copying the kept shapes costs as much as the shapes replaced since the last compaction, so
+	//	it adds a constant amount per replaced shape
+	if (numReplaced <= found.size() / 2) return;
+
+	compacted.clear();
+	foundGrid.reset(foundGrid.getBounds(), foundGrid.getCellSize());
+	for (int id = 0; id < found.size(); id++)
+	{
+		if (found.getType(id) == ShapeType::Discarded) continue;
+
+		framePolygon.assign(found.getPoints(id), found.getPoints(id) + found.getNumPoints(id));
+		int newId = compacted.addShape(framePolygon, found.getType(id), -1);
+		foundGrid.insert(newId, found.getBoundingBox(id));
+	}
+	swap(found, compacted);
+	numReplaced = 0;
+}
+
+// ------------------------------------ resolveShapes --------------------------------------
+
+// purpose: decide the outer contour and the weak types of every shape found
+// preconditions: none
+// postconditions: shapes holds the shapes of found that were not replaced, with the outer contour
+//	discarded and the weak types tagged
+
+// --------------------------------------------------------------------------------------
+void IncrementalRecognizer::resolveShapes()
+{
+	// a change can make a shape weak (a second line drawn inside it) without touching the shape
+	//	itself, so the weak types of every shape are decided again; it only takes the boxes
+	shapes.clear();
+	for (int id = 0; id < found.size(); id++)
+	{
+		if (found.getType(id) == ShapeType::Discarded) continue;
+
+		framePolygon.assign(found.getPoints(id), found.getPoints(id) + found.getNumPoints(id));
+		shapes.addShape(framePolygon, found.getType(id), -1);
+	}
+	RecognitionCore::eraseParentContour(shapes, params);
+	containment.resolve(shapes, vector<Vec4i>());
+}
+
+// ------------------------------------ touches --------------------------------------
+
+// purpose: check whether a shape can be altered by a change in a region
+// preconditions: none
+// postconditions: returns true if box, grown by the pixel of ink around it, overlaps region
+
+// --------------------------------------------------------------------------------------
+bool IncrementalRecognizer::touches(const Rect& box, const Rect& region)
+{
+	// a shape is the paper inside a line, so the line around it is a pixel outside its box
+	Rect grown(box.x - 1, box.y - 1, box.width + 2, box.height + 2);
+	return (grown & region).area() > 0;
+}
+
+// ------------------------------------ reset --------------------------------------
+
+// purpose: start a new sequence
+// preconditions: none
+// postconditions: the next update recognizes the whole frame; buffers keep their memory
+
+// --------------------------------------------------------------------------------------
+void IncrementalRecognizer::reset()
+{
+	// an empty last frame never matches the size of the next one
+	previous.release();
+	found.clear();
+	shapes.clear();
+	changedRegions.clear();
+	cascadeStats.clear();
+	numReplaced = 0;
+}
+
+// ------------------------------------ setParams --------------------------------------
+
+// purpose: change the limits used to recognize the frames
+// preconditions: none
+// postconditions: the next update recognizes the whole frame with params; pyramid settings are
+//	ignored, regions are always recognized at full resolution
+
+// --------------------------------------------------------------------------------------
+void IncrementalRecognizer::setParams(const RecognitionParams& params)
+{
+	this->params = params;
+	// shapes kept from earlier frames were found with the old limits
+	reset();
+}
+
+// ------------------------------------ getShapes --------------------------------------
+
+// purpose: get every shape of the last frame
+// preconditions: none
+// postconditions: returns the shape table in frame coordinates; shapes tagged
+//	ShapeType::Discarded are not part of the result
+
+// --------------------------------------------------------------------------------------
+const ShapeTable& IncrementalRecognizer::getShapes() const
+{
+	return shapes;
+}
+
+// ------------------------------------ getChangedRegions --------------------------------------
+
+// purpose: get where the last frame differed from the one before
+// preconditions: none
+// postconditions: returns the regions recognized again by the last update, before they were
+//	grown by the margin; empty if nothing changed
+
+// --------------------------------------------------------------------------------------
+const vector<Rect>& IncrementalRecognizer::getChangedRegions() const
+{
+	return changedRegions;
+}
+
+// ------------------------------------ getCascadeStats --------------------------------------
+
+// purpose: get where the contours of the changed regions were dropped during classification
+// preconditions: none
+// postconditions: returns how many contours each stage of classifyContour rejected and how many
+//	became shapes, over the regions of the last update
+
+// --------------------------------------------------------------------------------------
+const CascadeStats& IncrementalRecognizer::getCascadeStats() const
+{
+	return cascadeStats;
+}
+
+// ------------------------------------ getImageSize --------------------------------------
+
+// purpose: get the size of the frames
+// preconditions: none
+// postconditions: returns the width and height of the last frame
+
+// --------------------------------------------------------------------------------------
+Size IncrementalRecognizer::getImageSize() const
+{
+	return previous.size();
+}
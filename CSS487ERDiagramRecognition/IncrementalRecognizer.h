@@ -0,0 +1,196 @@
+// IncrementalRecognizer.h
+// Purpose: recognize a live sequence of whiteboard frames in time that depends on how much of the
+//	board changed, not on the size of the frame
+// Functionality: compares each frame with the last one block by block, groups the changed blocks
+//	into regions, and only thresholds, finds the contours of and classifies those regions (grown
+//	by a margin so shapes reaching into them are traced whole). Shapes touching a changed region
+//	are replaced by the ones found again; shapes anywhere else are kept from earlier frames. The
+//	weak types and the outer contour are then decided again from the bounding boxes of every
+//	shape, which takes time in the number of shapes only
+// Assumptions:
+//	No shape is larger than the margin in either direction; larger shapes are not found, as for
+//	TiledRecognizer (the outer contour of a diagram is usually one of them, and is discarded anyway)
+//	Frames of one sequence have the same size; a frame of another size starts a new sequence
+//	Comparing a frame with the last one still reads every pixel once; everything after that
+//	depends only on the changed blocks
+// Authors: Allan Genari Gaarden, Tommy Ni, Joshua Medvinsky
+
+#ifndef INCREMENTAL_RECOGNIZER_H
+#define INCREMENTAL_RECOGNIZER_H
+
+#include "RecognitionCore.h"
+#include "ShapeTable.h"
+#include "ContainmentTree.h"
+#include "SpatialGrid.h"
+#include "RecognitionParams.h"
+#include "GrayThreshold.h"
+#include "CascadeStats.h"
+
+class IncrementalRecognizer
+{
+public:
+	// default constructor not allowed
+	IncrementalRecognizer() = delete;
+	// ------------------------------------ parameter constructor --------------------------------------
+
+// purpose: set up incremental recognition
+// preconditions: blockSize is at least 1, margin is larger than the biggest shape, tolerance is
+//	between 0 and 255
+// postconditions: frames are compared in blockSize by blockSize blocks; a block changed if any
+//	channel of any pixel differs from the last frame by more than tolerance (0 for rendered
+//	frames, higher for camera noise)
+
+// --------------------------------------------------------------------------------------
+	IncrementalRecognizer(int blockSize, int margin, int tolerance);
+	// ------------------------------------ update --------------------------------------
+
+// purpose: recognize the next frame of the sequence
+// preconditions: frame is a valid 8 bit BGR image
+// postconditions: the shape table holds the shapes of frame; only the changed regions were
+//	recognized again, or the whole frame if it is the first or its size changed. Throws
+//	cv::Exception if frame is empty or not 8 bit BGR
+
+// --------------------------------------------------------------------------------------
+	void update(const Mat& frame);
+	// ------------------------------------ reset --------------------------------------
+
+// purpose: start a new sequence
+// preconditions: none
+// postconditions: the next update recognizes the whole frame; buffers keep their memory
+
+// --------------------------------------------------------------------------------------
+	void reset();
+	// ------------------------------------ setParams --------------------------------------
+
+// purpose: change the limits used to recognize the frames
+// preconditions: none
+// postconditions: the next update recognizes the whole frame with params; pyramid settings are
+//	ignored, regions are always recognized at full resolution
+
+// --------------------------------------------------------------------------------------
+	void setParams(const RecognitionParams& params);
+	// ------------------------------------ getShapes --------------------------------------
+
+// purpose: get every shape of the last frame
+// preconditions: none
+// postconditions: returns the shape table in frame coordinates; shapes tagged
+//	ShapeType::Discarded are not part of the result
+
+// --------------------------------------------------------------------------------------
+	const ShapeTable& getShapes() const;
+	// ------------------------------------ getChangedRegions --------------------------------------
+
+// purpose: get where the last frame differed from the one before
+// preconditions: none
+// postconditions: returns the regions recognized again by the last update, before they were
+//	grown by the margin; empty if nothing changed
+
+// --------------------------------------------------------------------------------------
+	const vector<Rect>& getChangedRegions() const;
+	// ------------------------------------ getCascadeStats --------------------------------------
+
+// purpose: get where the contours of the changed regions were dropped during classification
+// preconditions: none
+// postconditions: returns how many contours each stage of classifyContour rejected and how many
+//	became shapes, over the regions of the last update
+
+// --------------------------------------------------------------------------------------
+	const CascadeStats& getCascadeStats() const;
+	// ------------------------------------ getImageSize --------------------------------------
+
+// purpose: get the size of the frames
+// preconditions: none
+// postconditions: returns the width and height of the last frame
+
+// --------------------------------------------------------------------------------------
+	Size getImageSize() const;
+
+private:
+	int blockSize;
+	int margin;
+	int tolerance;
+	RecognitionParams params;
+
+	// the last frame, updated block by block as blocks change
+	Mat previous;
+	// one flag per block, row by row, and the blocks still to be grouped into a region
+	vector<char> changedBlocks;
+	vector<int> blockStack;
+	vector<Rect> changedRegions;
+
+	// per region buffers, reused for every region
+	Mat thresh;
+	vector<vector<Point>> contours;
+	vector<Point> approx;
+	vector<Point> framePolygon;
+	vector<int> nearby;
+
+	// every shape found and not yet replaced, tagged with its type before the weak types are
+	//	decided; replaced shapes are tagged Discarded until the table is compacted
+	ShapeTable found;
+	ShapeTable compacted;
+	int numReplaced = 0;
+	// the shapes of found, looked up by position
+	SpatialGrid foundGrid;
+
+	// the result: the shapes of found with the outer contour and the weak types decided
+	ShapeTable shapes;
+	CascadeStats cascadeStats;
+	ContainmentTree containment;
+
+	// ------------------------------------ findChangedRegions --------------------------------------
+
+// purpose: compare a frame with the last one
+// preconditions: previous has the size and type of frame
+// postconditions: changedRegions holds the bounding rectangle of every group of neighbouring
+//	changed blocks, and those blocks of previous are updated to frame
+
+// --------------------------------------------------------------------------------------
+	void findChangedRegions(const Mat& frame);
+	// ------------------------------------ replaceShapes --------------------------------------
+
+// purpose: drop the shapes a changed region may have altered
+// preconditions: changedRegions is set
+// postconditions: every shape of found touching a changed region, or next to one, is tagged
+//	Discarded
+
+// --------------------------------------------------------------------------------------
+	void replaceShapes();
+	// ------------------------------------ recognizeRegion --------------------------------------
+
+// purpose: find the shapes of one changed region again
+// preconditions: region is a changed region of frame, and the shapes around it were replaced
+// postconditions: every shape next to or touching region that lies inside region grown by the
+//	margin, and was not already found, is added to found
+
+// --------------------------------------------------------------------------------------
+	void recognizeRegion(const Mat& frame, const Rect& region);
+	// ------------------------------------ compact --------------------------------------
+
+// purpose: drop the replaced shapes from found once they outnumber the others
+// preconditions: none
+// postconditions: if more than half of found was replaced, found holds only the others and
+//	foundGrid is rebuilt
+
+// --------------------------------------------------------------------------------------
+	void compact();
+	// ------------------------------------ resolveShapes --------------------------------------
+
+// purpose: decide the outer contour and the weak types of every shape found
+// preconditions: none
+// postconditions: shapes holds the shapes of found that were not replaced, with the outer contour
+//	discarded and the weak types tagged
+
+// --------------------------------------------------------------------------------------
+	void resolveShapes();
+	// ------------------------------------ touches --------------------------------------
+
+// purpose: check whether a shape can be altered by a change in a region
+// preconditions: none
+// postconditions: returns true if box, grown by the pixel of ink around it, overlaps region
+
+// --------------------------------------------------------------------------------------
+	static bool touches(const Rect& box, const Rect& region);
+};
+
+#endif
@@ -0,0 +1,296 @@
+// MemoryCommands.cpp
+// Purpose: measure what recognizing an image costs in memory and check the stateless API
+// Functionality: the allocations, memory and reentrant modes of the program: each command reads
+//	its arguments and runs its driver, which counts allocations and peak memory or recognizes the
+//	same images from many threads and checks the shapes agree
+// Assumptions:
+//	The heap is only counted when built with ERD_COUNT_ALLOCATIONS
+// Authors: Allan Genari Gaarden, Tommy Ni, Joshua Medvinsky
+
+#include "MemoryCommands.h"
+#include "RecognizeERDiagram.h"
+#include "AllocationStats.h"
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <thread>
+
+// ------------------------------------ runAllocations --------------------------------------
+
+// purpose: show how much a reused recognizer allocates per image
+// preconditions: imageName is a valid image, repetitions is at least 1
+// postconditions: the image file is read into memory once and recognized repetitions times from
+//	its encoded bytes by the same recognizer; the allocations of each run are output
+
+// --------------------------------------------------------------------------------------
+int runAllocations(const string& imageName, int repetitions)
+{
+	AllocationStats::install();
+
+	// the bytes are read once, the way images arrive from an upstream queue
+	ifstream file(imageName, ios::binary);
+	vector<uchar> encoded((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+	if (encoded.empty())
+	{
+		cerr << imageName << " could not be read" << endl;
+		return 1;
+	}
+
+	RecognizeERDiagram rec;
+	cout << "Run, Mat Allocations, Mat Bytes, Heap Allocations, Heap Bytes" << endl;
+	try
+	{
+		for (int i = 0; i < repetitions; i++)
+		{
+			AllocationCounts before = AllocationStats::current();
+			rec.recognizeEncoded(encoded.data(), encoded.size());
+			AllocationCounts after = AllocationStats::current();
+
+			cout << i + 1 << ", " << after.matAllocations - before.matAllocations << ", " <<
+				after.matBytes - before.matBytes << ", ";
+			if (AllocationStats::countsHeap())
+			{
+				cout << after.heapAllocations - before.heapAllocations << ", " <<
+					after.heapBytes - before.heapBytes << endl;
+			}
+			else
+			{
+				cout << "n/a, n/a" << endl;
+			}
+		}
+	}
+	catch (const cv::Exception&)
+	{
+		cerr << imageName << " could not be recognized" << endl;
+		return 1;
+	}
+
+	if (!AllocationStats::countsHeap())
+	{
+		cout << "Build with ERD_COUNT_ALLOCATIONS defined to count heap allocations as well" << endl;
+	}
+	return 0;
+}
+
+// ------------------------------------ allocationsCommand --------------------------------------
+
+// purpose: count the allocations of reused runs from the command line
+// preconditions: argv[1] is allocations and argc is at least 3
+// postconditions: the arguments after argv[1] are read and the mode is run; returns its exit
+//	code, or USAGE_ERROR if the arguments are wrong
+
+// --------------------------------------------------------------------------------------
+int allocationsCommand(int argc, char* argv[])
+{
+	int repetitions = argc >= 4 ? max(1, atoi(argv[3])) : 5;
+	return runAllocations(argv[2], repetitions);
+}
+
+// ------------------------------------ runMemory --------------------------------------
+
+// purpose: show how much memory recognizing each image takes at its peak and how much the
+//	recognizer holds on to afterwards, e.g. to size the memory of workers
+// preconditions: imageNames are valid image files
+// postconditions: each image is recognized from its encoded bytes by the same recognizer, in low
+//	memory mode if lowMemory is true and without keeping the image if keepImage is false; the
+//	peak and held megabytes of Mats (and of the heap, if counted) and the peak resident memory of
+//	the process so far are output per image. Returns 1 if an image could not be recognized
+
+// --------------------------------------------------------------------------------------
+int runMemory(const vector<string>& imageNames, bool lowMemory, bool keepImage)
+{
+	AllocationStats::install();
+	const double MB = 1024.0 * 1024.0;
+
+	RecognizeERDiagram rec;
+	rec.setLowMemory(lowMemory);
+	rec.setKeepImage(keepImage);
+	// what was alive before the first image is not the recognizer's
+	AllocationCounts start = AllocationStats::current();
+	int numFailed = 0;
+
+	cout << "Image, Width, Height, Mat Peak MB, Mat Held MB, Heap Peak MB, Heap Held MB, Process Peak MB" << endl;
+	cout << fixed << setprecision(2);
+	for (size_t i = 0; i < imageNames.size(); i++)
+	{
+		ifstream file(imageNames[i], ios::binary);
+		vector<uchar> encoded((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+		// the peaks count from what is alive now, the encoded bytes included
+		AllocationStats::resetPeaks();
+		AllocationCounts before = AllocationStats::current();
+		try
+		{
+			rec.recognizeEncoded(encoded.data(), encoded.size());
+		}
+		catch (const cv::Exception&)
+		{
+			cerr << imageNames[i] << " could not be recognized" << endl;
+			numFailed++;
+			continue;
+		}
+		AllocationCounts after = AllocationStats::current();
+
+		Size size = rec.getImageSize();
+		cout << imageNames[i] << ", " << size.width << ", " << size.height << ", " <<
+			(after.matPeakBytes - before.matLiveBytes) / MB << ", " <<
+			(after.matLiveBytes - start.matLiveBytes) / MB << ", ";
+		if (AllocationStats::countsHeap())
+		{
+			// the encoded bytes are freed with the next image, so they are not held
+			cout << (after.heapPeakBytes - before.heapLiveBytes) / MB << ", " <<
+				(after.heapLiveBytes - start.heapLiveBytes - (long long)encoded.capacity()) / MB << ", ";
+		}
+		else
+		{
+			cout << "n/a, n/a, ";
+		}
+		cout << AllocationStats::peakResidentBytes() / MB << endl;
+	}
+
+	if (!AllocationStats::countsHeap())
+	{
+		cout << "Build with ERD_COUNT_ALLOCATIONS defined to measure the heap as well" << endl;
+	}
+	return numFailed == 0 ? 0 : 1;
+}
+
+// ------------------------------------ memoryCommand --------------------------------------
+
+// purpose: measure the memory of recognizing images from the command line
+// preconditions: argv[1] is memory and argc is at least 3
+// postconditions: the arguments after argv[1] are read and the mode is run; returns its exit
+//	code, or USAGE_ERROR if the arguments are wrong
+
+// --------------------------------------------------------------------------------------
+int memoryCommand(int argc, char* argv[])
+{
+	bool lowMemory = false;
+	bool keepImage = true;
+	vector<string> imageNames;
+	for (int i = 2; i < argc; i++)
+	{
+		if (string(argv[i]) == "--low") lowMemory = true;
+		else if (string(argv[i]) == "--no-image") keepImage = false;
+		else imageNames.push_back(argv[i]);
+	}
+	return runMemory(imageNames, lowMemory, keepImage);
+}
+
+// ------------------------------------ sameShapes --------------------------------------
+
+// purpose: check that two recognitions found the same shapes
+// preconditions: none
+// postconditions: returns true if both tables hold the same kept shapes, with the same types and
+//	bounding boxes, in the same order
+
+// --------------------------------------------------------------------------------------
+bool sameShapes(const ShapeTable& a, const ShapeTable& b)
+{
+	int i = 0;
+	int j = 0;
+	while (true)
+	{
+		while (i < a.size() && a.getType(i) == ShapeType::Discarded) i++;
+		while (j < b.size() && b.getType(j) == ShapeType::Discarded) j++;
+		if (i == a.size() || j == b.size()) return i == a.size() && j == b.size();
+		if (a.getType(i) != b.getType(j) || a.getBoundingBox(i) != b.getBoundingBox(j)) return false;
+		i++;
+		j++;
+	}
+}
+
+// ------------------------------------ runReentrant --------------------------------------
+
+// purpose: recognize the same images from many threads at once with the stateless API
+// preconditions: imageNames are valid image files
+// postconditions: every image is recognized once by a RecognizeERDiagram, then repetitions times
+//	by each of numThreads threads calling RecognitionCore::recognize, each thread starting at a
+//	different image; outputs the throughput and the number of results that differ from the
+//	recognizer's, and returns 1 if any differ or fail
+
+// --------------------------------------------------------------------------------------
+int runReentrant(const vector<string>& imageNames, int numThreads, int repetitions)
+{
+	RecognizeERDiagram rec;
+	vector<Mat> images;
+	vector<ShapeTable> expected;
+	for (size_t i = 0; i < imageNames.size(); i++)
+	{
+		Mat image = imread(imageNames[i], IMREAD_COLOR);
+		if (image.empty())
+		{
+			cerr << imageNames[i] << " could not be read" << endl;
+			return 1;
+		}
+		rec.recognize(image);
+		images.push_back(image);
+		expected.push_back(rec.getShapes());
+	}
+	if (images.empty()) return 1;
+
+	// every thread shares the images, the parameters and the expected shapes, which are only read
+	const RecognitionParams& params = rec.getParams();
+	atomic<int> numMismatched{ 0 };
+	atomic<int> numFailed{ 0 };
+	auto start = chrono::steady_clock::now();
+	vector<thread> threads;
+	for (int t = 0; t < numThreads; t++)
+	{
+		threads.emplace_back([&, t]()
+		{
+			// reused, so a thread allocates only while its buffers grow
+			RecognitionResult result;
+			for (int r = 0; r < repetitions; r++)
+			{
+				for (size_t k = 0; k < images.size(); k++)
+				{
+					size_t i = (k + t) % images.size();
+					try
+					{
+						RecognitionCore::recognize(images[i], params, result);
+						if (!sameShapes(result.shapes, expected[i])) numMismatched++;
+					}
+					catch (const cv::Exception&)
+					{
+						numFailed++;
+					}
+				}
+			}
+		});
+	}
+	for (size_t t = 0; t < threads.size(); t++)
+	{
+		threads[t].join();
+	}
+	double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+	long long numRecognized = (long long)numThreads * repetitions * (long long)images.size();
+	cout << "Threads, Images, Seconds, Images/s, Mismatched, Failed" << endl;
+	cout << numThreads << ", " << numRecognized << ", " << seconds << ", " << numRecognized / seconds <<
+		", " << numMismatched << ", " << numFailed << endl;
+	return numMismatched == 0 && numFailed == 0 ? 0 : 1;
+}
+
+// ------------------------------------ reentrantCommand --------------------------------------
+
+// purpose: check the stateless API from many threads from the command line
+// preconditions: argv[1] is reentrant and argc is at least 3
+// postconditions: the arguments after argv[1] are read and the mode is run; returns its exit
+//	code, or USAGE_ERROR if the arguments are wrong
+
+// --------------------------------------------------------------------------------------
+int reentrantCommand(int argc, char* argv[])
+{
+	int numThreads = 64;
+	int repetitions = 4;
+	vector<string> imageNames;
+	for (int i = 2; i < argc; i++)
+	{
+		if (string(argv[i]) == "--threads" && i + 1 < argc) numThreads = max(1, atoi(argv[++i]));
+		else if (string(argv[i]) == "--runs" && i + 1 < argc) repetitions = max(1, atoi(argv[++i]));
+		else imageNames.push_back(argv[i]);
+	}
+	return runReentrant(imageNames, numThreads, repetitions);
+}
@@ -0,0 +1,56 @@
+// MemoryCommands.h
+// Purpose: measure what recognizing an image costs in memory and check the stateless API
+// Functionality: the allocations, memory and reentrant modes of the program: each command reads
+//	its arguments and runs its driver, which counts allocations and peak memory or recognizes the
+//	same images from many threads and checks the shapes agree
+// Assumptions:
+//	The heap is only counted when built with ERD_COUNT_ALLOCATIONS
+// Authors: Allan Genari Gaarden, Tommy Ni, Joshua Medvinsky
+
+#ifndef MEMORY_COMMANDS_H
+#define MEMORY_COMMANDS_H
+
+#include "Command.h"
+#include "ShapeTable.h"
+
+// ------------------------------------ sameShapes --------------------------------------
+
+// purpose: check that two recognitions found the same shapes
+// preconditions: none
+// postconditions: returns true if both tables hold the same kept shapes, with the same types and
+//	bounding boxes, in the same order
+
+// --------------------------------------------------------------------------------------
+bool sameShapes(const ShapeTable& a, const ShapeTable& b);
+
+// ------------------------------------ allocationsCommand --------------------------------------
+
+// purpose: count the allocations of reused runs from the command line
+// preconditions: argv[1] is allocations and argc is at least 3
+// postconditions: the arguments after argv[1] are read and the mode is run; returns its exit
+//	code, or USAGE_ERROR if the arguments are wrong
+
+// --------------------------------------------------------------------------------------
+int allocationsCommand(int argc, char* argv[]);
+
+// ------------------------------------ memoryCommand --------------------------------------
+
+// purpose: measure the memory of recognizing images from the command line
+// preconditions: argv[1] is memory and argc is at least 3
+// postconditions: the arguments after argv[1] are read and the mode is run; returns its exit
+//	code, or USAGE_ERROR if the arguments are wrong
+
+// --------------------------------------------------------------------------------------
+int memoryCommand(int argc, char* argv[]);
+
+// ------------------------------------ reentrantCommand --------------------------------------
+
+// purpose: check the stateless API from many threads from the command line
+// preconditions: argv[1] is reentrant and argc is at least 3
+// postconditions: the arguments after argv[1] are read and the mode is run; returns its exit
+//	code, or USAGE_ERROR if the arguments are wrong
+
+// --------------------------------------------------------------------------------------
+int reentrantCommand(int argc, char* argv[]);
+
+#endif
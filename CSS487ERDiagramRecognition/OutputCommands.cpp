@@ -0,0 +1,632 @@
+// OutputCommands.cpp
+// Purpose: recognize images from the command line and write what was found
+// Functionality: the batch, cli, tiled, archive, graph and generate modes of the program: each
+//	command reads its arguments and runs its driver, which recognizes images (or draws one) and
+//	writes the shapes found as counts, JSON, annotated images, SVG overlays or an archive
+// Assumptions:
+//	The images named on the command line are readable
+// Authors: Allan Genari Gaarden, Tommy Ni, Joshua Medvinsky
+
+#include "OutputCommands.h"
+#include "BatchRunner.h"
+#include "ResultWriter.h"
+#include "AsyncImageWriter.h"
+#include "TiledRecognizer.h"
+#include "DiagramGenerator.h"
+#include "ResultCache.h"
+#include "ResultArchive.h"
+#include "ConnectorExtractor.h"
+#include <climits>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <thread>
+
+// ------------------------------------ runBatch --------------------------------------
+
+// purpose: recognize every image of a directory or file list on all cores
+// preconditions: path is a directory of images or a text file with one image path per line;
+//	archiveName is empty or a writable path
+// postconditions: outputs the counts of each image in input order and the overall throughput; if
+//	archiveName is given, the shapes of every image are also written to an archive there
+
+// --------------------------------------------------------------------------------------
+int runBatch(const string& path, int numThreads, const string& archiveName)
+{
+	vector<string> imageNames = BatchRunner::collectImages(path);
+	if (imageNames.empty())
+	{
+		cerr << "No images found in " << path << endl;
+		return 1;
+	}
+
+	unique_ptr<ResultArchiveWriter> archive;
+	try
+	{
+		if (!archiveName.empty()) archive.reset(new ResultArchiveWriter(archiveName));
+	}
+	catch (const cv::Exception& e)
+	{
+		cerr << e.err << endl;
+		return 1;
+	}
+
+	BatchRunner batch(imageNames, numThreads);
+	batch.setArchive(archive.get());
+	batch.run();
+	batch.printResults(cout);
+	return 0;
+}
+
+// ------------------------------------ batchCommand --------------------------------------
+
+// purpose: recognize a whole directory or file list from the command line
+// preconditions: argv[1] is batch and argc is at least 3
+// postconditions: the arguments after argv[1] are read and the mode is run; returns its exit
+//	code, or USAGE_ERROR if the arguments are wrong
+
+// --------------------------------------------------------------------------------------
+int batchCommand(int argc, char* argv[])
+{
+	int numThreads = 0;
+	string archiveName;
+	for (int i = 3; i < argc; i++)
+	{
+		if (string(argv[i]) == "--archive" && i + 1 < argc) archiveName = argv[++i];
+		else numThreads = atoi(argv[i]);
+	}
+	return runBatch(argv[2], numThreads, archiveName);
+}
+
+// ------------------------------------ outputStems --------------------------------------
+
+// purpose: name the files written for each image so no two images write the same file
+// preconditions: none
+// postconditions: returns one name per image, the stem of its file name; images sharing a stem
+//	(a/x.png and b/x.png) get their position in the list appended instead, which no other image
+//	uses, and the renaming is output to cerr
+
+// --------------------------------------------------------------------------------------
+vector<string> outputStems(const vector<string>& imageNames)
+{
+	vector<string> stems(imageNames.size());
+	map<string, int> numUses;
+	for (size_t i = 0; i < imageNames.size(); i++)
+	{
+		stems[i] = filesystem::path(imageNames[i]).stem().string();
+		numUses[stems[i]]++;
+	}
+
+	for (size_t i = 0; i < imageNames.size(); i++)
+	{
+		if (numUses[stems[i]] == 1) continue;
+
+		// a stem of another image can already end in the same number, so keep appending until free
+		string stem = stems[i] + "_" + to_string(i + 1);
+		while (numUses.count(stem) > 0) stem += "_" + to_string(i + 1);
+		numUses[stem] = 1;
+		cerr << imageNames[i] << " shares its name with another image, written as " << stem << endl;
+		stems[i] = stem;
+	}
+	return stems;
+}
+
+// ------------------------------------ runCli --------------------------------------
+
+// purpose: recognize images without any window, for use on headless machines
+// preconditions: imageNames are valid images; outDir is empty or an existing directory;
+//	pyramidLevels is 0 for full resolution recognition; cacheDir is empty or a writable directory
+// postconditions: outputs one JSON line per image with its classified shapes; if outDir is given,
+//	the annotated images are written there by a background thread while recognition continues.
+//	If cacheDir is given, images recognized before with the same parameters are read from the
+//	cache there instead, the cache is kept under cacheBytes, and its hits and misses are output
+//	to cerr. If archiveName is given, the shapes of every image are also written to an archive.
+//	If svgDir is given, an SVG overlay of the boxes and labels of each image, linking to the
+//	image, is written there as <name>.svg; images with the same name in different directories get
+//	their position in imageNames appended to it, for the annotated images as well. If lowMemory is
+//	true, the recognizer frees its buffers after each image and does not hold on to the image. The
+//	limits are those of profile, and the contours are found with backend
+
+// --------------------------------------------------------------------------------------
+int runCli(const vector<string>& imageNames, const string& outDir, int pyramidLevels,
+	const string& cacheDir, long long cacheBytes, const string& archiveName, const string& svgDir,
+	bool lowMemory, RecognitionProfile profile, ContourBackend backend)
+{
+	// a couple of images in flight is enough to overlap encoding with recognition
+	AsyncImageWriter writer(4);
+	// one recognizer for every image, so its buffers are only allocated once
+	RecognizeERDiagram rec;
+	RecognitionParams params = profileParams(profile);
+	params.pyramidLevels = pyramidLevels;
+	params.contourBackend = backend;
+	rec.setParams(params);
+	// the image is rendered from the copy read here, so the recognizer need not keep it
+	rec.setLowMemory(lowMemory);
+	rec.setKeepImage(!lowMemory);
+	int numFailed = 0;
+
+	unique_ptr<ResultCache> cache;
+	if (!cacheDir.empty())
+	{
+		try
+		{
+			cache.reset(new ResultCache(cacheDir, cacheBytes));
+		}
+		catch (const cv::Exception& e)
+		{
+			cerr << e.err << endl;
+			return 1;
+		}
+	}
+	unique_ptr<ResultArchiveWriter> archive;
+	try
+	{
+		if (!archiveName.empty()) archive.reset(new ResultArchiveWriter(archiveName));
+	}
+	catch (const cv::Exception& e)
+	{
+		cerr << e.err << endl;
+		return 1;
+	}
+	ShapeTable cachedShapes;
+	Size cachedSize;
+	vector<string> stems = outputStems(imageNames);
+
+	for (size_t i = 0; i < imageNames.size(); i++)
+	{
+		try
+		{
+			Mat image = imread(imageNames[i]);
+			// an image that cannot be read is left to recognize to report
+			uint64 key = 0;
+			bool cached = false;
+			if (cache != nullptr && !image.empty())
+			{
+				key = ResultCache::hashKey(image, params);
+				cached = cache->lookup(key, cachedShapes, cachedSize);
+			}
+			if (!cached)
+			{
+				rec.recognize(image);
+				if (cache != nullptr) cache->store(key, rec.getImageSize(), rec.getShapes());
+			}
+
+			const ShapeTable& shapes = cached ? cachedShapes : rec.getShapes();
+			ResultWriter::writeJson(cout, imageNames[i], image.size(), shapes);
+			if (archive != nullptr) archive->write(imageNames[i], image.size(), shapes);
+			if (!svgDir.empty())
+			{
+				// a few kilobytes written straight away; the image itself is only linked
+				filesystem::path svgPath = filesystem::path(svgDir) / (stems[i] + ".svg");
+				ofstream svg(svgPath);
+				ResultWriter::writeSvg(svg, ResultWriter::imageHref(imageNames[i], svgDir), image.size(), shapes);
+				if (!svg)
+				{
+					cerr << svgPath.string() << " could not be written" << endl;
+					numFailed++;
+				}
+			}
+			if (!outDir.empty())
+			{
+				filesystem::path outPath = filesystem::path(outDir) / (stems[i] + "_annotated.png");
+				// a new matrix each time, since the writer holds on to its pixels
+				Mat rendered;
+				rec.renderShapes(image, shapes, rendered);
+				writer.write(outPath.string(), rendered);
+			}
+		}
+		catch (const cv::Exception&)
+		{
+			cout << "{\"image\":\"" << ResultWriter::escapeJson(imageNames[i]) <<
+				"\",\"error\":\"could not be recognized\"}" << endl;
+			numFailed++;
+		}
+	}
+
+	writer.finish();
+	if (writer.getNumFailed() > 0)
+	{
+		cerr << writer.getNumFailed() << " annotated images could not be written" << endl;
+		numFailed += writer.getNumFailed();
+	}
+	if (cache != nullptr)
+	{
+		CacheStats stats = cache->getStats();
+		cerr << "Cache: " << stats.hits << " hits, " << stats.misses << " misses, " << stats.stores <<
+			" stored, " << stats.evictions << " evicted" << endl;
+	}
+	return numFailed == 0 ? 0 : 1;
+}
+
+// ------------------------------------ cliCommand --------------------------------------
+
+// purpose: recognize images without any window from the command line
+// preconditions: argv[1] is cli and argc is at least 3
+// postconditions: the arguments after argv[1] are read and the mode is run; returns its exit
+//	code, or USAGE_ERROR if the arguments are wrong
+
+// --------------------------------------------------------------------------------------
+int cliCommand(int argc, char* argv[])
+{
+	string outDir;
+	int pyramidLevels = 0;
+	string cacheDir;
+	// megabytes the cache may take
+	long long cacheSize = 256;
+	string archiveName;
+	string svgDir;
+	bool lowMemory = false;
+	RecognitionProfile profile = RecognitionProfile::Digital;
+	ContourBackend backend = ContourBackend::FindContours;
+	vector<string> imageNames;
+	for (int i = 2; i < argc; i++)
+	{
+		if (string(argv[i]) == "--out" && i + 1 < argc) outDir = argv[++i];
+		else if (string(argv[i]) == "--profile" && i + 1 < argc)
+		{
+			if (!parseProfile(argv[++i], profile))
+			{
+				cerr << "unknown profile " << argv[i] << endl;
+				return USAGE_ERROR;
+			}
+		}
+		else if (string(argv[i]) == "--pyramid" && i + 1 < argc) pyramidLevels = max(0, atoi(argv[++i]));
+		else if (string(argv[i]) == "--backend" && i + 1 < argc)
+		{
+			if (!parseContourBackend(argv[++i], backend))
+			{
+				cerr << "unknown backend " << argv[i] << endl;
+				return USAGE_ERROR;
+			}
+		}
+		else if (string(argv[i]) == "--cache" && i + 1 < argc) cacheDir = argv[++i];
+		else if (string(argv[i]) == "--cache-size" && i + 1 < argc) cacheSize = max(1, atoi(argv[++i]));
+		else if (string(argv[i]) == "--archive" && i + 1 < argc) archiveName = argv[++i];
+		else if (string(argv[i]) == "--svg" && i + 1 < argc) svgDir = argv[++i];
+		else if (string(argv[i]) == "--low-memory") lowMemory = true;
+		else imageNames.push_back(argv[i]);
+	}
+	// options alone recognize nothing, which is a mistake rather than success
+	if (!imageNames.empty())
+	{
+		return runCli(imageNames, outDir, pyramidLevels, cacheDir, cacheSize * 1024 * 1024, archiveName,
+			svgDir, lowMemory, profile, backend);
+	}
+	return USAGE_ERROR;
+}
+
+// ------------------------------------ runTiled --------------------------------------
+
+// purpose: recognize very large scans one tile at a time
+// preconditions: imageNames are valid images, tileSize is larger than overlap
+// postconditions: outputs one JSON line per image with its classified shapes, shapes larger
+//	than the overlap included; the images are never fully loaded into memory, and an image that
+//	is not a binary PGM/PPM is refused with an error line. Regions the recognizer could not hold
+//	whole in any window are reported on the error output
+
+// --------------------------------------------------------------------------------------
+int runTiled(const vector<string>& imageNames, int tileSize, int overlap)
+{
+	TiledRecognizer rec(tileSize, overlap);
+	int numFailed = 0;
+
+	for (size_t i = 0; i < imageNames.size(); i++)
+	{
+		try
+		{
+			unique_ptr<TileSource> source = TileSource::open(imageNames[i]);
+			rec.recognize(*source);
+			ResultWriter::writeJson(cout, imageNames[i], rec.getImageSize(), rec.getShapes());
+
+			// shapes may be missing there, so say so rather than leave the output looking whole
+			const vector<Rect>& crossings = rec.getSeamCrossings();
+			if (!crossings.empty())
+			{
+				cerr << imageNames[i] << ": " << crossings.size() << " regions could not be read whole, " <<
+					"first at " << crossings[0] << "; shapes there may be missing" << endl;
+			}
+		}
+		catch (const cv::Exception& e)
+		{
+			cerr << imageNames[i] << ": " << e.err << endl;
+			cout << "{\"image\":\"" << ResultWriter::escapeJson(imageNames[i]) <<
+				"\",\"error\":\"could not be recognized\"}" << endl;
+			numFailed++;
+		}
+	}
+	return numFailed == 0 ? 0 : 1;
+}
+
+// ------------------------------------ tiledCommand --------------------------------------
+
+// purpose: recognize very large scans tile by tile from the command line
+// preconditions: argv[1] is tiled and argc is at least 3
+// postconditions: the arguments after argv[1] are read and the mode is run; returns its exit
+//	code, or USAGE_ERROR if the arguments are wrong
+
+// --------------------------------------------------------------------------------------
+int tiledCommand(int argc, char* argv[])
+{
+	int tileSize = 2048;
+	int overlap = 512;
+	vector<string> imageNames;
+	for (int i = 2; i < argc; i++)
+	{
+		if (string(argv[i]) == "--tile" && i + 1 < argc) tileSize = atoi(argv[++i]);
+		else if (string(argv[i]) == "--overlap" && i + 1 < argc) overlap = atoi(argv[++i]);
+		else imageNames.push_back(argv[i]);
+	}
+	return runTiled(imageNames, tileSize, overlap);
+}
+
+// ------------------------------------ runArchiveJson --------------------------------------
+
+// purpose: convert an archive back to the JSON lines cli prints
+// preconditions: archiveName is an archive written by batch or cli
+// postconditions: outputs one JSON line per record, in archive order
+
+// --------------------------------------------------------------------------------------
+int runArchiveJson(const string& archiveName)
+{
+	try
+	{
+		ResultArchiveReader reader(archiveName);
+		ArchiveRecord record;
+		ShapeTable shapes;
+		while (reader.next(record))
+		{
+			record.toShapeTable(shapes);
+			ResultWriter::writeJson(cout, record.getImageName(), record.getImageSize(), shapes);
+		}
+	}
+	catch (const cv::Exception& e)
+	{
+		cerr << e.err << endl;
+		return 1;
+	}
+	return 0;
+}
+
+// ------------------------------------ runArchiveScan --------------------------------------
+
+// purpose: find the images of an archive whose counts are within limits
+// preconditions: archiveName is an archive written by batch or cli; minCounts and maxCounts hold
+//	a limit for each type, indexed by ShapeType
+// postconditions: outputs the name and counts of every matching image, then how many matched;
+//	only the record headers are read
+
+// --------------------------------------------------------------------------------------
+int runArchiveScan(const string& archiveName, const vector<int>& minCounts, const vector<int>& maxCounts)
+{
+	const ShapeType types[] = { ShapeType::Attribute, ShapeType::Entity, ShapeType::Relationship,
+		ShapeType::WeakEntity, ShapeType::WeakRelationship, ShapeType::MultivaluedAttribute };
+	try
+	{
+		ResultArchiveReader reader(archiveName);
+		ArchiveRecord record;
+		long long numRecords = 0;
+		long long numMatched = 0;
+		auto start = chrono::steady_clock::now();
+		cout << "Image, Attributes, Entities, Relationships, Weak Entities, Weak Relationships, " <<
+			"Multivalued Attributes" << endl;
+		while (reader.next(record))
+		{
+			numRecords++;
+			bool matches = true;
+			for (int t = 0; t < NUM_SHAPE_TYPES - 1 && matches; t++)
+			{
+				int count = record.count((ShapeType)t);
+				matches = count >= minCounts[t] && count <= maxCounts[t];
+			}
+			if (!matches) continue;
+
+			numMatched++;
+			cout << record.getImageName();
+			for (int t = 0; t < 6; t++)
+			{
+				cout << ", " << record.count(types[t]);
+			}
+			cout << endl;
+		}
+		auto end = chrono::steady_clock::now();
+		cout << "matched " << numMatched << " of " << numRecords << " images in " <<
+			chrono::duration<double, milli>(end - start).count() << " ms" << endl;
+	}
+	catch (const cv::Exception& e)
+	{
+		cerr << e.err << endl;
+		return 1;
+	}
+	return 0;
+}
+
+// ------------------------------------ archiveCommand --------------------------------------
+
+// purpose: read an archive from the command line
+// preconditions: argv[1] is archive and argc is at least 4
+// postconditions: the arguments after argv[1] are read and the mode is run; returns its exit
+//	code, or USAGE_ERROR if the arguments are wrong
+
+// --------------------------------------------------------------------------------------
+int archiveCommand(int argc, char* argv[])
+{
+	if (string(argv[2]) == "json") return runArchiveJson(argv[3]);
+	if (string(argv[2]) != "scan") return USAGE_ERROR;
+
+	vector<int> minCounts(NUM_SHAPE_TYPES - 1, 0);
+	vector<int> maxCounts(NUM_SHAPE_TYPES - 1, INT_MAX);
+	string archiveName;
+	bool valid = true;
+	for (int i = 3; i < argc && valid; i++)
+	{
+		string arg = argv[i];
+		if ((arg == "--min" || arg == "--max") && i + 2 < argc)
+		{
+			// types are named as in the JSON output, e.g. weakEntity
+			string typeName = argv[++i];
+			int limit = atoi(argv[++i]);
+			int type = 0;
+			while (type < NUM_SHAPE_TYPES - 1 && typeName != ResultWriter::jsonTypeName((ShapeType)type)) type++;
+			valid = type < NUM_SHAPE_TYPES - 1;
+			if (valid && arg == "--min") minCounts[type] = limit;
+			else if (valid) maxCounts[type] = limit;
+		}
+		else archiveName = arg;
+	}
+	if (valid && !archiveName.empty()) return runArchiveScan(archiveName, minCounts, maxCounts);
+	return USAGE_ERROR;
+}
+
+// ------------------------------------ runGraph --------------------------------------
+
+// purpose: read diagrams as graphs of shapes joined by connectors
+// preconditions: imageNames are valid images
+// postconditions: outputs one JSON line per image with its shapes as nodes and its connectors
+//	as edges
+
+// --------------------------------------------------------------------------------------
+int runGraph(const vector<string>& imageNames)
+{
+	RecognizeERDiagram rec;
+	ConnectorExtractor extractor;
+	const RecognitionParams& params = rec.getParams();
+	Mat binary;
+	int numFailed = 0;
+
+	for (size_t i = 0; i < imageNames.size(); i++)
+	{
+		try
+		{
+			Mat image = imread(imageNames[i]);
+			if (image.empty()) CV_Error(Error::StsBadArg, "could not read " + imageNames[i]);
+
+			// the connectors are traced in the same threshold the shapes were found in
+			GrayThreshold::apply(image, binary, params.minThreshold, params.maxThreshold);
+			rec.recognizeThresholded(image, binary);
+			extractor.extract(binary, rec.getShapes(), params);
+			ResultWriter::writeGraphJson(cout, imageNames[i], image.size(), rec.getShapes(),
+				extractor.getConnectors());
+		}
+		catch (const cv::Exception&)
+		{
+			cout << "{\"image\":\"" << ResultWriter::escapeJson(imageNames[i]) <<
+				"\",\"error\":\"could not be recognized\"}" << endl;
+			numFailed++;
+		}
+	}
+	return numFailed == 0 ? 0 : 1;
+}
+
+// ------------------------------------ graphCommand --------------------------------------
+
+// purpose: output the graph of shapes and connectors from the command line
+// preconditions: argv[1] is graph and argc is at least 3
+// postconditions: the arguments after argv[1] are read and the mode is run; returns its exit
+//	code, or USAGE_ERROR if the arguments are wrong
+
+// --------------------------------------------------------------------------------------
+int graphCommand(int argc, char* argv[])
+{
+	return runGraph(vector<string>(argv + 2, argv + argc));
+}
+
+// ------------------------------------ runGenerate --------------------------------------
+
+// purpose: draw a diagram whose correct recognition is known
+// preconditions: spec is within the limits given in DiagramSpec; outFile is a writable image path
+// postconditions: the diagram is written to outFile and its expected counts are output as a Test;
+//	if check is true it is also recognized and 1 is returned unless every count matches
+
+// --------------------------------------------------------------------------------------
+int runGenerate(const DiagramSpec& spec, const string& outFile, bool check)
+{
+	Mat page;
+	try
+	{
+		page = DiagramGenerator::generate(spec);
+	}
+	catch (const cv::Exception& e)
+	{
+		cerr << e.err << endl;
+		return 1;
+	}
+	if (!imwrite(outFile, page))
+	{
+		cerr << outFile << " could not be written" << endl;
+		return 1;
+	}
+
+	Test test = DiagramGenerator::expectedCounts(spec, outFile);
+	cout << "Test{ \"" << test.imageName << "\", " << test.expectedAttributes << ", " <<
+		test.expectedEntities << ", " << test.expectedRelationships << ", " << test.expectedWeakEntities <<
+		", " << test.expectedWeakRelationships << ", " << test.expectedMultivaluedAttributes << " }" << endl;
+	if (!check) return 0;
+
+	RecognizeERDiagram rec;
+	rec.recognize(page);
+	int actual[] = { rec.getNumAttributes(), rec.getNumEntities(), rec.getNumRelationships(),
+		rec.getNumWeakEntities(), rec.getNumWeakRelationships(), rec.getNumMultivaluedAttributes() };
+	int expected[] = { test.expectedAttributes, test.expectedEntities, test.expectedRelationships,
+		test.expectedWeakEntities, test.expectedWeakRelationships, test.expectedMultivaluedAttributes };
+	const char* labels[] = { "Attributes        ", "Entities          ", "Relationships     ",
+		"Weak Entities     ", "Weak Relationships", "Multivalued Attributes" };
+	bool matches = true;
+	cout << "\nActual vs Expected" << endl;
+	for (int i = 0; i < 6; i++)
+	{
+		cout << labels[i] << ": " << actual[i] << " : " << expected[i] << endl;
+		if (actual[i] != expected[i]) matches = false;
+	}
+	return matches ? 0 : 1;
+}
+
+// ------------------------------------ generateCommand --------------------------------------
+
+// purpose: draw a diagram with known counts from the command line
+// preconditions: argv[1] is generate and argc is at least 3
+// postconditions: the arguments after argv[1] are read and the mode is run; returns its exit
+//	code, or USAGE_ERROR if the arguments are wrong
+
+// --------------------------------------------------------------------------------------
+int generateCommand(int argc, char* argv[])
+{
+	DiagramSpec spec;
+	bool check = false;
+	string outFile;
+	for (int i = 2; i < argc; i++)
+	{
+		string arg = argv[i];
+		if (arg == "--check") check = true;
+		else if (i + 1 >= argc) outFile = arg;
+		else if (arg == "--shapes")
+		{
+			DiagramSpec mixed = DiagramGenerator::mix(max(0, atoi(argv[++i])));
+			spec.numEntities = mixed.numEntities;
+			spec.numRelationships = mixed.numRelationships;
+			spec.numAttributes = mixed.numAttributes;
+			spec.numWeakEntities = mixed.numWeakEntities;
+			spec.numWeakRelationships = mixed.numWeakRelationships;
+			spec.numMultivaluedAttributes = mixed.numMultivaluedAttributes;
+		}
+		else if (arg == "--entities") spec.numEntities = max(0, atoi(argv[++i]));
+		else if (arg == "--relationships") spec.numRelationships = max(0, atoi(argv[++i]));
+		else if (arg == "--attributes") spec.numAttributes = max(0, atoi(argv[++i]));
+		else if (arg == "--weak-entities") spec.numWeakEntities = max(0, atoi(argv[++i]));
+		else if (arg == "--weak-relationships") spec.numWeakRelationships = max(0, atoi(argv[++i]));
+		else if (arg == "--multivalued") spec.numMultivaluedAttributes = max(0, atoi(argv[++i]));
+		else if (arg == "--size") spec.shapeSize = atoi(argv[++i]);
+		else if (arg == "--stroke") spec.strokeWidth = atoi(argv[++i]);
+		else if (arg == "--noise") spec.noise = atof(argv[++i]);
+		else if (arg == "--seed") spec.seed = atoi(argv[++i]);
+		else if (arg == "--page")
+		{
+			int width = 0, height = 0;
+			sscanf(argv[++i], "%dx%d", &width, &height);
+			spec.pageSize = Size(width, height);
+		}
+		else outFile = arg;
+	}
+	if (!outFile.empty()) return runGenerate(spec, outFile, check);
+	return USAGE_ERROR;
+}
@@ -0,0 +1,75 @@
+// OutputCommands.h
+// Purpose: recognize images from the command line and write what was found
+// Functionality: the batch, cli, tiled, archive, graph and generate modes of the program: each
+//	command reads its arguments and runs its driver, which recognizes images (or draws one) and
+//	writes the shapes found as counts, JSON, annotated images, SVG overlays or an archive
+// Assumptions:
+//	The images named on the command line are readable
+// Authors: Allan Genari Gaarden, Tommy Ni, Joshua Medvinsky
+
+#ifndef OUTPUT_COMMANDS_H
+#define OUTPUT_COMMANDS_H
+
+#include "Command.h"
+
+// ------------------------------------ batchCommand --------------------------------------
+
+// purpose: recognize a whole directory or file list from the command line
+// preconditions: argv[1] is batch and argc is at least 3
+// postconditions: the arguments after argv[1] are read and the mode is run; returns its exit
+//	code, or USAGE_ERROR if the arguments are wrong
+
+// --------------------------------------------------------------------------------------
+int batchCommand(int argc, char* argv[]);
+
+// ------------------------------------ cliCommand --------------------------------------
+
+// purpose: recognize images without any window from the command line
+// preconditions: argv[1] is cli and argc is at least 3
+// postconditions: the arguments after argv[1] are read and the mode is run; returns its exit
+//	code, or USAGE_ERROR if the arguments are wrong
+
+// --------------------------------------------------------------------------------------
+int cliCommand(int argc, char* argv[]);
+
+// ------------------------------------ tiledCommand --------------------------------------
+
+// purpose: recognize very large scans tile by tile from the command line
+// preconditions: argv[1] is tiled and argc is at least 3
+// postconditions: the arguments after argv[1] are read and the mode is run; returns its exit
+//	code, or USAGE_ERROR if the arguments are wrong
+
+// --------------------------------------------------------------------------------------
+int tiledCommand(int argc, char* argv[]);
+
+// ------------------------------------ archiveCommand --------------------------------------
+
+// purpose: read an archive from the command line
+// preconditions: argv[1] is archive and argc is at least 4
+// postconditions: the arguments after argv[1] are read and the mode is run; returns its exit
+//	code, or USAGE_ERROR if the arguments are wrong
+
+// --------------------------------------------------------------------------------------
+int archiveCommand(int argc, char* argv[]);
+
+// ------------------------------------ graphCommand --------------------------------------
+
+// purpose: output the graph of shapes and connectors from the command line
+// preconditions: argv[1] is graph and argc is at least 3
+// postconditions: the arguments after argv[1] are read and the mode is run; returns its exit
+//	code, or USAGE_ERROR if the arguments are wrong
+
+// --------------------------------------------------------------------------------------
+int graphCommand(int argc, char* argv[]);
+
+// ------------------------------------ generateCommand --------------------------------------
+
+// purpose: draw a diagram with known counts from the command line
+// preconditions: argv[1] is generate and argc is at least 3
+// postconditions: the arguments after argv[1] are read and the mode is run; returns its exit
+//	code, or USAGE_ERROR if the arguments are wrong
+
+// --------------------------------------------------------------------------------------
+int generateCommand(int argc, char* argv[]);
+
+#endif
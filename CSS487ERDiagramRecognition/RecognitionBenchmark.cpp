@@ -0,0 +1,309 @@
+// RecognitionBenchmark.cpp
+// Purpose: time recognition as a whole and each of its stages, to compare builds and catch
+//	performance regressions
+// Functionality: recognizes every image added a number of times, timing the whole recognition
+//	and, on a second pass, each stage on its own: thresholding, findContours, detectShapes,
+//	eraseParentContour, determineWeakTypes, isNested over every pair of shapes, rendering
+//	the boxes, and writing them as an SVG overlay instead. The fastest, median and mean time
+//	of every stage are written as one JSON object.
+//	mosaic builds large pages out of small images for timing at production sizes
+// Assumptions:
+//	Images are recognized at full resolution with the default parameters
+//	Times are wall clock times of one thread, except detectShapes which uses every core
+// Authors: Allan Genari Gaarden, Tommy Ni, Joshua Medvinsky
+
+#include "RecognitionBenchmark.h"
+#include "ResultWriter.h"
+#include <algorithm>
+#include <sstream>
+
+// isNested is timed on every pair of at most this many shapes; every pair of a page with a
+//	hundred thousand shapes would take minutes and say nothing more about a single call
+static const int MAX_NESTED_SHAPES = 2000;
+
+// ------------------------------------ parameter constructor --------------------------------------
+
+// purpose: set up a benchmark
+// preconditions: repetitions is at least 1
+// postconditions: every image is timed repetitions times, after one run that is not timed
+
+// --------------------------------------------------------------------------------------
+RecognitionBenchmark::RecognitionBenchmark(int repetitions)
+{
+	this->repetitions = max(1, repetitions);
+}
+
+// ------------------------------------ addImage --------------------------------------
+
+// purpose: add an image to time
+// preconditions: image is a valid BGR image
+// postconditions: image is timed by the next run under the name imageName
+
+// --------------------------------------------------------------------------------------
+void RecognitionBenchmark::addImage(const string& imageName, const Mat& image)
+{
+	imageNames.push_back(imageName);
+	images.push_back(image);
+}
+
+// ------------------------------------ run --------------------------------------
+
+// purpose: time every image added
+// preconditions: none
+// postconditions: the results hold the times of every stage for every image, in the order the
+//	images were added; throws cv::Exception if an image cannot be recognized
+
+// --------------------------------------------------------------------------------------
+void RecognitionBenchmark::run()
+{
+	results.clear();
+	// one recognizer for every run, as in production, so buffers are not allocated while timing
+	RecognizeERDiagram rec;
+	TickMeter timer;
+
+	for (size_t i = 0; i < images.size(); i++)
+	{
+		BenchmarkResult result;
+		result.imageName = imageNames[i];
+		result.imageSize = images[i].size();
+
+		// the untimed run grows the buffers to the size of this image
+		BenchmarkResult warmUp;
+		rec.recognize(images[i]);
+		timeStages(rec, images[i], warmUp);
+
+		for (int run = 0; run < repetitions; run++)
+		{
+			timer.reset();
+			timer.start();
+			rec.recognize(images[i]);
+			timer.stop();
+			result.times[(int)BenchmarkStage::Recognize].push_back(timer.getTimeMilli());
+
+			timeStages(rec, images[i], result);
+		}
+		results.push_back(result);
+	}
+}
+
+// ------------------------------------ timeStages --------------------------------------
+
+// purpose: run recognition one stage at a time, timing each
+// preconditions: rec has no image; image is a valid BGR image
+// postconditions: the time of every stage but Recognize is appended to result, and the counts
+//	of result are set
+
+// --------------------------------------------------------------------------------------
+void RecognitionBenchmark::timeStages(RecognizeERDiagram& rec, const Mat& image,
+	BenchmarkResult& result)
+{
+	// the same steps as RecognitionCore::recognize at full resolution, with a timer around each
+	TickMeter timer;
+	rec.reset();
+	rec.image = image;
+	rec.result.imageSize = image.size();
+	RecognitionScratch& scratch = rec.scratch;
+	ShapeTable& shapes = rec.result.shapes;
+
+	timer.start();
+	GrayThreshold::apply(rec.image, scratch.thresh, rec.params.minThreshold, rec.params.maxThreshold);
+	timer.stop();
+	result.times[(int)BenchmarkStage::GrayThreshold].push_back(timer.getTimeMilli());
+
+	timer.reset();
+	timer.start();
+	findContours(scratch.thresh, scratch.contours, scratch.hierarchy, RETR_TREE, CHAIN_APPROX_NONE);
+	timer.stop();
+	result.times[(int)BenchmarkStage::FindContours].push_back(timer.getTimeMilli());
+
+	timer.reset();
+	timer.start();
+	RecognitionCore::detectShapes(image.size(), rec.params, scratch, rec.result);
+	timer.stop();
+	result.times[(int)BenchmarkStage::DetectShapes].push_back(timer.getTimeMilli());
+
+	timer.reset();
+	timer.start();
+	RecognitionCore::eraseParentContour(shapes, rec.params);
+	timer.stop();
+	result.times[(int)BenchmarkStage::EraseParentContour].push_back(timer.getTimeMilli());
+
+	timer.reset();
+	timer.start();
+	RecognitionCore::determineWeakTypes(scratch, rec.result);
+	timer.stop();
+	result.times[(int)BenchmarkStage::DetermineWeakTypes].push_back(timer.getTimeMilli());
+
+	// the boxes are gathered first so only the comparisons are timed
+	int numBoxes = min(shapes.size(), MAX_NESTED_SHAPES);
+	vector<Rect> boxes(numBoxes);
+	for (int id = 0; id < numBoxes; id++)
+	{
+		boxes[id] = shapes.getBoundingBox(id);
+	}
+	// the nested pairs are counted and reported so the comparisons cannot be optimized away
+	long long numNested = 0;
+	timer.reset();
+	timer.start();
+	for (int i = 0; i < numBoxes; i++)
+	{
+		for (int j = 0; j < numBoxes; j++)
+		{
+			if (i != j && ContainmentTree::isNested(boxes[i], boxes[j])) numNested++;
+		}
+	}
+	timer.stop();
+	result.times[(int)BenchmarkStage::IsNested].push_back(timer.getTimeMilli());
+
+	timer.reset();
+	timer.start();
+	Mat rendered = rec.renderRectForShapes();
+	timer.stop();
+	result.times[(int)BenchmarkStage::RenderRectForShapes].push_back(timer.getTimeMilli());
+
+	// into memory, so only building the document is timed
+	ostringstream svg;
+	timer.reset();
+	timer.start();
+	ResultWriter::writeSvg(svg, result.imageName, image.size(), shapes);
+	timer.stop();
+	result.times[(int)BenchmarkStage::WriteSvg].push_back(timer.getTimeMilli());
+
+	result.numContours = (int)scratch.contours.size();
+	result.numShapes = shapes.size() - shapes.count(ShapeType::Discarded);
+	result.numNestedCalls = (long long)numBoxes * (numBoxes - 1);
+	result.numNestedPairs = numNested;
+}
+
+// ------------------------------------ writeJson --------------------------------------
+
+// purpose: write the results in a form that can be compared between builds
+// preconditions: run has been called
+// postconditions: one JSON object, terminated by a newline, is written to out with the build
+//	details and the fastest, median and mean milliseconds of every stage of every image
+
+// --------------------------------------------------------------------------------------
+void RecognitionBenchmark::writeJson(ostream& out) const
+{
+	out << "{\"opencvVersion\":\"" << CV_VERSION << "\"";
+	out << ",\"grayThresholdKernel\":\"" <<
+		GrayThreshold::kernelName(GrayThreshold::bestKernel()) << "\"";
+	out << ",\"threads\":" << getNumThreads();
+	out << ",\"repetitions\":" << repetitions;
+
+	out << ",\"images\":[";
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		const BenchmarkResult& result = results[i];
+		if (i > 0) out << ",";
+		out << "{\"image\":\"" << ResultWriter::escapeJson(result.imageName) << "\"";
+		out << ",\"width\":" << result.imageSize.width << ",\"height\":" << result.imageSize.height;
+		out << ",\"contours\":" << result.numContours << ",\"shapes\":" << result.numShapes;
+		out << ",\"nestedCalls\":" << result.numNestedCalls << ",\"nestedPairs\":" <<
+			result.numNestedPairs;
+
+		out << ",\"stages\":{";
+		for (int stage = 0; stage < NUM_BENCHMARK_STAGES; stage++)
+		{
+			if (stage > 0) out << ",";
+			out << "\"" << stageName((BenchmarkStage)stage) << "\":";
+			writeStage(out, result.times[stage]);
+		}
+		out << "}}";
+	}
+	out << "]}" << endl;
+}
+
+// ------------------------------------ writeStage --------------------------------------
+
+// purpose: write the summary of one stage as a JSON object
+// preconditions: times is not empty
+// postconditions: the fastest, median and mean of times are written to out
+
+// --------------------------------------------------------------------------------------
+void RecognitionBenchmark::writeStage(ostream& out, const vector<double>& times)
+{
+	vector<double> sorted = times;
+	sort(sorted.begin(), sorted.end());
+	double median = sorted.size() % 2 == 1 ? sorted[sorted.size() / 2] :
+		(sorted[sorted.size() / 2 - 1] + sorted[sorted.size() / 2]) / 2;
+	double sum = 0;
+	for (size_t i = 0; i < sorted.size(); i++)
+	{
+		sum += sorted[i];
+	}
+
+	out << "{\"minMs\":" << sorted.front() << ",\"medianMs\":" << median << ",\"meanMs\":" <<
+		sum / sorted.size() << "}";
+}
+
+// ------------------------------------ getResults --------------------------------------
+
+// purpose: get what was measured
+// preconditions: none
+// postconditions: returns one result per image, in the order the images were added
+
+// --------------------------------------------------------------------------------------
+const vector<BenchmarkResult>& RecognitionBenchmark::getResults() const
+{
+	return results;
+}
+
+// ------------------------------------ mosaic --------------------------------------
+
+// purpose: build a large page out of smaller images
+// preconditions: images is not empty and holds BGR images; columns and rows are at least 1
+// postconditions: returns a white page with columns by rows cells, each holding the next image
+//	(starting over once all are used) with a white margin around it so no drawing touches
+//	another or the edge of the page
+
+// --------------------------------------------------------------------------------------
+Mat RecognitionBenchmark::mosaic(const vector<Mat>& images, int columns, int rows)
+{
+	const int margin = 20;
+	int cellWidth = 0;
+	int cellHeight = 0;
+	for (size_t i = 0; i < images.size(); i++)
+	{
+		cellWidth = max(cellWidth, images[i].cols + 2 * margin);
+		cellHeight = max(cellHeight, images[i].rows + 2 * margin);
+	}
+
+	Mat page(rows * cellHeight, columns * cellWidth, CV_8UC3, Scalar(255, 255, 255));
+	int next = 0;
+	for (int row = 0; row < rows; row++)
+	{
+		for (int column = 0; column < columns; column++)
+		{
+			const Mat& image = images[next];
+			next = (next + 1) % images.size();
+			Mat cell = page(Rect(column * cellWidth + margin, row * cellHeight + margin, image.cols,
+				image.rows));
+			image.copyTo(cell);
+		}
+	}
+	return page;
+}
+
+// ------------------------------------ stageName --------------------------------------
+
+// purpose: get the name used for a stage in the JSON output
+// preconditions: none
+// postconditions: returns the camel case name of stage (e.g. "findContours")
+
+// --------------------------------------------------------------------------------------
+const char* RecognitionBenchmark::stageName(BenchmarkStage stage)
+{
+	switch (stage)
+	{
+	case BenchmarkStage::Recognize: return "recognize";
+	case BenchmarkStage::GrayThreshold: return "grayThreshold";
+	case BenchmarkStage::FindContours: return "findContours";
+	case BenchmarkStage::DetectShapes: return "detectShapes";
+	case BenchmarkStage::EraseParentContour: return "eraseParentContour";
+	case BenchmarkStage::DetermineWeakTypes: return "determineWeakTypes";
+	case BenchmarkStage::IsNested: return "isNested";
+	case BenchmarkStage::RenderRectForShapes: return "renderRectForShapes";
+	default: return "writeSvg";
+	}
+}
@@ -0,0 +1,143 @@
+// RecognitionBenchmark.h
+// Purpose: time recognition as a whole and each of its stages, to compare builds and catch
+//	performance regressions
+// Functionality: recognizes every image added a number of times, timing the whole recognition
+//	and, on a second pass, each stage on its own: thresholding, findContours, detectShapes,
+//	eraseParentContour, determineWeakTypes, isNested over every pair of shapes, rendering
+//	the boxes, and writing them as an SVG overlay instead. The fastest, median and mean time
+//	of every stage are written as one JSON object.
+//	mosaic builds large pages out of small images for timing at production sizes
+// Assumptions:
+//	Images are recognized at full resolution with the default parameters
+//	Times are wall clock times of one thread, except detectShapes which uses every core
+// Authors: Allan Genari Gaarden, Tommy Ni, Joshua Medvinsky
+
+#ifndef RECOGNITION_BENCHMARK_H
+#define RECOGNITION_BENCHMARK_H
+
+#include "RecognizeERDiagram.h"
+
+// the parts of recognition that are timed, in the order they run
+enum class BenchmarkStage
+{
+	Recognize,
+	GrayThreshold,
+	FindContours,
+	DetectShapes,
+	EraseParentContour,
+	DetermineWeakTypes,
+	IsNested,
+	RenderRectForShapes,
+	WriteSvg
+};
+
+// number of BenchmarkStage values, used to size per stage arrays
+const int NUM_BENCHMARK_STAGES = (int)BenchmarkStage::WriteSvg + 1;
+
+// everything measured on one image
+struct BenchmarkResult
+{
+	string imageName;
+	Size imageSize;
+	int numContours = 0;
+	int numShapes = 0;
+	// number of isNested calls timed per run, one per ordered pair of shapes
+	long long numNestedCalls = 0;
+	// number of those calls that found a shape inside another
+	long long numNestedPairs = 0;
+	// milliseconds taken by each stage, one entry per run
+	vector<double> times[NUM_BENCHMARK_STAGES];
+};
+
+class RecognitionBenchmark
+{
+public:
+	// default constructor not allowed
+	RecognitionBenchmark() = delete;
+	// ------------------------------------ parameter constructor --------------------------------------
+
+// purpose: set up a benchmark
+// preconditions: repetitions is at least 1
+// postconditions: every image is timed repetitions times, after one run that is not timed
+
+// --------------------------------------------------------------------------------------
+	RecognitionBenchmark(int repetitions);
+	// ------------------------------------ addImage --------------------------------------
+
+// purpose: add an image to time
+// preconditions: image is a valid BGR image
+// postconditions: image is timed by the next run under the name imageName
+
+// --------------------------------------------------------------------------------------
+	void addImage(const string& imageName, const Mat& image);
+	// ------------------------------------ run --------------------------------------
+
+// purpose: time every image added
+// preconditions: none
+// postconditions: the results hold the times of every stage for every image, in the order the
+//	images were added; throws cv::Exception if an image cannot be recognized
+
+// --------------------------------------------------------------------------------------
+	void run();
+	// ------------------------------------ writeJson --------------------------------------
+
+// purpose: write the results in a form that can be compared between builds
+// preconditions: run has been called
+// postconditions: one JSON object, terminated by a newline, is written to out with the build
+//	details and the fastest, median and mean milliseconds of every stage of every image
+
+// --------------------------------------------------------------------------------------
+	void writeJson(ostream& out) const;
+	// ------------------------------------ getResults --------------------------------------
+
+// purpose: get what was measured
+// preconditions: none
+// postconditions: returns one result per image, in the order the images were added
+
+// --------------------------------------------------------------------------------------
+	const vector<BenchmarkResult>& getResults() const;
+	// ------------------------------------ mosaic --------------------------------------
+
+// purpose: build a large page out of smaller images
+// preconditions: images is not empty and holds BGR images; columns and rows are at least 1
+// postconditions: returns a white page with columns by rows cells, each holding the next image
+//	(starting over once all are used) with a white margin around it so no drawing touches
+//	another or the edge of the page
+
+// --------------------------------------------------------------------------------------
+	static Mat mosaic(const vector<Mat>& images, int columns, int rows);
+	// ------------------------------------ stageName --------------------------------------
+
+// purpose: get the name used for a stage in the JSON output
+// preconditions: none
+// postconditions: returns the camel case name of stage (e.g. "findContours")
+
+// --------------------------------------------------------------------------------------
+	static const char* stageName(BenchmarkStage stage);
+
+private:
+	int repetitions;
+	vector<string> imageNames;
+	vector<Mat> images;
+	vector<BenchmarkResult> results;
+
+	// ------------------------------------ timeStages --------------------------------------
+
+// purpose: run recognition one stage at a time, timing each
+// preconditions: rec has no image; image is a valid BGR image
+// postconditions: the time of every stage but Recognize is appended to result, and the counts
+//	of result are set
+
+// --------------------------------------------------------------------------------------
+	void timeStages(RecognizeERDiagram& rec, const Mat& image, BenchmarkResult& result);
+	// ------------------------------------ writeStage --------------------------------------
+
+// purpose: write the summary of one stage as a JSON object
+// preconditions: times is not empty
+// postconditions: the fastest, median and mean of times are written to out
+
+// --------------------------------------------------------------------------------------
+	static void writeStage(ostream& out, const vector<double>& times);
+};
+
+#endif
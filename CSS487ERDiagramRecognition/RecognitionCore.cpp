@@ -0,0 +1,800 @@
+// RecognitionCore.cpp
+// Purpose: recognize ER diagrams from any number of threads at once, without a recognizer object
+//	per request and without a lock
+// Functionality: every step of recognition (threshold, contours, classification, outer contour,
+//	weak types, pyramid mode) as static functions of the image, the parameters, a
+//	RecognitionScratch of buffers and the RecognitionResult they fill in. Nothing is shared
+//	between calls except what is passed in: the calls without a scratch use one kept per thread,
+//	so a thread recognizing image after image stops allocating once its buffers have grown, and
+//	threads never touch each other's buffers. The classification and the outer contour test are
+//	compiled for each profile of RecognitionProfile, and the one the parameters hold is picked
+//	once per image. The contours come from findContours or, with ContourBackend::Components,
+//	from a ComponentExtractor that traces only the regions large enough to be a symbol.
+//	RecognizeERDiagram wraps these functions with its own scratch and the display functions
+// Assumptions:
+//	Each RecognitionScratch and RecognitionResult is used by one call at a time; the images and
+//	parameters may be shared freely since they are only read
+//	The contours are classified with parallel_for_, which OpenCV runs on the calling thread when
+//	several threads call it at once
+// Authors: Allan Genari Gaarden, Tommy Ni, Joshua Medvinsky
+
+#include "RecognitionCore.h"
+
+// number of contours classified by one thread at a time; classifying a contour takes
+//	little time, so smaller chunks would spend more time handing out work than doing it
+static const int CLASSIFY_CHUNK_SIZE = 64;
+
+// ------------------------------------ classifyWith --------------------------------------
+
+// purpose: decide which kind of ER diagram symbol a contour is, with the limits of a profile
+//	known when compiling or of parameters known only when running
+// preconditions: Limits is RecognitionParams or a profile type of RecognitionProfile.h; contour
+//	is a closed contour found by findContours, with CHAIN_APPROX_SIMPLE if compressed is true and
+//	CHAIN_APPROX_NONE otherwise
+// postconditions: the same as classifyContour
+// This method structure was inspired by http://www.calumk.com/old_posts_archive/0008//detecting-simple-shapes-in-an-image/
+// We made edits to the code to not check for angles of the shapes
+// as we only deal with rectangles/squares.
+
+// --------------------------------------------------------------------------------------
+template<class Limits>
+static inline ShapeType classifyWith(const vector<Point>& contour, vector<Point>& approx, const Limits& params,
+	bool compressed, CascadeStage& stage)
+{
+	// the tests run cheapest first, so the specks that make up most contours of a noisy image are
+	//	dropped before their polygon is approximated. The first two only drop contours whose
+	//	polygon could never pass the area test of either shape, so the result is the same as
+	//	approximating every contour
+	double minArea = min(params.thresholdAreaForRect, params.thresholdAreaForCircle);
+
+	// neighbouring points of the contour are at most sqrt(2) apart, so the polygon through some of
+	//	them is at most n * sqrt(2) long, and no closed curve that long encloses more than
+	//	(n * sqrt(2))^2 / (4 * pi) = n^2 / (2 * pi)
+	double numPoints = (double)contour.size();
+	if (compressed)
+	{
+		// every pixel step of the traced contour moves one pixel across, down or diagonally, so a
+		//	compressed run stood for as many points as its longer side, and the test stays exact
+		long long steps = 0;
+		for (size_t i = 0; i < contour.size(); i++)
+		{
+			const Point& next = contour[(i + 1) % contour.size()];
+			steps += max(abs(next.x - contour[i].x), abs(next.y - contour[i].y));
+		}
+		numPoints = (double)max(1LL, steps);
+	}
+	if (numPoints * numPoints <= 2 * CV_PI * minArea)
+	{
+		stage = CascadeStage::PointCount;
+		return ShapeType::Discarded;
+	}
+
+	// the polygon lies inside the bounding box of the contour
+	Rect r = boundingRect(contour);
+	if ((double)r.area() <= minArea)
+	{
+		stage = CascadeStage::BoundingBoxArea;
+		return ShapeType::Discarded;
+	}
+
+	// long thin boxes are strokes and lines, not symbols; off unless a limit is set
+	if (params.maxAspectRatio > 0 &&
+		max(r.width, r.height) > params.maxAspectRatio * min(r.width, r.height))
+	{
+		stage = CascadeStage::AspectRatio;
+		return ShapeType::Discarded;
+	}
+
+	approxPolyDP(Mat(contour), approx, arcLength(Mat(contour), true) * params.approxEpsilonFraction, true);
+
+	// 4 vertices is a rectangle or square, more than 6 vertices is a circle
+	bool quadrilateral = approx.size() == 4;
+	if (!quadrilateral && approx.size() <= 6)
+	{
+		stage = CascadeStage::PolygonVertices;
+		return ShapeType::Discarded;
+	}
+
+	double area = fabs(contourArea(Mat(approx)));
+	if (area <= (quadrilateral ? params.thresholdAreaForRect : params.thresholdAreaForCircle))
+	{
+		stage = CascadeStage::PolygonArea;
+		return ShapeType::Discarded;
+	}
+
+	if (quadrilateral && !isContourConvex(Mat(approx)))
+	{
+		stage = CascadeStage::Convexity;
+		return ShapeType::Discarded;
+	}
+
+	stage = CascadeStage::Accepted;
+	if (!quadrilateral) return ShapeType::Attribute;
+
+	// distinguishes between square and rectangle
+	double ratio = abs(1 - (double)r.width / r.height);
+	if (ratio <= params.thresholdRatioForSqar) // if sides are mostly similar in length, it is a square
+	{
+		return ShapeType::Relationship;
+	}
+	else // otherwise it is a rectangle
+	{
+		return ShapeType::Entity;
+	}
+}
+
+// ------------------------------------ classifyCandidatesWith --------------------------------------
+
+// purpose: classify every candidate contour on every core, with the limits of a profile or of
+//	parameters
+// preconditions: Limits is RecognitionParams or a profile type; scratch.candidateContours holds
+//	the indices of the contours to classify
+// postconditions: the type, polygon and rejecting stage of each candidate are in the slots of
+//	scratch with the same index
+
+// --------------------------------------------------------------------------------------
+template<class Limits>
+static void classifyCandidatesWith(const Limits& limits, RecognitionScratch& scratch)
+{
+	const vector<vector<Point>>& contours = scratch.contours;
+	const vector<int>& candidateContours = scratch.candidateContours;
+	bool compressed = scratch.lowMemory;
+
+	// every candidate has its own slot for its type and polygon, so the threads below never write
+	//	to the same memory; the slots are only ever grown so their polygons keep their capacity
+	int numCandidates = (int)candidateContours.size();
+	scratch.candidateTypes.resize(numCandidates);
+	scratch.candidateStages.resize(numCandidates);
+	if ((int)scratch.candidatePolygons.size() < numCandidates) scratch.candidatePolygons.resize(numCandidates);
+
+	// classifies the candidates on every core, in chunks large enough to be worth handing to a
+	//	thread
+	int numChunks = (numCandidates + CLASSIFY_CHUNK_SIZE - 1) / CLASSIFY_CHUNK_SIZE;
+	parallel_for_(Range(0, numChunks), [&](const Range& chunks)
+	{
+		int first = chunks.start * CLASSIFY_CHUNK_SIZE;
+		int last = min(chunks.end * CLASSIFY_CHUNK_SIZE, numCandidates);
+		for (int c = first; c < last; c++)
+		{
+			scratch.candidateTypes[c] = classifyWith(contours[candidateContours[c]],
+				scratch.candidatePolygons[c], limits, compressed, scratch.candidateStages[c]);
+		}
+	});
+}
+
+// ------------------------------------ eraseParentContourWith --------------------------------------
+
+// purpose: to get rid of the outer contour, if there is one, with the limits of a profile or of
+//	parameters
+// preconditions: Limits is RecognitionParams or a profile type
+// postconditions: the same as eraseParentContour
+
+// --------------------------------------------------------------------------------------
+template<class Limits>
+static void eraseParentContourWith(ShapeTable& shapes, const Limits& params)
+{
+	for (int id = 0; id < shapes.size(); id++)
+	{
+		// given an ER diagram, the outer contour, if it exists, is almost guaranteed to be recognized
+		//	as an attribute. this outer contour is removed based on a reasonable size requirement
+		if (shapes.getType(id) == ShapeType::Attribute && shapes.getArea(id) > params.thresholdForOutsideContour)
+		{
+			shapes.setType(id, ShapeType::Discarded);
+		}
+	}
+}
+
+// ------------------------------------ dispatchProfile --------------------------------------
+
+// purpose: run the code specialized for the profile parameters were made from
+// preconditions: work can be called with any profile type and with RecognitionParams
+// postconditions: work was called with the profile type params holds, or with params itself if
+//	it holds none or specialize is false; returns the profile used, Custom for params
+
+// --------------------------------------------------------------------------------------
+template<class Work>
+static RecognitionProfile dispatchProfile(const RecognitionParams& params, bool specialize, Work work)
+{
+	RecognitionProfile profile = specialize ? matchingProfile(params) : RecognitionProfile::Custom;
+	switch (profile)
+	{
+	case RecognitionProfile::Digital: work(DigitalProfile()); break;
+	case RecognitionProfile::Photo: work(PhotoProfile()); break;
+	case RecognitionProfile::Scan: work(ScanProfile()); break;
+	default: work(params); break;
+	}
+	return profile;
+}
+
+// ------------------------------------ recognize --------------------------------------
+
+// purpose: recognize an image on any thread
+// preconditions: image is a valid 8 bit BGR image
+// postconditions: returns the shapes of image; the buffers of the calling thread are reused, so
+//	only the result is allocated once they have grown. Throws cv::Exception if image is empty
+
+// --------------------------------------------------------------------------------------
+RecognitionResult RecognitionCore::recognize(const Mat& image, const RecognitionParams& params)
+{
+	RecognitionResult result;
+	recognize(image, params, threadScratch(), result);
+	return result;
+}
+
+// ------------------------------------ recognize --------------------------------------
+
+// purpose: recognize an image on any thread into a result kept by the caller
+// preconditions: image is a valid 8 bit BGR image
+// postconditions: result holds the shapes of image, replacing the previous ones while keeping
+//	their memory; the buffers of the calling thread are reused. Throws cv::Exception if image is
+//	empty
+
+// --------------------------------------------------------------------------------------
+void RecognitionCore::recognize(const Mat& image, const RecognitionParams& params, RecognitionResult& result)
+{
+	recognize(image, params, threadScratch(), result);
+}
+
+// ------------------------------------ recognize --------------------------------------
+
+// purpose: recognize an image in buffers kept by the caller
+// preconditions: image is a valid 8 bit BGR image; scratch and result are not used by another
+//	thread during the call
+// postconditions: result holds the shapes of image; scratch holds the contours of the image
+//	unless scratch.lowMemory is set. Throws cv::Exception if image is empty
+
+// --------------------------------------------------------------------------------------
+void RecognitionCore::recognize(const Mat& image, const RecognitionParams& params, RecognitionScratch& scratch,
+	RecognitionResult& result)
+{
+	if (image.empty()) CV_Error(Error::StsBadArg, "the image to recognize is empty");
+	begin(result);
+	result.imageSize = image.size();
+	recognizeImage(image, params, scratch, result);
+	finish(scratch, result);
+}
+
+// ------------------------------------ recognizeEncoded --------------------------------------
+
+// purpose: recognize an image from its encoded bytes (PNG, JPEG, ...) without a file
+// preconditions: data points to size bytes of an image file; scratch and result are not used by
+//	another thread during the call
+// postconditions: the image is decoded into scratch.decodedImage and result holds its shapes;
+//	throws cv::Exception if the bytes cannot be decoded
+
+// --------------------------------------------------------------------------------------
+void RecognitionCore::recognizeEncoded(const uchar* data, size_t size, const RecognitionParams& params,
+	RecognitionScratch& scratch, RecognitionResult& result)
+{
+	begin(result);
+	// wraps the bytes without copying them, and decodes into the buffer of the previous image
+	ERD_TRACE_START(result.trace, TraceStage::Decode);
+	Mat encoded(1, (int)size, CV_8UC1, (void*)data);
+	imdecode(encoded, IMREAD_COLOR, &scratch.decodedImage);
+	ERD_TRACE_STOP(result.trace, TraceStage::Decode);
+	if (scratch.decodedImage.empty()) CV_Error(Error::StsError, "could not decode image");
+
+	result.imageSize = scratch.decodedImage.size();
+	recognizeImage(scratch.decodedImage, params, scratch, result);
+	finish(scratch, result);
+}
+
+// ------------------------------------ recognizeThresholded --------------------------------------
+
+// purpose: recognize an image whose threshold was already computed, e.g. by another thread
+// preconditions: binary is the threshold of an image of the same size with the limits of params;
+//	scratch and result are not used by another thread during the call
+// postconditions: result holds the shapes of the image; pyramid mode is not used since the full
+//	resolution threshold is already there
+
+// --------------------------------------------------------------------------------------
+void RecognitionCore::recognizeThresholded(const Mat& binary, const RecognitionParams& params,
+	RecognitionScratch& scratch, RecognitionResult& result)
+{
+	if (binary.empty()) CV_Error(Error::StsBadArg, "the threshold to recognize is empty");
+	begin(result);
+	result.imageSize = binary.size();
+	detectShapesInThreshold(binary, params, scratch, result);
+	resolveShapes(params, scratch, result);
+	finish(scratch, result);
+}
+
+// ------------------------------------ threadScratch --------------------------------------
+
+// purpose: get the buffers of the calling thread
+// preconditions: none
+// postconditions: returns a scratch only ever used by the calling thread, created on its first
+//	call and freed when the thread ends
+
+// --------------------------------------------------------------------------------------
+RecognitionScratch& RecognitionCore::threadScratch()
+{
+	thread_local RecognitionScratch scratch;
+	return scratch;
+}
+
+// ------------------------------------ begin --------------------------------------
+
+// purpose: start recognizing an image
+// preconditions: none
+// postconditions: result is emptied, keeping its memory, and its trace is started
+
+// --------------------------------------------------------------------------------------
+void RecognitionCore::begin(RecognitionResult& result)
+{
+	result.imageSize = Size();
+	result.shapes.clear();
+	result.cascadeStats.clear();
+	ERD_TRACE_BEGIN(result.trace);
+}
+
+// ------------------------------------ recognizeImage --------------------------------------
+
+// purpose: identify each object in the image
+// preconditions: image is not empty, begin has been called and result.imageSize is its size
+// postconditions: result holds every shape of image, with the weak types resolved
+
+// --------------------------------------------------------------------------------------
+void RecognitionCore::recognizeImage(const Mat& image, const RecognitionParams& params,
+	RecognitionScratch& scratch, RecognitionResult& result)
+{
+	// an image too small to shrink that many times is recognized at full resolution
+	bool usePyramid = params.pyramidLevels > 0 && (image.cols >> params.pyramidLevels) > 0 &&
+		(image.rows >> params.pyramidLevels) > 0;
+	if (usePyramid)
+	{
+		// only looks at full resolution around the ink found in a shrunk copy of the image
+		detectShapesPyramid(image, params, scratch, result);
+	}
+	else
+	{
+		// prepares image to find all contours; the gray levels are thresholded as they are
+		//	computed, into the threshold of the previous image so nothing new is allocated
+		ERD_TRACE_START(result.trace, TraceStage::GrayThreshold);
+		GrayThreshold::apply(image, scratch.thresh, params.minThreshold, params.maxThreshold);
+		ERD_TRACE_STOP(result.trace, TraceStage::GrayThreshold);
+
+		detectShapesInThreshold(scratch.thresh, params, scratch, result);
+	}
+	resolveShapes(params, scratch, result);
+}
+
+// ------------------------------------ finish --------------------------------------
+
+// purpose: finish recognizing an image
+// preconditions: the shapes of result are final
+// postconditions: the trace is ended and, in low memory mode, the buffers of scratch are freed
+
+// --------------------------------------------------------------------------------------
+void RecognitionCore::finish(RecognitionScratch& scratch, RecognitionResult& result)
+{
+	if (scratch.lowMemory) releaseScratch(scratch);
+	ERD_TRACE_END(result.trace, result.imageSize);
+}
+
+// ------------------------------------ detectShapesInThreshold --------------------------------------
+
+// purpose: find and classify the contours of a thresholded image
+// preconditions: binary is the threshold of the image
+// postconditions: scratch holds every contour of binary and its hierarchy (only the ones traced
+//	with ContourBackend::Components), and result the ones classified as symbols (except weak types)
+
+// --------------------------------------------------------------------------------------
+void RecognitionCore::detectShapesInThreshold(const Mat& binary, const RecognitionParams& params,
+	RecognitionScratch& scratch, RecognitionResult& result)
+{
+	if (params.contourBackend == ContourBackend::Components)
+	{
+		detectShapesByComponents(binary, params, scratch, result);
+		return;
+	}
+
+	ERD_TRACE_START(result.trace, TraceStage::FindContours);
+	// a compressed contour keeps only the ends of its straight runs, several times fewer points
+	findContours(binary, scratch.contours, scratch.hierarchy, RETR_TREE,
+		scratch.lowMemory ? CHAIN_APPROX_SIMPLE : CHAIN_APPROX_NONE);
+	ERD_TRACE_STOP(result.trace, TraceStage::FindContours);
+	ERD_TRACE_ADD(result.trace, TraceCounter::Contours, (long long)scratch.contours.size());
+
+	// populates type vectors (except weak types)
+	ERD_TRACE_START(result.trace, TraceStage::Classify);
+	detectShapes(binary.size(), params, scratch, result);
+	ERD_TRACE_STOP(result.trace, TraceStage::Classify);
+}
+
+// ------------------------------------ resolveShapes --------------------------------------
+
+// purpose: finish the shapes once every symbol has been classified
+// preconditions: result holds the classified symbols of the image
+// postconditions: the outer contour is discarded and the weak types are tagged
+
+// --------------------------------------------------------------------------------------
+void RecognitionCore::resolveShapes(const RecognitionParams& params, RecognitionScratch& scratch,
+	RecognitionResult& result)
+{
+	ShapeTable& shapes = result.shapes;
+	ERD_TRACE_ADD(result.trace, TraceCounter::Classified, shapes.size());
+
+	// gets rid of the unecessary outer contour
+	ERD_TRACE_START(result.trace, TraceStage::EraseParentContour);
+	eraseParentContour(shapes, params);
+	ERD_TRACE_STOP(result.trace, TraceStage::EraseParentContour);
+	ERD_TRACE_ADD(result.trace, TraceCounter::WithoutOuterContour,
+		shapes.size() - shapes.count(ShapeType::Discarded));
+
+	// distinguishes weak types
+	ERD_TRACE_START(result.trace, TraceStage::DetermineWeakTypes);
+	determineWeakTypes(scratch, result);
+	ERD_TRACE_STOP(result.trace, TraceStage::DetermineWeakTypes);
+	ERD_TRACE_ADD(result.trace, TraceCounter::NestedCalls, scratch.containment.getNumNestedCalls());
+	ERD_TRACE_ADD(result.trace, TraceCounter::Shapes, shapes.size() - shapes.count(ShapeType::Discarded));
+}
+
+// ------------------------------------ detectShapes --------------------------------------
+
+// purpose: populate vector types (except weak types)
+// preconditions: scratch.contours has been populated for an image of size imageSize
+// postconditions: populates all vector types, except weak types; the contours are classified on
+//	every core and added in contour order
+
+// --------------------------------------------------------------------------------------
+void RecognitionCore::detectShapes(Size imageSize, const RecognitionParams& params, RecognitionScratch& scratch,
+	RecognitionResult& result)
+{
+	const vector<vector<Point>>& contours = scratch.contours;
+	vector<int>& candidateContours = scratch.candidateContours;
+
+	// contours touching the border are filtered out first instead of being erased one at a time
+	candidateContours.clear();
+	for (size_t i = 0; i < contours.size(); i++)
+	{
+		if (contourTouchesBorder(contours[i], imageSize) == false) candidateContours.push_back((int)i);
+	}
+
+	ERD_TRACE_ADD(result.trace, TraceCounter::Candidates, (long long)candidateContours.size());
+	classifyCandidates(params, true, scratch);
+	mergeCandidates(scratch, result);
+}
+
+// ------------------------------------ detectShapesByComponents --------------------------------------
+
+// purpose: find and classify the contours of a thresholded image without tracing the regions too
+//	small to be a symbol
+// preconditions: binary is the threshold of the image
+// postconditions: result holds the shapes detectShapesInThreshold finds with findContours, in the
+//	same order; scratch holds only the contours that were traced, each with the closest traced
+//	contour around it as the parent in its hierarchy
+
+// --------------------------------------------------------------------------------------
+void RecognitionCore::detectShapesByComponents(const Mat& binary, const RecognitionParams& params,
+	RecognitionScratch& scratch, RecognitionResult& result)
+{
+	ComponentExtractor& components = scratch.components;
+	vector<vector<Point>>& contours = scratch.contours;
+	vector<int>& tracedAround = scratch.tracedAround;
+
+	ERD_TRACE_START(result.trace, TraceStage::FindContours);
+	components.extract(binary);
+	int numComponents = components.getNumComponents();
+	ERD_TRACE_ADD(result.trace, TraceCounter::Contours, numComponents);
+
+	// the box of a region is the box of its contour, so the tests classifyContour makes on the box
+	//	are made before tracing, and only the regions that can still be a symbol are traced. The
+	//	regions come in the order of findContours, so the shapes do too; the hierarchy only needs
+	//	the traced contours, since determineWeakTypes only looks for shapes around shapes
+	double minArea = min(params.thresholdAreaForRect, params.thresholdAreaForCircle);
+	int method = scratch.lowMemory ? CHAIN_APPROX_SIMPLE : CHAIN_APPROX_NONE;
+	int numTraced = 0;
+	tracedAround.resize(numComponents);
+	scratch.hierarchy.clear();
+	scratch.candidateContours.clear();
+	for (int c = 0; c < numComponents; c++)
+	{
+		// parents come first, so theirs is already known
+		int parent = components.getComponent(c).parent;
+		int around = parent < 0 ? -1 : tracedAround[parent];
+		tracedAround[c] = around;
+
+		Rect box = components.contourBox(c);
+		if (boxTouchesBorder(box, binary.size())) continue;
+		ERD_TRACE_ADD(result.trace, TraceCounter::Candidates, 1);
+		if ((double)box.area() <= minArea)
+		{
+			result.cascadeStats.add(CascadeStage::BoundingBoxArea);
+			continue;
+		}
+		if (params.maxAspectRatio > 0 &&
+			max(box.width, box.height) > params.maxAspectRatio * min(box.width, box.height))
+		{
+			result.cascadeStats.add(CascadeStage::AspectRatio);
+			continue;
+		}
+
+		// the contours of the previous image are traced over, keeping their memory
+		if (numTraced == (int)contours.size()) contours.emplace_back();
+		components.traceContour(c, method, contours[numTraced]);
+		scratch.hierarchy.push_back(Vec4i(-1, -1, -1, around));
+		scratch.candidateContours.push_back(numTraced);
+		tracedAround[c] = numTraced;
+		numTraced++;
+	}
+	contours.resize(numTraced);
+	ERD_TRACE_STOP(result.trace, TraceStage::FindContours);
+
+	ERD_TRACE_START(result.trace, TraceStage::Classify);
+	classifyCandidates(params, true, scratch);
+	mergeCandidates(scratch, result);
+	ERD_TRACE_STOP(result.trace, TraceStage::Classify);
+}
+
+// ------------------------------------ mergeCandidates --------------------------------------
+
+// purpose: add the classified candidates to the result
+// preconditions: classifyCandidates has run on scratch
+// postconditions: the rejecting stage of every candidate is counted and the symbols are added to
+//	result in candidate order
+
+// --------------------------------------------------------------------------------------
+void RecognitionCore::mergeCandidates(RecognitionScratch& scratch, RecognitionResult& result)
+{
+	const vector<int>& candidateContours = scratch.candidateContours;
+	const vector<ShapeType>& candidateTypes = scratch.candidateTypes;
+	const vector<vector<Point>>& candidatePolygons = scratch.candidatePolygons;
+	const vector<CascadeStage>& candidateStages = scratch.candidateStages;
+
+	// merges in candidate order, so the shapes come out in the same order however many threads ran
+	for (size_t c = 0; c < candidateContours.size(); c++)
+	{
+		result.cascadeStats.add(candidateStages[c]);
+		if (candidateTypes[c] != ShapeType::Discarded)
+		{
+			result.shapes.addShape(candidatePolygons[c], candidateTypes[c], candidateContours[c]);
+		}
+	}
+}
+
+// ------------------------------------ detectShapesPyramid --------------------------------------
+
+// purpose: populate vector types (except weak types) without thresholding the whole image at
+//	full resolution
+// preconditions: params.pyramidLevels is at least 1 and image can be halved that many times
+// postconditions: result holds the same shapes detectShapes finds; contours are not kept for the
+//	whole image and the hierarchy is left empty
+
+// --------------------------------------------------------------------------------------
+void RecognitionCore::detectShapesPyramid(const Mat& image, const RecognitionParams& params,
+	RecognitionScratch& scratch, RecognitionResult& result)
+{
+	ERD_TRACE_START(result.trace, TraceStage::Pyramid);
+	int factor = 1 << params.pyramidLevels;
+	RecognitionParams coarse = scaledForLevel(params, params.pyramidLevels);
+
+	// halving with bilinear interpolation averages each 2 by 2 block, reading every pixel once, so
+	//	a block with a line through it is still darker than the paper around it (and it is much
+	//	cheaper than INTER_AREA on a color image)
+	vector<Mat>& pyramid = scratch.pyramid;
+	pyramid.resize(params.pyramidLevels);
+	for (int level = 0; level < params.pyramidLevels; level++)
+	{
+		const Mat& larger = level == 0 ? image : pyramid[level - 1];
+		resize(larger, pyramid[level], Size(larger.cols / 2, larger.rows / 2), 0, 0, INTER_LINEAR);
+	}
+	cvtColor(pyramid.back(), scratch.smallGray, COLOR_BGR2GRAY);
+	threshold(scratch.smallGray, scratch.inkMask, coarse.pyramidInkThreshold, 255, THRESH_BINARY_INV);
+	// joins strokes that shrinking left a pixel apart
+	dilate(scratch.inkMask, scratch.inkMask, Mat());
+	// every shape is the inside of some piece of ink, and shapes nested in a piece of ink are
+	//	inside its bounding box, so the outermost pieces are enough
+	findContours(scratch.inkMask, scratch.inkContours, RETR_EXTERNAL, CHAIN_APPROX_SIMPLE);
+	ERD_TRACE_STOP(result.trace, TraceStage::Pyramid);
+
+	// the shapes are found region by region, so there is no hierarchy for them; clearing the
+	//	last image's makes the containment fall back to the bounding boxes
+	scratch.hierarchy.clear();
+	Rect page(Point(0, 0), image.size());
+	scratch.regionShapes.reset(page, 128);
+	double minArea = min(coarse.thresholdAreaForRect, coarse.thresholdAreaForCircle);
+	for (size_t i = 0; i < scratch.inkContours.size(); i++)
+	{
+		Rect box = boundingRect(scratch.inkContours[i]);
+		// a shape drawn with this ink is no larger than the ink itself
+		if (box.area() <= minArea) continue;
+
+		// back to full resolution, with a shrunk pixel of margin so no shape touches the edge
+		Rect region((box.x - 1) * factor, (box.y - 1) * factor, (box.width + 2) * factor,
+			(box.height + 2) * factor);
+		detectShapesInRegion(image, region & page, params, scratch, result);
+	}
+}
+
+// ------------------------------------ detectShapesInRegion --------------------------------------
+
+// purpose: add the shapes lying inside one region of the image
+// preconditions: region lies inside image
+// postconditions: every shape strictly inside region that was not already found is added to
+//	result in image coordinates
+
+// --------------------------------------------------------------------------------------
+void RecognitionCore::detectShapesInRegion(const Mat& image, const Rect& region, const RecognitionParams& params,
+	RecognitionScratch& scratch, RecognitionResult& result)
+{
+	vector<vector<Point>>& contours = scratch.contours;
+	vector<Point>& approx = scratch.approx;
+	ShapeTable& shapes = result.shapes;
+
+	// the stages add up over every region
+	ERD_TRACE_START(result.trace, TraceStage::GrayThreshold);
+	GrayThreshold::apply(image(region), scratch.thresh, params.minThreshold, params.maxThreshold);
+	ERD_TRACE_STOP(result.trace, TraceStage::GrayThreshold);
+	// nesting is decided from the bounding boxes afterwards, so no hierarchy is needed
+	ERD_TRACE_START(result.trace, TraceStage::FindContours);
+	findContours(scratch.thresh, contours, RETR_LIST, scratch.lowMemory ? CHAIN_APPROX_SIMPLE : CHAIN_APPROX_NONE);
+	ERD_TRACE_STOP(result.trace, TraceStage::FindContours);
+	ERD_TRACE_ADD(result.trace, TraceCounter::Contours, (long long)contours.size());
+
+	ERD_TRACE_START(result.trace, TraceStage::Classify);
+	Point offset = region.tl();
+	for (size_t i = 0; i < contours.size(); i++)
+	{
+		// the paper around the ink touches the region edge, as does anything on the page border
+		if (contourTouchesBorder(contours[i], region.size())) continue;
+		ERD_TRACE_ADD(result.trace, TraceCounter::Candidates, 1);
+
+		CascadeStage stage;
+		ShapeType type = classifyContour(contours[i], approx, params, scratch.lowMemory, stage);
+		result.cascadeStats.add(stage);
+		if (type == ShapeType::Discarded) continue;
+
+		for (size_t j = 0; j < approx.size(); j++)
+		{
+			approx[j] += offset;
+		}
+		Rect box = boundingRect(approx);
+
+		// regions of neighbouring pieces of ink can overlap and find the same shape, traced from
+		//	the same pixels, so with the same type and bounding box
+		bool found = false;
+		const vector<int>& candidates = scratch.regionShapes.cellAt(box.tl());
+		for (size_t j = 0; j < candidates.size() && !found; j++)
+		{
+			found = shapes.getType(candidates[j]) == type && shapes.getBoundingBox(candidates[j]) == box;
+		}
+		if (found) continue;
+
+		int id = shapes.addShape(approx, type, -1);
+		scratch.regionShapes.insert(id, box);
+	}
+	ERD_TRACE_STOP(result.trace, TraceStage::Classify);
+}
+
+// ------------------------------------ classifyContour --------------------------------------
+
+// purpose: decide which kind of ER diagram symbol a contour is
+// preconditions: contour is a closed contour found by findContours, with CHAIN_APPROX_SIMPLE if
+//	compressed is true and CHAIN_APPROX_NONE otherwise; params holds the limits for the
+//	resolution of the contour
+// postconditions: returns the type of the symbol, or ShapeType::Discarded if the contour is not a
+//	symbol; stage is the test that rejected the contour, or CascadeStage::Accepted. approx holds
+//	the approximated polygon of a symbol. Safe to call from several threads at once with
+//	different approx vectors
+
+// --------------------------------------------------------------------------------------
+ShapeType RecognitionCore::classifyContour(const vector<Point>& contour, vector<Point>& approx,
+	const RecognitionParams& params, bool compressed, CascadeStage& stage)
+{
+	// one contour at a time is too little work to look for a profile; classifyCandidates does
+	return classifyWith(contour, approx, params, compressed, stage);
+}
+
+// ------------------------------------ classifyCandidates --------------------------------------
+
+// purpose: classify the candidate contours of an image with the code specialized for the profile
+//	params was made from
+// preconditions: scratch.candidateContours holds the indices of the contours of scratch to
+//	classify, traced with CHAIN_APPROX_SIMPLE if scratch.lowMemory is set
+// postconditions: the type, polygon and rejecting stage of each candidate are in the slots of
+//	scratch with the same index; if specialize is false or params holds no profile the limits
+//	are read from params as the contours are classified. Returns the profile used, Custom if none
+
+// --------------------------------------------------------------------------------------
+RecognitionProfile RecognitionCore::classifyCandidates(const RecognitionParams& params, bool specialize,
+	RecognitionScratch& scratch)
+{
+	return dispatchProfile(params, specialize, [&](const auto& limits) { classifyCandidatesWith(limits, scratch); });
+}
+
+// ------------------------------------ contourTouchesBorder --------------------------------------
+
+// purpose: helper method checks if contour touches the border
+// preconditions: using intended contour, and image size is the image's size
+// postconditions: returns true or false based on if the contour is touching the border
+
+// --------------------------------------------------------------------------------------
+bool RecognitionCore::contourTouchesBorder(const vector<Point>& contour, const Size& imageSize)
+{
+	return boxTouchesBorder(boundingRect(contour), imageSize);
+}
+
+// ------------------------------------ boxTouchesBorder --------------------------------------
+
+// purpose: helper method checks if the bounding box of a contour touches the border
+// preconditions: box is the bounding box of the intended contour, and image size is the image's
+//	size
+// postconditions: returns true or false based on if the contour is touching the border
+
+// --------------------------------------------------------------------------------------
+bool RecognitionCore::boxTouchesBorder(const Rect& box, const Size& imageSize)
+{
+	// created ints to represent the mins and maxes for x and y respectively
+	int xMin, xMax, yMin, yMax;
+	//set x and y min to 0
+	xMin = 0;
+	yMin = 0;
+	//set x to the images width-1, and y to image height-1
+	xMax = imageSize.width - 1;
+	yMax = imageSize.height - 1;
+
+	int boxEndX = box.x + box.width - 1;
+	int boxEndY = box.y + box.height - 1;
+	// if the min or max coordinates of the contour are outside the range of the image, returns true
+	if (box.x <= xMin || box.y <= yMin || boxEndX >= xMax || boxEndY >= yMax)
+	{
+		return true;
+	}
+	//returns false if coordinates of the contour are in range
+	return false;
+}
+
+// ------------------------------------ eraseParentContour --------------------------------------
+
+// purpose: to get rid of the outer contour, if there is one
+// preconditions: attributes have been added to shapes
+// postconditions: the outer contour is tagged ShapeType::Discarded, by the code specialized for
+//	the profile params holds if there is one
+
+// --------------------------------------------------------------------------------------
+void RecognitionCore::eraseParentContour(ShapeTable& shapes, const RecognitionParams& params)
+{
+	dispatchProfile(params, true, [&](const auto& limits) { eraseParentContourWith(shapes, limits); });
+}
+
+// ------------------------------------ determineWeakTypes --------------------------------------
+
+// purpose: seperates the weak from the strong of every type
+// preconditions: result holds the shapes and the outer contour was erased
+// postconditions: every entity, relationship and attribute with another shape of its type nested
+//	inside it is tagged as its weak type, the shapes nested inside it are discarded, and every
+//	shape's parent is the shape it is drawn inside of
+
+// --------------------------------------------------------------------------------------
+void RecognitionCore::determineWeakTypes(RecognitionScratch& scratch, RecognitionResult& result)
+{
+	// uses the contour hierarchy when it can be trusted, otherwise the bounding boxes
+	scratch.containment.resolve(result.shapes, scratch.hierarchy);
+}
+
+// ------------------------------------ releaseScratch --------------------------------------
+
+// purpose: free the buffers of a scratch
+// preconditions: none
+// postconditions: every buffer of scratch but decodedImage is empty and holds no memory
+
+// --------------------------------------------------------------------------------------
+void RecognitionCore::releaseScratch(RecognitionScratch& scratch)
+{
+	// swapping with an empty vector frees the memory, which clear would keep
+	vector<vector<Point>>().swap(scratch.contours);
+	vector<Vec4i>().swap(scratch.hierarchy);
+	vector<int>().swap(scratch.candidateContours);
+	vector<ShapeType>().swap(scratch.candidateTypes);
+	vector<vector<Point>>().swap(scratch.candidatePolygons);
+	vector<CascadeStage>().swap(scratch.candidateStages);
+	vector<Point>().swap(scratch.approx);
+	vector<Mat>().swap(scratch.pyramid);
+	vector<vector<Point>>().swap(scratch.inkContours);
+	scratch.thresh.release();
+	scratch.smallGray.release();
+	scratch.inkMask.release();
+	scratch.components.release();
+	vector<int>().swap(scratch.tracedAround);
+}
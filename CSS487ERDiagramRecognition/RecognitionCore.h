@@ -0,0 +1,322 @@
+// RecognitionCore.h
+// Purpose: recognize ER diagrams from any number of threads at once, without a recognizer object
+//	per request and without a lock
+// Functionality: every step of recognition (threshold, contours, classification, outer contour,
+//	weak types, pyramid mode) as static functions of the image, the parameters, a
+//	RecognitionScratch of buffers and the RecognitionResult they fill in. Nothing is shared
+//	between calls except what is passed in: the calls without a scratch use one kept per thread,
+//	so a thread recognizing image after image stops allocating once its buffers have grown, and
+//	threads never touch each other's buffers. The classification and the outer contour test are
+//	compiled for each profile of RecognitionProfile, and the one the parameters hold is picked
+//	once per image. The contours come from findContours or, with ContourBackend::Components,
+//	from a ComponentExtractor that traces only the regions large enough to be a symbol.
+//	RecognizeERDiagram wraps these functions with its own scratch and the display functions
+// Assumptions:
+//	Each RecognitionScratch and RecognitionResult is used by one call at a time; the images and
+//	parameters may be shared freely since they are only read
+//	The contours are classified with parallel_for_, which OpenCV runs on the calling thread when
+//	several threads call it at once
+// Authors: Allan Genari Gaarden, Tommy Ni, Joshua Medvinsky
+
+#ifndef RECOGNITION_CORE_H
+#define RECOGNITION_CORE_H
+
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+#include <opencv2/imgcodecs.hpp>
+#include "ShapeTable.h"
+#include "ContainmentTree.h"
+#include "ComponentExtractor.h"
+#include "RecognitionParams.h"
+#include "RecognitionProfile.h"
+#include "SpatialGrid.h"
+#include "GrayThreshold.h"
+#include "CascadeStats.h"
+#include "RecognitionTrace.h"
+using namespace std;
+using namespace cv;
+
+// everything recognizing one image gives
+struct RecognitionResult
+{
+	Size imageSize;
+	// every classified shape, tagged with its type; shapes tagged ShapeType::Discarded are not
+	//	part of the result
+	ShapeTable shapes;
+	// how many contours each classification stage rejected
+	CascadeStats cascadeStats;
+	// what the recognition measured, filled in only when instrumented
+	RecognitionTrace trace;
+};
+
+// the buffers recognition works in, kept between images so their memory is reused
+struct RecognitionScratch
+{
+	// when true, contours are traced compressed (only the ends of straight runs are kept) and
+	//	every buffer below but decodedImage is freed once the shapes of an image are final
+	bool lowMemory = false;
+	// the last image decoded by recognizeEncoded
+	Mat decodedImage;
+	Mat thresh;
+	vector<Point> approx;
+	vector<vector<Point>> contours;
+	vector<Vec4i> hierarchy;
+	// pyramid mode buffers: the halved images, where the ink is, and the shapes found so far
+	vector<Mat> pyramid;
+	Mat smallGray;
+	Mat inkMask;
+	vector<vector<Point>> inkContours;
+	SpatialGrid regionShapes;
+	// indices of the contours that do not touch the border of the image
+	vector<int> candidateContours;
+	// the type, polygon and rejecting stage of each candidate contour, in the same order
+	vector<ShapeType> candidateTypes;
+	vector<vector<Point>> candidatePolygons;
+	vector<CascadeStage> candidateStages;
+	// finds the shapes nested inside each other
+	ContainmentTree containment;
+	// ContourBackend::Components buffers: the regions of the threshold, and for each region the
+	//	contour traced for it or else the closest one traced around it (-1 if none)
+	ComponentExtractor components;
+	vector<int> tracedAround;
+};
+
+class RecognitionCore
+{
+public:
+	// ------------------------------------ recognize --------------------------------------
+
+// purpose: recognize an image on any thread
+// preconditions: image is a valid 8 bit BGR image
+// postconditions: returns the shapes of image; the buffers of the calling thread are reused, so
+//	only the result is allocated once they have grown. Throws cv::Exception if image is empty
+
+// --------------------------------------------------------------------------------------
+	static RecognitionResult recognize(const Mat& image, const RecognitionParams& params);
+	// ------------------------------------ recognize --------------------------------------
+
+// purpose: recognize an image on any thread into a result kept by the caller
+// preconditions: image is a valid 8 bit BGR image
+// postconditions: result holds the shapes of image, replacing the previous ones while keeping
+//	their memory; the buffers of the calling thread are reused. Throws cv::Exception if image is
+//	empty
+
+// --------------------------------------------------------------------------------------
+	static void recognize(const Mat& image, const RecognitionParams& params, RecognitionResult& result);
+	// ------------------------------------ recognize --------------------------------------
+
+// purpose: recognize an image in buffers kept by the caller
+// preconditions: image is a valid 8 bit BGR image; scratch and result are not used by another
+//	thread during the call
+// postconditions: result holds the shapes of image; scratch holds the contours of the image
+//	unless scratch.lowMemory is set. Throws cv::Exception if image is empty
+
+// --------------------------------------------------------------------------------------
+	static void recognize(const Mat& image, const RecognitionParams& params, RecognitionScratch& scratch,
+		RecognitionResult& result);
+	// ------------------------------------ recognizeEncoded --------------------------------------
+
+// purpose: recognize an image from its encoded bytes (PNG, JPEG, ...) without a file
+// preconditions: data points to size bytes of an image file; scratch and result are not used by
+//	another thread during the call
+// postconditions: the image is decoded into scratch.decodedImage and result holds its shapes;
+//	throws cv::Exception if the bytes cannot be decoded
+
+// --------------------------------------------------------------------------------------
+	static void recognizeEncoded(const uchar* data, size_t size, const RecognitionParams& params,
+		RecognitionScratch& scratch, RecognitionResult& result);
+	// ------------------------------------ recognizeThresholded --------------------------------------
+
+// purpose: recognize an image whose threshold was already computed, e.g. by another thread
+// preconditions: binary is the threshold of an image of the same size with the limits of params;
+//	scratch and result are not used by another thread during the call
+// postconditions: result holds the shapes of the image; pyramid mode is not used since the full
+//	resolution threshold is already there
+
+// --------------------------------------------------------------------------------------
+	static void recognizeThresholded(const Mat& binary, const RecognitionParams& params,
+		RecognitionScratch& scratch, RecognitionResult& result);
+	// ------------------------------------ classifyContour --------------------------------------
+
+// purpose: decide which kind of ER diagram symbol a contour is
+// preconditions: contour is a closed contour found by findContours, with CHAIN_APPROX_SIMPLE if
+//	compressed is true and CHAIN_APPROX_NONE otherwise; params holds the limits for the
+//	resolution of the contour
+// postconditions: returns the type of the symbol, or ShapeType::Discarded if the contour is not a
+//	symbol; stage is the test that rejected the contour, or CascadeStage::Accepted. approx holds
+//	the approximated polygon of a symbol. Safe to call from several threads at once with
+//	different approx vectors
+
+// --------------------------------------------------------------------------------------
+	static ShapeType classifyContour(const vector<Point>& contour, vector<Point>& approx,
+		const RecognitionParams& params, bool compressed, CascadeStage& stage);
+	// ------------------------------------ classifyCandidates --------------------------------------
+
+// purpose: classify the candidate contours of an image with the code specialized for the profile
+//	params was made from
+// preconditions: scratch.candidateContours holds the indices of the contours of scratch to
+//	classify, traced with CHAIN_APPROX_SIMPLE if scratch.lowMemory is set
+// postconditions: the type, polygon and rejecting stage of each candidate are in the slots of
+//	scratch with the same index; if specialize is false or params holds no profile the limits
+//	are read from params as the contours are classified. Returns the profile used, Custom if none
+
+// --------------------------------------------------------------------------------------
+	static RecognitionProfile classifyCandidates(const RecognitionParams& params, bool specialize,
+		RecognitionScratch& scratch);
+	// ------------------------------------ contourTouchesBorder --------------------------------------
+
+// purpose: helper method checks if contour touches the border
+// preconditions: using intended contour, and image size is the image's size
+// postconditions: returns true or false based on if the contour is touching the border
+
+// --------------------------------------------------------------------------------------
+	static bool contourTouchesBorder(const vector<Point>& contour, const Size& imageSize);
+	// ------------------------------------ boxTouchesBorder --------------------------------------
+
+// purpose: helper method checks if the bounding box of a contour touches the border
+// preconditions: box is the bounding box of the intended contour, and image size is the image's
+//	size
+// postconditions: returns true or false based on if the contour is touching the border
+
+// --------------------------------------------------------------------------------------
+	static bool boxTouchesBorder(const Rect& box, const Size& imageSize);
+	// ------------------------------------ eraseParentContour --------------------------------------
+
+// purpose: to get rid of the outer contour, if there is one
+// preconditions: attributes have been added to shapes
+// postconditions: the outer contour is tagged ShapeType::Discarded, by the code specialized for
+//	the profile params holds if there is one
+
+// --------------------------------------------------------------------------------------
+	static void eraseParentContour(ShapeTable& shapes, const RecognitionParams& params);
+
+private:
+	// times the private stages one at a time
+	friend class RecognitionBenchmark;
+
+	// ------------------------------------ threadScratch --------------------------------------
+
+// purpose: get the buffers of the calling thread
+// preconditions: none
+// postconditions: returns a scratch only ever used by the calling thread, created on its first
+//	call and freed when the thread ends
+
+// --------------------------------------------------------------------------------------
+	static RecognitionScratch& threadScratch();
+	// ------------------------------------ begin --------------------------------------
+
+// purpose: start recognizing an image
+// preconditions: none
+// postconditions: result is emptied, keeping its memory, and its trace is started
+
+// --------------------------------------------------------------------------------------
+	static void begin(RecognitionResult& result);
+	// ------------------------------------ recognizeImage --------------------------------------
+
+// purpose: identify each object in the image
+// preconditions: image is not empty, begin has been called and result.imageSize is its size
+// postconditions: result holds every shape of image, with the weak types resolved
+
+// --------------------------------------------------------------------------------------
+	static void recognizeImage(const Mat& image, const RecognitionParams& params, RecognitionScratch& scratch,
+		RecognitionResult& result);
+	// ------------------------------------ finish --------------------------------------
+
+// purpose: finish recognizing an image
+// preconditions: the shapes of result are final
+// postconditions: the trace is ended and, in low memory mode, the buffers of scratch are freed
+
+// --------------------------------------------------------------------------------------
+	static void finish(RecognitionScratch& scratch, RecognitionResult& result);
+	// ------------------------------------ detectShapesInThreshold --------------------------------------
+
+// purpose: find and classify the contours of a thresholded image
+// preconditions: binary is the threshold of the image
+// postconditions: scratch holds every contour of binary and its hierarchy (only the ones traced
+//	with ContourBackend::Components), and result the ones classified as symbols (except weak types)
+
+// --------------------------------------------------------------------------------------
+	static void detectShapesInThreshold(const Mat& binary, const RecognitionParams& params,
+		RecognitionScratch& scratch, RecognitionResult& result);
+	// ------------------------------------ resolveShapes --------------------------------------
+
+// purpose: finish the shapes once every symbol has been classified
+// preconditions: result holds the classified symbols of the image
+// postconditions: the outer contour is discarded and the weak types are tagged
+
+// --------------------------------------------------------------------------------------
+	static void resolveShapes(const RecognitionParams& params, RecognitionScratch& scratch,
+		RecognitionResult& result);
+	// ------------------------------------ detectShapes --------------------------------------
+
+// purpose: populate vector types (except weak types)
+// preconditions: scratch.contours has been populated for an image of size imageSize
+// postconditions: populates all vector types, except weak types; the contours are classified on
+//	every core and added in contour order
+
+// --------------------------------------------------------------------------------------
+	static void detectShapes(Size imageSize, const RecognitionParams& params, RecognitionScratch& scratch,
+		RecognitionResult& result);
+	// ------------------------------------ detectShapesByComponents --------------------------------------
+
+// purpose: find and classify the contours of a thresholded image without tracing the regions too
+//	small to be a symbol
+// preconditions: binary is the threshold of the image
+// postconditions: result holds the shapes detectShapesInThreshold finds with findContours, in the
+//	same order; scratch holds only the contours that were traced, each with the closest traced
+//	contour around it as the parent in its hierarchy
+
+// --------------------------------------------------------------------------------------
+	static void detectShapesByComponents(const Mat& binary, const RecognitionParams& params,
+		RecognitionScratch& scratch, RecognitionResult& result);
+	// ------------------------------------ mergeCandidates --------------------------------------
+
+// purpose: add the classified candidates to the result
+// preconditions: classifyCandidates has run on scratch
+// postconditions: the rejecting stage of every candidate is counted and the symbols are added to
+//	result in candidate order
+
+// --------------------------------------------------------------------------------------
+	static void mergeCandidates(RecognitionScratch& scratch, RecognitionResult& result);
+	// ------------------------------------ detectShapesPyramid --------------------------------------
+
+// purpose: populate vector types (except weak types) without thresholding the whole image at
+//	full resolution
+// preconditions: params.pyramidLevels is at least 1 and image can be halved that many times
+// postconditions: result holds the same shapes detectShapes finds; contours are not kept for the
+//	whole image and the hierarchy is left empty
+
+// --------------------------------------------------------------------------------------
+	static void detectShapesPyramid(const Mat& image, const RecognitionParams& params,
+		RecognitionScratch& scratch, RecognitionResult& result);
+	// ------------------------------------ detectShapesInRegion --------------------------------------
+
+// purpose: add the shapes lying inside one region of the image
+// preconditions: region lies inside image
+// postconditions: every shape strictly inside region that was not already found is added to
+//	result in image coordinates
+
+// --------------------------------------------------------------------------------------
+	static void detectShapesInRegion(const Mat& image, const Rect& region, const RecognitionParams& params,
+		RecognitionScratch& scratch, RecognitionResult& result);
+	// ------------------------------------ determineWeakTypes --------------------------------------
+
+// purpose: seperates the weak from the strong of every type
+// preconditions: result holds the shapes and the outer contour was erased
+// postconditions: every entity, relationship and attribute with another shape of its type nested
+//	inside it is tagged as its weak type, the shapes nested inside it are discarded, and every
+//	shape's parent is the shape it is drawn inside of
+
+// --------------------------------------------------------------------------------------
+	static void determineWeakTypes(RecognitionScratch& scratch, RecognitionResult& result);
+	// ------------------------------------ releaseScratch --------------------------------------
+
+// purpose: free the buffers of a scratch
+// preconditions: none
+// postconditions: every buffer of scratch but decodedImage is empty and holds no memory
+
+// --------------------------------------------------------------------------------------
+	static void releaseScratch(RecognitionScratch& scratch);
+};
+
+#endif
@@ -0,0 +1,68 @@
+// RecognitionParams.cpp
+// Purpose: keep every tunable number used to recognize an ER diagram in one place
+// Functionality: holds the threshold used to separate ink from paper, the area and ratio limits
+//	used to classify shapes and drop the outer contour, the pyramid settings and the limits used
+//	to find the connectors between shapes, and how the contours are found. scaledForLevel
+//	gives the same limits for an image shrunk by a power of two; RecognitionProfile holds the
+//	tuned sets of limits for different kinds of images
+// Assumptions:
+//	The defaults are the values the program was tuned with on the test images
+//	Every field is part of the ResultCache key; a new field must be added to ResultCache::hashKey
+// Authors: Allan Genari Gaarden, Tommy Ni, Joshua Medvinsky
+
+#include "RecognitionParams.h"
+
+// ------------------------------------ scaledForLevel --------------------------------------
+
+// purpose: get the limits to use on an image shrunk by a pyramid level
+// preconditions: level is at least 0
+// postconditions: returns params with every area limit divided by 4 per level (each halving
+//	quarters areas); gray levels and ratios are unchanged
+
+// --------------------------------------------------------------------------------------
+RecognitionParams scaledForLevel(const RecognitionParams& params, int level)
+{
+	RecognitionParams scaled = params;
+	double areaScale = 1;
+	for (int i = 0; i < level; i++)
+	{
+		areaScale *= 4;
+	}
+	scaled.thresholdAreaForRect /= areaScale;
+	scaled.thresholdAreaForCircle /= areaScale;
+	scaled.thresholdForOutsideContour /= areaScale;
+	return scaled;
+}
+
+// ------------------------------------ contourBackendName --------------------------------------
+
+// purpose: get the name of a contour backend as used on the command line
+// preconditions: none
+// postconditions: returns "findcontours" or "components"
+
+// --------------------------------------------------------------------------------------
+const char* contourBackendName(ContourBackend backend)
+{
+	return backend == ContourBackend::Components ? "components" : "findcontours";
+}
+
+// ------------------------------------ parseContourBackend --------------------------------------
+
+// purpose: read a contour backend named on the command line
+// preconditions: none
+// postconditions: returns true and sets backend if name is the name of a backend, otherwise
+//	returns false and leaves backend as it is
+
+// --------------------------------------------------------------------------------------
+bool parseContourBackend(const string& name, ContourBackend& backend)
+{
+	for (int i = 0; i < NUM_CONTOUR_BACKENDS; i++)
+	{
+		if (name == contourBackendName((ContourBackend)i))
+		{
+			backend = (ContourBackend)i;
+			return true;
+		}
+	}
+	return false;
+}
@@ -0,0 +1,103 @@
+// RecognitionParams.h
+// Purpose: keep every tunable number used to recognize an ER diagram in one place
+// Functionality: holds the threshold used to separate ink from paper, the area and ratio limits
+//	used to classify shapes and drop the outer contour, the pyramid settings and the limits used
+//	to find the connectors between shapes, and how the contours are found. scaledForLevel
+//	gives the same limits for an image shrunk by a power of two; RecognitionProfile holds the
+//	tuned sets of limits for different kinds of images
+// Assumptions:
+//	The defaults are the values the program was tuned with on the test images
+//	Every field is part of the ResultCache key; a new field must be added to ResultCache::hashKey
+// Authors: Allan Genari Gaarden, Tommy Ni, Joshua Medvinsky
+
+#ifndef RECOGNITION_PARAMS_H
+#define RECOGNITION_PARAMS_H
+
+#include <string>
+using namespace std;
+
+// how the regions of the thresholded image are found; both give the same contours, hierarchy and
+//	shapes
+enum class ContourBackend
+{
+	// findContours traces the border of every region
+	FindContours,
+	// ComponentExtractor labels the regions in one pass and traces only the ones large enough to
+	//	be a symbol, much faster when most regions are specks
+	Components
+};
+
+// number of ContourBackend values
+const int NUM_CONTOUR_BACKENDS = (int)ContourBackend::Components + 1;
+
+struct RecognitionParams
+{
+	// gray level separating paper (above) from ink
+	int minThreshold = 150;
+	int maxThreshold = 255;
+	// smallest area, in pixels, of a rectangle or square
+	double thresholdAreaForRect = 500;
+	// smallest area, in pixels, of a circle
+	double thresholdAreaForCircle = 500;
+	// how far from 1 the width to height ratio of a square may be
+	double thresholdRatioForSqar = 0.2;
+	// attributes larger than this are the outer contour of the diagram, not attributes
+	double thresholdForOutsideContour = 20000;
+	// contours whose bounding box is more than this many times longer than it is wide are dropped
+	//	before their polygon is approximated; 0 keeps every contour
+	double maxAspectRatio = 0;
+	// how far the polygon approximating a contour may stray from it, as a fraction of its length
+	double approxEpsilonFraction = 0.02;
+	// pixels between a shape and the box drawn around it
+	int boundingBoxOffByPixel = 10;
+
+	// number of times the image is halved to look for ink before recognizing at full
+	//	resolution; 0 recognizes the whole image at full resolution
+	int pyramidLevels = 0;
+	// gray level below which a pixel of the shrunk image counts as ink; lighter than
+	//	minThreshold because shrinking blends thin lines with the paper around them
+	int pyramidInkThreshold = 230;
+	// how the regions of a full resolution threshold are found; pyramid mode always uses
+	//	findContours on its small regions
+	ContourBackend contourBackend = ContourBackend::FindContours;
+
+	// pixels outside a shape's polygon erased as its outline before connectors are traced; at
+	//	least the stroke width of the outlines
+	int connectorOutlineWidth = 6;
+	// strokes shorter than this many pixels are specks or writing, not connectors
+	double minConnectorLength = 10;
+	// how many pixels past a shape's erased outline the end of a connector may stop and still
+	//	be joined to it
+	int connectorSnapDistance = 15;
+};
+
+// ------------------------------------ scaledForLevel --------------------------------------
+
+// purpose: get the limits to use on an image shrunk by a pyramid level
+// preconditions: level is at least 0
+// postconditions: returns params with every area limit divided by 4 per level (each halving
+//	quarters areas); gray levels and ratios are unchanged
+
+// --------------------------------------------------------------------------------------
+RecognitionParams scaledForLevel(const RecognitionParams& params, int level);
+
+// ------------------------------------ contourBackendName --------------------------------------
+
+// purpose: get the name of a contour backend as used on the command line
+// preconditions: none
+// postconditions: returns "findcontours" or "components"
+
+// --------------------------------------------------------------------------------------
+const char* contourBackendName(ContourBackend backend);
+
+// ------------------------------------ parseContourBackend --------------------------------------
+
+// purpose: read a contour backend named on the command line
+// preconditions: none
+// postconditions: returns true and sets backend if name is the name of a backend, otherwise
+//	returns false and leaves backend as it is
+
+// --------------------------------------------------------------------------------------
+bool parseContourBackend(const string& name, ContourBackend& backend);
+
+#endif
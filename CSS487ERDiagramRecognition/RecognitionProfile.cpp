@@ -0,0 +1,109 @@
+// RecognitionProfile.cpp
+// Purpose: group the tuning of RecognitionParams into profiles for the kinds of images the program
+//	is given, so the classification can be compiled for each of them
+// Functionality: each profile is a type whose classification limits are compile time constants
+//	with the same names as the fields of RecognitionParams, so code written against the names
+//	works with either: given a profile type it is specialized (the limits are folded into the
+//	tests, and the tests a profile turns off are removed), given RecognitionParams it reads them
+//	at run time. paramsOf gives the RecognitionParams of a profile and matchingProfile is the run
+//	time dispatcher, finding the profile whose limits a RecognitionParams holds
+// Assumptions:
+//	DigitalProfile holds the values the program was tuned with on the test images (drawings made
+//	in a paint program), which are also the defaults of RecognitionParams; the photo and scan
+//	profiles scale them for larger images and noisier paper and are starting points to tune
+// Authors: Allan Genari Gaarden, Tommy Ni, Joshua Medvinsky
+
+#include "RecognitionProfile.h"
+
+// ------------------------------------ holdsProfile --------------------------------------
+
+// purpose: check whether parameters hold the limits of a profile
+// preconditions: Profile is one of the profile types
+// postconditions: returns true if every field Profile sets has its value in params
+
+// --------------------------------------------------------------------------------------
+template<class Profile>
+static bool holdsProfile(const RecognitionParams& params)
+{
+	return params.minThreshold == Profile::minThreshold && params.maxThreshold == Profile::maxThreshold &&
+		params.thresholdAreaForRect == Profile::thresholdAreaForRect &&
+		params.thresholdAreaForCircle == Profile::thresholdAreaForCircle &&
+		params.thresholdRatioForSqar == Profile::thresholdRatioForSqar &&
+		params.thresholdForOutsideContour == Profile::thresholdForOutsideContour &&
+		params.maxAspectRatio == Profile::maxAspectRatio &&
+		params.approxEpsilonFraction == Profile::approxEpsilonFraction &&
+		params.boundingBoxOffByPixel == Profile::boundingBoxOffByPixel;
+}
+
+// ------------------------------------ profileParams --------------------------------------
+
+// purpose: get the parameters of a profile chosen at run time
+// preconditions: none
+// postconditions: returns the parameters of profile; Custom gives the defaults
+
+// --------------------------------------------------------------------------------------
+RecognitionParams profileParams(RecognitionProfile profile)
+{
+	switch (profile)
+	{
+	case RecognitionProfile::Digital: return paramsOf<DigitalProfile>();
+	case RecognitionProfile::Photo: return paramsOf<PhotoProfile>();
+	case RecognitionProfile::Scan: return paramsOf<ScanProfile>();
+	default: return RecognitionParams();
+	}
+}
+
+// ------------------------------------ matchingProfile --------------------------------------
+
+// purpose: find the profile a set of parameters was made from, to run its specialized code
+// preconditions: none
+// postconditions: returns the profile whose limits params holds exactly, or Custom if there is
+//	none; the fields no profile sets (the pyramid and connector ones) are not compared
+
+// --------------------------------------------------------------------------------------
+RecognitionProfile matchingProfile(const RecognitionParams& params)
+{
+	if (holdsProfile<DigitalProfile>(params)) return RecognitionProfile::Digital;
+	if (holdsProfile<PhotoProfile>(params)) return RecognitionProfile::Photo;
+	if (holdsProfile<ScanProfile>(params)) return RecognitionProfile::Scan;
+	return RecognitionProfile::Custom;
+}
+
+// ------------------------------------ profileName --------------------------------------
+
+// purpose: get the name of a profile as used on the command line
+// preconditions: none
+// postconditions: returns "custom", "digital", "photo" or "scan"
+
+// --------------------------------------------------------------------------------------
+const char* profileName(RecognitionProfile profile)
+{
+	switch (profile)
+	{
+	case RecognitionProfile::Digital: return "digital";
+	case RecognitionProfile::Photo: return "photo";
+	case RecognitionProfile::Scan: return "scan";
+	default: return "custom";
+	}
+}
+
+// ------------------------------------ parseProfile --------------------------------------
+
+// purpose: read a profile named on the command line
+// preconditions: none
+// postconditions: returns true and sets profile if name is the name of a profile, otherwise
+//	returns false and leaves profile as it is
+
+// --------------------------------------------------------------------------------------
+bool parseProfile(const string& name, RecognitionProfile& profile)
+{
+	for (int i = 0; i < NUM_RECOGNITION_PROFILES; i++)
+	{
+		if (name == profileName((RecognitionProfile)i))
+		{
+			profile = (RecognitionProfile)i;
+			return true;
+		}
+	}
+	return false;
+}
@@ -0,0 +1,144 @@
+// RecognitionProfile.h
+// Purpose: group the tuning of RecognitionParams into profiles for the kinds of images the program
+//	is given, so the classification can be compiled for each of them
+// Functionality: each profile is a type whose classification limits are compile time constants
+//	with the same names as the fields of RecognitionParams, so code written against the names
+//	works with either: given a profile type it is specialized (the limits are folded into the
+//	tests, and the tests a profile turns off are removed), given RecognitionParams it reads them
+//	at run time. paramsOf gives the RecognitionParams of a profile and matchingProfile is the run
+//	time dispatcher, finding the profile whose limits a RecognitionParams holds
+// Assumptions:
+//	DigitalProfile holds the values the program was tuned with on the test images (drawings made
+//	in a paint program), which are also the defaults of RecognitionParams; the photo and scan
+//	profiles scale them for larger images and noisier paper and are starting points to tune
+// Authors: Allan Genari Gaarden, Tommy Ni, Joshua Medvinsky
+
+#ifndef RECOGNITION_PROFILE_H
+#define RECOGNITION_PROFILE_H
+
+#include "RecognitionParams.h"
+#include <string>
+using namespace std;
+
+// the profiles; Custom is any RecognitionParams that is not a profile
+enum class RecognitionProfile
+{
+	Custom,
+	Digital,
+	Photo,
+	Scan
+};
+
+// number of RecognitionProfile values
+const int NUM_RECOGNITION_PROFILES = (int)RecognitionProfile::Scan + 1;
+
+// clean drawings made in a paint program, about 1000 pixels across, on white
+struct DigitalProfile
+{
+	static constexpr RecognitionProfile id = RecognitionProfile::Digital;
+	static constexpr int minThreshold = 150;
+	static constexpr int maxThreshold = 255;
+	static constexpr double thresholdAreaForRect = 500;
+	static constexpr double thresholdAreaForCircle = 500;
+	static constexpr double thresholdRatioForSqar = 0.2;
+	static constexpr double thresholdForOutsideContour = 20000;
+	static constexpr double maxAspectRatio = 0;
+	static constexpr double approxEpsilonFraction = 0.02;
+	static constexpr int boundingBoxOffByPixel = 10;
+};
+
+// phone photos of paper or whiteboards, about 4000 pixels across: shapes are about three times
+//	larger than in a drawing, the paper is grayer where it is shaded, the lines wobble more and
+//	the many thin specks and strokes are dropped by their aspect ratio
+struct PhotoProfile
+{
+	static constexpr RecognitionProfile id = RecognitionProfile::Photo;
+	static constexpr int minThreshold = 120;
+	static constexpr int maxThreshold = 255;
+	static constexpr double thresholdAreaForRect = 4500;
+	static constexpr double thresholdAreaForCircle = 4500;
+	static constexpr double thresholdRatioForSqar = 0.25;
+	static constexpr double thresholdForOutsideContour = 180000;
+	static constexpr double maxAspectRatio = 10;
+	static constexpr double approxEpsilonFraction = 0.03;
+	static constexpr int boundingBoxOffByPixel = 30;
+};
+
+// pages scanned at 600 DPI, about 5000 pixels across: the paper is close to white, so lighter
+//	pencil still counts as ink, and shapes are about four times larger than in a drawing
+struct ScanProfile
+{
+	static constexpr RecognitionProfile id = RecognitionProfile::Scan;
+	static constexpr int minThreshold = 180;
+	static constexpr int maxThreshold = 255;
+	static constexpr double thresholdAreaForRect = 8000;
+	static constexpr double thresholdAreaForCircle = 8000;
+	static constexpr double thresholdRatioForSqar = 0.2;
+	static constexpr double thresholdForOutsideContour = 320000;
+	static constexpr double maxAspectRatio = 20;
+	static constexpr double approxEpsilonFraction = 0.02;
+	static constexpr int boundingBoxOffByPixel = 40;
+};
+
+// ------------------------------------ paramsOf --------------------------------------
+
+// purpose: get the parameters of a profile type
+// preconditions: Profile is one of the profile types
+// postconditions: returns the default RecognitionParams with the limits of Profile
+
+// --------------------------------------------------------------------------------------
+template<class Profile>
+RecognitionParams paramsOf()
+{
+	RecognitionParams params;
+	params.minThreshold = Profile::minThreshold;
+	params.maxThreshold = Profile::maxThreshold;
+	params.thresholdAreaForRect = Profile::thresholdAreaForRect;
+	params.thresholdAreaForCircle = Profile::thresholdAreaForCircle;
+	params.thresholdRatioForSqar = Profile::thresholdRatioForSqar;
+	params.thresholdForOutsideContour = Profile::thresholdForOutsideContour;
+	params.maxAspectRatio = Profile::maxAspectRatio;
+	params.approxEpsilonFraction = Profile::approxEpsilonFraction;
+	params.boundingBoxOffByPixel = Profile::boundingBoxOffByPixel;
+	return params;
+}
+
+// ------------------------------------ profileParams --------------------------------------
+
+// purpose: get the parameters of a profile chosen at run time
+// preconditions: none
+// postconditions: returns the parameters of profile; Custom gives the defaults
+
+// --------------------------------------------------------------------------------------
+RecognitionParams profileParams(RecognitionProfile profile);
+
+// ------------------------------------ matchingProfile --------------------------------------
+
+// purpose: find the profile a set of parameters was made from, to run its specialized code
+// preconditions: none
+// postconditions: returns the profile whose limits params holds exactly, or Custom if there is
+//	none; the fields no profile sets (the pyramid and connector ones) are not compared
+
+// --------------------------------------------------------------------------------------
+RecognitionProfile matchingProfile(const RecognitionParams& params);
+
+// ------------------------------------ profileName --------------------------------------
+
+// purpose: get the name of a profile as used on the command line
+// preconditions: none
+// postconditions: returns "custom", "digital", "photo" or "scan"
+
+// --------------------------------------------------------------------------------------
+const char* profileName(RecognitionProfile profile);
+
+// ------------------------------------ parseProfile --------------------------------------
+
+// purpose: read a profile named on the command line
+// preconditions: none
+// postconditions: returns true and sets profile if name is the name of a profile, otherwise
+//	returns false and leaves profile as it is
+
+// --------------------------------------------------------------------------------------
+bool parseProfile(const string& name, RecognitionProfile& profile);
+
+#endif
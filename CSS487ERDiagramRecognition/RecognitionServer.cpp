@@ -0,0 +1,710 @@
+// RecognitionServer.cpp
+// Purpose: answer recognition requests from a long lived local process, so an upload does not pay
+//	for starting a program, loading OpenCV and allocating a new recognizer every time
+// Functionality: RecognitionServer listens on a Unix domain socket. Every connection has its own
+//	thread that reads requests (an image name and the encoded image bytes) and queues them for a
+//	pool of workers, each holding a warm RecognizeERDiagram whose buffers are reused between
+//	images. A worker takes the small requests waiting at the front of the queue as one group, up
+//	to a group size, so requests arriving together cost one wake up and one lock; each is still
+//	recognized on its own, one after the other. Requests beyond the queue limit are answered as
+//	busy straight away instead of waiting. The answer is the JSON line
+//	ResultWriter writes for the shapes. The latency of each request, from being read until its
+//	answer is ready, and the time it waited in the queue are kept for the last LATENCY_SAMPLES
+//	requests, and their 50th and 99th percentiles are reported. RecognitionClient sends requests
+//	to a server
+// Assumptions:
+//	The server and its clients run on the same POSIX machine (Linux or macOS); on Windows start
+//	and the client throw
+//	Only the user running the server can open the socket; requests are checked for size but are
+//	not authenticated further
+// Authors: Allan Genari Gaarden, Tommy Ni, Joshua Medvinsky
+
+#include "RecognitionServer.h"
+#include "ResultWriter.h"
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+// how often the acceptor checks whether the server is stopping, in milliseconds
+static const int ACCEPT_POLL_MS = 100;
+
+// connections waiting to be accepted before the system turns new ones away
+static const int LISTEN_BACKLOG = 128;
+
+#ifndef _WIN32
+// writing to a client that went away must fail instead of raising SIGPIPE
+#ifdef MSG_NOSIGNAL
+static const int SEND_FLAGS = MSG_NOSIGNAL;
+#else
+static const int SEND_FLAGS = 0;
+#endif
+
+// ------------------------------------ ignoreSigpipe --------------------------------------
+
+// purpose: keep writes to a closed socket from raising SIGPIPE where send cannot be told to
+// preconditions: fd is a socket
+// postconditions: on systems with SO_NOSIGPIPE (macOS) it is set on fd
+
+// --------------------------------------------------------------------------------------
+static void ignoreSigpipe(int fd)
+{
+#ifdef SO_NOSIGPIPE
+	int on = 1;
+	setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#else
+	(void)fd;
+#endif
+}
+
+// ------------------------------------ makeAddress --------------------------------------
+
+// purpose: get the address of a socket path
+// preconditions: none
+// postconditions: returns true with address holding path, or false if path is too long for it
+
+// --------------------------------------------------------------------------------------
+static bool makeAddress(const string& path, sockaddr_un& address)
+{
+	address = sockaddr_un();
+	address.sun_family = AF_UNIX;
+	if (path.empty() || path.size() >= sizeof(address.sun_path)) return false;
+	copy(path.begin(), path.end(), address.sun_path);
+	return true;
+}
+
+// ------------------------------------ readFully --------------------------------------
+
+// purpose: read an exact number of bytes from a socket
+// preconditions: data has room for size bytes
+// postconditions: returns true once size bytes were read, or false if the peer closed the
+//	connection or it failed first
+
+// --------------------------------------------------------------------------------------
+static bool readFully(int fd, void* data, size_t size)
+{
+	char* next = (char*)data;
+	while (size > 0)
+	{
+		ssize_t received = recv(fd, next, size, 0);
+		if (received < 0 && errno == EINTR) continue;
+		if (received <= 0) return false;
+		next += received;
+		size -= (size_t)received;
+	}
+	return true;
+}
+
+// ------------------------------------ writeFully --------------------------------------
+
+// purpose: write an exact number of bytes to a socket
+// preconditions: data holds size bytes
+// postconditions: returns true once every byte was written, or false if the connection failed
+
+// --------------------------------------------------------------------------------------
+static bool writeFully(int fd, const void* data, size_t size)
+{
+	const char* next = (const char*)data;
+	while (size > 0)
+	{
+		ssize_t sent = ::send(fd, next, size, SEND_FLAGS);
+		if (sent < 0 && errno == EINTR) continue;
+		if (sent <= 0) return false;
+		next += sent;
+		size -= (size_t)sent;
+	}
+	return true;
+}
+#endif
+
+// ------------------------------------ errorJson --------------------------------------
+
+// purpose: get the answer to a request that got no shapes
+// preconditions: message needs no escaping
+// postconditions: returns a JSON line with the image name and the error, like the cli mode's
+
+// --------------------------------------------------------------------------------------
+static string errorJson(const string& imageName, const string& message)
+{
+	return "{\"image\":\"" + ResultWriter::escapeJson(imageName) + "\",\"error\":\"" + message + "\"}\n";
+}
+
+// ------------------------------------ parameter constructor --------------------------------------
+
+// purpose: set up a server
+// preconditions: config.socketPath is a path the socket can be created at
+// postconditions: nothing is listening until start is called
+
+// --------------------------------------------------------------------------------------
+RecognitionServer::RecognitionServer(const ServerConfig& config)
+{
+	this->config = config;
+	this->config.queueLimit = max(1, config.queueLimit);
+	this->config.maxConnections = max(1, config.maxConnections);
+	this->config.maxGroup = max(1, config.maxGroup);
+	if (this->config.numWorkers < 1) this->config.numWorkers = max(1, (int)thread::hardware_concurrency());
+}
+
+// ------------------------------------ destructor --------------------------------------
+
+// purpose: make sure every thread is stopped
+// preconditions: none
+// postconditions: calls stop
+
+// --------------------------------------------------------------------------------------
+RecognitionServer::~RecognitionServer()
+{
+	stop();
+}
+
+// ------------------------------------ start --------------------------------------
+
+// purpose: start answering requests
+// preconditions: start has not been called yet
+// postconditions: the workers are warm and the socket is listening; a socket file left at the path
+//	by a server that stopped is replaced. Throws cv::Exception if another server is listening on
+//	the path or the socket cannot be created
+
+// --------------------------------------------------------------------------------------
+void RecognitionServer::start()
+{
+#ifdef _WIN32
+	CV_Error(Error::StsNotImplemented, "the recognition server needs Unix domain sockets (Linux or macOS)");
+#else
+	if (started) CV_Error(Error::StsError, "the server was already started");
+
+	sockaddr_un address;
+	if (!makeAddress(config.socketPath, address))
+	{
+		CV_Error(Error::StsBadArg, "invalid socket path " + config.socketPath);
+	}
+
+	// a socket file nobody answers on was left by a server that stopped without removing it;
+	//	anything else at the path is not ours to remove
+	struct stat existing;
+	if (lstat(config.socketPath.c_str(), &existing) == 0)
+	{
+		if (!S_ISSOCK(existing.st_mode)) CV_Error(Error::StsError, config.socketPath + " is not a socket");
+		int probe = ::socket(AF_UNIX, SOCK_STREAM, 0);
+		bool inUse = probe >= 0 && connect(probe, (sockaddr*)&address, sizeof(address)) == 0;
+		if (probe >= 0) close(probe);
+		if (inUse) CV_Error(Error::StsError, "another server is listening on " + config.socketPath);
+		unlink(config.socketPath.c_str());
+	}
+
+	listenSocket = ::socket(AF_UNIX, SOCK_STREAM, 0);
+	if (listenSocket < 0) CV_Error(Error::StsError, "could not create a socket");
+	// bind creates the socket file with the permissions the umask leaves, so the umask shuts out
+	//	everyone else from the start rather than leaving a moment before chmod when they could
+	//	connect; the umask is the process's, and no other thread creates files yet
+	mode_t previousMask = umask(S_IRWXG | S_IRWXO);
+	bool bound = ::bind(listenSocket, (sockaddr*)&address, sizeof(address)) == 0;
+	umask(previousMask);
+	if (!bound || chmod(config.socketPath.c_str(), S_IRUSR | S_IWUSR) != 0 ||
+		listen(listenSocket, LISTEN_BACKLOG) != 0)
+	{
+		close(listenSocket);
+		listenSocket = -1;
+		unlink(config.socketPath.c_str());
+		CV_Error(Error::StsError, "could not listen on " + config.socketPath);
+	}
+	started = true;
+
+	// every worker already runs its own image, so keep OpenCV from spawning threads of its own
+	openCVThreads = getNumThreads();
+	if (config.numWorkers > 1) setNumThreads(1);
+
+	for (int i = 0; i < config.numWorkers; i++)
+	{
+		workers.emplace_back([this] { runWorker(); });
+	}
+	acceptor = thread([this] { acceptConnections(); });
+#endif
+}
+
+// ------------------------------------ stop --------------------------------------
+
+// purpose: stop answering requests
+// preconditions: none
+// postconditions: no new connection or request is taken, the requests already read are answered,
+//	every thread is joined and the socket file is removed; later calls do nothing
+
+// --------------------------------------------------------------------------------------
+void RecognitionServer::stop()
+{
+	if (!started || stopped) return;
+	stopped = true;
+
+	stopping.store(true);
+	acceptor.join();
+#ifndef _WIN32
+	close(listenSocket);
+	listenSocket = -1;
+	unlink(config.socketPath.c_str());
+
+	// no more requests are read, but the workers are still running, so the ones already read are
+	//	answered before their connections finish
+	for (auto it = connections.begin(); it != connections.end(); ++it)
+	{
+		shutdown((*it)->clientSocket, SHUT_RD);
+	}
+	for (auto it = connections.begin(); it != connections.end(); ++it)
+	{
+		(*it)->reader.join();
+		close((*it)->clientSocket);
+	}
+#endif
+	connections.clear();
+
+	{
+		lock_guard<mutex> guard(queueLock);
+		workersStopping = true;
+	}
+	jobReady.notify_all();
+	for (size_t i = 0; i < workers.size(); i++)
+	{
+		workers[i].join();
+	}
+	workers.clear();
+	setNumThreads(openCVThreads);
+}
+
+// ------------------------------------ getStats --------------------------------------
+
+// purpose: get what the server has done so far
+// preconditions: none
+// postconditions: returns the counts and percentiles since start; safe from any thread
+
+// --------------------------------------------------------------------------------------
+ServerStats RecognitionServer::getStats()
+{
+	ServerStats stats;
+	vector<double> latencies;
+	vector<double> queueWaits;
+	{
+		lock_guard<mutex> guard(statsLock);
+		stats = totals;
+		latencies = latencySamples;
+		queueWaits = queueWaitSamples;
+	}
+	stats.p50LatencyMs = percentile(latencies, 0.5);
+	stats.p99LatencyMs = percentile(latencies, 0.99);
+	stats.p50QueueWaitMs = percentile(queueWaits, 0.5);
+	stats.p99QueueWaitMs = percentile(queueWaits, 0.99);
+	return stats;
+}
+
+// ------------------------------------ writeStatsJson --------------------------------------
+
+// purpose: write the stats of a server as a JSON object
+// preconditions: none
+// postconditions: one JSON object, terminated by a newline, is written to out
+
+// --------------------------------------------------------------------------------------
+void RecognitionServer::writeStatsJson(ostream& out, const ServerStats& stats)
+{
+	out << "{\"requests\":" << stats.requests << ",\"failed\":" << stats.failed << ",\"rejected\":" <<
+		stats.rejected << ",\"groups\":" << stats.groups << ",\"maxQueueDepth\":" << stats.maxQueueDepth <<
+		",\"latencyMs\":{\"p50\":" << stats.p50LatencyMs << ",\"p99\":" << stats.p99LatencyMs <<
+		"},\"queueWaitMs\":{\"p50\":" << stats.p50QueueWaitMs << ",\"p99\":" << stats.p99QueueWaitMs <<
+		"}}" << endl;
+}
+
+// ------------------------------------ percentile --------------------------------------
+
+// purpose: get a percentile of some samples
+// preconditions: fraction is between 0 and 1
+// postconditions: returns the smallest sample at least fraction of the samples are not above, or
+//	0 if there are none; samples is reordered
+
+// --------------------------------------------------------------------------------------
+double RecognitionServer::percentile(vector<double>& samples, double fraction)
+{
+	if (samples.empty()) return 0;
+	size_t rank = (size_t)ceil(fraction * samples.size());
+	size_t index = min(samples.size(), max((size_t)1, rank)) - 1;
+	nth_element(samples.begin(), samples.begin() + index, samples.end());
+	return samples[index];
+}
+
+// ------------------------------------ acceptConnections --------------------------------------
+
+// purpose: take new connections until the server stops
+// preconditions: listenSocket is listening
+// postconditions: every connection taken has its thread, or was answered as busy and closed;
+//	finished connections are joined and closed as new ones arrive
+
+// --------------------------------------------------------------------------------------
+void RecognitionServer::acceptConnections()
+{
+#ifndef _WIN32
+	while (!stopping.load())
+	{
+		// waits a little at a time, so stop is noticed without closing the socket under accept
+		pollfd listening = { listenSocket, POLLIN, 0 };
+		int ready = poll(&listening, 1, ACCEPT_POLL_MS);
+
+		for (auto it = connections.begin(); it != connections.end();)
+		{
+			if (!(*it)->finished.load())
+			{
+				++it;
+				continue;
+			}
+			(*it)->reader.join();
+			close((*it)->clientSocket);
+			it = connections.erase(it);
+		}
+		if (ready <= 0) continue;
+
+		int clientSocket = accept(listenSocket, nullptr, nullptr);
+		if (clientSocket < 0) continue;
+		ignoreSigpipe(clientSocket);
+
+		if ((int)connections.size() >= config.maxConnections)
+		{
+			string busy = errorJson("", "too many connections");
+			writeFully(clientSocket, busy.data(), busy.size());
+			close(clientSocket);
+			lock_guard<mutex> guard(statsLock);
+			totals.rejected++;
+			continue;
+		}
+
+		unique_ptr<Connection> connection(new Connection());
+		connection->clientSocket = clientSocket;
+		Connection* served = connection.get();
+		connection->reader = thread([this, served] { serveConnection(served); });
+		connections.push_back(move(connection));
+	}
+#endif
+}
+
+// ------------------------------------ serveConnection --------------------------------------
+
+// purpose: answer the requests of one client, one after another
+// preconditions: connection holds a connected socket
+// postconditions: every request read was answered; returns once the client closes the
+//	connection, sends a request that is too large, or the server stops. The socket is left open
+//	for the acceptor to close
+
+// --------------------------------------------------------------------------------------
+void RecognitionServer::serveConnection(Connection* connection)
+{
+#ifndef _WIN32
+	int clientSocket = connection->clientSocket;
+	RequestHeader header;
+	while (!stopping.load() && readFully(clientSocket, &header, sizeof(header)))
+	{
+		// a client sending nonsense is cut off rather than read into memory
+		if (header.nameBytes > MAX_REQUEST_NAME_BYTES || header.imageBytes > MAX_REQUEST_IMAGE_BYTES) break;
+
+		shared_ptr<Job> job = make_shared<Job>();
+		job->name.resize(header.nameBytes);
+		job->bytes.resize(header.imageBytes);
+		if (!readFully(clientSocket, &job->name[0], job->name.size()) ||
+			!readFully(clientSocket, job->bytes.data(), job->bytes.size()))
+		{
+			break;
+		}
+		job->received = chrono::steady_clock::now();
+
+		string response;
+		if (job->bytes.empty())
+		{
+			ostringstream stats;
+			writeStatsJson(stats, getStats());
+			response = stats.str();
+		}
+		else if (!submit(job))
+		{
+			response = errorJson(job->name, "busy");
+		}
+		else
+		{
+			unique_lock<mutex> lock(resultLock);
+			job->answered.wait(lock, [&job] { return job->done; });
+			response = move(job->response);
+		}
+		if (!writeFully(clientSocket, response.data(), response.size())) break;
+	}
+#endif
+	connection->finished.store(true);
+}
+
+// ------------------------------------ submit --------------------------------------
+
+// purpose: queue a request for the workers
+// preconditions: job holds a request that was read whole
+// postconditions: returns true if the job was queued, or false if the queue is at its limit
+
+// --------------------------------------------------------------------------------------
+bool RecognitionServer::submit(const shared_ptr<Job>& job)
+{
+	int depth = -1;
+	{
+		lock_guard<mutex> guard(queueLock);
+		if ((int)jobs.size() < config.queueLimit)
+		{
+			jobs.push_back(job);
+			depth = (int)jobs.size();
+		}
+	}
+	if (depth > 0) jobReady.notify_one();
+
+	lock_guard<mutex> guard(statsLock);
+	if (depth < 0)
+	{
+		totals.rejected++;
+		return false;
+	}
+	totals.maxQueueDepth = max(totals.maxQueueDepth, depth);
+	return true;
+}
+
+// ------------------------------------ runWorker --------------------------------------
+
+// purpose: answer queued requests with a warm recognizer until the server stops
+// preconditions: none
+// postconditions: every job taken has its response and is marked done; returns once the queue
+//	is empty and the workers are stopping
+
+// --------------------------------------------------------------------------------------
+void RecognitionServer::runWorker()
+{
+	// lives as long as the server, so its threshold, contour and decode buffers are only ever
+	//	allocated for the first images
+	RecognizeERDiagram rec;
+	rec.setParams(config.params);
+	rec.setLowMemory(config.lowMemory);
+	rec.setKeepImage(!config.lowMemory);
+	vector<shared_ptr<Job>> group;
+	ostringstream response;
+
+	while (true)
+	{
+		{
+			unique_lock<mutex> lock(queueLock);
+			if (!takeGroup(lock, group)) return;
+		}
+		auto taken = chrono::steady_clock::now();
+		{
+			lock_guard<mutex> guard(statsLock);
+			totals.groups++;
+		}
+
+		for (size_t i = 0; i < group.size(); i++)
+		{
+			Job& job = *group[i];
+			double queueWaitMs = chrono::duration<double, milli>(taken - job.received).count();
+			bool recognized = true;
+			response.str("");
+			try
+			{
+				rec.recognizeEncoded(job.bytes.data(), job.bytes.size());
+				ResultWriter::writeJson(response, job.name, rec.getImageSize(), rec.getShapes());
+			}
+			catch (const cv::Exception&)
+			{
+				recognized = false;
+				response.str("");
+				response << errorJson(job.name, "could not be recognized");
+			}
+			// the encoded image can be large and is not needed any more
+			vector<uchar>().swap(job.bytes);
+			double latencyMs = chrono::duration<double, milli>(chrono::steady_clock::now() - job.received).count();
+			record(recognized, latencyMs, queueWaitMs);
+
+			// each request is answered as soon as it is done, not when the whole group is
+			{
+				lock_guard<mutex> guard(resultLock);
+				job.response = response.str();
+				job.done = true;
+			}
+			job.answered.notify_one();
+		}
+	}
+}
+
+// ------------------------------------ takeGroup --------------------------------------
+
+// purpose: take the next requests a worker answers one after the other
+// preconditions: lock holds queueLock
+// postconditions: group holds the oldest job and, if it is small, the small jobs right behind
+//	it, up to config.maxGroup; returns false with group empty once the workers are stopping and
+//	the queue is empty
+
+// --------------------------------------------------------------------------------------
+bool RecognitionServer::takeGroup(unique_lock<mutex>& lock, vector<shared_ptr<Job>>& group)
+{
+	group.clear();
+	jobReady.wait(lock, [this] { return workersStopping || !jobs.empty(); });
+	if (jobs.empty()) return false;
+
+	group.push_back(jobs.front());
+	jobs.pop_front();
+	// a large image keeps a worker busy long enough on its own
+	if (group[0]->bytes.size() > (size_t)config.smallRequestBytes) return true;
+
+	// only the jobs right behind are taken, so no request is overtaken by a later one
+	auto deadline = chrono::steady_clock::now() +
+		chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double, milli>(config.groupWindowMs));
+	while ((int)group.size() < config.maxGroup)
+	{
+		if (!jobs.empty())
+		{
+			if (jobs.front()->bytes.size() > (size_t)config.smallRequestBytes) break;
+			group.push_back(jobs.front());
+			jobs.pop_front();
+			continue;
+		}
+		if (config.groupWindowMs <= 0 || workersStopping) break;
+		if (jobReady.wait_until(lock, deadline) == cv_status::timeout && jobs.empty()) break;
+	}
+	return true;
+}
+
+// ------------------------------------ record --------------------------------------
+
+// purpose: keep the timings of an answered request
+// preconditions: none
+// postconditions: the counts and the latency rings include the request
+
+// --------------------------------------------------------------------------------------
+void RecognitionServer::record(bool recognized, double latencyMs, double queueWaitMs)
+{
+	lock_guard<mutex> guard(statsLock);
+	if (recognized) totals.requests++;
+	else totals.failed++;
+
+	// the oldest sample is replaced once the rings are full
+	if ((int)latencySamples.size() < LATENCY_SAMPLES)
+	{
+		latencySamples.push_back(latencyMs);
+		queueWaitSamples.push_back(queueWaitMs);
+	}
+	else
+	{
+		size_t slot = (size_t)(numSamples % LATENCY_SAMPLES);
+		latencySamples[slot] = latencyMs;
+		queueWaitSamples[slot] = queueWaitMs;
+	}
+	numSamples++;
+}
+
+// ------------------------------------ parameter constructor --------------------------------------
+
+// purpose: connect to a server
+// preconditions: a RecognitionServer is listening on socketPath
+// postconditions: the client is connected; throws cv::Exception if it cannot connect
+
+// --------------------------------------------------------------------------------------
+RecognitionClient::RecognitionClient(const string& socketPath)
+{
+#ifdef _WIN32
+	CV_Error(Error::StsNotImplemented, "the recognition server needs Unix domain sockets (Linux or macOS)");
+#else
+	sockaddr_un address;
+	if (!makeAddress(socketPath, address)) CV_Error(Error::StsBadArg, "invalid socket path " + socketPath);
+
+	clientSocket = ::socket(AF_UNIX, SOCK_STREAM, 0);
+	if (clientSocket < 0 || connect(clientSocket, (sockaddr*)&address, sizeof(address)) != 0)
+	{
+		if (clientSocket >= 0) close(clientSocket);
+		clientSocket = -1;
+		CV_Error(Error::StsError, "could not connect to " + socketPath);
+	}
+	ignoreSigpipe(clientSocket);
+#endif
+}
+
+// ------------------------------------ destructor --------------------------------------
+
+// purpose: close the connection
+// preconditions: none
+// postconditions: the socket is closed
+
+// --------------------------------------------------------------------------------------
+RecognitionClient::~RecognitionClient()
+{
+#ifndef _WIN32
+	if (clientSocket >= 0) close(clientSocket);
+#endif
+}
+
+// ------------------------------------ recognize --------------------------------------
+
+// purpose: have the server recognize an encoded image
+// preconditions: data points to size bytes of an image file, size is at least 1
+// postconditions: returns the JSON line the server answered, without its newline; throws
+//	cv::Exception if the connection fails
+
+// --------------------------------------------------------------------------------------
+string RecognitionClient::recognize(const string& imageName, const uchar* data, size_t size)
+{
+	// no image bytes would ask for the stats instead
+	if (size == 0) CV_Error(Error::StsBadArg, "the image is empty");
+	return exchange(imageName, data, size);
+}
+
+// ------------------------------------ requestStats --------------------------------------
+
+// purpose: get the stats of the server as JSON
+// preconditions: none
+// postconditions: returns the JSON line of RecognitionServer::writeStatsJson, without its
+//	newline; throws cv::Exception if the connection fails
+
+// --------------------------------------------------------------------------------------
+string RecognitionClient::requestStats()
+{
+	return exchange("", nullptr, 0);
+}
+
+// ------------------------------------ exchange --------------------------------------
+
+// purpose: send one request and read its answer
+// preconditions: the client is connected
+// postconditions: returns the answer without its newline; throws cv::Exception if the
+//	connection fails
+
+// --------------------------------------------------------------------------------------
+string RecognitionClient::exchange(const string& imageName, const uchar* data, size_t size)
+{
+#ifdef _WIN32
+	CV_Error(Error::StsNotImplemented, "the recognition server needs Unix domain sockets (Linux or macOS)");
+#else
+	if (imageName.size() > MAX_REQUEST_NAME_BYTES || size > MAX_REQUEST_IMAGE_BYTES)
+	{
+		CV_Error(Error::StsBadArg, "the request is larger than the server accepts");
+	}
+	RequestHeader header = { (uint32_t)imageName.size(), (uint32_t)size };
+	if (!writeFully(clientSocket, &header, sizeof(header)) ||
+		!writeFully(clientSocket, imageName.data(), imageName.size()) ||
+		!writeFully(clientSocket, data, size))
+	{
+		CV_Error(Error::StsError, "the server closed the connection");
+	}
+
+	// the answer is one line; anything after its newline belongs to the next one
+	size_t end;
+	while ((end = buffered.find('\n')) == string::npos)
+	{
+		char chunk[4096];
+		ssize_t received = recv(clientSocket, chunk, sizeof(chunk), 0);
+		if (received < 0 && errno == EINTR) continue;
+		if (received <= 0) CV_Error(Error::StsError, "the server closed the connection");
+		buffered.append(chunk, (size_t)received);
+	}
+	string answer = buffered.substr(0, end);
+	buffered.erase(0, end + 1);
+	return answer;
+#endif
+}
@@ -0,0 +1,323 @@
+// RecognitionServer.h
+// Purpose: answer recognition requests from a long lived local process, so an upload does not pay
+//	for starting a program, loading OpenCV and allocating a new recognizer every time
+// Functionality: RecognitionServer listens on a Unix domain socket. Every connection has its own
+//	thread that reads requests (an image name and the encoded image bytes) and queues them for a
+//	pool of workers, each holding a warm RecognizeERDiagram whose buffers are reused between
+//	images. A worker takes the small requests waiting at the front of the queue as one group, up
+//	to a group size, so requests arriving together cost one wake up and one lock; each is still
+//	recognized on its own, one after the other. Requests beyond the queue limit are answered as
+//	busy straight away instead of waiting. The answer is the JSON line
+//	ResultWriter writes for the shapes. The latency of each request, from being read until its
+//	answer is ready, and the time it waited in the queue are kept for the last LATENCY_SAMPLES
+//	requests, and their 50th and 99th percentiles are reported. RecognitionClient sends requests
+//	to a server
+// Assumptions:
+//	The server and its clients run on the same POSIX machine (Linux or macOS); on Windows start
+//	and the client throw
+//	Only the user running the server can open the socket; requests are checked for size but are
+//	not authenticated further
+// Authors: Allan Genari Gaarden, Tommy Ni, Joshua Medvinsky
+
+#ifndef RECOGNITION_SERVER_H
+#define RECOGNITION_SERVER_H
+
+#include "RecognizeERDiagram.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+// the wire format: a request is a RequestHeader followed by nameBytes of image name and
+//	imageBytes of encoded image; a request with no image bytes asks for the ServerStats instead.
+//	Every request is answered with one line of JSON, and a connection can send any number of
+//	requests, one after another
+struct RequestHeader
+{
+	uint32_t nameBytes;
+	uint32_t imageBytes;
+};
+
+// largest name and image a request may hold; a connection sending more is closed
+const uint32_t MAX_REQUEST_NAME_BYTES = 4096;
+const uint32_t MAX_REQUEST_IMAGE_BYTES = 256 * 1024 * 1024;
+
+// how many of the most recent requests the percentiles are taken over
+const int LATENCY_SAMPLES = 4096;
+
+struct ServerConfig
+{
+	string socketPath;
+	// warm recognizers, each on a thread of its own; less than 1 means one per core
+	int numWorkers = 0;
+	// requests waiting for a worker; more are answered as busy
+	int queueLimit = 64;
+	// connections served at once; more are answered as busy and closed
+	int maxConnections = 64;
+	// requests of at most smallRequestBytes image bytes are taken from the queue by a worker as
+	//	one group, up to maxGroup at once, and recognized one after the other; a group waits up to
+	//	groupWindowMs for more to arrive, 0 takes only the ones already waiting
+	int maxGroup = 8;
+	int smallRequestBytes = 256 * 1024;
+	double groupWindowMs = 0;
+	// how every worker recognizes its images
+	RecognitionParams params;
+	bool lowMemory = false;
+};
+
+// what the server has done since it started
+struct ServerStats
+{
+	// answered with shapes, answered with an error, and turned away because the queue was full
+	long long requests = 0;
+	long long failed = 0;
+	long long rejected = 0;
+	// times a worker took requests from the queue, and the most requests waiting at once
+	long long groups = 0;
+	int maxQueueDepth = 0;
+	// over the last LATENCY_SAMPLES requests
+	double p50LatencyMs = 0;
+	double p99LatencyMs = 0;
+	double p50QueueWaitMs = 0;
+	double p99QueueWaitMs = 0;
+};
+
+class RecognitionServer
+{
+public:
+	// default constructor not allowed
+	RecognitionServer() = delete;
+	// the threads hold a pointer to the server
+	RecognitionServer(const RecognitionServer&) = delete;
+	RecognitionServer& operator=(const RecognitionServer&) = delete;
+	// ------------------------------------ parameter constructor --------------------------------------
+
+// purpose: set up a server
+// preconditions: config.socketPath is a path the socket can be created at
+// postconditions: nothing is listening until start is called
+
+// --------------------------------------------------------------------------------------
+	RecognitionServer(const ServerConfig& config);
+	// ------------------------------------ destructor --------------------------------------
+
+// purpose: make sure every thread is stopped
+// preconditions: none
+// postconditions: calls stop
+
+// --------------------------------------------------------------------------------------
+	~RecognitionServer();
+	// ------------------------------------ start --------------------------------------
+
+// purpose: start answering requests
+// preconditions: start has not been called yet
+// postconditions: the workers are warm and the socket is listening; a socket file left at the path
+//	by a server that stopped is replaced. Throws cv::Exception if another server is listening on
+//	the path or the socket cannot be created
+
+// --------------------------------------------------------------------------------------
+	void start();
+	// ------------------------------------ stop --------------------------------------
+
+// purpose: stop answering requests
+// preconditions: none
+// postconditions: no new connection or request is taken, the requests already read are answered,
+//	every thread is joined and the socket file is removed; later calls do nothing
+
+// --------------------------------------------------------------------------------------
+	void stop();
+	// ------------------------------------ getStats --------------------------------------
+
+// purpose: get what the server has done so far
+// preconditions: none
+// postconditions: returns the counts and percentiles since start; safe from any thread
+
+// --------------------------------------------------------------------------------------
+	ServerStats getStats();
+	// ------------------------------------ writeStatsJson --------------------------------------
+
+// purpose: write the stats of a server as a JSON object
+// preconditions: none
+// postconditions: one JSON object, terminated by a newline, is written to out
+
+// --------------------------------------------------------------------------------------
+	static void writeStatsJson(ostream& out, const ServerStats& stats);
+	// ------------------------------------ percentile --------------------------------------
+
+// purpose: get a percentile of some samples
+// preconditions: fraction is between 0 and 1
+// postconditions: returns the smallest sample at least fraction of the samples are not above, or
+//	0 if there are none; samples is reordered
+
+// --------------------------------------------------------------------------------------
+	static double percentile(vector<double>& samples, double fraction);
+
+private:
+	// one request from being read until its answer is written
+	struct Job
+	{
+		string name;
+		vector<uchar> bytes;
+		chrono::steady_clock::time_point received;
+		string response;
+		// set under resultLock once response is ready
+		bool done = false;
+		condition_variable answered;
+	};
+
+	// one client, served by its own thread
+	struct Connection
+	{
+		int clientSocket = -1;
+		thread reader;
+		atomic<bool> finished{ false };
+	};
+
+	ServerConfig config;
+	int listenSocket = -1;
+	bool started = false;
+	bool stopped = false;
+	atomic<bool> stopping{ false };
+	thread acceptor;
+	vector<thread> workers;
+	// only the acceptor thread changes the connections until it is joined
+	list<unique_ptr<Connection>> connections;
+	// OpenCV's own thread count, restored by stop
+	int openCVThreads = 0;
+
+	// the requests waiting for a worker
+	mutex queueLock;
+	condition_variable jobReady;
+	deque<shared_ptr<Job>> jobs;
+	bool workersStopping = false;
+
+	// answers are handed back to the connection threads under resultLock
+	mutex resultLock;
+
+	// counts and the most recent samples, in rings of LATENCY_SAMPLES
+	mutex statsLock;
+	ServerStats totals;
+	vector<double> latencySamples;
+	vector<double> queueWaitSamples;
+	long long numSamples = 0;
+
+	// ------------------------------------ acceptConnections --------------------------------------
+
+// purpose: take new connections until the server stops
+// preconditions: listenSocket is listening
+// postconditions: every connection taken has its thread, or was answered as busy and closed;
+//	finished connections are joined and closed as new ones arrive
+
+// --------------------------------------------------------------------------------------
+	void acceptConnections();
+	// ------------------------------------ serveConnection --------------------------------------
+
+// purpose: answer the requests of one client, one after another
+// preconditions: connection holds a connected socket
+// postconditions: every request read was answered; returns once the client closes the
+//	connection, sends a request that is too large, or the server stops. The socket is left open
+//	for the acceptor to close
+
+// --------------------------------------------------------------------------------------
+	void serveConnection(Connection* connection);
+	// ------------------------------------ submit --------------------------------------
+
+// purpose: queue a request for the workers
+// preconditions: job holds a request that was read whole
+// postconditions: returns true if the job was queued, or false if the queue is at its limit
+
+// --------------------------------------------------------------------------------------
+	bool submit(const shared_ptr<Job>& job);
+	// ------------------------------------ runWorker --------------------------------------
+
+// purpose: answer queued requests with a warm recognizer until the server stops
+// preconditions: none
+// postconditions: every job taken has its response and is marked done; returns once the queue
+//	is empty and the workers are stopping
+
+// --------------------------------------------------------------------------------------
+	void runWorker();
+	// ------------------------------------ takeGroup --------------------------------------
+
+// purpose: take the next requests a worker answers one after the other
+// preconditions: lock holds queueLock
+// postconditions: group holds the oldest job and, if it is small, the small jobs right behind
+//	it, up to config.maxGroup; returns false with group empty once the workers are stopping and
+//	the queue is empty
+
+// --------------------------------------------------------------------------------------
+	bool takeGroup(unique_lock<mutex>& lock, vector<shared_ptr<Job>>& group);
+	// ------------------------------------ record --------------------------------------
+
+// purpose: keep the timings of an answered request
+// preconditions: none
+// postconditions: the counts and the latency rings include the request
+
+// --------------------------------------------------------------------------------------
+	void record(bool recognized, double latencyMs, double queueWaitMs);
+};
+
+class RecognitionClient
+{
+public:
+	// default constructor not allowed
+	RecognitionClient() = delete;
+	// the socket belongs to one client only
+	RecognitionClient(const RecognitionClient&) = delete;
+	RecognitionClient& operator=(const RecognitionClient&) = delete;
+	// ------------------------------------ parameter constructor --------------------------------------
+
+// purpose: connect to a server
+// preconditions: a RecognitionServer is listening on socketPath
+// postconditions: the client is connected; throws cv::Exception if it cannot connect
+
+// --------------------------------------------------------------------------------------
+	RecognitionClient(const string& socketPath);
+	// ------------------------------------ destructor --------------------------------------
+
+// purpose: close the connection
+// preconditions: none
+// postconditions: the socket is closed
+
+// --------------------------------------------------------------------------------------
+	~RecognitionClient();
+	// ------------------------------------ recognize --------------------------------------
+
+// purpose: have the server recognize an encoded image
+// preconditions: data points to size bytes of an image file, size is at least 1
+// postconditions: returns the JSON line the server answered, without its newline; throws
+//	cv::Exception if the connection fails
+
+// --------------------------------------------------------------------------------------
+	string recognize(const string& imageName, const uchar* data, size_t size);
+	// ------------------------------------ requestStats --------------------------------------
+
+// purpose: get the stats of the server as JSON
+// preconditions: none
+// postconditions: returns the JSON line of RecognitionServer::writeStatsJson, without its
+//	newline; throws cv::Exception if the connection fails
+
+// --------------------------------------------------------------------------------------
+	string requestStats();
+
+private:
+	int clientSocket = -1;
+	// bytes read past the end of the last answer
+	string buffered;
+
+	// ------------------------------------ exchange --------------------------------------
+
+// purpose: send one request and read its answer
+// preconditions: the client is connected
+// postconditions: returns the answer without its newline; throws cv::Exception if the
+//	connection fails
+
+// --------------------------------------------------------------------------------------
+	string exchange(const string& imageName, const uchar* data, size_t size);
+};
+
+#endif
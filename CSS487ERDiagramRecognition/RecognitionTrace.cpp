@@ -0,0 +1,383 @@
+// RecognitionTrace.cpp
+// Purpose: show where the time of a slow recognition goes, without slowing down release builds
+// Functionality: RecognitionTrace holds what one recognition measured: the wall time of each
+//	stage, how many contours were left after each filter, the isNested calls, the bytes
+//	allocated and the image size. TraceHistograms gathers the traces of many recognitions into
+//	power of two histograms and writes them as text or JSON. The ERD_TRACE_ macros are what
+//	recognition calls; they do nothing unless the program is built with ERD_INSTRUMENT defined
+// Assumptions:
+//	Without ERD_INSTRUMENT every trace stays empty and the macros compile to nothing
+//	Allocations are only counted once AllocationStats::install has been called, and heap
+//	allocations outside of Mat only with ERD_COUNT_ALLOCATIONS as well
+// Authors: Allan Genari Gaarden, Tommy Ni, Joshua Medvinsky
+
+#include "RecognitionTrace.h"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+
+// ------------------------------------ enabled --------------------------------------
+
+// purpose: tell whether recognition fills in its trace
+// preconditions: none
+// postconditions: returns true if the program was built with ERD_INSTRUMENT
+
+// --------------------------------------------------------------------------------------
+bool RecognitionTrace::enabled()
+{
+#ifdef ERD_INSTRUMENT
+	return true;
+#else
+	return false;
+#endif
+}
+
+// ------------------------------------ begin --------------------------------------
+
+// purpose: start the trace of a new recognition
+// preconditions: none
+// postconditions: everything is cleared, and the total time and allocations are measured from now
+
+// --------------------------------------------------------------------------------------
+void RecognitionTrace::begin()
+{
+	*this = RecognitionTrace();
+	startAllocations = AllocationStats::current();
+	start(TraceStage::Total);
+}
+
+// ------------------------------------ end --------------------------------------
+
+// purpose: finish the trace of a recognition
+// preconditions: begin has been called
+// postconditions: the total time and the allocations since begin are stored, with imageSize
+
+// --------------------------------------------------------------------------------------
+void RecognitionTrace::end(Size imageSize)
+{
+	stop(TraceStage::Total);
+	this->imageSize = imageSize;
+	AllocationCounts now = AllocationStats::current();
+	counts[(int)TraceCounter::Allocations] = now.matAllocations - startAllocations.matAllocations +
+		now.heapAllocations - startAllocations.heapAllocations;
+	counts[(int)TraceCounter::AllocatedBytes] = now.matBytes - startAllocations.matBytes +
+		now.heapBytes - startAllocations.heapBytes;
+}
+
+// ------------------------------------ start --------------------------------------
+
+// purpose: start timing a stage
+// preconditions: none
+// postconditions: the next stop of stage adds the time from now to it
+
+// --------------------------------------------------------------------------------------
+void RecognitionTrace::start(TraceStage stage)
+{
+	stageRan[(int)stage] = true;
+	startTicks[(int)stage] = getTickCount();
+}
+
+// ------------------------------------ stop --------------------------------------
+
+// purpose: stop timing a stage
+// preconditions: start has been called for stage
+// postconditions: the time since start is added to the stage, so a stage run once per region
+//	holds the time of every region
+
+// --------------------------------------------------------------------------------------
+void RecognitionTrace::stop(TraceStage stage)
+{
+	stageMs[(int)stage] += (getTickCount() - startTicks[(int)stage]) * 1000.0 / getTickFrequency();
+}
+
+// ------------------------------------ add --------------------------------------
+
+// purpose: count something
+// preconditions: none
+// postconditions: value is added to counter
+
+// --------------------------------------------------------------------------------------
+void RecognitionTrace::add(TraceCounter counter, long long value)
+{
+	counts[(int)counter] += value;
+}
+
+// ------------------------------------ add --------------------------------------
+
+// purpose: count one value
+// preconditions: value is at least 0
+// postconditions: the bucket of value and the totals include it
+
+// --------------------------------------------------------------------------------------
+void TraceHistogram::add(double value)
+{
+	// frexp gives value = fraction * 2^exponent with fraction in [0.5, 1), so a value from
+	//	2^(b-1) up to 2^b has exponent b
+	int bucket = 0;
+	if (value >= 1)
+	{
+		int exponent;
+		frexp(value, &exponent);
+		bucket = std::min(exponent, NUM_BUCKETS - 1);
+	}
+	buckets[bucket]++;
+
+	minValue = count == 0 ? value : std::min(minValue, value);
+	maxValue = count == 0 ? value : std::max(maxValue, value);
+	sum += value;
+	count++;
+}
+
+// ------------------------------------ percentile --------------------------------------
+
+// purpose: estimate the value a fraction of the values are at or below
+// preconditions: fraction is between 0 and 1
+// postconditions: returns the upper end of the bucket holding that value, but no more than
+//	maxValue; 0 if nothing was counted
+
+// --------------------------------------------------------------------------------------
+double TraceHistogram::percentile(double fraction) const
+{
+	if (count == 0) return 0;
+
+	long long rank = std::max(1LL, (long long)ceil(fraction * count));
+	long long seen = 0;
+	for (int bucket = 0; bucket < NUM_BUCKETS; bucket++)
+	{
+		seen += buckets[bucket];
+		if (seen >= rank) return std::min(upperBound(bucket), maxValue);
+	}
+	return maxValue;
+}
+
+// ------------------------------------ upperBound --------------------------------------
+
+// purpose: get where a bucket ends
+// preconditions: bucket is between 0 and NUM_BUCKETS - 1
+// postconditions: returns 2^bucket
+
+// --------------------------------------------------------------------------------------
+double TraceHistogram::upperBound(int bucket)
+{
+	return ldexp(1.0, bucket);
+}
+
+// ------------------------------------ add --------------------------------------
+
+// purpose: gather one more trace
+// preconditions: none
+// postconditions: every stage that ran, every counter and the image size of trace are counted;
+//	safe to call from several threads at once
+
+// --------------------------------------------------------------------------------------
+void TraceHistograms::add(const RecognitionTrace& trace)
+{
+	lock_guard<mutex> guard(lock);
+	numTraces++;
+	for (int stage = 0; stage < NUM_TRACE_STAGES; stage++)
+	{
+		if (trace.stageRan[stage]) stages[stage].add(trace.stageMs[stage] * 1000);
+	}
+	for (int counter = 0; counter < NUM_TRACE_COUNTERS; counter++)
+	{
+		counters[counter].add((double)trace.counts[counter]);
+	}
+	pixels.add((double)trace.imageSize.area());
+}
+
+// ------------------------------------ clear --------------------------------------
+
+// purpose: start gathering again
+// preconditions: none
+// postconditions: no trace is counted
+
+// --------------------------------------------------------------------------------------
+void TraceHistograms::clear()
+{
+	lock_guard<mutex> guard(lock);
+	numTraces = 0;
+	for (int stage = 0; stage < NUM_TRACE_STAGES; stage++)
+	{
+		stages[stage] = TraceHistogram();
+	}
+	for (int counter = 0; counter < NUM_TRACE_COUNTERS; counter++)
+	{
+		counters[counter] = TraceHistogram();
+	}
+	pixels = TraceHistogram();
+}
+
+// ------------------------------------ count --------------------------------------
+
+// purpose: get how many traces were gathered
+// preconditions: none
+// postconditions: returns the number of calls to add since the last clear
+
+// --------------------------------------------------------------------------------------
+long long TraceHistograms::count() const
+{
+	lock_guard<mutex> guard(lock);
+	return numTraces;
+}
+
+// ------------------------------------ writeText --------------------------------------
+
+// purpose: write a table of the histograms for people to read
+// preconditions: none
+// postconditions: one line per stage, counter and the image size is written to out, with the
+//	count, minimum, median, 90th and 99th percentiles, maximum and mean
+
+// --------------------------------------------------------------------------------------
+void TraceHistograms::writeText(ostream& out) const
+{
+	lock_guard<mutex> guard(lock);
+	out << "recognitions: " << numTraces << endl;
+	writeTextLine(out, "stage (ms)", TraceHistogram(), 0, -1);
+	for (int stage = 0; stage < NUM_TRACE_STAGES; stage++)
+	{
+		writeTextLine(out, traceStageName((TraceStage)stage), stages[stage], 0.001, 3);
+	}
+	writeTextLine(out, "counter", TraceHistogram(), 0, -1);
+	for (int counter = 0; counter < NUM_TRACE_COUNTERS; counter++)
+	{
+		writeTextLine(out, traceCounterName((TraceCounter)counter), counters[counter], 1, 0);
+	}
+	writeTextLine(out, "pixels", pixels, 1, 0);
+}
+
+// ------------------------------------ writeTextLine --------------------------------------
+
+// purpose: write the summary of one histogram as a line of the table
+// preconditions: scale converts the counted values into the unit shown
+// postconditions: name and the summary, with decimals digits after the point, are written to out;
+//	with decimals below 0 the column headings are written instead
+
+// --------------------------------------------------------------------------------------
+void TraceHistograms::writeTextLine(ostream& out, const string& name, const TraceHistogram& histogram,
+	double scale, int decimals)
+{
+	if (decimals < 0)
+	{
+		out << left << setw(24) << name << right << setw(10) << "count" << setw(12) << "min" <<
+			setw(12) << "p50" << setw(12) << "p90" << setw(12) << "p99" << setw(12) << "max" <<
+			setw(12) << "mean" << endl;
+		return;
+	}
+
+	double mean = histogram.count == 0 ? 0 : histogram.sum / histogram.count;
+	out << left << setw(24) << name << right << setw(10) << histogram.count << fixed << setprecision(decimals) <<
+		setw(12) << histogram.minValue * scale << setw(12) << histogram.percentile(0.5) * scale <<
+		setw(12) << histogram.percentile(0.9) * scale << setw(12) << histogram.percentile(0.99) * scale <<
+		setw(12) << histogram.maxValue * scale << setw(12) << mean * scale << defaultfloat << setprecision(6) << endl;
+}
+
+// ------------------------------------ writeJson --------------------------------------
+
+// purpose: write the histograms for tools to read
+// preconditions: none
+// postconditions: one JSON object, terminated by a newline, is written to out with the summary
+//	of every stage, counter and the image size, and the counts of their non-empty buckets
+
+// --------------------------------------------------------------------------------------
+void TraceHistograms::writeJson(ostream& out) const
+{
+	lock_guard<mutex> guard(lock);
+	// byte counts run into the billions, more digits than the default six
+	streamsize precision = out.precision(15);
+	out << "{\"recognitions\":" << numTraces;
+
+	out << ",\"stages\":{";
+	for (int stage = 0; stage < NUM_TRACE_STAGES; stage++)
+	{
+		if (stage > 0) out << ",";
+		out << "\"" << traceStageName((TraceStage)stage) << "\":";
+		writeJsonHistogram(out, stages[stage], 0.001, "Ms");
+	}
+	out << "},\"counters\":{";
+	for (int counter = 0; counter < NUM_TRACE_COUNTERS; counter++)
+	{
+		if (counter > 0) out << ",";
+		out << "\"" << traceCounterName((TraceCounter)counter) << "\":";
+		writeJsonHistogram(out, counters[counter], 1, "");
+	}
+	out << "},\"pixels\":";
+	writeJsonHistogram(out, pixels, 1, "");
+	out << "}" << endl;
+	out.precision(precision);
+}
+
+// ------------------------------------ writeJsonHistogram --------------------------------------
+
+// purpose: write one histogram as a JSON object
+// preconditions: scale converts the counted values into the unit named by suffix
+// postconditions: the summary, each key ending in suffix, and the non-empty buckets as pairs of
+//	upper bound and count are written to out
+
+// --------------------------------------------------------------------------------------
+void TraceHistograms::writeJsonHistogram(ostream& out, const TraceHistogram& histogram, double scale,
+	const string& suffix)
+{
+	double mean = histogram.count == 0 ? 0 : histogram.sum / histogram.count;
+	out << "{\"count\":" << histogram.count;
+	out << ",\"min" << suffix << "\":" << histogram.minValue * scale;
+	out << ",\"p50" << suffix << "\":" << histogram.percentile(0.5) * scale;
+	out << ",\"p90" << suffix << "\":" << histogram.percentile(0.9) * scale;
+	out << ",\"p99" << suffix << "\":" << histogram.percentile(0.99) * scale;
+	out << ",\"max" << suffix << "\":" << histogram.maxValue * scale;
+	out << ",\"mean" << suffix << "\":" << mean * scale;
+
+	out << ",\"buckets\":[";
+	bool first = true;
+	for (int bucket = 0; bucket < TraceHistogram::NUM_BUCKETS; bucket++)
+	{
+		if (histogram.buckets[bucket] == 0) continue;
+		if (!first) out << ",";
+		out << "[" << TraceHistogram::upperBound(bucket) * scale << "," << histogram.buckets[bucket] << "]";
+		first = false;
+	}
+	out << "]}";
+}
+
+// ------------------------------------ traceStageName --------------------------------------
+
+// purpose: get the name used for a stage in the exports
+// preconditions: none
+// postconditions: returns the camel case name of stage (e.g. "findContours")
+
+// --------------------------------------------------------------------------------------
+const char* traceStageName(TraceStage stage)
+{
+	switch (stage)
+	{
+	case TraceStage::Total: return "total";
+	case TraceStage::Decode: return "decode";
+	case TraceStage::Pyramid: return "pyramid";
+	case TraceStage::GrayThreshold: return "grayThreshold";
+	case TraceStage::FindContours: return "findContours";
+	case TraceStage::Classify: return "classify";
+	case TraceStage::EraseParentContour: return "eraseParentContour";
+	default: return "determineWeakTypes";
+	}
+}
+
+// ------------------------------------ traceCounterName --------------------------------------
+
+// purpose: get the name used for a counter in the exports
+// preconditions: none
+// postconditions: returns the camel case name of counter (e.g. "nestedCalls")
+
+// --------------------------------------------------------------------------------------
+const char* traceCounterName(TraceCounter counter)
+{
+	switch (counter)
+	{
+	case TraceCounter::Contours: return "contours";
+	case TraceCounter::Candidates: return "candidates";
+	case TraceCounter::Classified: return "classified";
+	case TraceCounter::WithoutOuterContour: return "withoutOuterContour";
+	case TraceCounter::Shapes: return "shapes";
+	case TraceCounter::NestedCalls: return "nestedCalls";
+	case TraceCounter::Allocations: return "allocations";
+	default: return "allocatedBytes";
+	}
+}
@@ -0,0 +1,269 @@
+// RecognitionTrace.h
+// Purpose: show where the time of a slow recognition goes, without slowing down release builds
+// Functionality: RecognitionTrace holds what one recognition measured: the wall time of each
+//	stage, how many contours were left after each filter, the isNested calls, the bytes
+//	allocated and the image size. TraceHistograms gathers the traces of many recognitions into
+//	power of two histograms and writes them as text or JSON. The ERD_TRACE_ macros are what
+//	recognition calls; they do nothing unless the program is built with ERD_INSTRUMENT defined
+// Assumptions:
+//	Without ERD_INSTRUMENT every trace stays empty and the macros compile to nothing
+//	Allocations are only counted once AllocationStats::install has been called, and heap
+//	allocations outside of Mat only with ERD_COUNT_ALLOCATIONS as well
+// Authors: Allan Genari Gaarden, Tommy Ni, Joshua Medvinsky
+
+#ifndef RECOGNITION_TRACE_H
+#define RECOGNITION_TRACE_H
+
+#include <opencv2/core.hpp>
+#include <iostream>
+#include <mutex>
+#include "AllocationStats.h"
+using namespace std;
+using namespace cv;
+
+#ifdef ERD_INSTRUMENT
+#define ERD_TRACE_BEGIN(trace) (trace).begin()
+#define ERD_TRACE_END(trace, imageSize) (trace).end(imageSize)
+#define ERD_TRACE_START(trace, stage) (trace).start(stage)
+#define ERD_TRACE_STOP(trace, stage) (trace).stop(stage)
+#define ERD_TRACE_ADD(trace, counter, value) (trace).add(counter, value)
+#else
+#define ERD_TRACE_BEGIN(trace) ((void)0)
+#define ERD_TRACE_END(trace, imageSize) ((void)0)
+#define ERD_TRACE_START(trace, stage) ((void)0)
+#define ERD_TRACE_STOP(trace, stage) ((void)0)
+#define ERD_TRACE_ADD(trace, counter, value) ((void)0)
+#endif
+
+// the timed parts of a recognition; Total covers all of them
+enum class TraceStage
+{
+	Total,
+	Decode,
+	Pyramid,
+	GrayThreshold,
+	FindContours,
+	Classify,
+	EraseParentContour,
+	DetermineWeakTypes
+};
+
+// number of TraceStage values, used to size per stage arrays
+const int NUM_TRACE_STAGES = (int)TraceStage::DetermineWeakTypes + 1;
+
+// the counts of a recognition; the first five are what is left after each filter, in order
+enum class TraceCounter
+{
+	Contours,
+	Candidates,
+	Classified,
+	WithoutOuterContour,
+	Shapes,
+	NestedCalls,
+	Allocations,
+	AllocatedBytes
+};
+
+// number of TraceCounter values, used to size per counter arrays
+const int NUM_TRACE_COUNTERS = (int)TraceCounter::AllocatedBytes + 1;
+
+// what one recognition measured
+struct RecognitionTrace
+{
+	Size imageSize;
+	// milliseconds spent in each stage, summed over every time it ran
+	double stageMs[NUM_TRACE_STAGES] = {};
+	// whether each stage ran at all, so stages a mode skips are left out of the histograms
+	bool stageRan[NUM_TRACE_STAGES] = {};
+	long long counts[NUM_TRACE_COUNTERS] = {};
+
+	// ------------------------------------ enabled --------------------------------------
+
+// purpose: tell whether recognition fills in its trace
+// preconditions: none
+// postconditions: returns true if the program was built with ERD_INSTRUMENT
+
+// --------------------------------------------------------------------------------------
+	static bool enabled();
+	// ------------------------------------ begin --------------------------------------
+
+// purpose: start the trace of a new recognition
+// preconditions: none
+// postconditions: everything is cleared, and the total time and allocations are measured from now
+
+// --------------------------------------------------------------------------------------
+	void begin();
+	// ------------------------------------ end --------------------------------------
+
+// purpose: finish the trace of a recognition
+// preconditions: begin has been called
+// postconditions: the total time and the allocations since begin are stored, with imageSize
+
+// --------------------------------------------------------------------------------------
+	void end(Size imageSize);
+	// ------------------------------------ start --------------------------------------
+
+// purpose: start timing a stage
+// preconditions: none
+// postconditions: the next stop of stage adds the time from now to it
+
+// --------------------------------------------------------------------------------------
+	void start(TraceStage stage);
+	// ------------------------------------ stop --------------------------------------
+
+// purpose: stop timing a stage
+// preconditions: start has been called for stage
+// postconditions: the time since start is added to the stage, so a stage run once per region
+//	holds the time of every region
+
+// --------------------------------------------------------------------------------------
+	void stop(TraceStage stage);
+	// ------------------------------------ add --------------------------------------
+
+// purpose: count something
+// preconditions: none
+// postconditions: value is added to counter
+
+// --------------------------------------------------------------------------------------
+	void add(TraceCounter counter, long long value);
+
+private:
+	int64 startTicks[NUM_TRACE_STAGES] = {};
+	AllocationCounts startAllocations;
+};
+
+// counts of values falling in power of two buckets
+struct TraceHistogram
+{
+	// bucket 0 holds values below 1, bucket b the values from 2^(b-1) up to 2^b
+	static const int NUM_BUCKETS = 64;
+
+	long long buckets[NUM_BUCKETS] = {};
+	long long count = 0;
+	double sum = 0;
+	double minValue = 0;
+	double maxValue = 0;
+
+	// ------------------------------------ add --------------------------------------
+
+// purpose: count one value
+// preconditions: value is at least 0
+// postconditions: the bucket of value and the totals include it
+
+// --------------------------------------------------------------------------------------
+	void add(double value);
+	// ------------------------------------ percentile --------------------------------------
+
+// purpose: estimate the value a fraction of the values are at or below
+// preconditions: fraction is between 0 and 1
+// postconditions: returns the upper end of the bucket holding that value, but no more than
+//	maxValue; 0 if nothing was counted
+
+// --------------------------------------------------------------------------------------
+	double percentile(double fraction) const;
+	// ------------------------------------ upperBound --------------------------------------
+
+// purpose: get where a bucket ends
+// preconditions: bucket is between 0 and NUM_BUCKETS - 1
+// postconditions: returns 2^bucket
+
+// --------------------------------------------------------------------------------------
+	static double upperBound(int bucket);
+};
+
+class TraceHistograms
+{
+public:
+	// ------------------------------------ add --------------------------------------
+
+// purpose: gather one more trace
+// preconditions: none
+// postconditions: every stage that ran, every counter and the image size of trace are counted;
+//	safe to call from several threads at once
+
+// --------------------------------------------------------------------------------------
+	void add(const RecognitionTrace& trace);
+	// ------------------------------------ clear --------------------------------------
+
+// purpose: start gathering again
+// preconditions: none
+// postconditions: no trace is counted
+
+// --------------------------------------------------------------------------------------
+	void clear();
+	// ------------------------------------ count --------------------------------------
+
+// purpose: get how many traces were gathered
+// preconditions: none
+// postconditions: returns the number of calls to add since the last clear
+
+// --------------------------------------------------------------------------------------
+	long long count() const;
+	// ------------------------------------ writeText --------------------------------------
+
+// purpose: write a table of the histograms for people to read
+// preconditions: none
+// postconditions: one line per stage, counter and the image size is written to out, with the
+//	count, minimum, median, 90th and 99th percentiles, maximum and mean
+
+// --------------------------------------------------------------------------------------
+	void writeText(ostream& out) const;
+	// ------------------------------------ writeJson --------------------------------------
+
+// purpose: write the histograms for tools to read
+// preconditions: none
+// postconditions: one JSON object, terminated by a newline, is written to out with the summary
+//	of every stage, counter and the image size, and the counts of their non-empty buckets
+
+// --------------------------------------------------------------------------------------
+	void writeJson(ostream& out) const;
+
+private:
+	mutable mutex lock;
+	long long numTraces = 0;
+	// stage times are counted in microseconds so stages under a millisecond spread over buckets
+	TraceHistogram stages[NUM_TRACE_STAGES];
+	TraceHistogram counters[NUM_TRACE_COUNTERS];
+	TraceHistogram pixels;
+
+	// ------------------------------------ writeTextLine --------------------------------------
+
+// purpose: write the summary of one histogram as a line of the table
+// preconditions: scale converts the counted values into the unit shown
+// postconditions: name and the summary, with decimals digits after the point, are written to out;
+//	with decimals below 0 the column headings are written instead
+
+// --------------------------------------------------------------------------------------
+	static void writeTextLine(ostream& out, const string& name, const TraceHistogram& histogram,
+		double scale, int decimals);
+	// ------------------------------------ writeJsonHistogram --------------------------------------
+
+// purpose: write one histogram as a JSON object
+// preconditions: scale converts the counted values into the unit named by suffix
+// postconditions: the summary, each key ending in suffix, and the non-empty buckets as pairs of
+//	upper bound and count are written to out
+
+// --------------------------------------------------------------------------------------
+	static void writeJsonHistogram(ostream& out, const TraceHistogram& histogram, double scale,
+		const string& suffix);
+};
+
+// ------------------------------------ traceStageName --------------------------------------
+
+// purpose: get the name used for a stage in the exports
+// preconditions: none
+// postconditions: returns the camel case name of stage (e.g. "findContours")
+
+// --------------------------------------------------------------------------------------
+const char* traceStageName(TraceStage stage);
+
+// ------------------------------------ traceCounterName --------------------------------------
+
+// purpose: get the name used for a counter in the exports
+// preconditions: none
+// postconditions: returns the camel case name of counter (e.g. "nestedCalls")
+
+// --------------------------------------------------------------------------------------
+const char* traceCounterName(TraceCounter counter);
+
+#endif
@@ -1,7 +1,8 @@
 // RecognizeERDiagram.cpp
 // Purpose: recognize and label different entity types in a given hand drawn ER diagram
 // Functionality: given a hand drawn ER diagram image, produces an image that boxes
-//	and labels each entity type in the diagram appropriately
+//	and labels each entity type in the diagram appropriately. The recognition itself is done by
+//	RecognitionCore in buffers the recognizer keeps between images, so they can be drawn
 // Assumptions: 
 //	Image used is a valid image ressembling an ER diagram
 //	None of the objects drawn are touching the border of the image
@@ -10,221 +11,6 @@
 
 #include "RecognizeERDiagram.h"
 
-// ------------------------------------ recognizeDiagram --------------------------------------
-
-// purpose: identify each object in the image
-// preconditions: the image has already been defined
-// postconditions: every object's contour in the image is stored in the appropriate type vector
-
-// --------------------------------------------------------------------------------------
-void RecognizeERDiagram::recognizeDiagram()
-{
-	int minThreshold = 150;
-	int maxThreshold = 255;
-	// prepares image to find all contours
-	Mat grayImage;
-	cvtColor(image, grayImage, COLOR_BGR2GRAY);
-	Mat thresh;
-	threshold(grayImage, thresh, minThreshold, maxThreshold, THRESH_BINARY);
-
-	findContours(thresh, contours, hierarchy, RETR_TREE, CHAIN_APPROX_NONE);
-
-	// populates type vectors (except weak types)
-	detectShapes();
-
-	// gets rid of the unecessary outer contour
-	eraseParentContour();
-
-	// distinguishes weak types 
-	determineWeakType(entities, weakEntities);
-	determineWeakType(relationships, weakRelationships);
-	determineWeakType(attributes, weakAttributes);
-}
-
-// ------------------------------------ detectShapes --------------------------------------
-
-// purpose: populate vector types (except weak types)
-// preconditions: contours vector has been populated 
-// postconditions: populates all vector types, except weak types
-// This method structure was inspired by http://www.calumk.com/old_posts_archive/0008//detecting-simple-shapes-in-an-image/
-// We made edits to the code to not check for angles of the shapes
-// as we only deal with rectangles/squares.
-
-// --------------------------------------------------------------------------------------
-void RecognizeERDiagram::detectShapes() 
-{
-	vector<Point> approx;
-	int thresholdAreaForRect = 500;
-	int thresholdAreaForCircle = 500;
-	double thresholdRatioForSqar = 0.2;
-	// goes through every contour
-	for (size_t i = 0; i < contours.size(); i++) 
-	{
-		// checks if contour is touching border
-		if (contourTouchesBorder(contours[i], image.size()) == false) 
-		{
-			approxPolyDP(Mat(contours[i]), approx,
-				arcLength(Mat(contours[i]), true) * 0.02, true);
-
-			// distinguishes between square and rectangle
-			if (approx.size() == 4 &&
-				fabs(contourArea(Mat(approx))) > thresholdAreaForRect &&
-				isContourConvex(Mat(approx)))
-			{
-
-				Rect r = boundingRect(contours[i]);
-				double ratio = abs(1 - (double)r.width / r.height);
-				if (ratio <= thresholdRatioForSqar) // if sides are mostly similar in length, it is a square
-				{
-					relationships.push_back(approx);
-				}
-				else // otherwise it is a rectangle
-				{
-					entities.push_back(approx);
-				}
-			}
-			else if (approx.size() > 6) // if greater than 6 vertices, it is a circle
-			{
-				if(fabs(contourArea(Mat(approx))) > thresholdAreaForCircle) attributes.push_back(approx);
-			}
-		}
-		else 
-		{
-			//delete contour from contours vector if  current contour touches border
-			contours.erase(contours.begin() + i);
-		}
-	}
-}
-
-// ------------------------------------ contourTouchesBorder --------------------------------------
-
-// purpose: helper method checks if contour touches the border
-// preconditions: using intended contour, and image size is the image's size
-// postconditions: returns true or false based on if the contour is touching the border
-
-// --------------------------------------------------------------------------------------
-bool RecognizeERDiagram::contourTouchesBorder(const vector<Point>& contour, const Size& imageSize)
-{
-	Rect shape = boundingRect(contour);
-	// created ints to represent the mins and maxes for x and y respectively
-	int xMin, xMax, yMin, yMax;
-	//set x and y min to 0
-	xMin = 0;
-	yMin = 0;
-	//set x to the images width-1, and y to image height-1
-	xMax = imageSize.width - 1;
-	yMax = imageSize.height - 1;
-
-	int shapeEndX = shape.x + shape.width - 1;
-	int shapeEndY = shape.y + shape.height - 1;
-	// if the min or max coordinates of the contour are outside the range of the image, returns true
-	if (shape.x <= xMin || shape.y <= yMin || shapeEndX >= xMax || shapeEndY >= yMax)
-	{
-		return true;
-	}
-	//returns false if coordinates of the contour are in range
-	return false;
-}
-
-// ------------------------------------ eraseParentContour --------------------------------------
-
-// purpose: to get rid of the outer contour, if there is one
-// preconditions: attributes vector has been populated
-// postconditions: removes the outer contour from the vector
-
-// --------------------------------------------------------------------------------------
-void RecognizeERDiagram::eraseParentContour()
-{
-	int thresholdForOutsideContour = 20000;
-	for (size_t i = 0; i < attributes.size(); i++)
-	{
-		// given an ER diagram, the outer contour, if it exists, is almost guaranteed to be recognized 
-		//	as an attribute. this outer contour is removed based on a reasonable size requirement
-		if (contourArea(attributes[i]) > thresholdForOutsideContour)
-		{
-			attributes.erase(attributes.begin() + i);
-		}
-	}
-}
-
-// ------------------------------------ determineWeakType --------------------------------------
-
-// purpose: seperates the weak from the strong of a given type
-// preconditions: pointer to the vector containing the type to seperate, and the pointer to the vector
-// //	the weak type will be stored in
-// postconditions: all strong types will be left in type and all the weak types found in type will be 
-// removed and stored in the weakType vector
-
-// --------------------------------------------------------------------------------------
-void RecognizeERDiagram::determineWeakType(vector<vector<Point>>& type, vector<vector<Point>>& weakType)
-{
-	// compares each contour against all other contours to see if it is nested
-	for (int i = 0; i < type.size(); i++)
-	{
-		for (int j = 0; j < type.size(); j++)
-		{
-			if(isNested(type[i], type[j])) // if [i] is nested inside [j]
-			{
-				// consider [j] a weak entity if it is not already
-				if (indexOfShape(type[j], weakType) == -1) weakType.push_back(type[j]);
-				// remove [i] from type, since it is part of a weak entity
-				type.erase(type.begin() + i); 
-				// if [i] is removed, need to reset for check on next element
-				i--;
-				break;
-			}
-		}
-	}
-
-	// removes any weak entities from entities
-	int index;
-	for (int i = 0; i < weakType.size(); i++)
-	{
-		index = indexOfShape(weakType[i], type);
-		if (index != -1) type.erase(type.begin() + index);
-	}
-}
-
-// ------------------------------------ isNested --------------------------------------
-
-// purpose: determines if contour1 is inside contour2
-// preconditions: contour1 and contour 2 are valid contours
-// postconditions: returns true if contour1 is inside contour2, false if not
-
-// --------------------------------------------------------------------------------------
-bool RecognizeERDiagram::isNested(const vector<Point>& contour1, const vector<Point>& contour2)
-{
-	// determine upperLeft and lowerRight points for both contours
-	Point upperLeft1 = contour1[0];
-	Point lowerRight1 = contour1[0];
-	Point upperLeft2 = contour2[0];
-	Point lowerRight2 = contour2[0];
-
-	for (int i = 0; i < contour1.size(); i++)
-	{
-		if (contour1[i].x < upperLeft1.x) upperLeft1.x = contour1[i].x;
-		if (contour1[i].y < upperLeft1.y) upperLeft1.y = contour1[i].y;
-		if (contour1[i].x > lowerRight1.x) lowerRight1.x = contour1[i].x;
-		if (contour1[i].y > lowerRight1.y) lowerRight1.y = contour1[i].y;
-	}
-	for(int i = 0; i < contour2.size(); i++)
-	{
-		if (contour2[i].x < upperLeft2.x) upperLeft2.x = contour2[i].x;
-		if (contour2[i].y < upperLeft2.y) upperLeft2.y = contour2[i].y;
-		if (contour2[i].x > lowerRight2.x) lowerRight2.x = contour2[i].x;
-		if (contour2[i].y > lowerRight2.y) lowerRight2.y = contour2[i].y;
-	}
-
-	// check if nested
-	if (upperLeft2.x < upperLeft1.x && upperLeft2.y < upperLeft1.y && lowerRight2.x > lowerRight1.x && 
-		lowerRight2.y > lowerRight1.y)
-	{
- 		return true;
-	}
-
-	return false;
-}
-
 // ------------------------------------ drawOriginalImage --------------------------------------
 
 // purpose: display the original, unmodified input image
@@ -249,7 +35,10 @@ void RecognizeERDiagram::drawOriginalImage()
 void RecognizeERDiagram::drawAllContours()
 {
 	Mat imageCopy = image.clone();
-	drawContours(imageCopy, contours, -1, contourColor, 2);
+	for (size_t i = 0; i < scratch.candidateContours.size(); i++)
+	{
+		drawContours(imageCopy, scratch.contours, scratch.candidateContours[i], contourColor, 2);
+	}
 	imshow("All Contours", imageCopy);
 	resizeWindow("All Contours", imageCopy.cols, imageCopy.rows);
 }
@@ -264,15 +53,19 @@ void RecognizeERDiagram::drawAllContours()
 void RecognizeERDiagram::drawColorCodedContours()
 {
 	int thickness = 2;
-	int contourid = -1;
 	Mat imageCopy(image.size(), image.type());
-	drawContours(imageCopy, contours, contourid, contourColor, thickness);
-	drawContours(imageCopy, entities, contourid, entityColor, thickness);
-	drawContours(imageCopy, relationships, contourid, relationshipColor, thickness);
-	drawContours(imageCopy, attributes, contourid, attributeColor, thickness);
-	drawContours(imageCopy, weakEntities, contourid, weakEntityColor, thickness);
-	drawContours(imageCopy, weakRelationships, contourid, weakRelationshipColor, thickness);
-	drawContours(imageCopy, weakAttributes, contourid, weakAttributeColor, thickness);
+	for (size_t i = 0; i < scratch.candidateContours.size(); i++)
+	{
+		drawContours(imageCopy, scratch.contours, scratch.candidateContours[i], contourColor, thickness);
+	}
+	const ShapeTable& shapes = result.shapes;
+	for (int id = 0; id < shapes.size(); id++)
+	{
+		if (shapes.getType(id) == ShapeType::Discarded) continue;
+		const Point* points = shapes.getPoints(id);
+		int numPoints = shapes.getNumPoints(id);
+		polylines(imageCopy, &points, &numPoints, 1, true, getTypeColor(shapes.getType(id)), thickness);
+	}
 	namedWindow("Color Coded Contours", WINDOW_NORMAL);
 	imshow("Color Coded Contours", imageCopy);
 	resizeWindow("Color Coded Contours", imageCopy.cols, imageCopy.rows);
@@ -287,46 +80,68 @@ void RecognizeERDiagram::drawColorCodedContours()
 // --------------------------------------------------------------------------------------
 void RecognizeERDiagram::drawRectForShapes()
 {
-	Mat imageCopy = image.clone();
-	if (!entities.empty()) drawRectsForSpecificShape(entities, imageCopy, entityColor);
-	if (!relationships.empty()) drawRectsForSpecificShape(relationships, imageCopy, relationshipColor);
-	if (!attributes.empty()) drawRectsForSpecificShape(attributes, imageCopy, attributeColor);
-	if (!weakEntities.empty()) drawRectsForSpecificShape(weakEntities, imageCopy, weakEntityColor);
-	if (!weakRelationships.empty()) drawRectsForSpecificShape(weakRelationships, imageCopy, 
-		weakRelationshipColor);
-	if (!weakAttributes.empty()) drawRectsForSpecificShape(weakAttributes, imageCopy, weakAttributeColor);
+	Mat imageCopy = renderRectForShapes();
 	namedWindow("Color Coded Shapes", WINDOW_NORMAL);
 	resizeWindow("Color Coded Shapes", imageCopy.cols, imageCopy.rows);
 	imshow("Color Coded Shapes", imageCopy);
 }
 
+// ------------------------------------ renderRectForShapes --------------------------------------
+
+// purpose: box and label all the shapes without displaying anything
+// preconditions: image has been defined and all type vectors have been populated as intended
+// postconditions: returns a copy of the image with all the objects boxed and labeled appropriately;
+//	throws cv::Exception if the image was not kept (see setKeepImage)
+
+// --------------------------------------------------------------------------------------
+Mat RecognizeERDiagram::renderRectForShapes()
+{
+	if (image.empty()) CV_Error(Error::StsError, "the image was not kept, so it cannot be rendered");
+	Mat imageCopy;
+	renderShapes(image, result.shapes, imageCopy);
+	return imageCopy;
+}
+
+// ------------------------------------ renderShapes --------------------------------------
+
+// purpose: box and label the shapes of any image, e.g. ones recognized by another recognizer
+// preconditions: image is a valid BGR image and shapes are in its coordinates
+// postconditions: rendered is a copy of image with every shape of shapes boxed and labeled; its
+//	memory is reused if it already has the size of image
+
+// --------------------------------------------------------------------------------------
+void RecognizeERDiagram::renderShapes(const Mat& image, const ShapeTable& shapes, Mat& rendered)
+{
+	image.copyTo(rendered);
+	drawRectsForSpecificShape(ShapeType::Entity, shapes, rendered, entityColor);
+	drawRectsForSpecificShape(ShapeType::Relationship, shapes, rendered, relationshipColor);
+	drawRectsForSpecificShape(ShapeType::Attribute, shapes, rendered, attributeColor);
+	drawRectsForSpecificShape(ShapeType::WeakEntity, shapes, rendered, weakEntityColor);
+	drawRectsForSpecificShape(ShapeType::WeakRelationship, shapes, rendered, weakRelationshipColor);
+	drawRectsForSpecificShape(ShapeType::MultivaluedAttribute, shapes, rendered, weakAttributeColor);
+}
+
 // ------------------------------------ drawRectsForSpecificShape --------------------------------------
 
 // purpose: boxes and labels all the shapes of a specific type
-// preconditions: using a valid type, a valid image, and intended color
+// preconditions: using a valid type, shapes in the coordinates of a valid image, and intended color
 // postconditions: image is modified to box and label all the shapes of a specific type with color 
 //	equal to color passed in
 
 // --------------------------------------------------------------------------------------
-void RecognizeERDiagram::drawRectsForSpecificShape(vector<vector<Point>> currentShape, Mat& 
-	imageCopy, const Scalar color)
-{
-	Point upperLeft = currentShape[0][0];
-	Point lowerRight = currentShape[0][0];
-	int boundingBoxOffByPixel = 10;
-	// goes through every shape
-	for (int i = 0; i < currentShape.size(); i++) 
+void RecognizeERDiagram::drawRectsForSpecificShape(ShapeType type, const ShapeTable& shapes, Mat& imageCopy,
+	const Scalar color)
+{
+	int boundingBoxOffByPixel = params.boundingBoxOffByPixel;
+	// goes through every shape of the type
+	for (int id = 0; id < shapes.size(); id++) 
 	{
-		upperLeft = currentShape[i][0];
-		lowerRight = currentShape[i][0];
+		if (shapes.getType(id) != type) continue;
+
 		// determine coordinates to draw box
-		for (int j = 0; j < currentShape[i].size(); j++) 
-		{
-			if (currentShape[i][j].x < upperLeft.x) upperLeft.x = currentShape[i][j].x;
-			if (currentShape[i][j].y < upperLeft.y) upperLeft.y = currentShape[i][j].y;
-			if (currentShape[i][j].x > lowerRight.x) lowerRight.x = currentShape[i][j].x;
-			if (currentShape[i][j].y > lowerRight.y) lowerRight.y = currentShape[i][j].y;
-		}
+		const Rect& box = shapes.getBoundingBox(id);
+		Point upperLeft = box.tl();
+		Point lowerRight(box.x + box.width - 1, box.y + box.height - 1);
 		
 		// extend box to envelop the shape
 		upperLeft.x -= boundingBoxOffByPixel;
@@ -334,154 +149,335 @@ void RecognizeERDiagram::drawRectsForSpecificShape(vector<vector<Point>> current
 		lowerRight.x += boundingBoxOffByPixel;
 		lowerRight.y += boundingBoxOffByPixel;
 		rectangle(imageCopy, upperLeft, lowerRight, color, 2);
-		labelShape(imageCopy, color, upperLeft);
+		labelShape(imageCopy, type, color, upperLeft);
 	}
 }
 
 // ------------------------------------ labelShape --------------------------------------
 
 // purpose: to label a shape on the given image
-// preconditions: valid image using a predefined type color and a point within the image
-// postconditions: labels the shape in the image based on the color passed in at the point given
+// preconditions: valid image, the shape's type and color, and a point within the image
+// postconditions: labels the shape in the image with the name of its type at the point given
 
 // --------------------------------------------------------------------------------------
-void RecognizeERDiagram::labelShape(Mat& imageCopy, const Scalar color, Point upperLeft)
+void RecognizeERDiagram::labelShape(Mat& imageCopy, ShapeType type, const Scalar color, Point upperLeft)
 {
 	upperLeft.y -= 3;
 	int thickness = 1;
 	double fontSize = 0.5;
-	//if entity color, then entity type
-	if (color == entityColor)
-	{
-		putText(imageCopy, "Entity", upperLeft, FONT_HERSHEY_SIMPLEX, fontSize, color, thickness);
-	}
-	//if relationship color, then relationship type
-	if (color == relationshipColor)
-	{
-		putText(imageCopy, "Relationship", upperLeft, FONT_HERSHEY_SIMPLEX, fontSize, color, thickness);
-	}
-	//if attribute color, then attribute type
-	if (color == attributeColor)
-	{
-		putText(imageCopy, "Attribute", upperLeft, FONT_HERSHEY_SIMPLEX, fontSize, color, thickness);
-	}
-	//if weak entity color, then weak entity type
-	if (color == weakEntityColor)
-	{
-		putText(imageCopy, "Weak Entity", upperLeft, FONT_HERSHEY_SIMPLEX, fontSize, color, thickness);
-	}
-	//if weak relationship color, then weak relationship type
-	if (color == weakRelationshipColor)
-	{
-		putText(imageCopy, "Weak Relationship", upperLeft, FONT_HERSHEY_SIMPLEX, fontSize, color, thickness);
-	}
-	//if weak attribute color, then weak attribute type
-	if (color == weakAttributeColor)
-	{
-		putText(imageCopy, "Multivalued Attribute", upperLeft, FONT_HERSHEY_SIMPLEX, fontSize, color, thickness);
-	}
+	putText(imageCopy, shapeTypeName(type), upperLeft, FONT_HERSHEY_SIMPLEX, fontSize, color, thickness);
 }
 
-// ------------------------------------ indexOfShape --------------------------------------
+// ------------------------------------ getTypeColor --------------------------------------
 
-// purpose: to return the index of a target shape inside a type vector to search
-// preconditions: target shape and search shape are defined
-// postconditions: returns index of target in search vector, otherwise returns -1
+// purpose: get the predefined color of a shape type
+// preconditions: none
+// postconditions: returns the color used to draw shapes of the given type
 
 // --------------------------------------------------------------------------------------
-int RecognizeERDiagram::indexOfShape(const vector<Point>& targetShape, 
-	const vector<vector<Point>>& searchShape)
+Scalar RecognizeERDiagram::getTypeColor(ShapeType type)
 {
-	for (int i = 0; i < searchShape.size(); i++)
+	switch (type)
 	{
-		if (targetShape == searchShape[i]) return i;
+	case ShapeType::Entity: return entityColor;
+	case ShapeType::Relationship: return relationshipColor;
+	case ShapeType::Attribute: return attributeColor;
+	case ShapeType::WeakEntity: return weakEntityColor;
+	case ShapeType::WeakRelationship: return weakRelationshipColor;
+	case ShapeType::MultivaluedAttribute: return weakAttributeColor;
+	default: return contourColor;
 	}
-	return -1;
+}
+
+// ------------------------------------ default constructor --------------------------------------
+
+// purpose: create a recognizer that is given its images later with recognize
+// preconditions: none
+// postconditions: no image is loaded and no shapes are stored
+
+// --------------------------------------------------------------------------------------
+RecognizeERDiagram::RecognizeERDiagram()
+{
 }
 
 // ------------------------------------ parameter constructor --------------------------------------
 
-// purpose: the only way to create an instance of the class
+// purpose: read an image file and recognize it right away
 // preconditions: fileName is a valid image in the directory
 // postconditions: image is read in and all object contours are stored in the appropriate type vector
 
 // --------------------------------------------------------------------------------------
 RecognizeERDiagram::RecognizeERDiagram(string fileName)
 {
-	image = imread(fileName);
-	recognizeDiagram();
+	recognize(imread(fileName));
+}
+
+// ------------------------------------ recognize --------------------------------------
+
+// purpose: recognize an image that is already in memory
+// preconditions: image is a valid 8 bit BGR image; it is not copied, so it must not be modified
+//	while its results are drawn
+// postconditions: the results of the previous image are replaced by the shapes of image; throws
+//	cv::Exception if image is empty
+
+// --------------------------------------------------------------------------------------
+void RecognizeERDiagram::recognize(const Mat& image)
+{
+	reset();
+	this->image = image;
+	RecognitionCore::recognize(image, params, scratch, result);
+	releaseImage();
+}
+
+// ------------------------------------ recognizeEncoded --------------------------------------
+
+// purpose: recognize an image from its encoded bytes (PNG, JPEG, ...) without a file
+// preconditions: data points to size bytes of an image file
+// postconditions: the image is decoded into a reused buffer and recognized; throws cv::Exception if
+//	the bytes cannot be decoded
+
+// --------------------------------------------------------------------------------------
+void RecognizeERDiagram::recognizeEncoded(const uchar* data, size_t size)
+{
+	reset();
+	// the bytes are decoded into the buffer of the previous image
+	RecognitionCore::recognizeEncoded(data, size, params, scratch, result);
+	image = scratch.decodedImage;
+	releaseImage();
+}
+
+// ------------------------------------ recognizeThresholded --------------------------------------
+
+// purpose: recognize an image whose threshold was already computed, e.g. by another thread
+// preconditions: image is a valid 8 bit BGR image and binary its threshold with the limits of
+//	params; neither is copied, so they must not be modified while the image is recognized
+// postconditions: the results of the previous image are replaced by the shapes of image; pyramid
+//	mode is not used since the full resolution threshold is already there
+
+// --------------------------------------------------------------------------------------
+void RecognizeERDiagram::recognizeThresholded(const Mat& image, const Mat& binary)
+{
+	reset();
+	this->image = image;
+	RecognitionCore::recognizeThresholded(binary, params, scratch, result);
+	releaseImage();
+}
+
+// ------------------------------------ reset --------------------------------------
+
+// purpose: forget the last image so the recognizer can be reused
+// preconditions: none
+// postconditions: no image and no shapes are stored; the threshold, contour and shape buffers
+//	keep their memory so the next image of the same size allocates almost nothing
+
+// --------------------------------------------------------------------------------------
+void RecognizeERDiagram::reset()
+{
+	// only the reference to the image is dropped; decodedImage keeps its buffer for imdecode
+	image.release();
+	result.imageSize = Size();
+	result.shapes.clear();
+	result.cascadeStats.clear();
+	scratch.candidateContours.clear();
+	scratch.hierarchy.clear();
+	// contours is left as it is: findContours resizes it in place, so each inner vector keeps
+	//	its capacity, while clearing it would free every one of them
+}
+
+// ------------------------------------ releaseImage --------------------------------------
+
+// purpose: drop the image once it is recognized, unless it is kept
+// preconditions: the image has been recognized
+// postconditions: when keepImage is false, the image and the buffer a decoded image was read into
+//	are released
+
+// --------------------------------------------------------------------------------------
+void RecognizeERDiagram::releaseImage()
+{
+	if (!keepImage)
+	{
+		image.release();
+		scratch.decodedImage.release();
+	}
+}
+
+// ------------------------------------ setParams --------------------------------------
+
+// purpose: change the limits used to recognize the next images, e.g. to turn on pyramid mode
+// preconditions: none
+// postconditions: the next recognize uses params
+
+// --------------------------------------------------------------------------------------
+void RecognizeERDiagram::setParams(const RecognitionParams& params)
+{
+	this->params = params;
+}
+
+// ------------------------------------ setLowMemory --------------------------------------
+
+// purpose: trade the buffers kept between images for less memory, e.g. for workers that hold
+//	many recognizers or recognize very large images
+// preconditions: none
+// postconditions: when lowMemory is true, the next images are traced with compressed contours
+//	(only the ends of straight runs are kept) and the threshold, contours, hierarchy and other
+//	scratch buffers are freed as soon as the shapes are classified, so only the shapes are held
+//	between images. Straight runs hold no corners, so the same shapes are found, though a
+//	polygon can gain or lose a vertex where the approximation had a tie. drawAllContours draws
+//	nothing then
+
+// --------------------------------------------------------------------------------------
+void RecognizeERDiagram::setLowMemory(bool lowMemory)
+{
+	scratch.lowMemory = lowMemory;
+}
+
+// ------------------------------------ setKeepImage --------------------------------------
+
+// purpose: choose whether the recognizer holds on to the image once it is recognized
+// preconditions: none
+// postconditions: when keepImage is false, the reference to the next images (and the buffer a
+//	decoded image was read into) is dropped once they are recognized, so the caller decides how
+//	long the pixels live; the images can then not be drawn or rendered
+
+// --------------------------------------------------------------------------------------
+void RecognizeERDiagram::setKeepImage(bool keepImage)
+{
+	this->keepImage = keepImage;
+}
+
+// ------------------------------------ getParams --------------------------------------
+
+// purpose: get the limits used to recognize images
+// preconditions: none
+// postconditions: returns the current parameters
+
+// --------------------------------------------------------------------------------------
+const RecognitionParams& RecognizeERDiagram::getParams()
+{
+	return params;
 }
 
 // ------------------------------------ getNumAttributes --------------------------------------
 
 // purpose: get the number of attributes detected from the image
 // preconditions: none
-// postconditions: returns the number of attributes stored in the attributes vector
+// postconditions: returns the number of attributes tagged as attributes
 
 // --------------------------------------------------------------------------------------
 int RecognizeERDiagram::getNumAttributes()
 {
-	return (int)attributes.size();
+	return result.shapes.count(ShapeType::Attribute);
 }
 
 // ------------------------------------ getNumEntities --------------------------------------
 
 // purpose: get the number of entities detected from the image
 // preconditions: none
-// postconditions: returns the number of entities stored in the entities vector
+// postconditions: returns the number of entities tagged as entities
 
 // --------------------------------------------------------------------------------------
 int RecognizeERDiagram::getNumEntities()
 {
-	return (int)entities.size();
+	return result.shapes.count(ShapeType::Entity);
 }
 
 // ------------------------------------ getNumRelationships --------------------------------------
 
 // purpose: get the number of relationships detected from the image
 // preconditions: none
-// postconditions: returns the number of relationships stored in the relationships vector
+// postconditions: returns the number of relationships tagged as relationships
 
 // --------------------------------------------------------------------------------------
 int RecognizeERDiagram::getNumRelationships()
 {
-	return (int)relationships.size();
+	return result.shapes.count(ShapeType::Relationship);
 }
 
 // ------------------------------------ getNumWeakEntities --------------------------------------
 
 // purpose: get the number of weak entities detected from the image
 // preconditions: none
-// postconditions: returns the number of weak entities stored in the weak entities vector
+// postconditions: returns the number of weak entities tagged as weak entities
 
 // --------------------------------------------------------------------------------------
 int RecognizeERDiagram::getNumWeakEntities()
 {
-	return (int)weakEntities.size();
+	return result.shapes.count(ShapeType::WeakEntity);
 }
 
 // ------------------------------------ getNumWeakRelationships --------------------------------------
 
 // purpose: get the number of weak relationships detected from the image
 // preconditions: none
-// postconditions: returns the number of weak relationships stored in the weak relationships vector
+// postconditions: returns the number of weak relationships tagged as weak relationships
 
 // --------------------------------------------------------------------------------------
 int RecognizeERDiagram::getNumWeakRelationships()
 {
-	return (int)weakRelationships.size();
+	return result.shapes.count(ShapeType::WeakRelationship);
 }
 
 // ------------------------------------ getNumMultivaluedAttributes --------------------------------------
 
 // purpose: get the number of multivalued attributes detected from the image
 // preconditions: none
-// postconditions: returns the number of multivalued attributes stored in the weak attributes vector
+// postconditions: returns the number of multivalued attributes tagged as multivalued attributes
 
 // --------------------------------------------------------------------------------------
 int RecognizeERDiagram::getNumMultivaluedAttributes()
 {
-	return (int)weakAttributes.size();
+	return result.shapes.count(ShapeType::MultivaluedAttribute);
+}
+
+// ------------------------------------ getImageSize --------------------------------------
+
+// purpose: get the size of the input image
+// preconditions: none
+// postconditions: returns the width and height of the image that was recognized
+
+// --------------------------------------------------------------------------------------
+Size RecognizeERDiagram::getImageSize()
+{
+	return result.imageSize;
+}
+
+// ------------------------------------ getTrace --------------------------------------
+
+// purpose: get what the last recognition measured
+// preconditions: none
+// postconditions: returns the stage times and counts of the last image recognized; empty unless
+//	the program was built with ERD_INSTRUMENT
+
+// --------------------------------------------------------------------------------------
+const RecognitionTrace& RecognizeERDiagram::getTrace()
+{
+	return result.trace;
+}
+
+// ------------------------------------ getShapes --------------------------------------
+
+// purpose: get every shape detected from the image
+// preconditions: none
+// postconditions: returns the shape table; shapes tagged ShapeType::Discarded are not part of
+//	the result
+
+// --------------------------------------------------------------------------------------
+const ShapeTable& RecognizeERDiagram::getShapes()
+{
+	return result.shapes;
+}
+
+// ------------------------------------ getCascadeStats --------------------------------------
+
+// purpose: get where the contours of the image were dropped during classification
+// preconditions: none
+// postconditions: returns how many contours each stage of classifyContour rejected and how many
+//	became shapes, for the last image recognized
+
+// --------------------------------------------------------------------------------------
+const CascadeStats& RecognizeERDiagram::getCascadeStats()
+{
+	return result.cascadeStats;
 }
 
 
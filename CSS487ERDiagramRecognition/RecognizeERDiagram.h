@@ -1,7 +1,8 @@
 // RecognizeERDiagram.h
 // Purpose: recognize and label different entity types in a given hand drawn ER diagram
 // Functionality: given a hand drawn ER diagram image, produces an image that boxes
-//	and labels each entity type in the diagram appropriately
+//	and labels each entity type in the diagram appropriately. The recognition itself is done by
+//	RecognitionCore in buffers the recognizer keeps between images, so they can be drawn
 // Assumptions: 
 //	Image used is a valid image ressembling an ER diagram
 //	None of the objects drawn are touching the border of the image
@@ -16,22 +17,107 @@
 #include <opencv2/imgproc.hpp>
 #include "opencv2/imgcodecs.hpp"
 #include <iostream>
+#include "RecognitionCore.h"
 using namespace std;
 using namespace cv;
 
 class RecognizeERDiagram
 {
 public:
-	// default constructor not allowed
-	RecognizeERDiagram() = delete;
+	// ------------------------------------ default constructor --------------------------------------
+
+// purpose: create a recognizer that is given its images later with recognize
+// preconditions: none
+// postconditions: no image is loaded and no shapes are stored
+
+// --------------------------------------------------------------------------------------
+	RecognizeERDiagram();
 	// ------------------------------------ parameter constructor --------------------------------------
 
-// purpose: the only way to create an instance of the class
+// purpose: read an image file and recognize it right away
 // preconditions: fileName is a valid image in the directory
 // postconditions: image is read in and all object contours are stored in the appropriate type vector
 
 // --------------------------------------------------------------------------------------
 	RecognizeERDiagram(string fileName);
+	// ------------------------------------ recognize --------------------------------------
+
+// purpose: recognize an image that is already in memory
+// preconditions: image is a valid 8 bit BGR image; it is not copied, so it must not be modified
+//	while its results are drawn
+// postconditions: the results of the previous image are replaced by the shapes of image; throws
+//	cv::Exception if image is empty
+
+// --------------------------------------------------------------------------------------
+	void recognize(const Mat& image);
+	// ------------------------------------ recognizeEncoded --------------------------------------
+
+// purpose: recognize an image from its encoded bytes (PNG, JPEG, ...) without a file
+// preconditions: data points to size bytes of an image file
+// postconditions: the image is decoded into a reused buffer and recognized; throws cv::Exception if
+//	the bytes cannot be decoded
+
+// --------------------------------------------------------------------------------------
+	void recognizeEncoded(const uchar* data, size_t size);
+	// ------------------------------------ recognizeThresholded --------------------------------------
+
+// purpose: recognize an image whose threshold was already computed, e.g. by another thread
+// preconditions: image is a valid 8 bit BGR image and binary its threshold with the limits of
+//	params; neither is copied, so they must not be modified while the image is recognized
+// postconditions: the results of the previous image are replaced by the shapes of image; pyramid
+//	mode is not used since the full resolution threshold is already there
+
+// --------------------------------------------------------------------------------------
+	void recognizeThresholded(const Mat& image, const Mat& binary);
+	// ------------------------------------ reset --------------------------------------
+
+// purpose: forget the last image so the recognizer can be reused
+// preconditions: none
+// postconditions: no image and no shapes are stored; the threshold, contour and shape buffers
+//	keep their memory so the next image of the same size allocates almost nothing
+
+// --------------------------------------------------------------------------------------
+	void reset();
+	// ------------------------------------ setParams --------------------------------------
+
+// purpose: change the limits used to recognize the next images, e.g. to turn on pyramid mode
+// preconditions: none
+// postconditions: the next recognize uses params
+
+// --------------------------------------------------------------------------------------
+	void setParams(const RecognitionParams& params);
+	// ------------------------------------ setLowMemory --------------------------------------
+
+// purpose: trade the buffers kept between images for less memory, e.g. for workers that hold
+//	many recognizers or recognize very large images
+// preconditions: none
+// postconditions: when lowMemory is true, the next images are traced with compressed contours
+//	(only the ends of straight runs are kept) and the threshold, contours, hierarchy and other
+//	scratch buffers are freed as soon as the shapes are classified, so only the shapes are held
+//	between images. Straight runs hold no corners, so the same shapes are found, though a
+//	polygon can gain or lose a vertex where the approximation had a tie. drawAllContours draws
+//	nothing then
+
+// --------------------------------------------------------------------------------------
+	void setLowMemory(bool lowMemory);
+	// ------------------------------------ setKeepImage --------------------------------------
+
+// purpose: choose whether the recognizer holds on to the image once it is recognized
+// preconditions: none
+// postconditions: when keepImage is false, the reference to the next images (and the buffer a
+//	decoded image was read into) is dropped once they are recognized, so the caller decides how
+//	long the pixels live; the images can then not be drawn or rendered
+
+// --------------------------------------------------------------------------------------
+	void setKeepImage(bool keepImage);
+	// ------------------------------------ getParams --------------------------------------
+
+// purpose: get the limits used to recognize images
+// preconditions: none
+// postconditions: returns the current parameters
+
+// --------------------------------------------------------------------------------------
+	const RecognitionParams& getParams();
 	// ------------------------------------ drawOriginalImage --------------------------------------
 
 // purpose: display the original, unmodified input image
@@ -64,36 +150,46 @@ public:
 
 // --------------------------------------------------------------------------------------
 	void drawRectForShapes();
+	// ------------------------------------ renderRectForShapes --------------------------------------
+
+// purpose: box and label all the shapes without displaying anything
+// preconditions: image has been defined and all type vectors have been populated as intended
+// postconditions: returns a copy of the image with all the objects boxed and labeled appropriately;
+//	throws cv::Exception if the image was not kept (see setKeepImage)
+
+// --------------------------------------------------------------------------------------
+	Mat renderRectForShapes();
+	// ------------------------------------ renderShapes --------------------------------------
+
+// purpose: box and label the shapes of any image, e.g. ones recognized by another recognizer
+// preconditions: image is a valid BGR image and shapes are in its coordinates
+// postconditions: rendered is a copy of image with every shape of shapes boxed and labeled; its
+//	memory is reused if it already has the size of image
+
+// --------------------------------------------------------------------------------------
+	void renderShapes(const Mat& image, const ShapeTable& shapes, Mat& rendered);
 	// ------------------------------------ drawRectsForSpecificShape --------------------------------------
 
 // purpose: boxes and labels all the shapes of a specific type
-// preconditions: using a valid type, a valid image, and intended color
+// preconditions: using a valid type, shapes in the coordinates of a valid image, and intended color
 // postconditions: image is modified to box and label all the shapes of a specific type with color 
 //	equal to color passed in
 
 // --------------------------------------------------------------------------------------
-	void drawRectsForSpecificShape(vector<vector<Point>> currentShape, Mat& imageCopy, const Scalar color);
+	void drawRectsForSpecificShape(ShapeType type, const ShapeTable& shapes, Mat& imageCopy, const Scalar color);
 	// ------------------------------------ labelShape --------------------------------------
 
 // purpose: to label a shape on the given image
-// preconditions: valid image using a predefined type color and a point within the image
-// postconditions: labels the shape in the image based on the color passed in at the point given
+// preconditions: valid image, the shape's type and color, and a point within the image
+// postconditions: labels the shape in the image with the name of its type at the point given
 
 // --------------------------------------------------------------------------------------
-	void labelShape(Mat& imageCopy, const Scalar color, Point upperLeft);
-	// ------------------------------------ indexOfShape --------------------------------------
-
-// purpose: to return the index of a target shape inside a type vector to search
-// preconditions: target shape and search shape are defined
-// postconditions: returns index of target in search vector, otherwise returns -1
-
-// --------------------------------------------------------------------------------------
-	int indexOfShape(const vector<Point>& targetShape, const vector<vector<Point>>& searchShape);
+	void labelShape(Mat& imageCopy, ShapeType type, const Scalar color, Point upperLeft);
 	// ------------------------------------ getNumAttributes --------------------------------------
 
 // purpose: get the number of attributes detected from the image
 // preconditions: none
-// postconditions: returns the number of attributes stored in the attributes vector
+// postconditions: returns the number of attributes tagged as attributes
 
 // --------------------------------------------------------------------------------------
 	int getNumAttributes();
@@ -101,7 +197,7 @@ public:
 
 // purpose: get the number of entities detected from the image
 // preconditions: none
-// postconditions: returns the number of entities stored in the entities vector
+// postconditions: returns the number of entities tagged as entities
 
 // --------------------------------------------------------------------------------------
 	int getNumEntities();
@@ -109,7 +205,7 @@ public:
 
 // purpose: get the number of relationships detected from the image
 // preconditions: none
-// postconditions: returns the number of relationships stored in the relationships vector
+// postconditions: returns the number of relationships tagged as relationships
 
 // --------------------------------------------------------------------------------------
 	int getNumRelationships();
@@ -117,7 +213,7 @@ public:
 
 // purpose: get the number of weak entities detected from the image
 // preconditions: none
-// postconditions: returns the number of weak entities stored in the weak entities vector
+// postconditions: returns the number of weak entities tagged as weak entities
 
 // --------------------------------------------------------------------------------------
 	int getNumWeakEntities();
@@ -125,7 +221,7 @@ public:
 
 // purpose: get the number of weak relationships detected from the image
 // preconditions: none
-// postconditions: returns the number of weak relationships stored in the weak relationships vector
+// postconditions: returns the number of weak relationships tagged as weak relationships
 
 // --------------------------------------------------------------------------------------
 	int getNumWeakRelationships();
@@ -133,82 +229,84 @@ public:
 
 // purpose: get the number of multivalued attributes detected from the image
 // preconditions: none
-// postconditions: returns the number of multivalued attributes stored in the weak attributes vector
+// postconditions: returns the number of multivalued attributes tagged as multivalued attributes
 
 // --------------------------------------------------------------------------------------
 	int getNumMultivaluedAttributes();
+	// ------------------------------------ getImageSize --------------------------------------
 
-private:
-	Mat image;
-	vector<vector<Point>> contours;
-	vector<Vec4i> hierarchy;
-	// vectors to store each type
-	vector<vector<Point>> relationships;
-	vector<vector<Point>> entities;
-	vector<vector<Point>> attributes;
-	vector<vector<Point>> weakRelationships;
-	vector<vector<Point>> weakEntities;
-	vector<vector<Point>> weakAttributes;
-
-	// predefined colors for each type
-	Scalar contourColor = Scalar(120, 0, 120);
-	Scalar entityColor = Scalar(255, 0, 0);
-	Scalar relationshipColor = Scalar(0, 255, 0);
-	Scalar attributeColor = Scalar(0, 0, 255);
-	Scalar weakEntityColor = Scalar(200, 150, 150);
-	Scalar weakRelationshipColor = Scalar(150, 200, 150);
-	Scalar weakAttributeColor = Scalar(150, 150, 200);
+// purpose: get the size of the input image
+// preconditions: none
+// postconditions: returns the width and height of the image that was recognized
 
-	// ------------------------------------ recognizeDiagram --------------------------------------
+// --------------------------------------------------------------------------------------
+	Size getImageSize();
+	// ------------------------------------ getTrace --------------------------------------
 
-// purpose: identify each object in the image
-// preconditions: the image has already been defined
-// postconditions: every object's contour in the image is stored in the appropriate type vector
+// purpose: get what the last recognition measured
+// preconditions: none
+// postconditions: returns the stage times and counts of the last image recognized; empty unless
+//	the program was built with ERD_INSTRUMENT
 
 // --------------------------------------------------------------------------------------
-	void recognizeDiagram();
-	// ------------------------------------ detectShapes --------------------------------------
+	const RecognitionTrace& getTrace();
+	// ------------------------------------ getShapes --------------------------------------
 
-// purpose: populate vector types (except weak types)
-// preconditions: contours vector has been populated 
-// postconditions: populates all vector types, except weak types
+// purpose: get every shape detected from the image
+// preconditions: none
+// postconditions: returns the shape table; shapes tagged ShapeType::Discarded are not part of
+//	the result
 
 // --------------------------------------------------------------------------------------
-	void detectShapes();
-	// ------------------------------------ contourTouchesBorder --------------------------------------
+	const ShapeTable& getShapes();
+	// ------------------------------------ getCascadeStats --------------------------------------
 
-// purpose: helper method checks if contour touches the border
-// preconditions: using intended contour, and image size is the image's size
-// postconditions: returns true or false based on if the contour is touching the border
+// purpose: get where the contours of the image were dropped during classification
+// preconditions: none
+// postconditions: returns how many contours each stage of classifyContour rejected and how many
+//	became shapes, for the last image recognized
 
 // --------------------------------------------------------------------------------------
-	bool contourTouchesBorder(const vector<Point>& contour, const Size& imageSize);
-	// ------------------------------------ eraseParentContour --------------------------------------
+	const CascadeStats& getCascadeStats();
 
-// purpose: to get rid of the outer contour, if there is one
-// preconditions: attributes vector has been populated
-// postconditions: removes the outer contour from the vector
+private:
+	// times the stages of RecognitionCore one at a time in the buffers of a recognizer
+	friend class RecognitionBenchmark;
 
-// --------------------------------------------------------------------------------------
-	void eraseParentContour();
-	// ------------------------------------ determineWeakType --------------------------------------
+	Mat image;
+	// the buffers recognition works in, kept between images, and what the last image gave
+	RecognitionScratch scratch;
+	RecognitionResult result;
+	RecognitionParams params;
+	// see setKeepImage; the low memory mode of setLowMemory is kept in scratch
+	bool keepImage = true;
+
+	// predefined colors for each type
+	Scalar contourColor = Scalar(120, 0, 120);
+	Scalar entityColor = Scalar(255, 0, 0);
+	Scalar relationshipColor = Scalar(0, 255, 0);
+	Scalar attributeColor = Scalar(0, 0, 255);
+	Scalar weakEntityColor = Scalar(200, 150, 150);
+	Scalar weakRelationshipColor = Scalar(150, 200, 150);
+	Scalar weakAttributeColor = Scalar(150, 150, 200);
 
-// purpose: seperates the weak from the strong of a given type
-// preconditions: pointer to the vector containing the type to seperate, and the pointer to the vector
-// //	the weak type will be stored in
-// postconditions: all strong types will be left in type and all the weak types found in type will be 
-// removed and stored in the weakType vector
+	// ------------------------------------ getTypeColor --------------------------------------
+
+// purpose: get the predefined color of a shape type
+// preconditions: none
+// postconditions: returns the color used to draw shapes of the given type
 
 // --------------------------------------------------------------------------------------
-	void determineWeakType(vector<vector<Point>>& type, vector<vector<Point>>& weakType);
-	// ------------------------------------ isNested --------------------------------------
+	Scalar getTypeColor(ShapeType type);
+	// ------------------------------------ releaseImage --------------------------------------
 
-// purpose: determines if contour1 is inside contour2
-// preconditions: contour1 and contour 2 are valid contours
-// postconditions: returns true if contour1 is inside contour2, false if not
+// purpose: drop the image once it is recognized, unless it is kept
+// preconditions: the image has been recognized
+// postconditions: when keepImage is false, the image and the buffer a decoded image was read into
+//	are released
 
 // --------------------------------------------------------------------------------------
-	bool isNested(const vector<Point>& contour1, const vector<Point>& contour2);
+	void releaseImage();
 	
 	
 	// bool checkIfWeak(int contourIndex);
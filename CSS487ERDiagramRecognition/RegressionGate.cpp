@@ -0,0 +1,537 @@
+// RegressionGate.cpp
+// Purpose: catch a change that makes recognition less accurate or slower before it is trusted,
+//	by measuring a corpus of images with known counts and comparing against a stored baseline
+// Functionality: recognizes every test image of a corpus (the Test table, or a manifest file of
+//	tests) once to measure its peak memory, then a number of times to measure its latency. Each
+//	image gets the count of each type it found against the count expected, the 50th, 95th and
+//	99th percentile milliseconds and the peak megabytes. The results are written to a baseline
+//	file with FileStorage (YAML or JSON by its extension), and compared with a baseline written
+//	before: a count further from the expected count than in the baseline, or a 50th or 95th
+//	percentile slower than the baseline's by more than the tolerance, is a regression
+// Assumptions:
+//	A baseline is compared only with runs on the same machine and build settings; the threads,
+//	the OpenCV version, the profile and every parameter it was made with are stored, and a
+//	difference is reported
+//	Memory is the Mat buffers, and the heap when built with ERD_COUNT_ALLOCATIONS
+// Authors: Allan Genari Gaarden, Tommy Ni, Joshua Medvinsky
+
+#include "RegressionGate.h"
+#include "AllocationStats.h"
+#include <opencv2/imgcodecs.hpp>
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <sstream>
+
+// raise it whenever the baseline file changes, so an older baseline is refused instead of misread
+static const int BASELINE_FORMAT_VERSION = 2;
+
+static const double MB = 1024.0 * 1024.0;
+
+// ------------------------------------ parameter constructor --------------------------------------
+
+// purpose: set up a gate
+// preconditions: repetitions is at least 1
+// postconditions: every test is recognized with params repetitions times, after one run that
+//	measures its memory and is not timed
+
+// --------------------------------------------------------------------------------------
+RegressionGate::RegressionGate(int repetitions, const RecognitionParams& params)
+{
+	this->repetitions = max(1, repetitions);
+	this->params = params;
+}
+
+// ------------------------------------ addTest --------------------------------------
+
+// purpose: add a test image
+// preconditions: none
+// postconditions: the image of test is measured by the next run
+
+// --------------------------------------------------------------------------------------
+void RegressionGate::addTest(const Test& test)
+{
+	tests.push_back(test);
+}
+
+// ------------------------------------ run --------------------------------------
+
+// purpose: measure every test image
+// preconditions: none
+// postconditions: the results hold one entry per test, in the order the tests were added; an
+//	image that cannot be read or recognized has recognized set to false
+
+// --------------------------------------------------------------------------------------
+void RegressionGate::run()
+{
+	AllocationStats::install();
+	results.clear();
+
+	for (size_t i = 0; i < tests.size(); i++)
+	{
+		RegressionResult result;
+		result.test = tests[i];
+		const Test& test = tests[i];
+		int expected[NUM_TEST_COUNTS] = { test.expectedAttributes, test.expectedEntities,
+			test.expectedRelationships, test.expectedWeakEntities, test.expectedWeakRelationships,
+			test.expectedMultivaluedAttributes };
+		copy(expected, expected + NUM_TEST_COUNTS, result.expected);
+
+		// decoding is not part of recognition, so the image is read before anything is measured
+		Mat image = imread(test.imageName);
+		if (!image.empty())
+		{
+			// buffers of each image's own, so its peak holds everything recognition allocates
+			RecognitionScratch scratch;
+			RecognitionResult recognition;
+			try
+			{
+				measure(image, scratch, recognition, result);
+				result.recognized = true;
+			}
+			catch (const cv::Exception&)
+			{
+				result.recognized = false;
+			}
+		}
+		results.push_back(result);
+	}
+}
+
+// ------------------------------------ measure --------------------------------------
+
+// purpose: measure one test image
+// preconditions: image is a valid BGR image
+// postconditions: result holds the counts, latencies and peak memory of image
+
+// --------------------------------------------------------------------------------------
+void RegressionGate::measure(const Mat& image, RecognitionScratch& scratch,
+	RecognitionResult& recognition, RegressionResult& result) const
+{
+	// the untimed run measures the peak, starting from empty buffers
+	AllocationStats::resetPeaks();
+	AllocationCounts before = AllocationStats::current();
+	RecognitionCore::recognize(image, params, scratch, recognition);
+	AllocationCounts after = AllocationStats::current();
+	result.matPeakMB = (after.matPeakBytes - before.matLiveBytes) / MB;
+	result.heapPeakMB = AllocationStats::countsHeap() ?
+		(after.heapPeakBytes - before.heapLiveBytes) / MB : -1;
+
+	const ShapeTable& shapes = recognition.shapes;
+	ShapeType types[NUM_TEST_COUNTS] = { ShapeType::Attribute, ShapeType::Entity,
+		ShapeType::Relationship, ShapeType::WeakEntity, ShapeType::WeakRelationship,
+		ShapeType::MultivaluedAttribute };
+	for (int type = 0; type < NUM_TEST_COUNTS; type++)
+	{
+		result.actual[type] = shapes.count(types[type]);
+		result.error[type] = abs(result.actual[type] - result.expected[type]);
+	}
+
+	// the timed runs reuse the buffers the untimed run grew, as a long running service would
+	vector<double> times;
+	TickMeter timer;
+	for (int run = 0; run < repetitions; run++)
+	{
+		timer.reset();
+		timer.start();
+		RecognitionCore::recognize(image, params, scratch, recognition);
+		timer.stop();
+		times.push_back(timer.getTimeMilli());
+	}
+	sort(times.begin(), times.end());
+	result.p50Ms = percentile(times, 0.50);
+	result.p95Ms = percentile(times, 0.95);
+	result.p99Ms = percentile(times, 0.99);
+}
+
+// ------------------------------------ percentile --------------------------------------
+
+// purpose: get a percentile of sorted samples
+// preconditions: sorted is in increasing order; fraction is between 0 and 1
+// postconditions: returns the smallest sample at least fraction of the samples are not above,
+//	or 0 if there are none
+
+// --------------------------------------------------------------------------------------
+double RegressionGate::percentile(const vector<double>& sorted, double fraction)
+{
+	if (sorted.empty()) return 0;
+
+	// nearest rank, so every percentile is a time that was measured
+	size_t rank = (size_t)ceil(fraction * sorted.size());
+	rank = min(sorted.size(), max((size_t)1, rank));
+	return sorted[rank - 1];
+}
+
+// ------------------------------------ paramFields --------------------------------------
+
+// purpose: list the parameters a baseline is measured with
+// preconditions: none
+// postconditions: names and values hold every field of params but the contour backend, which
+//	is stored by name, in the same order every time
+
+// --------------------------------------------------------------------------------------
+void RegressionGate::paramFields(const RecognitionParams& params, vector<string>& names,
+	vector<double>& values)
+{
+	names = { "minThreshold", "maxThreshold", "thresholdAreaForRect", "thresholdAreaForCircle",
+		"thresholdRatioForSqar", "thresholdForOutsideContour", "maxAspectRatio",
+		"approxEpsilonFraction", "boundingBoxOffByPixel", "pyramidLevels", "pyramidInkThreshold",
+		"connectorOutlineWidth", "minConnectorLength", "connectorSnapDistance" };
+	values = { (double)params.minThreshold, (double)params.maxThreshold, params.thresholdAreaForRect,
+		params.thresholdAreaForCircle, params.thresholdRatioForSqar, params.thresholdForOutsideContour,
+		params.maxAspectRatio, params.approxEpsilonFraction, (double)params.boundingBoxOffByPixel,
+		(double)params.pyramidLevels, (double)params.pyramidInkThreshold,
+		(double)params.connectorOutlineWidth, params.minConnectorLength,
+		(double)params.connectorSnapDistance };
+}
+
+// ------------------------------------ writeText --------------------------------------
+
+// purpose: write the results for people to read
+// preconditions: run has been called
+// postconditions: one line per image with its counts found against expected, latencies and
+//	peak memory, then per type how many images had the count right and the sum of how far off
+//	the counts were, are written to out
+
+// --------------------------------------------------------------------------------------
+void RegressionGate::writeText(ostream& out) const
+{
+	int numMatched[NUM_TEST_COUNTS] = {};
+	int totalError[NUM_TEST_COUNTS] = {};
+	int numAllMatched = 0;
+	int numRecognized = 0;
+
+	out << "Image, Counts Found : Expected, p50 ms, p95 ms, p99 ms, Mat Peak MB, Heap Peak MB" << endl;
+	out << fixed << setprecision(2);
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		const RegressionResult& result = results[i];
+		out << result.test.imageName << ", ";
+		if (!result.recognized)
+		{
+			out << "could not be recognized" << endl;
+			continue;
+		}
+
+		numRecognized++;
+		bool allMatched = true;
+		for (int type = 0; type < NUM_TEST_COUNTS; type++)
+		{
+			bool matched = result.actual[type] == result.expected[type];
+			if (matched) numMatched[type]++;
+			totalError[type] += result.error[type];
+			allMatched = allMatched && matched;
+			out << (type > 0 ? " " : "") << result.actual[type] << ":" << result.expected[type];
+		}
+		if (allMatched) numAllMatched++;
+
+		out << (allMatched ? "" : " wrong") << ", " << result.p50Ms << ", " << result.p95Ms << ", " <<
+			result.p99Ms << ", " << result.matPeakMB << ", ";
+		if (result.heapPeakMB >= 0) out << result.heapPeakMB << endl;
+		else out << "n/a" << endl;
+	}
+
+	out << "\nImages with the count right, of " << results.size() << ", and how far off the others are in all" <<
+		endl;
+	for (int type = 0; type < NUM_TEST_COUNTS; type++)
+	{
+		out << "  " << left << setw(22) << countName(type) << right << ": " << numMatched[type] <<
+			", off by " << totalError[type] << endl;
+	}
+	out << "  " << left << setw(22) << "every count" << right << ": " << numAllMatched << endl;
+	if (numRecognized < (int)results.size())
+	{
+		out << (results.size() - numRecognized) << " images could not be recognized" << endl;
+	}
+	out << defaultfloat;
+}
+
+// ------------------------------------ writeBaseline --------------------------------------
+
+// purpose: keep the results to compare later runs with
+// preconditions: run has been called
+// postconditions: the results are written to fileName, as JSON if it ends in .json and YAML
+//	otherwise; throws cv::Exception if it cannot be written
+
+// --------------------------------------------------------------------------------------
+void RegressionGate::writeBaseline(const string& fileName) const
+{
+	// FileStorage picks the format from the extension, and would write XML for .xml
+	FileStorage file(fileName, FileStorage::WRITE);
+	if (!file.isOpened())
+	{
+		CV_Error(Error::StsError, "cannot write the baseline " + fileName);
+	}
+
+	file << "version" << BASELINE_FORMAT_VERSION;
+	file << "opencvVersion" << CV_VERSION;
+	file << "threads" << getNumThreads();
+	file << "backend" << contourBackendName(params.contourBackend);
+	file << "profile" << profileName(matchingProfile(params));
+	vector<string> paramNames;
+	vector<double> paramValues;
+	paramFields(params, paramNames, paramValues);
+	file << "params" << "{";
+	for (size_t i = 0; i < paramNames.size(); i++)
+	{
+		file << paramNames[i] << paramValues[i];
+	}
+	file << "}";
+	file << "repetitions" << repetitions;
+	file << "images" << "[";
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		const RegressionResult& result = results[i];
+		file << "{" << "image" << result.test.imageName << "recognized" << (int)result.recognized;
+		if (result.recognized)
+		{
+			file << "expected" << vector<int>(result.expected, result.expected + NUM_TEST_COUNTS);
+			file << "actual" << vector<int>(result.actual, result.actual + NUM_TEST_COUNTS);
+			file << "error" << vector<int>(result.error, result.error + NUM_TEST_COUNTS);
+			file << "p50Ms" << result.p50Ms << "p95Ms" << result.p95Ms << "p99Ms" << result.p99Ms;
+			file << "matPeakMB" << result.matPeakMB << "heapPeakMB" << result.heapPeakMB;
+		}
+		file << "}";
+	}
+	file << "]";
+	file.release();
+}
+
+// ------------------------------------ compare --------------------------------------
+
+// purpose: find what got worse since a baseline was written
+// preconditions: run has been called; tolerance is at least 0
+// postconditions: writes one line to out for every regression: a count further from the same
+//	expected count than in the baseline, an image recognized in the baseline that failed now,
+//	or a 50th or 95th percentile above baseline * (1 + tolerance) + slackMs. A profile or
+//	parameter that differs from the baseline's, and images that are not in both, are only
+//	noted. Returns the number of regressions; throws cv::Exception if the baseline cannot be read
+
+// --------------------------------------------------------------------------------------
+int RegressionGate::compare(const string& baselineName, double tolerance, double slackMs,
+	ostream& out) const
+{
+	FileStorage file(baselineName, FileStorage::READ);
+	if (!file.isOpened())
+	{
+		CV_Error(Error::StsBadArg, "cannot read the baseline " + baselineName);
+	}
+	if ((int)file["version"] != BASELINE_FORMAT_VERSION)
+	{
+		CV_Error(Error::StsBadArg, baselineName + " is not a baseline of this version");
+	}
+
+	// times from other settings are not comparable, though the counts still are
+	if ((int)file["threads"] != getNumThreads())
+	{
+		out << "note: the baseline was measured on " << (int)file["threads"] << " threads, this run on " <<
+			getNumThreads() << endl;
+	}
+	if ((string)file["opencvVersion"] != CV_VERSION)
+	{
+		out << "note: the baseline was measured with OpenCV " << (string)file["opencvVersion"] <<
+			", this run with " << CV_VERSION << endl;
+	}
+	if ((string)file["backend"] != contourBackendName(params.contourBackend))
+	{
+		out << "note: the baseline was measured with the " << (string)file["backend"] <<
+			" backend, this run with " << contourBackendName(params.contourBackend) << endl;
+	}
+	const char* profile = profileName(matchingProfile(params));
+	if ((string)file["profile"] != profile)
+	{
+		out << "note: the baseline was measured with the " << (string)file["profile"] <<
+			" profile, this run with " << profile << endl;
+	}
+	vector<string> paramNames;
+	vector<double> paramValues;
+	paramFields(params, paramNames, paramValues);
+	FileNode paramNodes = file["params"];
+	for (size_t i = 0; i < paramNames.size(); i++)
+	{
+		FileNode paramNode = paramNodes[paramNames[i]];
+		if (paramNode.empty())
+		{
+			out << "note: the baseline does not hold " << paramNames[i] << endl;
+		}
+		else if ((double)paramNode != paramValues[i])
+		{
+			out << "note: the baseline was measured with " << paramNames[i] << " " <<
+				(double)paramNode << ", this run with " << paramValues[i] << endl;
+		}
+	}
+
+	// each image of the baseline by name
+	FileNode imageNodes = file["images"];
+	map<string, int> baselineIndex;
+	for (int i = 0; i < (int)imageNodes.size(); i++)
+	{
+		baselineIndex[(string)imageNodes[i]["image"]] = i;
+	}
+
+	int numRegressions = 0;
+	vector<int> expected;
+	vector<int> error;
+	out << fixed << setprecision(2);
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		const RegressionResult& result = results[i];
+		const string& name = result.test.imageName;
+		map<string, int>::const_iterator found = baselineIndex.find(name);
+		if (found == baselineIndex.end())
+		{
+			out << "note: " << name << " is not in the baseline" << endl;
+			continue;
+		}
+		FileNode node = imageNodes[found->second];
+		baselineIndex.erase(name);
+		if ((int)node["recognized"] == 0) continue;
+
+		if (!result.recognized)
+		{
+			out << "REGRESSION " << name << ": could not be recognized" << endl;
+			numRegressions++;
+			continue;
+		}
+
+		// a count is held against this run if it is further off than in the baseline, for the
+		//	same expected count, so one already wrong cannot get worse unnoticed; a test
+		//	corrected since then starts over
+		node["expected"] >> expected;
+		node["error"] >> error;
+		if ((int)expected.size() != NUM_TEST_COUNTS || (int)error.size() != NUM_TEST_COUNTS)
+		{
+			CV_Error(Error::StsBadArg, baselineName + " has no counts for " + name);
+		}
+		for (int type = 0; type < NUM_TEST_COUNTS; type++)
+		{
+			if (expected[type] != result.expected[type] || result.error[type] <= error[type]) continue;
+
+			out << "REGRESSION " << name << ": " << result.actual[type] << " " << countName(type) <<
+				" found, " << result.expected[type] << " expected";
+			if (error[type] == 0) out << " and found in the baseline" << endl;
+			else out << ", off by " << result.error[type] << " against " << error[type] << " in the baseline" <<
+				endl;
+			numRegressions++;
+		}
+
+		const char* percentileNames[2] = { "p50", "p95" };
+		double baselineMs[2] = { (double)node["p50Ms"], (double)node["p95Ms"] };
+		double currentMs[2] = { result.p50Ms, result.p95Ms };
+		for (int p = 0; p < 2; p++)
+		{
+			double limit = baselineMs[p] * (1 + tolerance) + slackMs;
+			if (currentMs[p] > limit)
+			{
+				out << "REGRESSION " << name << ": " << percentileNames[p] << " " << currentMs[p] <<
+					" ms, baseline " << baselineMs[p] << " ms, limit " << limit << " ms" << endl;
+				numRegressions++;
+			}
+		}
+	}
+
+	// what is left of the index are the images this run did not have
+	for (map<string, int>::const_iterator missing = baselineIndex.begin(); missing != baselineIndex.end();
+		++missing)
+	{
+		out << "note: " << missing->first << " of the baseline was not run" << endl;
+	}
+	out << defaultfloat;
+	return numRegressions;
+}
+
+// ------------------------------------ getResults --------------------------------------
+
+// purpose: get what was measured
+// preconditions: none
+// postconditions: returns one result per test, in the order the tests were added
+
+// --------------------------------------------------------------------------------------
+const vector<RegressionResult>& RegressionGate::getResults() const
+{
+	return results;
+}
+
+// ------------------------------------ loadManifest --------------------------------------
+
+// purpose: read a corpus of tests from a file
+// preconditions: none
+// postconditions: the tests of fileName are appended to tests. Each line holds one test, either
+//	as the image name followed by its six counts, or as a Test{ "name", ... } initializer as
+//	written in BenchmarkCommands.cpp and by generate; blank lines and lines starting with # are
+//	skipped. Throws cv::Exception naming the line if the file cannot be read or a line is not a
+//	test
+
+// --------------------------------------------------------------------------------------
+void RegressionGate::loadManifest(const string& fileName, vector<Test>& tests)
+{
+	ifstream file(fileName);
+	if (!file)
+	{
+		CV_Error(Error::StsBadArg, "cannot read the manifest " + fileName);
+	}
+
+	string line;
+	int lineNumber = 0;
+	while (getline(file, line))
+	{
+		lineNumber++;
+		// lists written on Windows end their lines with \r
+		if (!line.empty() && line.back() == '\r') line.pop_back();
+		size_t start = line.find_first_not_of(" \t");
+		if (start == string::npos || line[start] == '#') continue;
+
+		Test test;
+		string counts;
+		size_t openQuote = line.find('"');
+		size_t closeQuote = openQuote == string::npos ? string::npos : line.find('"', openQuote + 1);
+		if (closeQuote != string::npos)
+		{
+			// an initializer: the name is quoted and the counts follow it, between commas
+			test.imageName = line.substr(openQuote + 1, closeQuote - openQuote - 1);
+			counts = line.substr(closeQuote + 1);
+			replace_if(counts.begin(), counts.end(),
+				[](char c) { return c == ',' || c == '}' || c == ')' || c == ';'; }, ' ');
+		}
+		else
+		{
+			istringstream fields(line);
+			fields >> test.imageName;
+			getline(fields, counts);
+		}
+
+		istringstream fields(counts);
+		string rest;
+		fields >> test.expectedAttributes >> test.expectedEntities >> test.expectedRelationships >>
+			test.expectedWeakEntities >> test.expectedWeakRelationships >>
+			test.expectedMultivaluedAttributes;
+		if (test.imageName.empty() || fields.fail() || (fields >> rest))
+		{
+			CV_Error(Error::StsBadArg, fileName + " line " + to_string(lineNumber) +
+				" is not an image name followed by six counts");
+		}
+		tests.push_back(test);
+	}
+}
+
+// ------------------------------------ countName --------------------------------------
+
+// purpose: get the name of one of the counts of a test
+// preconditions: index is at least 0 and less than NUM_TEST_COUNTS
+// postconditions: returns the camel case name of the count (e.g. "weakEntities")
+
+// --------------------------------------------------------------------------------------
+const char* RegressionGate::countName(int index)
+{
+	switch (index)
+	{
+	case 0: return "attributes";
+	case 1: return "entities";
+	case 2: return "relationships";
+	case 3: return "weakEntities";
+	case 4: return "weakRelationships";
+	default: return "multivaluedAttributes";
+	}
+}
@@ -0,0 +1,177 @@
+// RegressionGate.h
+// Purpose: catch a change that makes recognition less accurate or slower before it is trusted,
+//	by measuring a corpus of images with known counts and comparing against a stored baseline
+// Functionality: recognizes every test image of a corpus (the Test table, or a manifest file of
+//	tests) once to measure its peak memory, then a number of times to measure its latency. Each
+//	image gets the count of each type it found against the count expected, the 50th, 95th and
+//	99th percentile milliseconds and the peak megabytes. The results are written to a baseline
+//	file with FileStorage (YAML or JSON by its extension), and compared with a baseline written
+//	before: a count further from the expected count than in the baseline, or a 50th or 95th
+//	percentile slower than the baseline's by more than the tolerance, is a regression
+// Assumptions:
+//	A baseline is compared only with runs on the same machine and build settings; the threads,
+//	the OpenCV version, the profile and every parameter it was made with are stored, and a
+//	difference is reported
+//	Memory is the Mat buffers, and the heap when built with ERD_COUNT_ALLOCATIONS
+// Authors: Allan Genari Gaarden, Tommy Ni, Joshua Medvinsky
+
+#ifndef REGRESSION_GATE_H
+#define REGRESSION_GATE_H
+
+#include "RecognitionCore.h"
+#include "DiagramTest.h"
+#include <ostream>
+
+// number of counts a Test holds, one per type recognized
+const int NUM_TEST_COUNTS = 6;
+
+// everything measured on one test image
+struct RegressionResult
+{
+	Test test;
+	// false if the image could not be read or recognized; nothing else is then set
+	bool recognized = false;
+	// the counts expected and found, in the order of Test: attributes, entities, relationships,
+	//	weak entities, weak relationships, multivalued attributes
+	int expected[NUM_TEST_COUNTS] = {};
+	int actual[NUM_TEST_COUNTS] = {};
+	// how far each count found is from the count expected
+	int error[NUM_TEST_COUNTS] = {};
+	// latency percentiles over the timed runs, in milliseconds
+	double p50Ms = 0;
+	double p95Ms = 0;
+	double p99Ms = 0;
+	// most megabytes of Mats, and of the heap (-1 if not counted), alive at once while
+	//	recognizing with fresh buffers
+	double matPeakMB = 0;
+	double heapPeakMB = -1;
+};
+
+class RegressionGate
+{
+public:
+	// default constructor not allowed
+	RegressionGate() = delete;
+	// ------------------------------------ parameter constructor --------------------------------------
+
+// purpose: set up a gate
+// preconditions: repetitions is at least 1
+// postconditions: every test is recognized with params repetitions times, after one run that
+//	measures its memory and is not timed
+
+// --------------------------------------------------------------------------------------
+	RegressionGate(int repetitions, const RecognitionParams& params);
+	// ------------------------------------ addTest --------------------------------------
+
+// purpose: add a test image
+// preconditions: none
+// postconditions: the image of test is measured by the next run
+
+// --------------------------------------------------------------------------------------
+	void addTest(const Test& test);
+	// ------------------------------------ run --------------------------------------
+
+// purpose: measure every test image
+// preconditions: none
+// postconditions: the results hold one entry per test, in the order the tests were added; an
+//	image that cannot be read or recognized has recognized set to false
+
+// --------------------------------------------------------------------------------------
+	void run();
+	// ------------------------------------ writeText --------------------------------------
+
+// purpose: write the results for people to read
+// preconditions: run has been called
+// postconditions: one line per image with its counts found against expected, latencies and
+//	peak memory, then per type how many images had the count right and the sum of how far off
+//	the counts were, are written to out
+
+// --------------------------------------------------------------------------------------
+	void writeText(ostream& out) const;
+	// ------------------------------------ writeBaseline --------------------------------------
+
+// purpose: keep the results to compare later runs with
+// preconditions: run has been called
+// postconditions: the results are written to fileName, as JSON if it ends in .json and YAML
+//	otherwise; throws cv::Exception if it cannot be written
+
+// --------------------------------------------------------------------------------------
+	void writeBaseline(const string& fileName) const;
+	// ------------------------------------ compare --------------------------------------
+
+// purpose: find what got worse since a baseline was written
+// preconditions: run has been called; tolerance is at least 0
+// postconditions: writes one line to out for every regression: a count further from the same
+//	expected count than in the baseline, an image recognized in the baseline that failed now,
+//	or a 50th or 95th percentile above baseline * (1 + tolerance) + slackMs. A profile or
+//	parameter that differs from the baseline's, and images that are not in both, are only
+//	noted. Returns the number of regressions; throws cv::Exception if the baseline cannot be read
+
+// --------------------------------------------------------------------------------------
+	int compare(const string& baselineName, double tolerance, double slackMs, ostream& out) const;
+	// ------------------------------------ getResults --------------------------------------
+
+// purpose: get what was measured
+// preconditions: none
+// postconditions: returns one result per test, in the order the tests were added
+
+// --------------------------------------------------------------------------------------
+	const vector<RegressionResult>& getResults() const;
+	// ------------------------------------ loadManifest --------------------------------------
+
+// purpose: read a corpus of tests from a file
+// preconditions: none
+// postconditions: the tests of fileName are appended to tests. Each line holds one test, either
+//	as the image name followed by its six counts, or as a Test{ "name", ... } initializer as
+//	written in BenchmarkCommands.cpp and by generate; blank lines and lines starting with # are
+//	skipped. Throws cv::Exception naming the line if the file cannot be read or a line is not a
+//	test
+
+// --------------------------------------------------------------------------------------
+	static void loadManifest(const string& fileName, vector<Test>& tests);
+	// ------------------------------------ countName --------------------------------------
+
+// purpose: get the name of one of the counts of a test
+// preconditions: index is at least 0 and less than NUM_TEST_COUNTS
+// postconditions: returns the camel case name of the count (e.g. "weakEntities")
+
+// --------------------------------------------------------------------------------------
+	static const char* countName(int index);
+
+private:
+	int repetitions;
+	RecognitionParams params;
+	vector<Test> tests;
+	vector<RegressionResult> results;
+
+	// ------------------------------------ measure --------------------------------------
+
+// purpose: measure one test image
+// preconditions: image is a valid BGR image
+// postconditions: result holds the counts, latencies and peak memory of image
+
+// --------------------------------------------------------------------------------------
+	void measure(const Mat& image, RecognitionScratch& scratch, RecognitionResult& recognition,
+		RegressionResult& result) const;
+	// ------------------------------------ percentile --------------------------------------
+
+// purpose: get a percentile of sorted samples
+// preconditions: sorted is in increasing order; fraction is between 0 and 1
+// postconditions: returns the smallest sample at least fraction of the samples are not above,
+//	or 0 if there are none
+
+// --------------------------------------------------------------------------------------
+	static double percentile(const vector<double>& sorted, double fraction);
+	// ------------------------------------ paramFields --------------------------------------
+
+// purpose: list the parameters a baseline is measured with
+// preconditions: none
+// postconditions: names and values hold every field of params but the contour backend, which
+//	is stored by name, in the same order every time
+
+// --------------------------------------------------------------------------------------
+	static void paramFields(const RecognitionParams& params, vector<string>& names,
+		vector<double>& values);
+};
+
+#endif
@@ -0,0 +1,458 @@
+// ResultArchive.cpp
+// Purpose: store the shape tables of millions of recognized diagrams compactly, and scan or
+//	filter them without parsing text or loading them into the heap
+// Functionality: ResultArchiveWriter appends one binary record per image to an archive file: the
+//	image name and size, the count of every type, and every shape with its type, bounding box,
+//	nesting parent and polygon points. ResultArchiveReader maps the file into memory and walks the
+//	records in place; an ArchiveRecord points straight into the mapping, so filtering by the
+//	counts only reads the record headers. A record can be copied into a ShapeTable, e.g. to be
+//	written as JSON by ResultWriter
+// Assumptions:
+//	Archives are written and read on little endian machines (x86 and ARM)
+//	The format is versioned; a reader only opens archives of its own ARCHIVE_VERSION
+//	An archive is not read while it is being written
+// Authors: Allan Genari Gaarden, Tommy Ni, Joshua Medvinsky
+
+#include "ResultArchive.h"
+#include <cstddef>
+#include <cstring>
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// first bytes of every archive
+static const char ARCHIVE_MAGIC[4] = { 'E', 'R', 'D', 'A' };
+
+// the reader hands out the points of the mapping as cv::Point, and every part of a record keeps
+//	the next one 4 byte aligned
+static_assert(sizeof(Point) == 2 * sizeof(int32_t), "cv::Point must be two 32 bit ints");
+static_assert(sizeof(ArchiveHeader) == 16, "ArchiveHeader must not be padded");
+static_assert(sizeof(ArchiveRecordHeader) % 4 == 0, "ArchiveRecordHeader must keep 4 byte alignment");
+static_assert(sizeof(ArchiveShape) == 32, "ArchiveShape must not be padded");
+
+// ------------------------------------ parameter constructor --------------------------------------
+
+// purpose: start a new archive
+// preconditions: fileName is a writable path
+// postconditions: fileName holds an empty archive, replacing any file there; throws
+//	cv::Exception if it cannot be created
+
+// --------------------------------------------------------------------------------------
+ResultArchiveWriter::ResultArchiveWriter(const string& fileName)
+{
+	file.open(fileName, ios::binary | ios::trunc);
+	ArchiveHeader header = {};
+	memcpy(header.magic, ARCHIVE_MAGIC, sizeof(header.magic));
+	header.version = ARCHIVE_VERSION;
+	file.write((const char*)&header, sizeof(header));
+	if (!file) CV_Error(Error::StsError, "could not create archive " + fileName);
+}
+
+// ------------------------------------ destructor --------------------------------------
+
+// purpose: make sure the archive is complete
+// preconditions: none
+// postconditions: calls close
+
+// --------------------------------------------------------------------------------------
+ResultArchiveWriter::~ResultArchiveWriter()
+{
+	close();
+}
+
+// ------------------------------------ write --------------------------------------
+
+// purpose: append the shapes of one image
+// preconditions: close has not been called; shapes are in the coordinates of the image
+// postconditions: one record is appended, with discarded shapes kept so shape ids and parents
+//	stay those of shapes; safe to call from several threads at once, records are then in the
+//	order the calls were made. Throws cv::Exception if the record cannot be written
+
+// --------------------------------------------------------------------------------------
+void ResultArchiveWriter::write(const string& imageName, Size imageSize, const ShapeTable& shapes)
+{
+	lock_guard<mutex> guard(lock);
+
+	ArchiveRecordHeader header = {};
+	header.nameBytes = (uint32_t)imageName.size();
+	header.width = imageSize.width;
+	header.height = imageSize.height;
+	for (int type = 0; type < NUM_SHAPE_TYPES - 1; type++)
+	{
+		header.counts[type] = shapes.count((ShapeType)type);
+	}
+	header.numShapes = (uint32_t)shapes.size();
+	for (int id = 0; id < shapes.size(); id++)
+	{
+		header.numPoints += (uint32_t)shapes.getNumPoints(id);
+	}
+
+	size_t paddedNameBytes = (imageName.size() + 3) / 4 * 4;
+	size_t shapesOffset = sizeof(header) + paddedNameBytes;
+	size_t pointsOffset = shapesOffset + header.numShapes * sizeof(ArchiveShape);
+	header.recordBytes = (uint32_t)(pointsOffset + header.numPoints * sizeof(Point));
+
+	// zero filled, so the padding of the name is the same in every archive
+	record.assign(header.recordBytes, 0);
+	memcpy(record.data(), &header, sizeof(header));
+	memcpy(record.data() + sizeof(header), imageName.data(), imageName.size());
+
+	uint32_t firstPoint = 0;
+	for (int id = 0; id < shapes.size(); id++)
+	{
+		const Rect& box = shapes.getBoundingBox(id);
+		ArchiveShape shape;
+		shape.type = (int32_t)shapes.getType(id);
+		shape.parent = shapes.getParent(id);
+		shape.x = box.x;
+		shape.y = box.y;
+		shape.width = box.width;
+		shape.height = box.height;
+		shape.firstPoint = firstPoint;
+		shape.numPoints = (uint32_t)shapes.getNumPoints(id);
+		memcpy(record.data() + shapesOffset + id * sizeof(ArchiveShape), &shape, sizeof(shape));
+		memcpy(record.data() + pointsOffset + firstPoint * sizeof(Point), shapes.getPoints(id),
+			shape.numPoints * sizeof(Point));
+		firstPoint += shape.numPoints;
+	}
+
+	file.write(record.data(), record.size());
+	if (!file) CV_Error(Error::StsError, "could not write the record of " + imageName);
+	numRecords++;
+}
+
+// ------------------------------------ close --------------------------------------
+
+// purpose: finish the archive
+// preconditions: none
+// postconditions: the number of records is stored in the header and the file is closed; later
+//	calls do nothing
+
+// --------------------------------------------------------------------------------------
+void ResultArchiveWriter::close()
+{
+	lock_guard<mutex> guard(lock);
+	if (!file.is_open()) return;
+
+	file.seekp(offsetof(ArchiveHeader, numRecords));
+	file.write((const char*)&numRecords, sizeof(numRecords));
+	file.close();
+}
+
+// ------------------------------------ getNumRecords --------------------------------------
+
+// purpose: get how many records were written
+// preconditions: none
+// postconditions: returns the number of calls to write that succeeded
+
+// --------------------------------------------------------------------------------------
+long long ResultArchiveWriter::getNumRecords()
+{
+	lock_guard<mutex> guard(lock);
+	return (long long)numRecords;
+}
+
+// ------------------------------------ getImageName --------------------------------------
+
+// purpose: get the name of the image the record was made from
+// preconditions: the record was filled in by ResultArchiveReader::next
+// postconditions: returns a copy of the name
+
+// --------------------------------------------------------------------------------------
+string ArchiveRecord::getImageName() const
+{
+	return string(name, header->nameBytes);
+}
+
+// ------------------------------------ getImageSize --------------------------------------
+
+// purpose: get the size of the image
+// preconditions: the record was filled in by ResultArchiveReader::next
+// postconditions: returns the width and height of the image
+
+// --------------------------------------------------------------------------------------
+Size ArchiveRecord::getImageSize() const
+{
+	return Size(header->width, header->height);
+}
+
+// ------------------------------------ count --------------------------------------
+
+// purpose: get the number of shapes of a type
+// preconditions: the record was filled in by ResultArchiveReader::next
+// postconditions: returns the count stored in the record header, 0 for ShapeType::Discarded
+
+// --------------------------------------------------------------------------------------
+int ArchiveRecord::count(ShapeType type) const
+{
+	if (type == ShapeType::Discarded) return 0;
+	return header->counts[(int)type];
+}
+
+// ------------------------------------ getNumShapes --------------------------------------
+
+// purpose: get the number of shapes stored
+// preconditions: the record was filled in by ResultArchiveReader::next
+// postconditions: returns the number of shapes, discarded ones included
+
+// --------------------------------------------------------------------------------------
+int ArchiveRecord::getNumShapes() const
+{
+	return (int)header->numShapes;
+}
+
+// ------------------------------------ getType --------------------------------------
+
+// purpose: get the type of a shape
+// preconditions: id is between 0 and getNumShapes() - 1
+// postconditions: returns the type of shape id
+
+// --------------------------------------------------------------------------------------
+ShapeType ArchiveRecord::getType(int id) const
+{
+	return (ShapeType)shapes[id].type;
+}
+
+// ------------------------------------ getBoundingBox --------------------------------------
+
+// purpose: get the bounding box of a shape
+// preconditions: id is between 0 and getNumShapes() - 1
+// postconditions: returns the bounding box of shape id
+
+// --------------------------------------------------------------------------------------
+Rect ArchiveRecord::getBoundingBox(int id) const
+{
+	const ArchiveShape& shape = shapes[id];
+	return Rect(shape.x, shape.y, shape.width, shape.height);
+}
+
+// ------------------------------------ getParent --------------------------------------
+
+// purpose: get the shape a shape is nested in
+// preconditions: id is between 0 and getNumShapes() - 1
+// postconditions: returns the id of the closest enclosing shape, or -1 if it is not nested
+
+// --------------------------------------------------------------------------------------
+int ArchiveRecord::getParent(int id) const
+{
+	return shapes[id].parent;
+}
+
+// ------------------------------------ getPoints --------------------------------------
+
+// purpose: get the polygon of a shape without copying it
+// preconditions: id is between 0 and getNumShapes() - 1
+// postconditions: returns a pointer to getNumPoints(id) points inside the mapped archive
+
+// --------------------------------------------------------------------------------------
+const Point* ArchiveRecord::getPoints(int id) const
+{
+	return points + shapes[id].firstPoint;
+}
+
+// ------------------------------------ getNumPoints --------------------------------------
+
+// purpose: get the number of points of a shape
+// preconditions: id is between 0 and getNumShapes() - 1
+// postconditions: returns the number of points of the polygon of shape id
+
+// --------------------------------------------------------------------------------------
+int ArchiveRecord::getNumPoints(int id) const
+{
+	return (int)shapes[id].numPoints;
+}
+
+// ------------------------------------ toShapeTable --------------------------------------
+
+// purpose: copy the record into a shape table
+// preconditions: the record was filled in by ResultArchiveReader::next
+// postconditions: shapes holds every shape of the record with the same ids, types and parents;
+//	contour indices are not stored and are -1
+
+// --------------------------------------------------------------------------------------
+void ArchiveRecord::toShapeTable(ShapeTable& shapes) const
+{
+	shapes.clear();
+	vector<Point> polygon;
+	for (int id = 0; id < getNumShapes(); id++)
+	{
+		// next only checked the sizes of the record, not where each shape's points are
+		const ArchiveShape& shape = this->shapes[id];
+		if (shape.type < 0 || shape.type >= NUM_SHAPE_TYPES ||
+			(uint64_t)shape.firstPoint + shape.numPoints > header->numPoints)
+		{
+			CV_Error(Error::StsError, "damaged shape in the record of " + getImageName());
+		}
+
+		polygon.assign(getPoints(id), getPoints(id) + shape.numPoints);
+		shapes.addShape(polygon, (ShapeType)shape.type, -1);
+		shapes.setParent(id, shape.parent);
+	}
+}
+
+// ------------------------------------ parameter constructor --------------------------------------
+
+// purpose: map an archive into memory
+// preconditions: fileName is an archive written by ResultArchiveWriter
+// postconditions: the file is mapped read only and the reader is at the first record; nothing
+//	is read until next is called. Throws cv::Exception if the file cannot be mapped or is not an
+//	archive of ARCHIVE_VERSION
+
+// --------------------------------------------------------------------------------------
+ResultArchiveReader::ResultArchiveReader(const string& fileName)
+{
+	// the pages are only read from disk as the records are walked, so a corpus larger than memory
+	//	can be scanned
+#ifdef _WIN32
+	HANDLE file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+		FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	LARGE_INTEGER fileSize;
+	if (file == INVALID_HANDLE_VALUE || !GetFileSizeEx(file, &fileSize))
+	{
+		if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+		CV_Error(Error::StsError, "could not open archive " + fileName);
+	}
+	fileHandle = file;
+	size = (size_t)fileSize.QuadPart;
+	if (size >= sizeof(ArchiveHeader))
+	{
+		mappingHandle = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (mappingHandle != nullptr) data = (const char*)MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+	}
+#else
+	fileDescriptor = open(fileName.c_str(), O_RDONLY);
+	struct stat status;
+	if (fileDescriptor < 0 || fstat(fileDescriptor, &status) != 0)
+	{
+		if (fileDescriptor >= 0) ::close(fileDescriptor);
+		fileDescriptor = -1;
+		CV_Error(Error::StsError, "could not open archive " + fileName);
+	}
+	size = (size_t)status.st_size;
+	if (size >= sizeof(ArchiveHeader))
+	{
+		void* mapped = mmap(nullptr, size, PROT_READ, MAP_SHARED, fileDescriptor, 0);
+		if (mapped != MAP_FAILED)
+		{
+			data = (const char*)mapped;
+			// records are read once each, front to back
+			madvise(mapped, size, MADV_SEQUENTIAL);
+		}
+	}
+#endif
+
+	const ArchiveHeader* header = (const ArchiveHeader*)data;
+	if (data == nullptr || memcmp(header->magic, ARCHIVE_MAGIC, sizeof(ARCHIVE_MAGIC)) != 0 ||
+		header->version != ARCHIVE_VERSION)
+	{
+		// the destructor does not run when the constructor throws
+		release();
+		CV_Error(Error::StsBadArg, fileName + " is not an archive of version " + to_string(ARCHIVE_VERSION));
+	}
+	offset = sizeof(ArchiveHeader);
+}
+
+// ------------------------------------ destructor --------------------------------------
+
+// purpose: release the mapping
+// preconditions: no ArchiveRecord of this reader is used any more
+// postconditions: the file is unmapped and closed
+
+// --------------------------------------------------------------------------------------
+ResultArchiveReader::~ResultArchiveReader()
+{
+	release();
+}
+
+// ------------------------------------ release --------------------------------------
+
+// purpose: unmap and close the file
+// preconditions: no ArchiveRecord of this reader is used any more
+// postconditions: whatever of the mapping and the file is open is released; calling it again
+//	does nothing
+
+// --------------------------------------------------------------------------------------
+void ResultArchiveReader::release()
+{
+#ifdef _WIN32
+	if (data != nullptr) UnmapViewOfFile(data);
+	if (mappingHandle != nullptr) CloseHandle(mappingHandle);
+	if (fileHandle != nullptr) CloseHandle(fileHandle);
+	mappingHandle = nullptr;
+	fileHandle = nullptr;
+#else
+	if (data != nullptr) munmap((void*)data, size);
+	if (fileDescriptor >= 0) ::close(fileDescriptor);
+	fileDescriptor = -1;
+#endif
+	data = nullptr;
+}
+
+// ------------------------------------ next --------------------------------------
+
+// purpose: move to the next record
+// preconditions: none
+// postconditions: returns true with record pointing at the next record, or false after the last
+//	one; throws cv::Exception if the record runs past the end of the file or its sizes disagree
+
+// --------------------------------------------------------------------------------------
+bool ResultArchiveReader::next(ArchiveRecord& record)
+{
+	if (offset == size) return false;
+
+	// an archive whose writer died in the middle of a record ends in part of a header, which
+	//	must not be read past the end of the mapping
+	if (size - offset < sizeof(ArchiveRecordHeader))
+	{
+		CV_Error(Error::StsError, "truncated record at byte " + to_string(offset));
+	}
+
+	// only the header is read; the shapes and points stay untouched until they are asked for
+	const ArchiveRecordHeader* header = (const ArchiveRecordHeader*)(data + offset);
+	uint64_t paddedNameBytes = ((uint64_t)header->nameBytes + 3) / 4 * 4;
+	uint64_t expectedBytes = sizeof(ArchiveRecordHeader) + paddedNameBytes +
+		(uint64_t)header->numShapes * sizeof(ArchiveShape) + (uint64_t)header->numPoints * sizeof(Point);
+	if (header->recordBytes != expectedBytes || header->recordBytes > size - offset)
+	{
+		CV_Error(Error::StsError, "damaged record at byte " + to_string(offset));
+	}
+
+	record.header = header;
+	record.name = data + offset + sizeof(ArchiveRecordHeader);
+	record.shapes = (const ArchiveShape*)(record.name + paddedNameBytes);
+	record.points = (const Point*)(record.shapes + header->numShapes);
+	offset += header->recordBytes;
+	return true;
+}
+
+// ------------------------------------ rewind --------------------------------------
+
+// purpose: go back to the first record
+// preconditions: none
+// postconditions: the next call to next returns the first record
+
+// --------------------------------------------------------------------------------------
+void ResultArchiveReader::rewind()
+{
+	offset = sizeof(ArchiveHeader);
+}
+
+// ------------------------------------ getNumRecords --------------------------------------
+
+// purpose: get how many records the archive holds without walking them
+// preconditions: none
+// postconditions: returns the count stored when the archive was closed, 0 if it never was
+
+// --------------------------------------------------------------------------------------
+long long ResultArchiveReader::getNumRecords() const
+{
+	return (long long)((const ArchiveHeader*)data)->numRecords;
+}
@@ -0,0 +1,295 @@
+// ResultArchive.h
+// Purpose: store the shape tables of millions of recognized diagrams compactly, and scan or
+//	filter them without parsing text or loading them into the heap
+// Functionality: ResultArchiveWriter appends one binary record per image to an archive file: the
+//	image name and size, the count of every type, and every shape with its type, bounding box,
+//	nesting parent and polygon points. ResultArchiveReader maps the file into memory and walks the
+//	records in place; an ArchiveRecord points straight into the mapping, so filtering by the
+//	counts only reads the record headers. A record can be copied into a ShapeTable, e.g. to be
+//	written as JSON by ResultWriter
+// Assumptions:
+//	Archives are written and read on little endian machines (x86 and ARM)
+//	The format is versioned; a reader only opens archives of its own ARCHIVE_VERSION
+//	An archive is not read while it is being written
+// Authors: Allan Genari Gaarden, Tommy Ni, Joshua Medvinsky
+
+#ifndef RESULT_ARCHIVE_H
+#define RESULT_ARCHIVE_H
+
+#include <opencv2/core.hpp>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include "ShapeTable.h"
+using namespace std;
+using namespace cv;
+
+// raised whenever the layout below changes
+const uint32_t ARCHIVE_VERSION = 1;
+
+// the file layout, with every field 4 byte aligned: one ArchiveHeader, then per image an
+//	ArchiveRecordHeader, the image name padded with zeros to a multiple of 4 bytes, numShapes
+//	ArchiveShapes and numPoints points of two int32_t each
+struct ArchiveHeader
+{
+	char magic[4];
+	uint32_t version;
+	// written when the archive is closed; 0 if the writer stopped before that
+	uint64_t numRecords;
+};
+
+struct ArchiveRecordHeader
+{
+	// size of the whole record, so the next one can be found without reading this one
+	uint32_t recordBytes;
+	uint32_t nameBytes;
+	int32_t width;
+	int32_t height;
+	// shapes of each type, indexed by ShapeType; discarded shapes are not counted
+	int32_t counts[NUM_SHAPE_TYPES - 1];
+	uint32_t numShapes;
+	uint32_t numPoints;
+};
+
+struct ArchiveShape
+{
+	int32_t type;
+	int32_t parent;
+	int32_t x;
+	int32_t y;
+	int32_t width;
+	int32_t height;
+	// the points of the shape within the points of its record
+	uint32_t firstPoint;
+	uint32_t numPoints;
+};
+
+class ResultArchiveWriter
+{
+public:
+	// default constructor not allowed
+	ResultArchiveWriter() = delete;
+	// ------------------------------------ parameter constructor --------------------------------------
+
+// purpose: start a new archive
+// preconditions: fileName is a writable path
+// postconditions: fileName holds an empty archive, replacing any file there; throws
+//	cv::Exception if it cannot be created
+
+// --------------------------------------------------------------------------------------
+	ResultArchiveWriter(const string& fileName);
+	// ------------------------------------ destructor --------------------------------------
+
+// purpose: make sure the archive is complete
+// preconditions: none
+// postconditions: calls close
+
+// --------------------------------------------------------------------------------------
+	~ResultArchiveWriter();
+	// ------------------------------------ write --------------------------------------
+
+// purpose: append the shapes of one image
+// preconditions: close has not been called; shapes are in the coordinates of the image
+// postconditions: one record is appended, with discarded shapes kept so shape ids and parents
+//	stay those of shapes; safe to call from several threads at once, records are then in the
+//	order the calls were made. Throws cv::Exception if the record cannot be written
+
+// --------------------------------------------------------------------------------------
+	void write(const string& imageName, Size imageSize, const ShapeTable& shapes);
+	// ------------------------------------ close --------------------------------------
+
+// purpose: finish the archive
+// preconditions: none
+// postconditions: the number of records is stored in the header and the file is closed; later
+//	calls do nothing
+
+// --------------------------------------------------------------------------------------
+	void close();
+	// ------------------------------------ getNumRecords --------------------------------------
+
+// purpose: get how many records were written
+// preconditions: none
+// postconditions: returns the number of calls to write that succeeded
+
+// --------------------------------------------------------------------------------------
+	long long getNumRecords();
+
+private:
+	ofstream file;
+	mutex lock;
+	uint64_t numRecords = 0;
+	// the record being written, built whole so it reaches the file with one write
+	vector<char> record;
+};
+
+// one record of a mapped archive; only valid while its reader is
+class ArchiveRecord
+{
+public:
+	// ------------------------------------ getImageName --------------------------------------
+
+// purpose: get the name of the image the record was made from
+// preconditions: the record was filled in by ResultArchiveReader::next
+// postconditions: returns a copy of the name
+
+// --------------------------------------------------------------------------------------
+	string getImageName() const;
+	// ------------------------------------ getImageSize --------------------------------------
+
+// purpose: get the size of the image
+// preconditions: the record was filled in by ResultArchiveReader::next
+// postconditions: returns the width and height of the image
+
+// --------------------------------------------------------------------------------------
+	Size getImageSize() const;
+	// ------------------------------------ count --------------------------------------
+
+// purpose: get the number of shapes of a type
+// preconditions: the record was filled in by ResultArchiveReader::next
+// postconditions: returns the count stored in the record header, 0 for ShapeType::Discarded
+
+// --------------------------------------------------------------------------------------
+	int count(ShapeType type) const;
+	// ------------------------------------ getNumShapes --------------------------------------
+
+// purpose: get the number of shapes stored
+// preconditions: the record was filled in by ResultArchiveReader::next
+// postconditions: returns the number of shapes, discarded ones included
+
+// --------------------------------------------------------------------------------------
+	int getNumShapes() const;
+	// ------------------------------------ getType --------------------------------------
+
+// purpose: get the type of a shape
+// preconditions: id is between 0 and getNumShapes() - 1
+// postconditions: returns the type of shape id
+
+// --------------------------------------------------------------------------------------
+	ShapeType getType(int id) const;
+	// ------------------------------------ getBoundingBox --------------------------------------
+
+// purpose: get the bounding box of a shape
+// preconditions: id is between 0 and getNumShapes() - 1
+// postconditions: returns the bounding box of shape id
+
+// --------------------------------------------------------------------------------------
+	Rect getBoundingBox(int id) const;
+	// ------------------------------------ getParent --------------------------------------
+
+// purpose: get the shape a shape is nested in
+// preconditions: id is between 0 and getNumShapes() - 1
+// postconditions: returns the id of the closest enclosing shape, or -1 if it is not nested
+
+// --------------------------------------------------------------------------------------
+	int getParent(int id) const;
+	// ------------------------------------ getPoints --------------------------------------
+
+// purpose: get the polygon of a shape without copying it
+// preconditions: id is between 0 and getNumShapes() - 1
+// postconditions: returns a pointer to getNumPoints(id) points inside the mapped archive
+
+// --------------------------------------------------------------------------------------
+	const Point* getPoints(int id) const;
+	// ------------------------------------ getNumPoints --------------------------------------
+
+// purpose: get the number of points of a shape
+// preconditions: id is between 0 and getNumShapes() - 1
+// postconditions: returns the number of points of the polygon of shape id
+
+// --------------------------------------------------------------------------------------
+	int getNumPoints(int id) const;
+	// ------------------------------------ toShapeTable --------------------------------------
+
+// purpose: copy the record into a shape table
+// preconditions: the record was filled in by ResultArchiveReader::next
+// postconditions: shapes holds every shape of the record with the same ids, types and parents;
+//	contour indices are not stored and are -1
+
+// --------------------------------------------------------------------------------------
+	void toShapeTable(ShapeTable& shapes) const;
+
+private:
+	friend class ResultArchiveReader;
+
+	const ArchiveRecordHeader* header = nullptr;
+	const char* name = nullptr;
+	const ArchiveShape* shapes = nullptr;
+	const Point* points = nullptr;
+};
+
+class ResultArchiveReader
+{
+public:
+	// default constructor not allowed
+	ResultArchiveReader() = delete;
+	// the mapping belongs to one reader only
+	ResultArchiveReader(const ResultArchiveReader&) = delete;
+	ResultArchiveReader& operator=(const ResultArchiveReader&) = delete;
+	// ------------------------------------ parameter constructor --------------------------------------
+
+// purpose: map an archive into memory
+// preconditions: fileName is an archive written by ResultArchiveWriter
+// postconditions: the file is mapped read only and the reader is at the first record; nothing
+//	is read until next is called. Throws cv::Exception if the file cannot be mapped or is not an
+//	archive of ARCHIVE_VERSION
+
+// --------------------------------------------------------------------------------------
+	ResultArchiveReader(const string& fileName);
+	// ------------------------------------ destructor --------------------------------------
+
+// purpose: release the mapping
+// preconditions: no ArchiveRecord of this reader is used any more
+// postconditions: the file is unmapped and closed
+
+// --------------------------------------------------------------------------------------
+	~ResultArchiveReader();
+	// ------------------------------------ next --------------------------------------
+
+// purpose: move to the next record
+// preconditions: none
+// postconditions: returns true with record pointing at the next record, or false after the last
+//	one; throws cv::Exception if the record runs past the end of the file or its sizes disagree
+
+// --------------------------------------------------------------------------------------
+	bool next(ArchiveRecord& record);
+	// ------------------------------------ rewind --------------------------------------
+
+// purpose: go back to the first record
+// preconditions: none
+// postconditions: the next call to next returns the first record
+
+// --------------------------------------------------------------------------------------
+	void rewind();
+	// ------------------------------------ getNumRecords --------------------------------------
+
+// purpose: get how many records the archive holds without walking them
+// preconditions: none
+// postconditions: returns the count stored when the archive was closed, 0 if it never was
+
+// --------------------------------------------------------------------------------------
+	long long getNumRecords() const;
+
+private:
+	const char* data = nullptr;
+	size_t size = 0;
+	size_t offset = 0;
+#ifdef _WIN32
+	// HANDLEs of the file and of its mapping
+	void* fileHandle = nullptr;
+	void* mappingHandle = nullptr;
+#else
+	int fileDescriptor = -1;
+#endif
+
+	// ------------------------------------ release --------------------------------------
+
+// purpose: unmap and close the file
+// preconditions: no ArchiveRecord of this reader is used any more
+// postconditions: whatever of the mapping and the file is open is released; calling it again
+//	does nothing
+
+// --------------------------------------------------------------------------------------
+	void release();
+};
+
+#endif
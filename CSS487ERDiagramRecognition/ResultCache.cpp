@@ -0,0 +1,329 @@
+// ResultCache.cpp
+// Purpose: skip recognizing an image again when the same pixels were already recognized with the
+//	same parameters, e.g. re-uploaded or forwarded attachments
+// Functionality: each result is stored in a directory as one FileStorage file named after a 64
+//	bit FNV-1a hash of the decoded pixels, every RecognitionParams field and a format version.
+//	An entry holds the image size, the counts and every shape of the table. Entries are written
+//	to a temporary file and renamed into place, so several processes can share the directory and
+//	a reader only ever sees whole entries. A hit marks its entry as recently used, and once the
+//	directory grows past its size limit the least recently used entries are removed
+// Assumptions:
+//	The directory is on a local file system where renaming a file replaces the target at once
+//	The last write time of each entry is its last use; other tools do not touch the directory
+//	Two images or parameter sets never share a 64 bit hash
+// Authors: Allan Genari Gaarden, Tommy Ni, Joshua Medvinsky
+
+#include "ResultCache.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <random>
+
+// part of every key; raise it whenever recognition changes in a way the parameters do not show,
+//	so the entries made by older code are never returned
+static const int CACHE_FORMAT_VERSION = 3;
+
+// FNV-1a constants for 64 bit hashes
+static const uint64 FNV_OFFSET_BASIS = 14695981039346656037ULL;
+static const uint64 FNV_PRIME = 1099511628211ULL;
+
+// temporary files are named with this prefix; ones older than STALE_MINUTES belong to a writer
+//	that stopped before renaming them
+static const string TEMPORARY_PREFIX = "tmp-";
+static const int STALE_MINUTES = 10;
+
+// ------------------------------------ parameter constructor --------------------------------------
+
+// purpose: open a cache directory, creating it if needed
+// preconditions: maxBytes is at least 1
+// postconditions: entries are kept in directory, which holds about maxBytes at most; throws
+//	cv::Exception if the directory cannot be created
+
+// --------------------------------------------------------------------------------------
+ResultCache::ResultCache(const string& directory, long long maxBytes)
+{
+	this->directory = directory;
+	this->maxBytes = max(1LL, maxBytes);
+
+	error_code ec;
+	filesystem::create_directories(directory, ec);
+	if (!filesystem::is_directory(directory, ec))
+	{
+		CV_Error(Error::StsError, "could not create cache directory " + directory);
+	}
+
+	random_device random;
+	char prefix[32];
+	snprintf(prefix, sizeof(prefix), "%08x%08x-", random(), random());
+	temporaryPrefix = TEMPORARY_PREFIX + prefix;
+
+	// measures what other runs left, and trims it if the limit is now lower
+	evict();
+}
+
+// ------------------------------------ hashKey --------------------------------------
+
+// purpose: get the key of recognizing an image with some parameters
+// preconditions: image is a valid image
+// postconditions: returns the FNV-1a hash of the size, type and pixels of image, every field of
+//	params and the format version; the same pixels decoded from any file give the same key
+
+// --------------------------------------------------------------------------------------
+uint64 ResultCache::hashKey(const Mat& image, const RecognitionParams& params)
+{
+	uint64 hash = FNV_OFFSET_BASIS;
+	int header[] = { CACHE_FORMAT_VERSION, image.rows, image.cols, image.type() };
+	hashBytes(hash, header, sizeof(header));
+
+	// row by row, so the padding of a submatrix is never part of the key
+	size_t rowBytes = image.cols * image.elemSize();
+	for (int y = 0; y < image.rows; y++)
+	{
+		hashBytes(hash, image.ptr(y), rowBytes);
+	}
+
+	// field by field, so the padding of the struct is never part of the key either. The low
+	//	memory mode is left out: its compressed contours keep the ends of every straight run,
+	//	which are the points the polygons are approximated from, so it finds the same shapes
+	int intParams[] = { params.minThreshold, params.maxThreshold, params.pyramidLevels,
+		params.pyramidInkThreshold, params.connectorOutlineWidth, params.connectorSnapDistance,
+		params.boundingBoxOffByPixel, (int)params.contourBackend };
+	double doubleParams[] = { params.thresholdAreaForRect, params.thresholdAreaForCircle,
+		params.thresholdRatioForSqar, params.thresholdForOutsideContour, params.maxAspectRatio,
+		params.approxEpsilonFraction, params.minConnectorLength };
+	hashBytes(hash, intParams, sizeof(intParams));
+	hashBytes(hash, doubleParams, sizeof(doubleParams));
+	return hash;
+}
+
+// ------------------------------------ lookup --------------------------------------
+
+// purpose: get a stored result
+// preconditions: key was made by hashKey
+// postconditions: returns true with the stored shapes and image size, and marks the entry as
+//	recently used; returns false, leaving shapes cleared, if there is no whole entry for key
+
+// --------------------------------------------------------------------------------------
+bool ResultCache::lookup(uint64 key, ShapeTable& shapes, Size& imageSize)
+{
+	shapes.clear();
+	string path = entryPath(key);
+	bool found = false;
+	try
+	{
+		FileStorage file(path, FileStorage::READ);
+		if (file.isOpened() && (int)file["version"] == CACHE_FORMAT_VERSION)
+		{
+			imageSize = Size((int)file["width"], (int)file["height"]);
+			FileNode shapeNodes = file["shapes"];
+			vector<Point> polygon;
+			bool valid = true;
+			for (int i = 0; i < (int)shapeNodes.size() && valid; i++)
+			{
+				FileNode node = shapeNodes[i];
+				int type = (int)node["type"];
+				node["points"] >> polygon;
+				valid = type >= 0 && type < NUM_SHAPE_TYPES && !polygon.empty();
+				if (!valid) break;
+
+				int id = shapes.addShape(polygon, (ShapeType)type, (int)node["contour"]);
+				shapes.setParent(id, (int)node["parent"]);
+			}
+			found = valid && (int)file["numShapes"] == shapes.size();
+		}
+	}
+	catch (const cv::Exception&)
+	{
+		// an entry removed or replaced while it was read is only a miss
+		found = false;
+	}
+
+	if (!found)
+	{
+		shapes.clear();
+		numMisses++;
+		return false;
+	}
+
+	// the write time is the last use, so the entry moves to the back of the eviction order
+	error_code ec;
+	filesystem::last_write_time(path, filesystem::file_time_type::clock::now(), ec);
+	numHits++;
+	return true;
+}
+
+// ------------------------------------ store --------------------------------------
+
+// purpose: keep a result for later
+// preconditions: key was made by hashKey for the image shapes were recognized from
+// postconditions: the entry for key is written, replacing any other, and the least recently
+//	used entries are removed if the directory grew past its limit; a failed write is ignored
+
+// --------------------------------------------------------------------------------------
+void ResultCache::store(uint64 key, Size imageSize, const ShapeTable& shapes)
+{
+	// the extension tells FileStorage to write YAML
+	filesystem::path temporaryPath = filesystem::path(directory) /
+		(temporaryPrefix + to_string(numTemporaryFiles++) + ".yml");
+	error_code ec;
+	try
+	{
+		FileStorage file(temporaryPath.string(), FileStorage::WRITE);
+		if (!file.isOpened()) return;
+
+		file << "version" << CACHE_FORMAT_VERSION;
+		file << "width" << imageSize.width << "height" << imageSize.height;
+		// the counts are only for people and tools reading the entry; lookup rebuilds them
+		file << "counts" << "{" <<
+			"attributes" << shapes.count(ShapeType::Attribute) <<
+			"entities" << shapes.count(ShapeType::Entity) <<
+			"relationships" << shapes.count(ShapeType::Relationship) <<
+			"weakEntities" << shapes.count(ShapeType::WeakEntity) <<
+			"weakRelationships" << shapes.count(ShapeType::WeakRelationship) <<
+			"multivaluedAttributes" << shapes.count(ShapeType::MultivaluedAttribute) << "}";
+		// discarded shapes are kept too, so a hit gives the same ids as recognizing again
+		file << "numShapes" << shapes.size();
+		file << "shapes" << "[";
+		for (int id = 0; id < shapes.size(); id++)
+		{
+			file << "{" << "type" << (int)shapes.getType(id) << "contour" << shapes.getContourIndex(id) <<
+				"parent" << shapes.getParent(id) << "points" << shapes.getPolygon(id) << "}";
+		}
+		file << "]";
+		file.release();
+	}
+	catch (const cv::Exception&)
+	{
+		filesystem::remove(temporaryPath, ec);
+		return;
+	}
+
+	// readers see either the old entry or the whole new one, never a partly written file
+	filesystem::path path = entryPath(key);
+	filesystem::rename(temporaryPath, path, ec);
+	if (ec)
+	{
+		filesystem::remove(temporaryPath, ec);
+		return;
+	}
+	numStores++;
+
+	long long bytes = (long long)filesystem::file_size(path, ec);
+	bool full;
+	{
+		lock_guard<mutex> guard(sizeLock);
+		knownBytes += ec ? 0 : bytes;
+		full = knownBytes > maxBytes;
+	}
+	if (full) evict();
+}
+
+// ------------------------------------ evict --------------------------------------
+
+// purpose: bring the directory back under its size limit
+// preconditions: none
+// postconditions: if the entries take more than the limit, the least recently used ones are
+//	removed until they take at most 90% of it; temporary files left by writers that stopped
+//	are removed
+
+// --------------------------------------------------------------------------------------
+void ResultCache::evict()
+{
+	struct Entry
+	{
+		filesystem::path path;
+		filesystem::file_time_type lastUse;
+		long long bytes;
+	};
+
+	lock_guard<mutex> guard(sizeLock);
+	vector<Entry> entries;
+	long long totalBytes = 0;
+	filesystem::file_time_type now = filesystem::file_time_type::clock::now();
+	error_code ec;
+	for (filesystem::directory_iterator it(directory, ec), end; !ec && it != end; it.increment(ec))
+	{
+		const filesystem::path& path = it->path();
+		if (path.extension() != ".yml") continue;
+
+		// another process may remove an entry while the directory is read
+		error_code entryEc;
+		filesystem::file_time_type lastUse = it->last_write_time(entryEc);
+		if (entryEc) continue;
+		long long bytes = (long long)it->file_size(entryEc);
+		if (entryEc) continue;
+
+		if (path.filename().string().compare(0, TEMPORARY_PREFIX.size(), TEMPORARY_PREFIX) == 0)
+		{
+			if (now - lastUse > chrono::minutes(STALE_MINUTES)) filesystem::remove(path, entryEc);
+			continue;
+		}
+		entries.push_back(Entry{ path, lastUse, bytes });
+		totalBytes += bytes;
+	}
+
+	// stops below the limit, so the next few stores do not each scan the directory again
+	if (totalBytes > maxBytes)
+	{
+		sort(entries.begin(), entries.end(),
+			[](const Entry& a, const Entry& b) { return a.lastUse < b.lastUse; });
+		long long targetBytes = maxBytes / 10 * 9;
+		for (size_t i = 0; i < entries.size() && totalBytes > targetBytes; i++)
+		{
+			// an entry another process already removed no longer counts either
+			error_code removeEc;
+			if (filesystem::remove(entries[i].path, removeEc)) numEvictions++;
+			totalBytes -= entries[i].bytes;
+		}
+	}
+	knownBytes = totalBytes;
+}
+
+// ------------------------------------ getStats --------------------------------------
+
+// purpose: get how this process used the cache
+// preconditions: none
+// postconditions: returns the hits, misses, stores and evicted entries since the cache was opened
+
+// --------------------------------------------------------------------------------------
+CacheStats ResultCache::getStats() const
+{
+	CacheStats stats;
+	stats.hits = numHits;
+	stats.misses = numMisses;
+	stats.stores = numStores;
+	stats.evictions = numEvictions;
+	return stats;
+}
+
+// ------------------------------------ entryPath --------------------------------------
+
+// purpose: get where the entry of a key is stored
+// preconditions: none
+// postconditions: returns directory/<16 hex digits of key>.yml
+
+// --------------------------------------------------------------------------------------
+string ResultCache::entryPath(uint64 key) const
+{
+	char name[32];
+	snprintf(name, sizeof(name), "%016llx.yml", (unsigned long long)key);
+	return (filesystem::path(directory) / name).string();
+}
+
+// ------------------------------------ hashBytes --------------------------------------
+
+// purpose: add bytes to an FNV-1a hash
+// preconditions: hash was started at the FNV offset basis
+// postconditions: hash covers size more bytes from data
+
+// --------------------------------------------------------------------------------------
+void ResultCache::hashBytes(uint64& hash, const void* data, size_t size)
+{
+	const uchar* bytes = (const uchar*)data;
+	for (size_t i = 0; i < size; i++)
+	{
+		hash ^= bytes[i];
+		hash *= FNV_PRIME;
+	}
+}
@@ -0,0 +1,130 @@
+// ResultCache.h
+// Purpose: skip recognizing an image again when the same pixels were already recognized with the
+//	same parameters, e.g. re-uploaded or forwarded attachments
+// Functionality: each result is stored in a directory as one FileStorage file named after a 64
+//	bit FNV-1a hash of the decoded pixels, every RecognitionParams field and a format version.
+//	An entry holds the image size, the counts and every shape of the table. Entries are written
+//	to a temporary file and renamed into place, so several processes can share the directory and
+//	a reader only ever sees whole entries. A hit marks its entry as recently used, and once the
+//	directory grows past its size limit the least recently used entries are removed
+// Assumptions:
+//	The directory is on a local file system where renaming a file replaces the target at once
+//	The last write time of each entry is its last use; other tools do not touch the directory
+//	Two images or parameter sets never share a 64 bit hash
+// Authors: Allan Genari Gaarden, Tommy Ni, Joshua Medvinsky
+
+#ifndef RESULT_CACHE_H
+#define RESULT_CACHE_H
+
+#include <opencv2/core.hpp>
+#include <atomic>
+#include <mutex>
+#include "ShapeTable.h"
+#include "RecognitionParams.h"
+using namespace std;
+using namespace cv;
+
+// how the cache was used by this process
+struct CacheStats
+{
+	long long hits = 0;
+	long long misses = 0;
+	long long stores = 0;
+	long long evictions = 0;
+};
+
+class ResultCache
+{
+public:
+	// default constructor not allowed
+	ResultCache() = delete;
+	// ------------------------------------ parameter constructor --------------------------------------
+
+// purpose: open a cache directory, creating it if needed
+// preconditions: maxBytes is at least 1
+// postconditions: entries are kept in directory, which holds about maxBytes at most; throws
+//	cv::Exception if the directory cannot be created
+
+// --------------------------------------------------------------------------------------
+	ResultCache(const string& directory, long long maxBytes);
+	// ------------------------------------ hashKey --------------------------------------
+
+// purpose: get the key of recognizing an image with some parameters
+// preconditions: image is a valid image
+// postconditions: returns the FNV-1a hash of the size, type and pixels of image, every field of
+//	params and the format version; the same pixels decoded from any file give the same key
+
+// --------------------------------------------------------------------------------------
+	static uint64 hashKey(const Mat& image, const RecognitionParams& params);
+	// ------------------------------------ lookup --------------------------------------
+
+// purpose: get a stored result
+// preconditions: key was made by hashKey
+// postconditions: returns true with the stored shapes and image size, and marks the entry as
+//	recently used; returns false, leaving shapes cleared, if there is no whole entry for key
+
+// --------------------------------------------------------------------------------------
+	bool lookup(uint64 key, ShapeTable& shapes, Size& imageSize);
+	// ------------------------------------ store --------------------------------------
+
+// purpose: keep a result for later
+// preconditions: key was made by hashKey for the image shapes were recognized from
+// postconditions: the entry for key is written, replacing any other, and the least recently
+//	used entries are removed if the directory grew past its limit; a failed write is ignored
+
+// --------------------------------------------------------------------------------------
+	void store(uint64 key, Size imageSize, const ShapeTable& shapes);
+	// ------------------------------------ evict --------------------------------------
+
+// purpose: bring the directory back under its size limit
+// preconditions: none
+// postconditions: if the entries take more than the limit, the least recently used ones are
+//	removed until they take at most 90% of it; temporary files left by writers that stopped
+//	are removed
+
+// --------------------------------------------------------------------------------------
+	void evict();
+	// ------------------------------------ getStats --------------------------------------
+
+// purpose: get how this process used the cache
+// preconditions: none
+// postconditions: returns the hits, misses, stores and evicted entries since the cache was opened
+
+// --------------------------------------------------------------------------------------
+	CacheStats getStats() const;
+
+private:
+	string directory;
+	long long maxBytes;
+	atomic<long long> numHits{ 0 };
+	atomic<long long> numMisses{ 0 };
+	atomic<long long> numStores{ 0 };
+	atomic<long long> numEvictions{ 0 };
+	// bytes in the directory as last scanned plus what this process wrote since; other processes
+	//	are only seen by the next scan
+	mutex sizeLock;
+	long long knownBytes = 0;
+	// tells apart the temporary files of the threads of this process
+	atomic<unsigned> numTemporaryFiles{ 0 };
+	// random for each cache, so temporary files of different processes never share a name
+	string temporaryPrefix;
+
+	// ------------------------------------ entryPath --------------------------------------
+
+// purpose: get where the entry of a key is stored
+// preconditions: none
+// postconditions: returns directory/<16 hex digits of key>.yml
+
+// --------------------------------------------------------------------------------------
+	string entryPath(uint64 key) const;
+	// ------------------------------------ hashBytes --------------------------------------
+
+// purpose: add bytes to an FNV-1a hash
+// preconditions: hash was started at the FNV offset basis
+// postconditions: hash covers size more bytes from data
+
+// --------------------------------------------------------------------------------------
+	static void hashBytes(uint64& hash, const void* data, size_t size);
+};
+
+#endif
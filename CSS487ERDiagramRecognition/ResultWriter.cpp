@@ -0,0 +1,288 @@
+// ResultWriter.cpp
+// Purpose: output the shapes recognized in an ER diagram in a structured, machine readable form
+// Functionality: writes every classified shape of a RecognizeERDiagram or a TiledRecognizer (id,
+//	type, bounding box and polygon) together with the six type counts as a single line JSON object.
+//	Also writes the boxes and labels as an SVG overlay that links to the original image, for
+//	review in a browser without copying, drawing on or encoding the image, and the diagram as a
+//	graph whose nodes are the shapes and whose edges are the connectors between them
+// Assumptions:
+//	The shapes passed in have already been recognized
+//	An SVG is viewed from where its image link still points to the image
+// Authors: Allan Genari Gaarden, Tommy Ni, Joshua Medvinsky
+
+#include "ResultWriter.h"
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+
+// the colors renderShapes draws each type in, as RGB, indexed by ShapeType
+static const char* SVG_TYPE_COLORS[NUM_SHAPE_TYPES - 1] = { "#0000ff", "#00ff00", "#ff0000",
+	"#9696c8", "#96c896", "#c89696" };
+
+// renderShapes draws each box this many pixels outside the bounding box, and its label this many
+//	pixels above the box
+static const int SVG_BOX_MARGIN = 10;
+static const int SVG_LABEL_OFFSET = 3;
+
+// ------------------------------------ writeJson --------------------------------------
+
+// purpose: write the recognized shapes of one image as a JSON object
+// preconditions: rec has recognized the image named imageName
+// postconditions: one JSON object, terminated by a newline, is written to out
+
+// --------------------------------------------------------------------------------------
+void ResultWriter::writeJson(ostream& out, const string& imageName, RecognizeERDiagram& rec)
+{
+	writeJson(out, imageName, rec.getImageSize(), rec.getShapes());
+}
+
+// ------------------------------------ writeJson --------------------------------------
+
+// purpose: write the shapes recognized in one image as a JSON object
+// preconditions: shapes holds the shapes recognized in the image named imageName
+// postconditions: one JSON object, terminated by a newline, is written to out
+
+// --------------------------------------------------------------------------------------
+void ResultWriter::writeJson(ostream& out, const string& imageName, Size imageSize,
+	const ShapeTable& shapes)
+{
+	out << "{\"image\":\"" << escapeJson(imageName) << "\"";
+	out << ",\"width\":" << imageSize.width << ",\"height\":" << imageSize.height;
+	out << ",\"counts\":{\"attributes\":" << shapes.count(ShapeType::Attribute) <<
+		",\"entities\":" << shapes.count(ShapeType::Entity) <<
+		",\"relationships\":" << shapes.count(ShapeType::Relationship) <<
+		",\"weakEntities\":" << shapes.count(ShapeType::WeakEntity) <<
+		",\"weakRelationships\":" << shapes.count(ShapeType::WeakRelationship) <<
+		",\"multivaluedAttributes\":" << shapes.count(ShapeType::MultivaluedAttribute) << "}";
+
+	out << ",\"shapes\":[";
+	bool first = true;
+	for (int id = 0; id < shapes.size(); id++)
+	{
+		if (shapes.getType(id) == ShapeType::Discarded) continue;
+		if (!first) out << ",";
+		first = false;
+		writeShape(out, shapes, id);
+	}
+	out << "]}" << endl;
+}
+
+// ------------------------------------ writeGraphJson --------------------------------------
+
+// purpose: write the diagram of one image as a graph in a JSON object
+// preconditions: shapes holds the shapes recognized in the image named imageName and connectors
+//	the connectors ConnectorExtractor found between them
+// postconditions: one JSON object, terminated by a newline, is written to out, with a node (id,
+//	type and bounding box) for every shape that is not discarded and an edge (the ids of the two
+//	shapes and where the line meets each of them) for every connector
+
+// --------------------------------------------------------------------------------------
+void ResultWriter::writeGraphJson(ostream& out, const string& imageName, Size imageSize,
+	const ShapeTable& shapes, const vector<Connector>& connectors)
+{
+	out << "{\"image\":\"" << escapeJson(imageName) << "\"";
+	out << ",\"width\":" << imageSize.width << ",\"height\":" << imageSize.height;
+
+	// node ids are the shape ids of the JSON lines of the same image
+	out << ",\"nodes\":[";
+	bool first = true;
+	for (int id = 0; id < shapes.size(); id++)
+	{
+		if (shapes.getType(id) == ShapeType::Discarded) continue;
+		if (!first) out << ",";
+		first = false;
+		const Rect& box = shapes.getBoundingBox(id);
+		out << "{\"id\":" << id << ",\"type\":\"" << jsonTypeName(shapes.getType(id)) << "\"";
+		out << ",\"boundingBox\":[" << box.x << "," << box.y << "," << box.width << "," <<
+			box.height << "]}";
+	}
+
+	out << "],\"edges\":[";
+	for (size_t i = 0; i < connectors.size(); i++)
+	{
+		const Connector& connector = connectors[i];
+		if (i > 0) out << ",";
+		out << "{\"from\":" << connector.from << ",\"to\":" << connector.to;
+		out << ",\"fromPoint\":[" << connector.fromPoint.x << "," << connector.fromPoint.y << "]";
+		out << ",\"toPoint\":[" << connector.toPoint.x << "," << connector.toPoint.y << "]}";
+	}
+	out << "]}" << endl;
+}
+
+// ------------------------------------ writeShape --------------------------------------
+
+// purpose: write a single shape as a JSON object
+// preconditions: id is a valid id in shapes
+// postconditions: the shape's id, type, bounding box and polygon are written to out
+
+// --------------------------------------------------------------------------------------
+void ResultWriter::writeShape(ostream& out, const ShapeTable& shapes, int id)
+{
+	const Rect& box = shapes.getBoundingBox(id);
+	out << "{\"id\":" << id << ",\"type\":\"" << jsonTypeName(shapes.getType(id)) << "\"";
+	out << ",\"boundingBox\":[" << box.x << "," << box.y << "," << box.width << "," <<
+		box.height << "]";
+	out << ",\"polygon\":[";
+	const Point* points = shapes.getPoints(id);
+	for (int j = 0; j < shapes.getNumPoints(id); j++)
+	{
+		if (j > 0) out << ",";
+		out << "[" << points[j].x << "," << points[j].y << "]";
+	}
+	out << "]}";
+}
+
+// ------------------------------------ jsonTypeName --------------------------------------
+
+// purpose: get the name used for a shape type in the JSON output
+// preconditions: none
+// postconditions: returns the camel case name of type (e.g. "weakEntity")
+
+// --------------------------------------------------------------------------------------
+const char* ResultWriter::jsonTypeName(ShapeType type)
+{
+	switch (type)
+	{
+	case ShapeType::Entity: return "entity";
+	case ShapeType::Relationship: return "relationship";
+	case ShapeType::Attribute: return "attribute";
+	case ShapeType::WeakEntity: return "weakEntity";
+	case ShapeType::WeakRelationship: return "weakRelationship";
+	case ShapeType::MultivaluedAttribute: return "multivaluedAttribute";
+	default: return "discarded";
+	}
+}
+
+// ------------------------------------ escapeJson --------------------------------------
+
+// purpose: make a string safe to place between the quotes of a JSON string
+// preconditions: none
+// postconditions: returns text with quotes, backslashes and control characters escaped
+
+// --------------------------------------------------------------------------------------
+string ResultWriter::escapeJson(const string& text)
+{
+	string escaped;
+	escaped.reserve(text.size());
+	for (size_t i = 0; i < text.size(); i++)
+	{
+		unsigned char c = (unsigned char)text[i];
+		if (c == '"') escaped += "\\\"";
+		else if (c == '\\') escaped += "\\\\";
+		else if (c == '\n') escaped += "\\n";
+		else if (c == '\r') escaped += "\\r";
+		else if (c == '\t') escaped += "\\t";
+		else if (c < 0x20)
+		{
+			char code[8];
+			snprintf(code, sizeof(code), "\\u%04x", c);
+			escaped += code;
+		}
+		else escaped += (char)c;
+	}
+	return escaped;
+}
+
+// ------------------------------------ writeSvg --------------------------------------
+
+// purpose: write the boxes and labels of the shapes of one image as an SVG overlay
+// preconditions: shapes holds the shapes recognized in an image of imageSize; imageHref is a URI
+//	reference to that image, e.g. made by imageHref
+// postconditions: an SVG document of the size of the image is written to out, showing the image
+//	through its link with every shape boxed and labeled as renderShapes does; the label is the
+//	name of the shape's type
+
+// --------------------------------------------------------------------------------------
+void ResultWriter::writeSvg(ostream& out, const string& imageHref, Size imageSize, const ShapeTable& shapes)
+{
+	out << "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"" << imageSize.width << "\" height=\"" <<
+		imageSize.height << "\" viewBox=\"0 0 " << imageSize.width << " " << imageSize.height << "\">\n";
+
+	// each type's color is given once, by class, so every shape only adds its box and label
+	out << "<style>rect{fill:none;stroke:currentColor;stroke-width:2}" <<
+		"text{fill:currentColor;font:12px sans-serif}";
+	for (int type = 0; type < NUM_SHAPE_TYPES - 1; type++)
+	{
+		out << "." << jsonTypeName((ShapeType)type) << "{color:" << SVG_TYPE_COLORS[type] << "}";
+	}
+	out << "</style>\n";
+
+	out << "<image href=\"" << escapeXml(imageHref) << "\" width=\"" << imageSize.width << "\" height=\"" <<
+		imageSize.height << "\"/>\n";
+	for (int id = 0; id < shapes.size(); id++)
+	{
+		ShapeType type = shapes.getType(id);
+		if (type == ShapeType::Discarded) continue;
+
+		// the same box as renderShapes, whose corners are both inside it
+		const Rect& box = shapes.getBoundingBox(id);
+		int x = box.x - SVG_BOX_MARGIN;
+		int y = box.y - SVG_BOX_MARGIN;
+		const char* typeClass = jsonTypeName(type);
+		out << "<rect class=\"" << typeClass << "\" x=\"" << x << "\" y=\"" << y << "\" width=\"" <<
+			box.width - 1 + 2 * SVG_BOX_MARGIN << "\" height=\"" << box.height - 1 + 2 * SVG_BOX_MARGIN << "\"/>";
+		out << "<text class=\"" << typeClass << "\" x=\"" << x << "\" y=\"" << y - SVG_LABEL_OFFSET << "\">" <<
+			shapeTypeName(type) << "</text>\n";
+	}
+	out << "</svg>\n";
+}
+
+// ------------------------------------ imageHref --------------------------------------
+
+// purpose: get the link an SVG written to a directory uses to show an image
+// preconditions: none
+// postconditions: returns the path of imageName relative to svgDir, or its absolute path if there
+//	is none (e.g. another drive), with forward slashes and with characters not allowed in a URI
+//	percent encoded
+
+// --------------------------------------------------------------------------------------
+string ResultWriter::imageHref(const string& imageName, const string& svgDir)
+{
+	error_code ec;
+	filesystem::path image = filesystem::absolute(imageName, ec);
+	filesystem::path relative = filesystem::relative(image, filesystem::absolute(svgDir, ec), ec);
+	bool isAbsolute = relative.empty();
+	string path = isAbsolute ? image.generic_string() : relative.generic_string();
+
+	// an absolute path becomes a file URI, so a drive letter is not read as a scheme
+	string href;
+	if (isAbsolute) href = path[0] == '/' ? "file://" : "file:///";
+	for (size_t i = 0; i < path.size(); i++)
+	{
+		unsigned char c = (unsigned char)path[i];
+		// a colon in a relative path would be read as ending a scheme
+		if (isalnum(c) || strchr(isAbsolute ? "-._~/:" : "-._~/", c) != nullptr) href += (char)c;
+		else
+		{
+			char code[4];
+			snprintf(code, sizeof(code), "%%%02X", c);
+			href += code;
+		}
+	}
+	return href;
+}
+
+// ------------------------------------ escapeXml --------------------------------------
+
+// purpose: make a string safe to place in XML text or between the quotes of an attribute
+// preconditions: none
+// postconditions: returns text with &, <, >, " and ' replaced by their entities
+
+// --------------------------------------------------------------------------------------
+string ResultWriter::escapeXml(const string& text)
+{
+	string escaped;
+	escaped.reserve(text.size());
+	for (size_t i = 0; i < text.size(); i++)
+	{
+		char c = text[i];
+		if (c == '&') escaped += "&amp;";
+		else if (c == '<') escaped += "&lt;";
+		else if (c == '>') escaped += "&gt;";
+		else if (c == '"') escaped += "&quot;";
+		else if (c == '\'') escaped += "&apos;";
+		else escaped += c;
+	}
+	return escaped;
+}
@@ -0,0 +1,109 @@
+// ResultWriter.h
+// Purpose: output the shapes recognized in an ER diagram in a structured, machine readable form
+// Functionality: writes every classified shape of a RecognizeERDiagram or a TiledRecognizer (id,
+//	type, bounding box and polygon) together with the six type counts as a single line JSON object.
+//	Also writes the boxes and labels as an SVG overlay that links to the original image, for
+//	review in a browser without copying, drawing on or encoding the image, and the diagram as a
+//	graph whose nodes are the shapes and whose edges are the connectors between them
+// Assumptions:
+//	The shapes passed in have already been recognized
+//	An SVG is viewed from where its image link still points to the image
+// Authors: Allan Genari Gaarden, Tommy Ni, Joshua Medvinsky
+
+#ifndef RESULT_WRITER_H
+#define RESULT_WRITER_H
+
+#include "RecognizeERDiagram.h"
+#include "ConnectorExtractor.h"
+
+class ResultWriter
+{
+public:
+	// ------------------------------------ writeJson --------------------------------------
+
+// purpose: write the recognized shapes of one image as a JSON object
+// preconditions: rec has recognized the image named imageName
+// postconditions: one JSON object, terminated by a newline, is written to out
+
+// --------------------------------------------------------------------------------------
+	static void writeJson(ostream& out, const string& imageName, RecognizeERDiagram& rec);
+	// ------------------------------------ writeJson --------------------------------------
+
+// purpose: write the shapes recognized in one image as a JSON object
+// preconditions: shapes holds the shapes recognized in the image named imageName
+// postconditions: one JSON object, terminated by a newline, is written to out
+
+// --------------------------------------------------------------------------------------
+	static void writeJson(ostream& out, const string& imageName, Size imageSize,
+		const ShapeTable& shapes);
+	// ------------------------------------ escapeJson --------------------------------------
+
+// purpose: make a string safe to place between the quotes of a JSON string
+// preconditions: none
+// postconditions: returns text with quotes, backslashes and control characters escaped
+
+// --------------------------------------------------------------------------------------
+	static string escapeJson(const string& text);
+	// ------------------------------------ writeGraphJson --------------------------------------
+
+// purpose: write the diagram of one image as a graph in a JSON object
+// preconditions: shapes holds the shapes recognized in the image named imageName and connectors
+//	the connectors ConnectorExtractor found between them
+// postconditions: one JSON object, terminated by a newline, is written to out, with a node (id,
+//	type and bounding box) for every shape that is not discarded and an edge (the ids of the two
+//	shapes and where the line meets each of them) for every connector
+
+// --------------------------------------------------------------------------------------
+	static void writeGraphJson(ostream& out, const string& imageName, Size imageSize,
+		const ShapeTable& shapes, const vector<Connector>& connectors);
+
+	// ------------------------------------ jsonTypeName --------------------------------------
+
+// purpose: get the name used for a shape type in the JSON output
+// preconditions: none
+// postconditions: returns the camel case name of type (e.g. "weakEntity")
+
+// --------------------------------------------------------------------------------------
+	static const char* jsonTypeName(ShapeType type);
+	// ------------------------------------ writeSvg --------------------------------------
+
+// purpose: write the boxes and labels of the shapes of one image as an SVG overlay
+// preconditions: shapes holds the shapes recognized in an image of imageSize; imageHref is a URI
+//	reference to that image, e.g. made by imageHref
+// postconditions: an SVG document of the size of the image is written to out, showing the image
+//	through its link with every shape boxed and labeled as renderShapes does; the label is the
+//	name of the shape's type
+
+// --------------------------------------------------------------------------------------
+	static void writeSvg(ostream& out, const string& imageHref, Size imageSize, const ShapeTable& shapes);
+	// ------------------------------------ imageHref --------------------------------------
+
+// purpose: get the link an SVG written to a directory uses to show an image
+// preconditions: none
+// postconditions: returns the path of imageName relative to svgDir, or its absolute path if there
+//	is none (e.g. another drive), with forward slashes and with characters not allowed in a URI
+//	percent encoded
+
+// --------------------------------------------------------------------------------------
+	static string imageHref(const string& imageName, const string& svgDir);
+
+private:
+	// ------------------------------------ writeShape --------------------------------------
+
+// purpose: write a single shape as a JSON object
+// preconditions: id is a valid id in shapes
+// postconditions: the shape's id, type, bounding box and polygon are written to out
+
+// --------------------------------------------------------------------------------------
+	static void writeShape(ostream& out, const ShapeTable& shapes, int id);
+	// ------------------------------------ escapeXml --------------------------------------
+
+// purpose: make a string safe to place in XML text or between the quotes of an attribute
+// preconditions: none
+// postconditions: returns text with &, <, >, " and ' replaced by their entities
+
+// --------------------------------------------------------------------------------------
+	static string escapeXml(const string& text);
+};
+
+#endif
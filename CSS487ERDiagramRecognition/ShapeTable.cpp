@@ -0,0 +1,225 @@
+// ShapeTable.cpp
+// Purpose: store every shape classified in an ER diagram in one flat, contiguous table
+// Functionality: the polygon points of all shapes live in a single buffer and each shape is a
+//	fixed size record (offset into the buffer, type tag, cached bounding box and area, and the
+//	id of the shape it is nested in). A shape's id is its position in the table and never
+//	changes, so reclassifying a shape only changes its tag. clear() keeps every buffer's
+//	capacity, so the table works as a per-recognition arena that stops allocating once it has
+//	grown to the size of the largest diagram seen
+// Assumptions:
+//	Shapes are only ever added, never removed; discarded shapes are tagged ShapeType::Discarded
+// Authors: Allan Genari Gaarden, Tommy Ni, Joshua Medvinsky
+
+#include "ShapeTable.h"
+
+// ------------------------------------ shapeTypeName --------------------------------------
+
+// purpose: get the label used for a shape type
+// preconditions: none
+// postconditions: returns the human readable name of type (e.g. "Weak Entity")
+
+// --------------------------------------------------------------------------------------
+const char* shapeTypeName(ShapeType type)
+{
+	switch (type)
+	{
+	case ShapeType::Entity: return "Entity";
+	case ShapeType::Relationship: return "Relationship";
+	case ShapeType::Attribute: return "Attribute";
+	case ShapeType::WeakEntity: return "Weak Entity";
+	case ShapeType::WeakRelationship: return "Weak Relationship";
+	case ShapeType::MultivaluedAttribute: return "Multivalued Attribute";
+	default: return "Discarded";
+	}
+}
+
+// ------------------------------------ addShape --------------------------------------
+
+// purpose: append a shape to the table
+// preconditions: polygon has at least one point
+// postconditions: the points are copied into the shared buffer, the bounding box and area are
+//	cached and the id of the new shape is returned
+
+// --------------------------------------------------------------------------------------
+int ShapeTable::addShape(const vector<Point>& polygon, ShapeType type, int contourIndex)
+{
+	ShapeRecord record;
+	record.pointOffset = (int)points.size();
+	record.numPoints = (int)polygon.size();
+	record.type = type;
+	record.boundingBox = boundingRect(polygon);
+	record.area = contourArea(polygon);
+	record.contourIndex = contourIndex;
+	record.parent = -1;
+
+	points.insert(points.end(), polygon.begin(), polygon.end());
+	records.push_back(record);
+	typeCounts[(int)type]++;
+	return (int)records.size() - 1;
+}
+
+// ------------------------------------ clear --------------------------------------
+
+// purpose: empty the table before the next image
+// preconditions: none
+// postconditions: the table holds no shapes but keeps all of its allocated memory
+
+// --------------------------------------------------------------------------------------
+void ShapeTable::clear()
+{
+	// vector::clear keeps the capacity, which is what makes the table reusable as an arena
+	points.clear();
+	records.clear();
+	for (int i = 0; i < NUM_SHAPE_TYPES; i++)
+	{
+		typeCounts[i] = 0;
+	}
+}
+
+// ------------------------------------ size --------------------------------------
+
+// purpose: get the number of shapes in the table, including discarded ones
+// preconditions: none
+// postconditions: returns one more than the largest valid id
+
+// --------------------------------------------------------------------------------------
+int ShapeTable::size() const
+{
+	return (int)records.size();
+}
+
+// ------------------------------------ count --------------------------------------
+
+// purpose: get the number of shapes currently tagged with a type
+// preconditions: none
+// postconditions: returns the count in constant time
+
+// --------------------------------------------------------------------------------------
+int ShapeTable::count(ShapeType type) const
+{
+	return typeCounts[(int)type];
+}
+
+// ------------------------------------ getType --------------------------------------
+
+// purpose: get the type tag of a shape
+// preconditions: id is a valid id
+// postconditions: returns the current type of the shape
+
+// --------------------------------------------------------------------------------------
+ShapeType ShapeTable::getType(int id) const
+{
+	return records[id].type;
+}
+
+// ------------------------------------ setType --------------------------------------
+
+// purpose: reclassify a shape
+// preconditions: id is a valid id
+// postconditions: the shape is tagged with type and the per type counts are updated
+
+// --------------------------------------------------------------------------------------
+void ShapeTable::setType(int id, ShapeType type)
+{
+	typeCounts[(int)records[id].type]--;
+	records[id].type = type;
+	typeCounts[(int)type]++;
+}
+
+// ------------------------------------ getPoints --------------------------------------
+
+// purpose: get the polygon of a shape without copying it
+// preconditions: id is a valid id
+// postconditions: returns a pointer to the first of getNumPoints(id) points; the pointer is
+//	invalidated by the next addShape or clear
+
+// --------------------------------------------------------------------------------------
+const Point* ShapeTable::getPoints(int id) const
+{
+	return points.data() + records[id].pointOffset;
+}
+
+// ------------------------------------ getNumPoints --------------------------------------
+
+// purpose: get the number of points in the polygon of a shape
+// preconditions: id is a valid id
+// postconditions: returns the number of polygon points
+
+// --------------------------------------------------------------------------------------
+int ShapeTable::getNumPoints(int id) const
+{
+	return records[id].numPoints;
+}
+
+// ------------------------------------ getPolygon --------------------------------------
+
+// purpose: get a copy of the polygon of a shape
+// preconditions: id is a valid id
+// postconditions: returns the polygon points as a vector
+
+// --------------------------------------------------------------------------------------
+vector<Point> ShapeTable::getPolygon(int id) const
+{
+	const Point* first = getPoints(id);
+	return vector<Point>(first, first + records[id].numPoints);
+}
+
+// ------------------------------------ getBoundingBox --------------------------------------
+
+// purpose: get the cached bounding box of a shape
+// preconditions: id is a valid id
+// postconditions: returns the smallest upright rectangle containing every polygon point
+
+// --------------------------------------------------------------------------------------
+const Rect& ShapeTable::getBoundingBox(int id) const
+{
+	return records[id].boundingBox;
+}
+
+// ------------------------------------ getArea --------------------------------------
+
+// purpose: get the cached area of a shape
+// preconditions: id is a valid id
+// postconditions: returns the area enclosed by the polygon
+
+// --------------------------------------------------------------------------------------
+double ShapeTable::getArea(int id) const
+{
+	return records[id].area;
+}
+
+// ------------------------------------ getContourIndex --------------------------------------
+
+// purpose: get the index of the contour the shape was approximated from
+// preconditions: id is a valid id
+// postconditions: returns the index into the contours found in the image
+
+// --------------------------------------------------------------------------------------
+int ShapeTable::getContourIndex(int id) const
+{
+	return records[id].contourIndex;
+}
+
+// ------------------------------------ getParent --------------------------------------
+
+// purpose: get the shape a shape is nested in
+// preconditions: id is a valid id
+// postconditions: returns the id of the closest enclosing shape, or -1 if it is not nested
+
+// --------------------------------------------------------------------------------------
+int ShapeTable::getParent(int id) const
+{
+	return records[id].parent;
+}
+
+// ------------------------------------ setParent --------------------------------------
+
+// purpose: record the shape a shape is nested in
+// preconditions: id is a valid id, parent is a valid id or -1
+// postconditions: getParent(id) returns parent
+
+// --------------------------------------------------------------------------------------
+void ShapeTable::setParent(int id, int parent)
+{
+	records[id].parent = parent;
+}
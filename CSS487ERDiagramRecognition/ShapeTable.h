@@ -0,0 +1,182 @@
+// ShapeTable.h
+// Purpose: store every shape classified in an ER diagram in one flat, contiguous table
+// Functionality: the polygon points of all shapes live in a single buffer and each shape is a
+//	fixed size record (offset into the buffer, type tag, cached bounding box and area, and the
+//	id of the shape it is nested in). A shape's id is its position in the table and never
+//	changes, so reclassifying a shape only changes its tag. clear() keeps every buffer's
+//	capacity, so the table works as a per-recognition arena that stops allocating once it has
+//	grown to the size of the largest diagram seen
+// Assumptions:
+//	Shapes are only ever added, never removed; discarded shapes are tagged ShapeType::Discarded
+// Authors: Allan Genari Gaarden, Tommy Ni, Joshua Medvinsky
+
+#ifndef SHAPE_TABLE_H
+#define SHAPE_TABLE_H
+
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+#include <vector>
+using namespace std;
+using namespace cv;
+
+// the kind of ER diagram symbol a shape was recognized as
+enum class ShapeType
+{
+	Entity,
+	Relationship,
+	Attribute,
+	WeakEntity,
+	WeakRelationship,
+	MultivaluedAttribute,
+	Discarded
+};
+
+// number of ShapeType values, used to size per type arrays
+const int NUM_SHAPE_TYPES = (int)ShapeType::Discarded + 1;
+
+// ------------------------------------ shapeTypeName --------------------------------------
+
+// purpose: get the label used for a shape type
+// preconditions: none
+// postconditions: returns the human readable name of type (e.g. "Weak Entity")
+
+// --------------------------------------------------------------------------------------
+const char* shapeTypeName(ShapeType type);
+
+class ShapeTable
+{
+public:
+	// ------------------------------------ addShape --------------------------------------
+
+// purpose: append a shape to the table
+// preconditions: polygon has at least one point
+// postconditions: the points are copied into the shared buffer, the bounding box and area are
+//	cached and the id of the new shape is returned
+
+// --------------------------------------------------------------------------------------
+	int addShape(const vector<Point>& polygon, ShapeType type, int contourIndex);
+	// ------------------------------------ clear --------------------------------------
+
+// purpose: empty the table before the next image
+// preconditions: none
+// postconditions: the table holds no shapes but keeps all of its allocated memory
+
+// --------------------------------------------------------------------------------------
+	void clear();
+	// ------------------------------------ size --------------------------------------
+
+// purpose: get the number of shapes in the table, including discarded ones
+// preconditions: none
+// postconditions: returns one more than the largest valid id
+
+// --------------------------------------------------------------------------------------
+	int size() const;
+	// ------------------------------------ count --------------------------------------
+
+// purpose: get the number of shapes currently tagged with a type
+// preconditions: none
+// postconditions: returns the count in constant time
+
+// --------------------------------------------------------------------------------------
+	int count(ShapeType type) const;
+	// ------------------------------------ getType --------------------------------------
+
+// purpose: get the type tag of a shape
+// preconditions: id is a valid id
+// postconditions: returns the current type of the shape
+
+// --------------------------------------------------------------------------------------
+	ShapeType getType(int id) const;
+	// ------------------------------------ setType --------------------------------------
+
+// purpose: reclassify a shape
+// preconditions: id is a valid id
+// postconditions: the shape is tagged with type and the per type counts are updated
+
+// --------------------------------------------------------------------------------------
+	void setType(int id, ShapeType type);
+	// ------------------------------------ getPoints --------------------------------------
+
+// purpose: get the polygon of a shape without copying it
+// preconditions: id is a valid id
+// postconditions: returns a pointer to the first of getNumPoints(id) points; the pointer is
+//	invalidated by the next addShape or clear
+
+// --------------------------------------------------------------------------------------
+	const Point* getPoints(int id) const;
+	// ------------------------------------ getNumPoints --------------------------------------
+
+// purpose: get the number of points in the polygon of a shape
+// preconditions: id is a valid id
+// postconditions: returns the number of polygon points
+
+// --------------------------------------------------------------------------------------
+	int getNumPoints(int id) const;
+	// ------------------------------------ getPolygon --------------------------------------
+
+// purpose: get a copy of the polygon of a shape
+// preconditions: id is a valid id
+// postconditions: returns the polygon points as a vector
+
+// --------------------------------------------------------------------------------------
+	vector<Point> getPolygon(int id) const;
+	// ------------------------------------ getBoundingBox --------------------------------------
+
+// purpose: get the cached bounding box of a shape
+// preconditions: id is a valid id
+// postconditions: returns the smallest upright rectangle containing every polygon point
+
+// --------------------------------------------------------------------------------------
+	const Rect& getBoundingBox(int id) const;
+	// ------------------------------------ getArea --------------------------------------
+
+// purpose: get the cached area of a shape
+// preconditions: id is a valid id
+// postconditions: returns the area enclosed by the polygon
+
+// --------------------------------------------------------------------------------------
+	double getArea(int id) const;
+	// ------------------------------------ getContourIndex --------------------------------------
+
+// purpose: get the index of the contour the shape was approximated from
+// preconditions: id is a valid id
+// postconditions: returns the index into the contours found in the image
+
+// --------------------------------------------------------------------------------------
+	int getContourIndex(int id) const;
+	// ------------------------------------ getParent --------------------------------------
+
+// purpose: get the shape a shape is nested in
+// preconditions: id is a valid id
+// postconditions: returns the id of the closest enclosing shape, or -1 if it is not nested
+
+// --------------------------------------------------------------------------------------
+	int getParent(int id) const;
+	// ------------------------------------ setParent --------------------------------------
+
+// purpose: record the shape a shape is nested in
+// preconditions: id is a valid id, parent is a valid id or -1
+// postconditions: getParent(id) returns parent
+
+// --------------------------------------------------------------------------------------
+	void setParent(int id, int parent);
+
+private:
+	// one fixed size record per shape, the points themselves live in the points buffer
+	struct ShapeRecord
+	{
+		int pointOffset;
+		int numPoints;
+		ShapeType type;
+		Rect boundingBox;
+		double area;
+		int contourIndex;
+		int parent;
+	};
+
+	vector<Point> points;
+	vector<ShapeRecord> records;
+	int typeCounts[NUM_SHAPE_TYPES] = {};
+};
+
+#endif
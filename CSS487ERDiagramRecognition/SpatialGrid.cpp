@@ -0,0 +1,133 @@
+// SpatialGrid.cpp
+// Purpose: find the shapes near a point or region without comparing against every shape
+// Functionality: splits the page into square cells and registers each inserted box in every
+//	cell it overlaps, so a lookup only has to look at the few boxes sharing a cell with it
+// Assumptions:
+//	Boxes are in image coordinates; parts of a box outside the grid bounds are ignored
+// Authors: Allan Genari Gaarden, Tommy Ni, Joshua Medvinsky
+
+#include "SpatialGrid.h"
+
+// ------------------------------------ reset --------------------------------------
+
+// purpose: empty the grid and size it to cover bounds
+// preconditions: cellSize is at least 1
+// postconditions: the grid holds no ids; cells keep their allocated memory when the grid is reused
+
+// --------------------------------------------------------------------------------------
+void SpatialGrid::reset(const Rect& bounds, int cellSize)
+{
+	this->bounds = bounds;
+	this->cellSize = max(1, cellSize);
+	cellsX = max(1, (bounds.width + this->cellSize - 1) / this->cellSize);
+	cellsY = max(1, (bounds.height + this->cellSize - 1) / this->cellSize);
+
+	if (cells.size() < (size_t)cellsX * cellsY) cells.resize((size_t)cellsX * cellsY);
+	for (size_t i = 0; i < cells.size(); i++)
+	{
+		cells[i].clear();
+	}
+}
+
+// ------------------------------------ insert --------------------------------------
+
+// purpose: register an id in every cell its box overlaps
+// preconditions: reset has been called
+// postconditions: id is returned by later lookups of any point or region overlapping box
+
+// --------------------------------------------------------------------------------------
+void SpatialGrid::insert(int id, const Rect& box)
+{
+	int firstX, firstY, lastX, lastY;
+	if (!cellRange(box, firstX, firstY, lastX, lastY)) return;
+
+	for (int y = firstY; y <= lastY; y++)
+	{
+		for (int x = firstX; x <= lastX; x++)
+		{
+			cells[(size_t)y * cellsX + x].push_back(id);
+		}
+	}
+}
+
+// ------------------------------------ cellAt --------------------------------------
+
+// purpose: get the ids registered in the cell containing a point
+// preconditions: reset has been called
+// postconditions: returns the ids of the cell (each at most once), or an empty list if the
+//	point is outside the grid
+
+// --------------------------------------------------------------------------------------
+const vector<int>& SpatialGrid::cellAt(Point point) const
+{
+	if (!bounds.contains(point)) return noIds;
+	int x = (point.x - bounds.x) / cellSize;
+	int y = (point.y - bounds.y) / cellSize;
+	return cells[(size_t)y * cellsX + x];
+}
+
+// ------------------------------------ query --------------------------------------
+
+// purpose: get the ids registered in every cell overlapping a region
+// preconditions: reset has been called
+// postconditions: the ids are appended to ids; an id spanning several cells appears once per cell
+
+// --------------------------------------------------------------------------------------
+void SpatialGrid::query(const Rect& region, vector<int>& ids) const
+{
+	int firstX, firstY, lastX, lastY;
+	if (!cellRange(region, firstX, firstY, lastX, lastY)) return;
+
+	for (int y = firstY; y <= lastY; y++)
+	{
+		for (int x = firstX; x <= lastX; x++)
+		{
+			const vector<int>& cell = cells[(size_t)y * cellsX + x];
+			ids.insert(ids.end(), cell.begin(), cell.end());
+		}
+	}
+}
+
+// ------------------------------------ cellRange --------------------------------------
+
+// purpose: get the range of cells overlapping a region
+// preconditions: reset has been called
+// postconditions: returns false if the region misses the grid, otherwise sets the first and last
+//	cell column and row (inclusive)
+
+// --------------------------------------------------------------------------------------
+bool SpatialGrid::cellRange(const Rect& region, int& firstX, int& firstY, int& lastX, int& lastY) const
+{
+	Rect clipped = region & bounds;
+	if (clipped.empty()) return false;
+
+	firstX = (clipped.x - bounds.x) / cellSize;
+	firstY = (clipped.y - bounds.y) / cellSize;
+	lastX = (clipped.x + clipped.width - 1 - bounds.x) / cellSize;
+	lastY = (clipped.y + clipped.height - 1 - bounds.y) / cellSize;
+	return true;
+}
+
+// ------------------------------------ getBounds --------------------------------------
+
+// purpose: get the region covered by the grid
+// preconditions: reset has been called
+// postconditions: returns the bounds given to reset
+
+// --------------------------------------------------------------------------------------
+const Rect& SpatialGrid::getBounds() const
+{
+	return bounds;
+}
+
+// ------------------------------------ getCellSize --------------------------------------
+
+// purpose: get the width and height of a cell
+// preconditions: reset has been called
+// postconditions: returns the cell size given to reset
+
+// --------------------------------------------------------------------------------------
+int SpatialGrid::getCellSize() const
+{
+	return cellSize;
+}
@@ -0,0 +1,89 @@
+// SpatialGrid.h
+// Purpose: find the shapes near a point or region without comparing against every shape
+// Functionality: splits the page into square cells and registers each inserted box in every
+//	cell it overlaps, so a lookup only has to look at the few boxes sharing a cell with it
+// Assumptions:
+//	Boxes are in image coordinates; parts of a box outside the grid bounds are ignored
+// Authors: Allan Genari Gaarden, Tommy Ni, Joshua Medvinsky
+
+#ifndef SPATIAL_GRID_H
+#define SPATIAL_GRID_H
+
+#include <opencv2/core.hpp>
+#include <vector>
+using namespace std;
+using namespace cv;
+
+class SpatialGrid
+{
+public:
+	// ------------------------------------ reset --------------------------------------
+
+// purpose: empty the grid and size it to cover bounds
+// preconditions: cellSize is at least 1
+// postconditions: the grid holds no ids; cells keep their allocated memory when the grid is reused
+
+// --------------------------------------------------------------------------------------
+	void reset(const Rect& bounds, int cellSize);
+	// ------------------------------------ insert --------------------------------------
+
+// purpose: register an id in every cell its box overlaps
+// preconditions: reset has been called
+// postconditions: id is returned by later lookups of any point or region overlapping box
+
+// --------------------------------------------------------------------------------------
+	void insert(int id, const Rect& box);
+	// ------------------------------------ cellAt --------------------------------------
+
+// purpose: get the ids registered in the cell containing a point
+// preconditions: reset has been called
+// postconditions: returns the ids of the cell (each at most once), or an empty list if the
+//	point is outside the grid
+
+// --------------------------------------------------------------------------------------
+	const vector<int>& cellAt(Point point) const;
+	// ------------------------------------ query --------------------------------------
+
+// purpose: get the ids registered in every cell overlapping a region
+// preconditions: reset has been called
+// postconditions: the ids are appended to ids; an id spanning several cells appears once per cell
+
+// --------------------------------------------------------------------------------------
+	void query(const Rect& region, vector<int>& ids) const;
+	// ------------------------------------ getBounds --------------------------------------
+
+// purpose: get the region covered by the grid
+// preconditions: reset has been called
+// postconditions: returns the bounds given to reset
+
+// --------------------------------------------------------------------------------------
+	const Rect& getBounds() const;
+	// ------------------------------------ getCellSize --------------------------------------
+
+// purpose: get the width and height of a cell
+// preconditions: reset has been called
+// postconditions: returns the cell size given to reset
+
+// --------------------------------------------------------------------------------------
+	int getCellSize() const;
+
+private:
+	Rect bounds;
+	int cellSize = 1;
+	int cellsX = 0;
+	int cellsY = 0;
+	vector<vector<int>> cells;
+	vector<int> noIds;
+
+	// ------------------------------------ cellRange --------------------------------------
+
+// purpose: get the range of cells overlapping a region
+// preconditions: reset has been called
+// postconditions: returns false if the region misses the grid, otherwise sets the first and last
+//	cell column and row (inclusive)
+
+// --------------------------------------------------------------------------------------
+	bool cellRange(const Rect& region, int& firstX, int& firstY, int& lastX, int& lastY) const;
+};
+
+#endif
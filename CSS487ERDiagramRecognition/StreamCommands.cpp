@@ -0,0 +1,359 @@
+// StreamCommands.cpp
+// Purpose: recognize streams of images: changing frames, videos and requests to a server
+// Functionality: the incremental, video, serve and request modes of the program: each command
+//	reads its arguments and runs its driver, which recognizes only what changed between frames,
+//	pipelines the frames of videos, runs the recognition server, or sends it requests
+// Assumptions:
+//	The server and its requests need Unix domain sockets (Linux and macOS)
+// Authors: Allan Genari Gaarden, Tommy Ni, Joshua Medvinsky
+
+#include "StreamCommands.h"
+#include "RecognizeERDiagram.h"
+#include "IncrementalRecognizer.h"
+#include "VideoPipeline.h"
+#include "RecognitionServer.h"
+#include <chrono>
+#include <csignal>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <thread>
+
+// ------------------------------------ runIncremental --------------------------------------
+
+// purpose: recognize a sequence of whiteboard frames, recognizing only what changed between them
+// preconditions: frameNames are valid images of the same size in order; margin is larger than
+//	the biggest shape
+// postconditions: one line per frame is output with how many regions changed, their area, the
+//	time taken and the counts; if check is true every frame is also recognized whole and 1 is
+//	returned unless the counts always match
+
+// --------------------------------------------------------------------------------------
+int runIncremental(const vector<string>& frameNames, int blockSize, int margin, int tolerance, bool check)
+{
+	IncrementalRecognizer incremental(blockSize, margin, tolerance);
+	RecognizeERDiagram rec;
+	const ShapeType types[] = { ShapeType::Attribute, ShapeType::Entity, ShapeType::Relationship,
+		ShapeType::WeakEntity, ShapeType::WeakRelationship, ShapeType::MultivaluedAttribute };
+	int numFailed = 0;
+	int numMismatched = 0;
+
+	cout << "Frame, Regions, Changed Pixels, ms, Attributes, Entities, Relationships, Weak Entities, " <<
+		"Weak Relationships, Multivalued Attributes" << (check ? ", Matches Full" : "") << endl;
+	for (size_t i = 0; i < frameNames.size(); i++)
+	{
+		Mat frame = imread(frameNames[i], IMREAD_COLOR);
+		try
+		{
+			auto start = chrono::steady_clock::now();
+			incremental.update(frame);
+			auto end = chrono::steady_clock::now();
+
+			long long changedPixels = 0;
+			const vector<Rect>& regions = incremental.getChangedRegions();
+			for (size_t j = 0; j < regions.size(); j++)
+			{
+				changedPixels += regions[j].area();
+			}
+			cout << frameNames[i] << ", " << regions.size() << ", " << changedPixels << ", " <<
+				chrono::duration<double, milli>(end - start).count();
+			const ShapeTable& shapes = incremental.getShapes();
+			for (int t = 0; t < 6; t++)
+			{
+				cout << ", " << shapes.count(types[t]);
+			}
+
+			if (check)
+			{
+				rec.recognize(frame);
+				int full[] = { rec.getNumAttributes(), rec.getNumEntities(), rec.getNumRelationships(),
+					rec.getNumWeakEntities(), rec.getNumWeakRelationships(), rec.getNumMultivaluedAttributes() };
+				bool matches = true;
+				for (int t = 0; t < 6; t++)
+				{
+					if (shapes.count(types[t]) != full[t]) matches = false;
+				}
+				cout << ", " << (matches ? "yes" : "no");
+				if (!matches) numMismatched++;
+			}
+			cout << endl;
+		}
+		catch (const cv::Exception&)
+		{
+			cerr << frameNames[i] << " could not be recognized" << endl;
+			numFailed++;
+		}
+	}
+	return numFailed == 0 && numMismatched == 0 ? 0 : 1;
+}
+
+// ------------------------------------ incrementalCommand --------------------------------------
+
+// purpose: recognize a sequence of frames incrementally from the command line
+// preconditions: argv[1] is incremental and argc is at least 3
+// postconditions: the arguments after argv[1] are read and the mode is run; returns its exit
+//	code, or USAGE_ERROR if the arguments are wrong
+
+// --------------------------------------------------------------------------------------
+int incrementalCommand(int argc, char* argv[])
+{
+	int blockSize = 32;
+	int margin = 512;
+	int tolerance = 0;
+	bool check = false;
+	vector<string> frameNames;
+	for (int i = 2; i < argc; i++)
+	{
+		if (string(argv[i]) == "--block" && i + 1 < argc) blockSize = max(1, atoi(argv[++i]));
+		else if (string(argv[i]) == "--margin" && i + 1 < argc) margin = max(0, atoi(argv[++i]));
+		else if (string(argv[i]) == "--tolerance" && i + 1 < argc) tolerance = atoi(argv[++i]);
+		else if (string(argv[i]) == "--check") check = true;
+		else frameNames.push_back(argv[i]);
+	}
+	return runIncremental(frameNames, blockSize, margin, tolerance, check);
+}
+
+// ------------------------------------ runVideo --------------------------------------
+
+// purpose: recognize recorded whiteboard videos through the four stage pipeline
+// preconditions: videoNames are video files; outDir is empty or an existing directory
+// postconditions: for each video, the report of the pipeline is output and, if outDir is given,
+//	the video with its shapes boxed and labeled is written there as <name>.avi; if logFrames is
+//	true the counts of every frame are output first
+
+// --------------------------------------------------------------------------------------
+int runVideo(const vector<string>& videoNames, const string& outDir, int queueCapacity, bool logFrames)
+{
+	VideoPipeline pipeline(queueCapacity);
+	int numFailed = 0;
+
+	for (size_t i = 0; i < videoNames.size(); i++)
+	{
+		string outName;
+		if (!outDir.empty())
+		{
+			filesystem::path outPath = filesystem::path(outDir) / filesystem::path(videoNames[i]).stem();
+			outName = outPath.string() + ".avi";
+		}
+
+		cout << videoNames[i] << endl;
+		if (logFrames)
+		{
+			cout << "Frame, Attributes, Entities, Relationships, Weak Entities, Weak Relationships, " <<
+				"Multivalued Attributes" << endl;
+		}
+		try
+		{
+			pipeline.run(videoNames[i], outName, logFrames ? &cout : nullptr);
+		}
+		catch (const cv::Exception& e)
+		{
+			cerr << videoNames[i] << " could not be recognized: " << e.err << endl;
+			numFailed++;
+			continue;
+		}
+		if (logFrames) cout << endl;
+		pipeline.writeReport(cout);
+		cout << endl;
+	}
+	return numFailed == 0 ? 0 : 1;
+}
+
+// ------------------------------------ videoCommand --------------------------------------
+
+// purpose: recognize videos through the pipeline from the command line
+// preconditions: argv[1] is video and argc is at least 3
+// postconditions: the arguments after argv[1] are read and the mode is run; returns its exit
+//	code, or USAGE_ERROR if the arguments are wrong
+
+// --------------------------------------------------------------------------------------
+int videoCommand(int argc, char* argv[])
+{
+	string outDir;
+	int queueCapacity = 4;
+	bool logFrames = false;
+	vector<string> videoNames;
+	for (int i = 2; i < argc; i++)
+	{
+		if (string(argv[i]) == "--out" && i + 1 < argc) outDir = argv[++i];
+		else if (string(argv[i]) == "--queue" && i + 1 < argc) queueCapacity = max(1, atoi(argv[++i]));
+		else if (string(argv[i]) == "--frames") logFrames = true;
+		else videoNames.push_back(argv[i]);
+	}
+	return runVideo(videoNames, outDir, queueCapacity, logFrames);
+}
+
+// set by the signal handler of runServe once the server should stop
+static volatile sig_atomic_t stopRequested = 0;
+
+// ------------------------------------ requestStop --------------------------------------
+
+// purpose: ask runServe to stop, from SIGINT or SIGTERM
+// preconditions: none
+// postconditions: stopRequested is set
+
+// --------------------------------------------------------------------------------------
+void requestStop(int)
+{
+	stopRequested = 1;
+}
+
+// ------------------------------------ runServe --------------------------------------
+
+// purpose: answer recognition requests over a Unix domain socket until told to stop
+// preconditions: config.socketPath is a path the socket can be created at
+// postconditions: the server runs until SIGINT or SIGTERM, then answers the requests already
+//	read and outputs its stats as JSON. Returns 1 if it could not start
+
+// --------------------------------------------------------------------------------------
+int runServe(const ServerConfig& config)
+{
+	RecognitionServer server(config);
+	try
+	{
+		server.start();
+	}
+	catch (const cv::Exception& e)
+	{
+		cerr << e.err << endl;
+		return 1;
+	}
+	signal(SIGINT, requestStop);
+	signal(SIGTERM, requestStop);
+	cerr << "Listening on " << config.socketPath << endl;
+
+	while (!stopRequested)
+	{
+		this_thread::sleep_for(chrono::milliseconds(100));
+	}
+	server.stop();
+	RecognitionServer::writeStatsJson(cout, server.getStats());
+	return 0;
+}
+
+// ------------------------------------ serveCommand --------------------------------------
+
+// purpose: run the recognition server from the command line
+// preconditions: argv[1] is serve and argc is at least 3
+// postconditions: the arguments after argv[1] are read and the mode is run; returns its exit
+//	code, or USAGE_ERROR if the arguments are wrong
+
+// --------------------------------------------------------------------------------------
+int serveCommand(int argc, char* argv[])
+{
+	ServerConfig config;
+	RecognitionProfile profile = RecognitionProfile::Digital;
+	for (int i = 2; i < argc; i++)
+	{
+		if (string(argv[i]) == "--workers" && i + 1 < argc) config.numWorkers = atoi(argv[++i]);
+		else if (string(argv[i]) == "--queue" && i + 1 < argc) config.queueLimit = atoi(argv[++i]);
+		else if (string(argv[i]) == "--connections" && i + 1 < argc) config.maxConnections = atoi(argv[++i]);
+		else if (string(argv[i]) == "--group" && i + 1 < argc) config.maxGroup = atoi(argv[++i]);
+		else if (string(argv[i]) == "--group-window" && i + 1 < argc) config.groupWindowMs = atof(argv[++i]);
+		else if (string(argv[i]) == "--small" && i + 1 < argc) config.smallRequestBytes = atoi(argv[++i]) * 1024;
+		else if (string(argv[i]) == "--pyramid" && i + 1 < argc) config.params.pyramidLevels = max(0, atoi(argv[++i]));
+		else if (string(argv[i]) == "--low-memory") config.lowMemory = true;
+		else if (string(argv[i]) == "--backend" && i + 1 < argc)
+		{
+			if (!parseContourBackend(argv[++i], config.params.contourBackend))
+			{
+				cerr << "unknown backend " << argv[i] << endl;
+				return 1;
+			}
+		}
+		else if (string(argv[i]) == "--profile" && i + 1 < argc)
+		{
+			if (!parseProfile(argv[++i], profile))
+			{
+				cerr << "unknown profile " << argv[i] << endl;
+				return 1;
+			}
+		}
+		else config.socketPath = argv[i];
+	}
+	// the pyramid and the backend are not part of a profile
+	RecognitionParams given = config.params;
+	config.params = profileParams(profile);
+	config.params.pyramidLevels = given.pyramidLevels;
+	config.params.contourBackend = given.contourBackend;
+	return runServe(config);
+}
+
+// ------------------------------------ runRequest --------------------------------------
+
+// purpose: send images to a running server, e.g. to measure its latency from the outside
+// preconditions: a server is listening on socketPath; imageNames are image files; repetitions
+//	is at least 1
+// postconditions: each image file is sent repetitions times over one connection and the first
+//	answer for it is output; the round trip percentiles go to cerr. If stats is true, the stats
+//	of the server are output last. Returns 1 if any answer is an error
+
+// --------------------------------------------------------------------------------------
+int runRequest(const string& socketPath, const vector<string>& imageNames, int repetitions, bool stats)
+{
+	int numFailed = 0;
+	vector<double> roundTripMs;
+	try
+	{
+		RecognitionClient client(socketPath);
+		for (size_t i = 0; i < imageNames.size(); i++)
+		{
+			ifstream file(imageNames[i], ios::binary);
+			vector<uchar> encoded((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+			if (encoded.empty())
+			{
+				cerr << imageNames[i] << " could not be read" << endl;
+				numFailed++;
+				continue;
+			}
+
+			for (int r = 0; r < repetitions; r++)
+			{
+				auto start = chrono::steady_clock::now();
+				string answer = client.recognize(imageNames[i], encoded.data(), encoded.size());
+				roundTripMs.push_back(chrono::duration<double, milli>(chrono::steady_clock::now() - start).count());
+				if (r > 0) continue;
+
+				cout << answer << endl;
+				if (answer.find("\"error\":") != string::npos) numFailed++;
+			}
+		}
+		if (!roundTripMs.empty())
+		{
+			cerr << "Round trips: " << roundTripMs.size() << ", p50 " <<
+				RecognitionServer::percentile(roundTripMs, 0.5) << " ms, p99 " <<
+				RecognitionServer::percentile(roundTripMs, 0.99) << " ms" << endl;
+		}
+		if (stats) cout << client.requestStats() << endl;
+	}
+	catch (const cv::Exception& e)
+	{
+		cerr << e.err << endl;
+		return 1;
+	}
+	return numFailed == 0 ? 0 : 1;
+}
+
+// ------------------------------------ requestCommand --------------------------------------
+
+// purpose: send images to a recognition server from the command line
+// preconditions: argv[1] is request and argc is at least 3
+// postconditions: the arguments after argv[1] are read and the mode is run; returns its exit
+//	code, or USAGE_ERROR if the arguments are wrong
+
+// --------------------------------------------------------------------------------------
+int requestCommand(int argc, char* argv[])
+{
+	int repetitions = 1;
+	bool stats = false;
+	string socketPath;
+	vector<string> imageNames;
+	for (int i = 2; i < argc; i++)
+	{
+		if (string(argv[i]) == "--repeat" && i + 1 < argc) repetitions = max(1, atoi(argv[++i]));
+		else if (string(argv[i]) == "--stats") stats = true;
+		else if (socketPath.empty()) socketPath = argv[i];
+		else imageNames.push_back(argv[i]);
+	}
+	return runRequest(socketPath, imageNames, repetitions, stats);
+}
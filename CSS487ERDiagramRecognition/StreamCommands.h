@@ -0,0 +1,55 @@
+// StreamCommands.h
+// Purpose: recognize streams of images: changing frames, videos and requests to a server
+// Functionality: the incremental, video, serve and request modes of the program: each command
+//	reads its arguments and runs its driver, which recognizes only what changed between frames,
+//	pipelines the frames of videos, runs the recognition server, or sends it requests
+// Assumptions:
+//	The server and its requests need Unix domain sockets (Linux and macOS)
+// Authors: Allan Genari Gaarden, Tommy Ni, Joshua Medvinsky
+
+#ifndef STREAM_COMMANDS_H
+#define STREAM_COMMANDS_H
+
+#include "Command.h"
+
+// ------------------------------------ incrementalCommand --------------------------------------
+
+// purpose: recognize a sequence of frames incrementally from the command line
+// preconditions: argv[1] is incremental and argc is at least 3
+// postconditions: the arguments after argv[1] are read and the mode is run; returns its exit
+//	code, or USAGE_ERROR if the arguments are wrong
+
+// --------------------------------------------------------------------------------------
+int incrementalCommand(int argc, char* argv[]);
+
+// ------------------------------------ videoCommand --------------------------------------
+
+// purpose: recognize videos through the pipeline from the command line
+// preconditions: argv[1] is video and argc is at least 3
+// postconditions: the arguments after argv[1] are read and the mode is run; returns its exit
+//	code, or USAGE_ERROR if the arguments are wrong
+
+// --------------------------------------------------------------------------------------
+int videoCommand(int argc, char* argv[]);
+
+// ------------------------------------ serveCommand --------------------------------------
+
+// purpose: run the recognition server from the command line
+// preconditions: argv[1] is serve and argc is at least 3
+// postconditions: the arguments after argv[1] are read and the mode is run; returns its exit
+//	code, or USAGE_ERROR if the arguments are wrong
+
+// --------------------------------------------------------------------------------------
+int serveCommand(int argc, char* argv[]);
+
+// ------------------------------------ requestCommand --------------------------------------
+
+// purpose: send images to a recognition server from the command line
+// preconditions: argv[1] is request and argc is at least 3
+// postconditions: the arguments after argv[1] are read and the mode is run; returns its exit
+//	code, or USAGE_ERROR if the arguments are wrong
+
+// --------------------------------------------------------------------------------------
+int requestCommand(int argc, char* argv[]);
+
+#endif
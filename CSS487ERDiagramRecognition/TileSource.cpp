@@ -0,0 +1,191 @@
+// TileSource.cpp
+// Purpose: give the tiled recognizer access to rectangular pieces of a page without requiring
+//	the whole page to be decoded into memory
+// Functionality: TileSource is the interface the tiled recognizer reads from. MatTileSource
+//	serves tiles out of an image already in memory, and PnmTileSource reads each tile straight
+//	from a binary PGM/PPM (P5/P6) file, so only one tile of the page is ever held in memory
+// Assumptions:
+//	Tiles are returned as 8 bit BGR or 8 bit grayscale images; PNM files use a maxval of 255
+// Authors: Allan Genari Gaarden, Tommy Ni, Joshua Medvinsky
+
+#include "TileSource.h"
+#include <cctype>
+#include <climits>
+
+// ------------------------------------ open --------------------------------------
+
+// purpose: open an image file to be read tile by tile
+// preconditions: none
+// postconditions: returns a PnmTileSource for a binary PGM/PPM file; throws cv::Exception for
+//	any other format, which could only be decoded whole, or if the file cannot be read
+
+// --------------------------------------------------------------------------------------
+unique_ptr<TileSource> TileSource::open(const string& fileName)
+{
+	// other formats are decoded whole by imread, which would hold the full page in memory and
+	//	defeat the point of reading it in tiles
+	if (!PnmTileSource::isPnm(fileName))
+	{
+		CV_Error(Error::StsBadArg, fileName + " is not a binary PGM/PPM file; tiled mode only reads " +
+			"those piece by piece, so convert the scan first");
+	}
+	return make_unique<PnmTileSource>(fileName);
+}
+
+// ------------------------------------ MatTileSource --------------------------------------
+
+// purpose: serve tiles out of an image in memory
+// preconditions: image is an 8 bit BGR or grayscale image
+// postconditions: tiles are views into image, no pixels are copied
+
+// --------------------------------------------------------------------------------------
+MatTileSource::MatTileSource(const Mat& image)
+{
+	this->image = image;
+}
+
+// ------------------------------------ getSize --------------------------------------
+
+// purpose: get the size of the whole page
+// preconditions: none
+// postconditions: returns the size of the image
+
+// --------------------------------------------------------------------------------------
+Size MatTileSource::getSize() const
+{
+	return image.size();
+}
+
+// ------------------------------------ readTile --------------------------------------
+
+// purpose: read one rectangular piece of the page
+// preconditions: region lies inside the image
+// postconditions: tile is a view of region in the image
+
+// --------------------------------------------------------------------------------------
+void MatTileSource::readTile(const Rect& region, Mat& tile)
+{
+	tile = image(region);
+}
+
+// ------------------------------------ PnmTileSource --------------------------------------
+
+// purpose: open a binary PGM (P5) or PPM (P6) file for tiled reading
+// preconditions: fileName is a P5 or P6 file with a maxval of 255
+// postconditions: the header is parsed and the file is kept open; throws cv::Exception if the
+//	file cannot be opened or is not a supported PNM file
+
+// --------------------------------------------------------------------------------------
+PnmTileSource::PnmTileSource(const string& fileName)
+{
+	file.open(fileName, ios::binary);
+	if (!file) CV_Error(Error::StsError, "could not open " + fileName);
+
+	char magic[2] = {};
+	file.read(magic, 2);
+	if (magic[0] != 'P' || (magic[1] != '5' && magic[1] != '6'))
+	{
+		CV_Error(Error::StsBadArg, fileName + " is not a binary PGM or PPM file");
+	}
+	channels = magic[1] == '6' ? 3 : 1;
+
+	int width = readHeaderValue();
+	int height = readHeaderValue();
+	int maxValue = readHeaderValue();
+	if (width <= 0 || height <= 0 || maxValue != 255)
+	{
+		CV_Error(Error::StsBadArg, fileName + " has an unsupported PNM header");
+	}
+	size = Size(width, height);
+
+	// exactly one whitespace character separates the header from the pixels
+	file.get();
+	dataOffset = file.tellg();
+}
+
+// ------------------------------------ getSize --------------------------------------
+
+// purpose: get the size of the whole page
+// preconditions: none
+// postconditions: returns the width and height given in the file header
+
+// --------------------------------------------------------------------------------------
+Size PnmTileSource::getSize() const
+{
+	return size;
+}
+
+// ------------------------------------ readTile --------------------------------------
+
+// purpose: read one rectangular piece of the page from the file
+// preconditions: region lies inside the page
+// postconditions: tile holds the pixels of region, BGR for P6 files and grayscale for P5 files;
+//	only the rows of region are read; throws cv::Exception if the file is truncated
+
+// --------------------------------------------------------------------------------------
+void PnmTileSource::readTile(const Rect& region, Mat& tile)
+{
+	// create keeps the existing buffer when the tile size does not change
+	tile.create(region.height, region.width, CV_8UC(channels));
+	streamsize rowBytes = (streamsize)region.width * channels;
+
+	for (int y = 0; y < region.height; y++)
+	{
+		streamoff offset = dataOffset +
+			((streamoff)(region.y + y) * size.width + region.x) * channels;
+		file.seekg(offset);
+		file.read((char*)tile.ptr(y), rowBytes);
+		if (file.gcount() != rowBytes) CV_Error(Error::StsError, "PNM file is truncated");
+	}
+
+	// PPM stores red first, the rest of the program expects blue first
+	if (channels == 3) cvtColor(tile, tile, COLOR_RGB2BGR);
+}
+
+// ------------------------------------ isPnm --------------------------------------
+
+// purpose: check whether a file is a binary PGM/PPM file this class can read
+// preconditions: none
+// postconditions: returns true if the file starts with the P5 or P6 magic number
+
+// --------------------------------------------------------------------------------------
+bool PnmTileSource::isPnm(const string& fileName)
+{
+	ifstream in(fileName, ios::binary);
+	char magic[2] = {};
+	in.read(magic, 2);
+	return in.gcount() == 2 && magic[0] == 'P' && (magic[1] == '5' || magic[1] == '6');
+}
+
+// ------------------------------------ readHeaderValue --------------------------------------
+
+// purpose: read the next number of the PNM header, skipping whitespace and comments
+// preconditions: file is positioned inside the header
+// postconditions: returns the number, or -1 if the header is malformed
+
+// --------------------------------------------------------------------------------------
+int PnmTileSource::readHeaderValue()
+{
+	int c = file.get();
+	while (c != EOF && (isspace(c) || c == '#'))
+	{
+		// comments run to the end of the line
+		if (c == '#')
+		{
+			while (c != EOF && c != '\n') c = file.get();
+		}
+		c = file.get();
+	}
+
+	if (c == EOF || !isdigit(c)) return -1;
+	long long value = 0;
+	while (c != EOF && isdigit(c))
+	{
+		value = value * 10 + (c - '0');
+		if (value > INT_MAX) return -1;
+		c = file.get();
+	}
+	// the character after the number is whitespace that belongs to the header
+	file.unget();
+	return (int)value;
+}
@@ -0,0 +1,146 @@
+// TileSource.h
+// Purpose: give the tiled recognizer access to rectangular pieces of a page without requiring
+//	the whole page to be decoded into memory
+// Functionality: TileSource is the interface the tiled recognizer reads from. MatTileSource
+//	serves tiles out of an image already in memory, and PnmTileSource reads each tile straight
+//	from a binary PGM/PPM (P5/P6) file, so only one tile of the page is ever held in memory
+// Assumptions:
+//	Tiles are returned as 8 bit BGR or 8 bit grayscale images; PNM files use a maxval of 255
+// Authors: Allan Genari Gaarden, Tommy Ni, Joshua Medvinsky
+
+#ifndef TILE_SOURCE_H
+#define TILE_SOURCE_H
+
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+#include "opencv2/imgcodecs.hpp"
+#include <fstream>
+#include <memory>
+#include <string>
+using namespace std;
+using namespace cv;
+
+class TileSource
+{
+public:
+	virtual ~TileSource() = default;
+	// ------------------------------------ getSize --------------------------------------
+
+// purpose: get the size of the whole page
+// preconditions: none
+// postconditions: returns the width and height of the page in pixels
+
+// --------------------------------------------------------------------------------------
+	virtual Size getSize() const = 0;
+	// ------------------------------------ readTile --------------------------------------
+
+// purpose: read one rectangular piece of the page
+// preconditions: region lies inside the page
+// postconditions: tile holds the pixels of region as an 8 bit BGR or grayscale image; tile may
+//	share memory with the source and is only valid until the next readTile
+
+// --------------------------------------------------------------------------------------
+	virtual void readTile(const Rect& region, Mat& tile) = 0;
+	// ------------------------------------ open --------------------------------------
+
+// purpose: open an image file to be read tile by tile
+// preconditions: none
+// postconditions: returns a PnmTileSource for a binary PGM/PPM file; throws cv::Exception for
+//	any other format, which could only be decoded whole, or if the file cannot be read
+
+// --------------------------------------------------------------------------------------
+	static unique_ptr<TileSource> open(const string& fileName);
+};
+
+class MatTileSource : public TileSource
+{
+public:
+	// default constructor not allowed
+	MatTileSource() = delete;
+	// ------------------------------------ parameter constructor --------------------------------------
+
+// purpose: serve tiles out of an image in memory
+// preconditions: image is an 8 bit BGR or grayscale image
+// postconditions: tiles are views into image, no pixels are copied
+
+// --------------------------------------------------------------------------------------
+	MatTileSource(const Mat& image);
+	// ------------------------------------ getSize --------------------------------------
+
+// purpose: get the size of the whole page
+// preconditions: none
+// postconditions: returns the size of the image
+
+// --------------------------------------------------------------------------------------
+	Size getSize() const override;
+	// ------------------------------------ readTile --------------------------------------
+
+// purpose: read one rectangular piece of the page
+// preconditions: region lies inside the image
+// postconditions: tile is a view of region in the image
+
+// --------------------------------------------------------------------------------------
+	void readTile(const Rect& region, Mat& tile) override;
+
+private:
+	Mat image;
+};
+
+class PnmTileSource : public TileSource
+{
+public:
+	// default constructor not allowed
+	PnmTileSource() = delete;
+	// ------------------------------------ parameter constructor --------------------------------------
+
+// purpose: open a binary PGM (P5) or PPM (P6) file for tiled reading
+// preconditions: fileName is a P5 or P6 file with a maxval of 255
+// postconditions: the header is parsed and the file is kept open; throws cv::Exception if the
+//	file cannot be opened or is not a supported PNM file
+
+// --------------------------------------------------------------------------------------
+	PnmTileSource(const string& fileName);
+	// ------------------------------------ getSize --------------------------------------
+
+// purpose: get the size of the whole page
+// preconditions: none
+// postconditions: returns the width and height given in the file header
+
+// --------------------------------------------------------------------------------------
+	Size getSize() const override;
+	// ------------------------------------ readTile --------------------------------------
+
+// purpose: read one rectangular piece of the page from the file
+// preconditions: region lies inside the page
+// postconditions: tile holds the pixels of region, BGR for P6 files and grayscale for P5 files;
+//	only the rows of region are read; throws cv::Exception if the file is truncated
+
+// --------------------------------------------------------------------------------------
+	void readTile(const Rect& region, Mat& tile) override;
+	// ------------------------------------ isPnm --------------------------------------
+
+// purpose: check whether a file is a binary PGM/PPM file this class can read
+// preconditions: none
+// postconditions: returns true if the file starts with the P5 or P6 magic number
+
+// --------------------------------------------------------------------------------------
+	static bool isPnm(const string& fileName);
+
+private:
+	ifstream file;
+	Size size;
+	int channels = 0;
+	// position of the first pixel in the file
+	streamoff dataOffset = 0;
+
+	// ------------------------------------ readHeaderValue --------------------------------------
+
+// purpose: read the next number of the PNM header, skipping whitespace and comments
+// preconditions: file is positioned inside the header
+// postconditions: returns the number, or -1 if the header is malformed
+
+// --------------------------------------------------------------------------------------
+	int readHeaderValue();
+};
+
+#endif
@@ -0,0 +1,429 @@
+// TiledRecognizer.cpp
+// Purpose: recognize the shapes of ER diagram scans too large to process as a single image
+// Functionality: reads the page one overlapping tile at a time from a TileSource, thresholds and
+//	finds the contours of each tile, and keeps a shape only from a tile it lies strictly inside
+//	of. Shapes found again in the overlap of the next tile are dropped, and the weak types are
+//	decided once every tile has been read. A region cut by a seam that reaches past the overlap
+//	lies whole in no tile; the parts of it the tiles saw are merged into one box, and once every
+//	tile has been read that box, grown by a margin, is read again and recognized as one more
+//	window, so the shapes there are found as whole image recognition finds them. Only one tile
+//	or window (and its thresholded copy) is held in memory at a time
+// Assumptions:
+//	A shape larger than the overlap costs a window as large as the shape; one that spans a whole
+//	tile in either direction cannot be told from the paper around the drawing and is not found
+//	Objects must be closed and must not touch the border of the page, as for RecognizeERDiagram
+// Authors: Allan Genari Gaarden, Tommy Ni, Joshua Medvinsky
+
+#include "TiledRecognizer.h"
+
+// pixels a seam crossing is grown by on every side before it is read again as a window, so the
+//	region's own outline does not touch the edge of the window
+static const int WINDOW_MARGIN = 16;
+// times a window is grown around the regions it still cuts before they are given up on
+static const int MAX_WINDOW_GROWTHS = 8;
+
+// ------------------------------------ parameter constructor --------------------------------------
+
+// purpose: set up tiled recognition
+// preconditions: tileSize is larger than overlap
+// postconditions: pages are read in tileSize by tileSize tiles, neighbouring tiles sharing
+//	overlap pixels; shapes larger than overlap are recognized in windows of their own
+
+// --------------------------------------------------------------------------------------
+TiledRecognizer::TiledRecognizer(int tileSize, int overlap)
+{
+	this->tileSize = max(2, tileSize);
+	this->overlap = min(max(0, overlap), this->tileSize - 1);
+}
+
+// ------------------------------------ recognize --------------------------------------
+
+// purpose: identify each object of the page one tile at a time
+// preconditions: source can read every tile of its page
+// postconditions: the shape table holds the same shapes whole image recognition finds (in a
+//	different order), but for the regions listed by getSeamCrossings; throws cv::Exception if a
+//	tile or window cannot be read
+
+// --------------------------------------------------------------------------------------
+void TiledRecognizer::recognize(TileSource& source)
+{
+	pageSize = source.getSize();
+	shapes.clear();
+	cascadeStats.clear();
+	seamCrossings.clear();
+	seen.reset(Rect(Point(0, 0), pageSize), max(16, overlap));
+
+	tileStarts(pageSize.width, startsX);
+	tileStarts(pageSize.height, startsY);
+	numTiles = (int)(startsX.size() * startsY.size());
+
+	for (int ty = 0; ty < (int)startsY.size(); ty++)
+	{
+		for (int tx = 0; tx < (int)startsX.size(); tx++)
+		{
+			recognizeTile(source, tx, ty);
+		}
+	}
+	recognizeSeamCrossings(source);
+
+	// the same clean up as whole image recognition, on the merged shapes; there is no single
+	//	contour hierarchy for the page, so the containment is found from the bounding boxes
+	RecognitionCore::eraseParentContour(shapes, params);
+	containment.resolve(shapes, vector<Vec4i>());
+}
+
+// ------------------------------------ recognizeTile --------------------------------------
+
+// purpose: add the shapes lying inside one tile
+// preconditions: tx and ty index startsX and startsY
+// postconditions: every shape strictly inside the tile that was not already found is added to
+//	shapes in page coordinates, and every region cut by a seam of the tile that no neighbouring
+//	tile holds whole is added to seamCrossings
+
+// --------------------------------------------------------------------------------------
+void TiledRecognizer::recognizeTile(TileSource& source, int tx, int ty)
+{
+	Rect region(startsX[tx], startsY[ty], min(tileSize, pageSize.width - startsX[tx]),
+		min(tileSize, pageSize.height - startsY[ty]));
+	recognizeWindow(source, region);
+
+	// a region cut off by the tile that the neighbour across the seam holds whole is found there
+	for (size_t i = 0; i < cutRegions.size(); i++)
+	{
+		if (crossesSeam(cutRegions[i], region, tx, ty)) addSeamCrossing(cutRegions[i]);
+	}
+}
+
+// ------------------------------------ recognizeWindow --------------------------------------
+
+// purpose: add the shapes lying inside one piece of the page
+// preconditions: window lies inside the page
+// postconditions: every shape strictly inside window that was not already found is added to
+//	shapes in page coordinates, and cutRegions holds the page boxes of the paper and ink regions
+//	that window cuts off and that may be shapes, as decided by cutByWindow; threshTile is left
+//	with the cut ink marked
+
+// --------------------------------------------------------------------------------------
+void TiledRecognizer::recognizeWindow(TileSource& source, const Rect& window)
+{
+	source.readTile(window, tile);
+	if (tile.channels() == 1)
+	{
+		threshold(tile, threshTile, params.minThreshold, params.maxThreshold, THRESH_BINARY);
+	}
+	else
+	{
+		GrayThreshold::apply(tile, threshTile, params.minThreshold, params.maxThreshold);
+	}
+
+	// the nesting is decided for the whole page at the end, so a flat list of contours is enough
+	findContours(threshTile, contours, RETR_LIST, CHAIN_APPROX_NONE);
+
+	cutRegions.clear();
+	Point offset = window.tl();
+	for (size_t i = 0; i < contours.size(); i++)
+	{
+		// a contour touching the edge of the window is either cut off by the window, in which
+		//	case another tile or window should hold all of it, or touches the edge of the page
+		//	and is not a shape
+		if (RecognitionCore::contourTouchesBorder(contours[i], window.size()))
+		{
+			Rect box = boundingRect(contours[i]) + offset;
+			if (cutByWindow(box, window)) cutRegions.push_back(box);
+			continue;
+		}
+
+		CascadeStage stage;
+		ShapeType type = RecognitionCore::classifyContour(contours[i], approx, params, false, stage);
+		cascadeStats.add(stage);
+		if (type == ShapeType::Discarded) continue;
+
+		pagePolygon.resize(approx.size());
+		for (size_t j = 0; j < approx.size(); j++)
+		{
+			pagePolygon[j] = approx[j] + offset;
+		}
+
+		Rect box = boundingRect(pagePolygon);
+		if (alreadyFound(type, box)) continue;
+
+		int id = shapes.addShape(pagePolygon, type, -1);
+		seen.insert(id, box);
+	}
+
+	// the ink cut by the edge of the window joins the border findContours puts around the image,
+	//	so its outline is never traced; it is found by filling the ink from every edge pixel
+	//	instead (4-connected, as findContours joins ink), marking it so each piece is filled once
+	const uchar INK = 0;
+	const uchar FILLED = 128;
+	Rect filled;
+	int width = threshTile.cols;
+	int height = threshTile.rows;
+	for (int side = 0; side < 4; side++)
+	{
+		bool vertical = side < 2;
+		// the page edge never cuts a region
+		if ((side == 0 && window.x == 0) || (side == 1 && window.x + width == pageSize.width) ||
+			(side == 2 && window.y == 0) || (side == 3 && window.y + height == pageSize.height))
+		{
+			continue;
+		}
+		int edge = side == 0 || side == 2 ? 0 : (vertical ? width : height) - 1;
+		for (int along = 0; along < (vertical ? height : width); along++)
+		{
+			Point seed = vertical ? Point(edge, along) : Point(along, edge);
+			if (threshTile.at<uchar>(seed) != INK) continue;
+
+			floodFill(threshTile, seed, Scalar(FILLED), &filled, Scalar(), Scalar(), 4);
+			Rect box = filled + offset;
+			if (cutByWindow(box, window)) cutRegions.push_back(box);
+		}
+	}
+}
+
+// ------------------------------------ recognizeSeamCrossings --------------------------------------
+
+// purpose: recognize the regions no tile held whole
+// preconditions: every tile of the page has been recognized
+// postconditions: the box of every seam crossing, grown by WINDOW_MARGIN, is recognized as a
+//	window; while the window still cuts a region that may be a shape, each side cutting one is
+//	moved out by a tile and it is recognized again, up to MAX_WINDOW_GROWTHS times.
+//	seamCrossings is left holding the last window of the regions still cut
+
+// --------------------------------------------------------------------------------------
+void TiledRecognizer::recognizeSeamCrossings(TileSource& source)
+{
+	Rect page(Point(0, 0), pageSize);
+	vector<Rect> crossings;
+	crossings.swap(seamCrossings);
+	for (size_t i = 0; i < crossings.size(); i++)
+	{
+		// the tiles only saw the parts of the region inside them, and a part that spanned a
+		//	whole tile was taken for paper, so the window may still cut the region; every side
+		//	that cuts something is then moved out by a tile until the window holds it whole
+		Rect window = crossings[i];
+		for (int growth = 0; growth <= MAX_WINDOW_GROWTHS; growth++)
+		{
+			window = Rect(window.x - WINDOW_MARGIN, window.y - WINDOW_MARGIN,
+				window.width + 2 * WINDOW_MARGIN, window.height + 2 * WINDOW_MARGIN) & page;
+			recognizeWindow(source, window);
+			if (cutRegions.empty()) break;
+			if (growth == MAX_WINDOW_GROWTHS)
+			{
+				seamCrossings.push_back(window);
+				break;
+			}
+
+			Point topLeft = window.tl();
+			Point bottomRight = window.br();
+			for (size_t j = 0; j < cutRegions.size(); j++)
+			{
+				const Rect& cut = cutRegions[j];
+				if (cut.x <= window.x) topLeft.x = window.x - tileSize;
+				if (cut.y <= window.y) topLeft.y = window.y - tileSize;
+				if (cut.x + cut.width >= window.x + window.width) bottomRight.x = window.br().x + tileSize;
+				if (cut.y + cut.height >= window.y + window.height) bottomRight.y = window.br().y + tileSize;
+			}
+			window = Rect(topLeft, bottomRight) & page;
+		}
+	}
+}
+
+// ------------------------------------ cutByWindow --------------------------------------
+
+// purpose: check whether a contour touching the edge of a window is part of a larger region
+// preconditions: box is the bounding box of the contour in page coordinates and lies inside
+//	window
+// postconditions: returns true if the contour touches an edge of window that is not the edge of
+//	the page, does not span the whole window, and is large enough to be a shape
+
+// --------------------------------------------------------------------------------------
+bool TiledRecognizer::cutByWindow(const Rect& box, const Rect& window) const
+{
+	// the same edge test as RecognitionCore::boxTouchesBorder, one side at a time
+	bool left = box.x <= window.x;
+	bool top = box.y <= window.y;
+	bool right = box.x + box.width >= window.x + window.width;
+	bool bottom = box.y + box.height >= window.y + window.height;
+
+	// the page edge never cuts a region, and a region spanning the whole window is the paper
+	//	around the drawing rather than a shape
+	if ((left && window.x == 0) || (top && window.y == 0) ||
+		(right && window.x + window.width == pageSize.width) ||
+		(bottom && window.y + window.height == pageSize.height))
+	{
+		return false;
+	}
+	if ((left && right) || (top && bottom)) return false;
+	double minArea = min(params.thresholdAreaForRect, params.thresholdAreaForCircle);
+	return (double)box.area() > minArea;
+}
+
+// ------------------------------------ crossesSeam --------------------------------------
+
+// purpose: check whether a region cut by the edge of a tile is one no tile holds whole
+// preconditions: box is the bounding box of the region in page coordinates, cut by the edge of
+//	region as decided by cutByWindow; tx and ty index startsX and startsY and region is their tile
+// postconditions: returns true if the region reaches past the part of the tile the neighbour
+//	across the seam that cut it also reads
+
+// --------------------------------------------------------------------------------------
+bool TiledRecognizer::crossesSeam(const Rect& box, const Rect& region, int tx, int ty) const
+{
+	bool left = box.x <= region.x;
+	bool top = box.y <= region.y;
+	bool right = box.x + box.width >= region.x + region.width;
+	bool bottom = box.y + box.height >= region.y + region.height;
+
+	// the neighbour across a seam reads up to its own far edge; a region cut by the seam that
+	//	reaches further is cut by that neighbour too. cutByWindow ruled out the page edges, so
+	//	every side touched has a neighbour
+	if (left && box.x + box.width > startsX[tx - 1] + tileSize) return true;
+	if (top && box.y + box.height > startsY[ty - 1] + tileSize) return true;
+	if (right && box.x < startsX[tx + 1]) return true;
+	if (bottom && box.y < startsY[ty + 1]) return true;
+	return false;
+}
+
+// ------------------------------------ addSeamCrossing --------------------------------------
+
+// purpose: remember a region no tile holds whole
+// preconditions: box is in page coordinates
+// postconditions: box is merged into a seam crossing it overlaps or touches, seen from another
+//	tile, or added as a new one; the seam crossings are recognized once every tile has been read
+
+// --------------------------------------------------------------------------------------
+void TiledRecognizer::addSeamCrossing(const Rect& box)
+{
+	// the parts of one region seen by two neighbouring tiles share the overlap between them
+	Rect grown(box.x - 1, box.y - 1, box.width + 2, box.height + 2);
+	for (size_t i = 0; i < seamCrossings.size(); i++)
+	{
+		if ((seamCrossings[i] & grown).area() > 0)
+		{
+			seamCrossings[i] |= box;
+			return;
+		}
+	}
+	seamCrossings.push_back(box);
+}
+
+// ------------------------------------ alreadyFound --------------------------------------
+
+// purpose: check whether a shape was already found in an earlier tile
+// preconditions: box is in page coordinates
+// postconditions: returns true if a shape of type with exactly the bounding box box is in shapes
+
+// --------------------------------------------------------------------------------------
+bool TiledRecognizer::alreadyFound(ShapeType type, const Rect& box) const
+{
+	// a shape lying inside two tiles is traced from the same pixels in both, so its copy has the
+	//	same type and bounding box
+	const vector<int>& candidates = seen.cellAt(box.tl());
+	for (size_t i = 0; i < candidates.size(); i++)
+	{
+		if (shapes.getType(candidates[i]) == type && shapes.getBoundingBox(candidates[i]) == box)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+// ------------------------------------ tileStarts --------------------------------------
+
+// purpose: get where each tile starts along one side of the page
+// preconditions: length is at least 1
+// postconditions: starts holds the first coordinate of every tile, the last tile ending at the
+//	end of the page
+
+// --------------------------------------------------------------------------------------
+void TiledRecognizer::tileStarts(int length, vector<int>& starts) const
+{
+	int stride = tileSize - overlap;
+	starts.clear();
+	starts.push_back(0);
+	while (starts.back() + tileSize < length)
+	{
+		// the last tile is moved back so it ends on the page instead of hanging over it
+		starts.push_back(min(starts.back() + stride, length - tileSize));
+	}
+}
+
+// ------------------------------------ setParams --------------------------------------
+
+// purpose: change the limits used to recognize the next pages
+// preconditions: none
+// postconditions: the next recognize uses params; pyramid settings are ignored, tiles are
+//	always recognized at full resolution
+
+// --------------------------------------------------------------------------------------
+void TiledRecognizer::setParams(const RecognitionParams& params)
+{
+	this->params = params;
+}
+
+// ------------------------------------ getShapes --------------------------------------
+
+// purpose: get every shape detected on the page
+// preconditions: none
+// postconditions: returns the shape table in page coordinates; shapes tagged
+//	ShapeType::Discarded are not part of the result
+
+// --------------------------------------------------------------------------------------
+const ShapeTable& TiledRecognizer::getShapes() const
+{
+	return shapes;
+}
+
+// ------------------------------------ getCascadeStats --------------------------------------
+
+// purpose: get where the contours of the page were dropped during classification
+// preconditions: none
+// postconditions: returns how many contours each stage of classifyContour rejected and how many
+//	became shapes, over every tile of the last page; shapes found in two tiles count twice
+
+// --------------------------------------------------------------------------------------
+const CascadeStats& TiledRecognizer::getCascadeStats() const
+{
+	return cascadeStats;
+}
+
+// ------------------------------------ getImageSize --------------------------------------
+
+// purpose: get the size of the page
+// preconditions: none
+// postconditions: returns the width and height of the page that was recognized
+
+// --------------------------------------------------------------------------------------
+Size TiledRecognizer::getImageSize() const
+{
+	return pageSize;
+}
+
+// ------------------------------------ getNumTiles --------------------------------------
+
+// purpose: get how many tiles the page was split into
+// preconditions: none
+// postconditions: returns the number of tiles read by the last recognize
+
+// --------------------------------------------------------------------------------------
+int TiledRecognizer::getNumTiles() const
+{
+	return numTiles;
+}
+
+// ------------------------------------ getSeamCrossings --------------------------------------
+
+// purpose: get the regions neither a tile nor a window of their own held whole
+// preconditions: none
+// postconditions: returns, in page coordinates, the last window of every region large enough
+//	to be a shape that a seam cut and that was still cut by the edge of its window after growing
+//	it MAX_WINDOW_GROWTHS times; shapes there may be missing. Empty if every shape of the last
+//	page was found
+
+// --------------------------------------------------------------------------------------
+const vector<Rect>& TiledRecognizer::getSeamCrossings() const
+{
+	return seamCrossings;
+}
@@ -0,0 +1,214 @@
+// TiledRecognizer.h
+// Purpose: recognize the shapes of ER diagram scans too large to process as a single image
+// Functionality: reads the page one overlapping tile at a time from a TileSource, thresholds and
+//	finds the contours of each tile, and keeps a shape only from a tile it lies strictly inside
+//	of. Shapes found again in the overlap of the next tile are dropped, and the weak types are
+//	decided once every tile has been read. A region cut by a seam that reaches past the overlap
+//	lies whole in no tile; the parts of it the tiles saw are merged into one box, and once every
+//	tile has been read that box, grown by a margin, is read again and recognized as one more
+//	window, so the shapes there are found as whole image recognition finds them. Only one tile
+//	or window (and its thresholded copy) is held in memory at a time
+// Assumptions:
+//	A shape larger than the overlap costs a window as large as the shape; one that spans a whole
+//	tile in either direction cannot be told from the paper around the drawing and is not found
+//	Objects must be closed and must not touch the border of the page, as for RecognizeERDiagram
+// Authors: Allan Genari Gaarden, Tommy Ni, Joshua Medvinsky
+
+#ifndef TILED_RECOGNIZER_H
+#define TILED_RECOGNIZER_H
+
+#include "RecognitionCore.h"
+#include "ShapeTable.h"
+#include "ContainmentTree.h"
+#include "SpatialGrid.h"
+#include "TileSource.h"
+#include "RecognitionParams.h"
+#include "GrayThreshold.h"
+#include "CascadeStats.h"
+
+class TiledRecognizer
+{
+public:
+	// default constructor not allowed
+	TiledRecognizer() = delete;
+	// ------------------------------------ parameter constructor --------------------------------------
+
+// purpose: set up tiled recognition
+// preconditions: tileSize is larger than overlap
+// postconditions: pages are read in tileSize by tileSize tiles, neighbouring tiles sharing
+//	overlap pixels; shapes larger than overlap are recognized in windows of their own
+
+// --------------------------------------------------------------------------------------
+	TiledRecognizer(int tileSize, int overlap);
+	// ------------------------------------ recognize --------------------------------------
+
+// purpose: identify each object of the page one tile at a time
+// preconditions: source can read every tile of its page
+// postconditions: the shape table holds the same shapes whole image recognition finds (in a
+//	different order), but for the regions listed by getSeamCrossings; throws cv::Exception if a
+//	tile or window cannot be read
+
+// --------------------------------------------------------------------------------------
+	void recognize(TileSource& source);
+	// ------------------------------------ setParams --------------------------------------
+
+// purpose: change the limits used to recognize the next pages
+// preconditions: none
+// postconditions: the next recognize uses params; pyramid settings are ignored, tiles are
+//	always recognized at full resolution
+
+// --------------------------------------------------------------------------------------
+	void setParams(const RecognitionParams& params);
+	// ------------------------------------ getShapes --------------------------------------
+
+// purpose: get every shape detected on the page
+// preconditions: none
+// postconditions: returns the shape table in page coordinates; shapes tagged
+//	ShapeType::Discarded are not part of the result
+
+// --------------------------------------------------------------------------------------
+	const ShapeTable& getShapes() const;
+	// ------------------------------------ getCascadeStats --------------------------------------
+
+// purpose: get where the contours of the page were dropped during classification
+// preconditions: none
+// postconditions: returns how many contours each stage of classifyContour rejected and how many
+//	became shapes, over every tile of the last page; shapes found in two tiles count twice
+
+// --------------------------------------------------------------------------------------
+	const CascadeStats& getCascadeStats() const;
+	// ------------------------------------ getImageSize --------------------------------------
+
+// purpose: get the size of the page
+// preconditions: none
+// postconditions: returns the width and height of the page that was recognized
+
+// --------------------------------------------------------------------------------------
+	Size getImageSize() const;
+	// ------------------------------------ getNumTiles --------------------------------------
+
+// purpose: get how many tiles the page was split into
+// preconditions: none
+// postconditions: returns the number of tiles read by the last recognize
+
+// --------------------------------------------------------------------------------------
+	int getNumTiles() const;
+	// ------------------------------------ getSeamCrossings --------------------------------------
+
+// purpose: get the regions neither a tile nor a window of their own held whole
+// preconditions: none
+// postconditions: returns, in page coordinates, the last window of every region large enough
+//	to be a shape that a seam cut and that was still cut by the edge of its window after growing
+//	it MAX_WINDOW_GROWTHS times; shapes there may be missing. Empty if every shape of the last
+//	page was found
+
+// --------------------------------------------------------------------------------------
+	const vector<Rect>& getSeamCrossings() const;
+
+private:
+	int tileSize;
+	int overlap;
+	Size pageSize;
+	int numTiles = 0;
+	RecognitionParams params;
+	// where each column and row of tiles starts
+	vector<int> startsX;
+	vector<int> startsY;
+
+	// per tile buffers, reused for every tile and window
+	Mat tile;
+	Mat threshTile;
+	vector<vector<Point>> contours;
+	vector<Point> approx;
+	vector<Point> pagePolygon;
+	// boxes of the regions the edge of the last window cut, in page coordinates
+	vector<Rect> cutRegions;
+
+	ShapeTable shapes;
+	CascadeStats cascadeStats;
+	vector<Rect> seamCrossings;
+	// shapes kept so far, looked up by position to drop the copies found in the overlaps
+	SpatialGrid seen;
+	ContainmentTree containment;
+
+	// ------------------------------------ tileStarts --------------------------------------
+
+// purpose: get where each tile starts along one side of the page
+// preconditions: length is at least 1
+// postconditions: starts holds the first coordinate of every tile, the last tile ending at the
+//	end of the page
+
+// --------------------------------------------------------------------------------------
+	void tileStarts(int length, vector<int>& starts) const;
+	// ------------------------------------ recognizeTile --------------------------------------
+
+// purpose: add the shapes lying inside one tile
+// preconditions: tx and ty index startsX and startsY
+// postconditions: every shape strictly inside the tile that was not already found is added to
+//	shapes in page coordinates, and every region cut by a seam of the tile that no neighbouring
+//	tile holds whole is added to seamCrossings
+
+// --------------------------------------------------------------------------------------
+	void recognizeTile(TileSource& source, int tx, int ty);
+	// ------------------------------------ recognizeWindow --------------------------------------
+
+// purpose: add the shapes lying inside one piece of the page
+// preconditions: window lies inside the page
+// postconditions: every shape strictly inside window that was not already found is added to
+//	shapes in page coordinates, and cutRegions holds the page boxes of the paper and ink regions
+//	that window cuts off and that may be shapes, as decided by cutByWindow; threshTile is left
+//	with the cut ink marked
+
+// --------------------------------------------------------------------------------------
+	void recognizeWindow(TileSource& source, const Rect& window);
+	// ------------------------------------ recognizeSeamCrossings --------------------------------------
+
+// purpose: recognize the regions no tile held whole
+// preconditions: every tile of the page has been recognized
+// postconditions: the box of every seam crossing, grown by WINDOW_MARGIN, is recognized as a
+//	window; while the window still cuts a region that may be a shape, each side cutting one is
+//	moved out by a tile and it is recognized again, up to MAX_WINDOW_GROWTHS times.
+//	seamCrossings is left holding the last window of the regions still cut
+
+// --------------------------------------------------------------------------------------
+	void recognizeSeamCrossings(TileSource& source);
+	// ------------------------------------ cutByWindow --------------------------------------
+
+// purpose: check whether a contour touching the edge of a window is part of a larger region
+// preconditions: box is the bounding box of the contour in page coordinates and lies inside
+//	window
+// postconditions: returns true if the contour touches an edge of window that is not the edge of
+//	the page, does not span the whole window, and is large enough to be a shape
+
+// --------------------------------------------------------------------------------------
+	bool cutByWindow(const Rect& box, const Rect& window) const;
+	// ------------------------------------ crossesSeam --------------------------------------
+
+// purpose: check whether a region cut by the edge of a tile is one no tile holds whole
+// preconditions: box is the bounding box of the region in page coordinates, cut by the edge of
+//	region as decided by cutByWindow; tx and ty index startsX and startsY and region is their tile
+// postconditions: returns true if the region reaches past the part of the tile the neighbour
+//	across the seam that cut it also reads
+
+// --------------------------------------------------------------------------------------
+	bool crossesSeam(const Rect& box, const Rect& region, int tx, int ty) const;
+	// ------------------------------------ addSeamCrossing --------------------------------------
+
+// purpose: remember a region no tile holds whole
+// preconditions: box is in page coordinates
+// postconditions: box is merged into a seam crossing it overlaps or touches, seen from another
+//	tile, or added as a new one; the seam crossings are recognized once every tile has been read
+
+// --------------------------------------------------------------------------------------
+	void addSeamCrossing(const Rect& box);
+	// ------------------------------------ alreadyFound --------------------------------------
+
+// purpose: check whether a shape was already found in an earlier tile
+// preconditions: box is in page coordinates
+// postconditions: returns true if a shape of type with exactly the bounding box box is in shapes
+
+// --------------------------------------------------------------------------------------
+	bool alreadyFound(ShapeType type, const Rect& box) const;
+};
+
+#endif
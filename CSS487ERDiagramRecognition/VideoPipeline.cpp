@@ -0,0 +1,373 @@
+// VideoPipeline.cpp
+// Purpose: recognize recorded whiteboard videos at least as fast as they play
+// Functionality: runs decoding, gray threshold, contour finding plus classification, and
+//	overlay rendering plus encoding as four stages, each on its own thread, so the frames of the
+//	video flow through all four at once. Neighbouring stages are joined by lock-free BoundedQueues
+//	that hold back a stage running ahead of the next one, and finished frames go back to the
+//	decoder to be reused. The queue depths, the time each stage spent working and waiting, and
+//	the stage holding the others back are kept as PipelineStats
+// Assumptions:
+//	The video can be read by VideoCapture, and the output extension written by VideoWriter
+//	(.avi is written as MJPG, anything else as MPEG-4)
+//	Pyramid mode is not used, since the threshold stage thresholds every frame at full resolution
+// Authors: Allan Genari Gaarden, Tommy Ni, Joshua Medvinsky
+
+#include "VideoPipeline.h"
+#include <chrono>
+#include <iomanip>
+
+// frame rate written to the output when the video does not give its own
+static const double DEFAULT_FPS = 30;
+
+// ------------------------------------ parameter constructor --------------------------------------
+
+// purpose: set up a pipeline
+// preconditions: queueCapacity is at least 1
+// postconditions: each queue between two stages holds at most queueCapacity frames, so at most
+//	3 * queueCapacity + 4 frames are in memory at once
+
+// --------------------------------------------------------------------------------------
+VideoPipeline::VideoPipeline(int queueCapacity)
+{
+	this->queueCapacity = max(1, queueCapacity);
+}
+
+// ------------------------------------ Queues constructor --------------------------------------
+
+// purpose: create the queues of one run
+// preconditions: capacity is at least 1
+// postconditions: the queues between stages hold capacity frames; the recycled queue can hold
+//	every frame that can be in flight, so returning a frame never waits
+
+// --------------------------------------------------------------------------------------
+VideoPipeline::Queues::Queues(int capacity) : decoded(capacity), thresholded(capacity),
+	recognized(capacity), recycled(3 * capacity + NUM_PIPELINE_STAGES)
+{
+}
+
+// ------------------------------------ Queues cancel --------------------------------------
+
+// purpose: stop every stage
+// preconditions: none
+// postconditions: every queue is cancelled
+
+// --------------------------------------------------------------------------------------
+void VideoPipeline::Queues::cancel()
+{
+	decoded.cancel();
+	thresholded.cancel();
+	recognized.cancel();
+	recycled.cancel();
+}
+
+// ------------------------------------ run --------------------------------------
+
+// purpose: recognize every frame of a video
+// preconditions: videoName is a video file; outName is empty or a writable video path
+// postconditions: every frame was recognized and, if outName is given, written there with its
+//	shapes boxed and labeled; if frameLog is given one line per frame with its counts is written
+//	to it. getStats describes the run. Throws cv::Exception if the video cannot be opened, the
+//	output cannot be written or a frame cannot be recognized
+
+// --------------------------------------------------------------------------------------
+void VideoPipeline::run(const string& videoName, const string& outName, ostream* frameLog)
+{
+	stats = PipelineStats();
+	error.clear();
+
+	// opened here so a missing video is reported before any thread starts
+	VideoCapture capture(videoName);
+	if (!capture.isOpened()) CV_Error(Error::StsBadArg, "could not open video " + videoName);
+	stats.sourceFps = capture.get(CAP_PROP_FPS);
+	double fps = stats.sourceFps > 0 ? stats.sourceFps : DEFAULT_FPS;
+
+	Queues queues(queueCapacity);
+	auto start = chrono::steady_clock::now();
+	thread decoder([&]() { runStage(PipelineStage::Decode, queues, [&]() { decodeStage(capture, queues); }); });
+	thread thresholder([&]() { runStage(PipelineStage::Threshold, queues, [&]() { thresholdStage(queues); }); });
+	thread recognizer([&]() { runStage(PipelineStage::Recognize, queues, [&]() { recognizeStage(queues); }); });
+	thread renderer([&]() {
+		runStage(PipelineStage::Render, queues, [&]() { renderStage(queues, outName, fps, frameLog); });
+	});
+	decoder.join();
+	thresholder.join();
+	recognizer.join();
+	renderer.join();
+	stats.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+	// a stage waits on its input queue as consumer and on its output queue as producer
+	const BoundedQueue<FramePtr>* between[] = { &queues.decoded, &queues.thresholded, &queues.recognized };
+	for (int i = 0; i < NUM_PIPELINE_STAGES - 1; i++)
+	{
+		stats.queues[i] = between[i]->getStats();
+		stats.stages[i].outputWaitMs = stats.queues[i].fullWaitMs;
+		stats.stages[i + 1].inputWaitMs = stats.queues[i].emptyWaitMs;
+	}
+
+	if (!error.empty()) CV_Error(Error::StsError, error);
+}
+
+// ------------------------------------ runStage --------------------------------------
+
+// purpose: run one stage on the calling thread and time it
+// preconditions: stageFunction runs the stage
+// postconditions: the total time of stage is stored; if it raised a cv::Exception, the error is
+//	kept and every queue cancelled so the other stages stop
+
+// --------------------------------------------------------------------------------------
+template <typename StageFunction>
+void VideoPipeline::runStage(PipelineStage stage, Queues& queues, StageFunction stageFunction)
+{
+	auto start = chrono::steady_clock::now();
+	try
+	{
+		stageFunction();
+	}
+	catch (const cv::Exception& e)
+	{
+		lock_guard<mutex> guard(errorLock);
+		if (error.empty()) error = string(pipelineStageName(stage)) + ": " + e.err;
+		queues.cancel();
+	}
+	// each stage writes only its own entry, and run reads them after joining every thread
+	stats.stages[(int)stage].totalMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+// ------------------------------------ decodeStage --------------------------------------
+
+// purpose: read the frames of the video
+// preconditions: capture is open
+// postconditions: every frame was pushed to queues.decoded in order, in reused frames when
+//	there were any, and the queue is closed
+
+// --------------------------------------------------------------------------------------
+void VideoPipeline::decodeStage(VideoCapture& capture, Queues& queues)
+{
+	StageStats& stage = stats.stages[(int)PipelineStage::Decode];
+	FramePtr frame;
+	for (int index = 0; ; index++)
+	{
+		// a returned frame already holds buffers of the right size for every stage
+		if (!queues.recycled.tryPop(frame)) frame.reset(new VideoFrame());
+		if (!capture.read(frame->image)) break;
+
+		frame->index = index;
+		stage.numFrames++;
+		if (!queues.decoded.push(frame)) break;
+	}
+	queues.decoded.close();
+}
+
+// ------------------------------------ thresholdStage --------------------------------------
+
+// purpose: threshold the decoded frames
+// preconditions: none
+// postconditions: every frame of queues.decoded has its threshold and was pushed to
+//	queues.thresholded, which is closed
+
+// --------------------------------------------------------------------------------------
+void VideoPipeline::thresholdStage(Queues& queues)
+{
+	StageStats& stage = stats.stages[(int)PipelineStage::Threshold];
+	FramePtr frame;
+	while (queues.decoded.pop(frame))
+	{
+		GrayThreshold::apply(frame->image, frame->thresh, params.minThreshold, params.maxThreshold);
+		stage.numFrames++;
+		if (!queues.thresholded.push(frame)) break;
+	}
+	queues.thresholded.close();
+}
+
+// ------------------------------------ recognizeStage --------------------------------------
+
+// purpose: find and classify the shapes of the thresholded frames
+// preconditions: none
+// postconditions: every frame of queues.thresholded has its shapes and was pushed to
+//	queues.recognized, which is closed
+
+// --------------------------------------------------------------------------------------
+void VideoPipeline::recognizeStage(Queues& queues)
+{
+	StageStats& stage = stats.stages[(int)PipelineStage::Recognize];
+	// one recognizer for the whole video, so its contour buffers are reused from frame to frame
+	RecognizeERDiagram rec;
+	rec.setParams(params);
+	FramePtr frame;
+	while (queues.thresholded.pop(frame))
+	{
+		rec.recognizeThresholded(frame->image, frame->thresh);
+		// copied into the vectors the frame had before, so this allocates nothing once warm
+		frame->shapes = rec.getShapes();
+		stage.numFrames++;
+		if (!queues.recognized.push(frame)) break;
+	}
+	queues.recognized.close();
+}
+
+// ------------------------------------ renderStage --------------------------------------
+
+// purpose: draw the shapes onto the recognized frames and encode them
+// preconditions: outName is empty or a writable video path
+// postconditions: every frame of queues.recognized was rendered, written to outName if given,
+//	logged to frameLog if given, and returned to queues.recycled
+
+// --------------------------------------------------------------------------------------
+void VideoPipeline::renderStage(Queues& queues, const string& outName, double fps, ostream* frameLog)
+{
+	StageStats& stage = stats.stages[(int)PipelineStage::Render];
+	// only draws; it never recognizes, so it does not share state with the recognize stage
+	RecognizeERDiagram renderer;
+	VideoWriter writer;
+	FramePtr frame;
+	while (queues.recognized.pop(frame))
+	{
+		renderer.renderShapes(frame->image, frame->shapes, frame->rendered);
+		if (!outName.empty())
+		{
+			// the size of the output is only known once the first frame arrives
+			if (!writer.isOpened())
+			{
+				bool avi = outName.size() >= 4 && outName.compare(outName.size() - 4, 4, ".avi") == 0;
+				int fourcc = avi ? VideoWriter::fourcc('M', 'J', 'P', 'G') : VideoWriter::fourcc('m', 'p', '4', 'v');
+				if (!writer.open(outName, fourcc, fps, frame->rendered.size()))
+				{
+					CV_Error(Error::StsError, "could not write video " + outName);
+				}
+			}
+			writer.write(frame->rendered);
+		}
+
+		for (int type = 0; type < NUM_SHAPE_TYPES; type++)
+		{
+			stats.shapeCounts[type] += frame->shapes.count((ShapeType)type);
+		}
+		if (frameLog != nullptr)
+		{
+			const ShapeTable& shapes = frame->shapes;
+			*frameLog << frame->index << ", " << shapes.count(ShapeType::Attribute) << ", " <<
+				shapes.count(ShapeType::Entity) << ", " << shapes.count(ShapeType::Relationship) << ", " <<
+				shapes.count(ShapeType::WeakEntity) << ", " << shapes.count(ShapeType::WeakRelationship) <<
+				", " << shapes.count(ShapeType::MultivaluedAttribute) << endl;
+		}
+		stage.numFrames++;
+		stats.numFrames++;
+		// the recycled queue holds every frame in flight, so this only fails when cancelled
+		queues.recycled.tryPush(frame);
+	}
+}
+
+// ------------------------------------ setParams --------------------------------------
+
+// purpose: change the limits used to recognize the frames
+// preconditions: none
+// postconditions: the next run uses params; pyramid settings are ignored
+
+// --------------------------------------------------------------------------------------
+void VideoPipeline::setParams(const RecognitionParams& params)
+{
+	this->params = params;
+}
+
+// ------------------------------------ getStats --------------------------------------
+
+// purpose: get how the last video went through the pipeline
+// preconditions: none
+// postconditions: returns the frame rate, queue use and stage times of the last run
+
+// --------------------------------------------------------------------------------------
+const PipelineStats& VideoPipeline::getStats() const
+{
+	return stats;
+}
+
+// ------------------------------------ getBottleneck --------------------------------------
+
+// purpose: find the stage holding the others back
+// preconditions: run has been called
+// postconditions: returns the stage that spent the most time working rather than waiting
+
+// --------------------------------------------------------------------------------------
+PipelineStage VideoPipeline::getBottleneck() const
+{
+	// every other stage ends up waiting for the slowest one, so it is the one that waited least
+	int bottleneck = 0;
+	double mostBusyMs = -1;
+	for (int i = 0; i < NUM_PIPELINE_STAGES; i++)
+	{
+		const StageStats& stage = stats.stages[i];
+		double busyMs = stage.totalMs - stage.inputWaitMs - stage.outputWaitMs;
+		if (busyMs > mostBusyMs)
+		{
+			mostBusyMs = busyMs;
+			bottleneck = i;
+		}
+	}
+	return (PipelineStage)bottleneck;
+}
+
+// ------------------------------------ writeReport --------------------------------------
+
+// purpose: show how the last video went through the pipeline
+// preconditions: run has been called
+// postconditions: the frame rates, whether the run kept up with the video, one line per stage
+//	and per queue, and the bottleneck are written to out
+
+// --------------------------------------------------------------------------------------
+void VideoPipeline::writeReport(ostream& out) const
+{
+	double fps = stats.seconds > 0 ? stats.numFrames / stats.seconds : 0;
+	streamsize oldPrecision = out.precision();
+	out << fixed << setprecision(2);
+	out << "Frames: " << stats.numFrames << " in " << stats.seconds << " s (" << fps << " fps)";
+	if (stats.sourceFps > 0)
+	{
+		out << ", video plays at " << stats.sourceFps << " fps, " <<
+			(fps >= stats.sourceFps ? "keeps up with real time" : "slower than real time");
+	}
+	out << endl;
+
+	out << "\nStage, Frames, Busy ms, Waiting for Input ms, Waiting for Output ms, Busy ms per Frame" << endl;
+	for (int i = 0; i < NUM_PIPELINE_STAGES; i++)
+	{
+		const StageStats& stage = stats.stages[i];
+		double busyMs = stage.totalMs - stage.inputWaitMs - stage.outputWaitMs;
+		out << pipelineStageName((PipelineStage)i) << ", " << stage.numFrames << ", " << busyMs << ", " <<
+			stage.inputWaitMs << ", " << stage.outputWaitMs << ", " <<
+			(stage.numFrames > 0 ? busyMs / stage.numFrames : 0) << endl;
+	}
+
+	// a queue that is often full is waiting on the stage after it, one that is often empty on the
+	//	stage before it
+	out << "\nQueue, Capacity, Mean Depth, Max Depth, Full Waits, Full ms, Empty Waits, Empty ms" << endl;
+	for (int i = 0; i < NUM_PIPELINE_STAGES - 1; i++)
+	{
+		const QueueStats& queue = stats.queues[i];
+		out << pipelineStageName((PipelineStage)i) << " -> " << pipelineStageName((PipelineStage)(i + 1)) <<
+			", " << queue.capacity << ", " <<
+			(queue.numPushed > 0 ? (double)queue.depthSum / queue.numPushed : 0) << ", " << queue.maxDepth <<
+			", " << queue.numFullWaits << ", " << queue.fullWaitMs << ", " << queue.numEmptyWaits << ", " <<
+			queue.emptyWaitMs << endl;
+	}
+
+	out << "\nBottleneck: " << pipelineStageName(getBottleneck()) << endl;
+	out << defaultfloat << setprecision(oldPrecision);
+}
+
+// ------------------------------------ pipelineStageName --------------------------------------
+
+// purpose: get the name used for a stage in the report
+// preconditions: none
+// postconditions: returns the lower case name of stage (e.g. "threshold")
+
+// --------------------------------------------------------------------------------------
+const char* pipelineStageName(PipelineStage stage)
+{
+	switch (stage)
+	{
+	case PipelineStage::Decode: return "decode";
+	case PipelineStage::Threshold: return "threshold";
+	case PipelineStage::Recognize: return "recognize";
+	default: return "render";
+	}
+}
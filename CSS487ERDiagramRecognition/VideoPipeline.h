@@ -0,0 +1,210 @@
+// VideoPipeline.h
+// Purpose: recognize recorded whiteboard videos at least as fast as they play
+// Functionality: runs decoding, gray threshold, contour finding plus classification, and
+//	overlay rendering plus encoding as four stages, each on its own thread, so the frames of the
+//	video flow through all four at once. Neighbouring stages are joined by lock-free BoundedQueues
+//	that hold back a stage running ahead of the next one, and finished frames go back to the
+//	decoder to be reused. The queue depths, the time each stage spent working and waiting, and
+//	the stage holding the others back are kept as PipelineStats
+// Assumptions:
+//	The video can be read by VideoCapture, and the output extension written by VideoWriter
+//	(.avi is written as MJPG, anything else as MPEG-4)
+//	Pyramid mode is not used, since the threshold stage thresholds every frame at full resolution
+// Authors: Allan Genari Gaarden, Tommy Ni, Joshua Medvinsky
+
+#ifndef VIDEO_PIPELINE_H
+#define VIDEO_PIPELINE_H
+
+#include "RecognizeERDiagram.h"
+#include "BoundedQueue.h"
+#include <opencv2/videoio.hpp>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+// the stages of the pipeline, in the order frames go through them
+enum class PipelineStage
+{
+	Decode,
+	Threshold,
+	Recognize,
+	Render
+};
+
+// number of PipelineStage values, used to size per stage arrays
+const int NUM_PIPELINE_STAGES = (int)PipelineStage::Render + 1;
+
+// how one stage spent its time
+struct StageStats
+{
+	long long numFrames = 0;
+	// from when the stage started until it ran out of frames
+	double totalMs = 0;
+	// waiting for the stage before it, and for room in the queue to the stage after it
+	double inputWaitMs = 0;
+	double outputWaitMs = 0;
+};
+
+// how a whole video went through the pipeline
+struct PipelineStats
+{
+	int numFrames = 0;
+	double seconds = 0;
+	// frame rate of the video as recorded, 0 if the container does not give one
+	double sourceFps = 0;
+	StageStats stages[NUM_PIPELINE_STAGES];
+	// the queue from each stage to the next
+	QueueStats queues[NUM_PIPELINE_STAGES - 1];
+	// shapes of every type over all frames
+	long long shapeCounts[NUM_SHAPE_TYPES] = {};
+};
+
+// one frame and everything the stages made of it; reused for later frames
+struct VideoFrame
+{
+	int index = 0;
+	Mat image;
+	Mat thresh;
+	ShapeTable shapes;
+	Mat rendered;
+};
+
+class VideoPipeline
+{
+public:
+	// default constructor not allowed
+	VideoPipeline() = delete;
+	// ------------------------------------ parameter constructor --------------------------------------
+
+// purpose: set up a pipeline
+// preconditions: queueCapacity is at least 1
+// postconditions: each queue between two stages holds at most queueCapacity frames, so at most
+//	3 * queueCapacity + 4 frames are in memory at once
+
+// --------------------------------------------------------------------------------------
+	VideoPipeline(int queueCapacity);
+	// ------------------------------------ run --------------------------------------
+
+// purpose: recognize every frame of a video
+// preconditions: videoName is a video file; outName is empty or a writable video path
+// postconditions: every frame was recognized and, if outName is given, written there with its
+//	shapes boxed and labeled; if frameLog is given one line per frame with its counts is written
+//	to it. getStats describes the run. Throws cv::Exception if the video cannot be opened, the
+//	output cannot be written or a frame cannot be recognized
+
+// --------------------------------------------------------------------------------------
+	void run(const string& videoName, const string& outName, ostream* frameLog);
+	// ------------------------------------ setParams --------------------------------------
+
+// purpose: change the limits used to recognize the frames
+// preconditions: none
+// postconditions: the next run uses params; pyramid settings are ignored
+
+// --------------------------------------------------------------------------------------
+	void setParams(const RecognitionParams& params);
+	// ------------------------------------ getStats --------------------------------------
+
+// purpose: get how the last video went through the pipeline
+// preconditions: none
+// postconditions: returns the frame rate, queue use and stage times of the last run
+
+// --------------------------------------------------------------------------------------
+	const PipelineStats& getStats() const;
+	// ------------------------------------ getBottleneck --------------------------------------
+
+// purpose: find the stage holding the others back
+// preconditions: run has been called
+// postconditions: returns the stage that spent the most time working rather than waiting
+
+// --------------------------------------------------------------------------------------
+	PipelineStage getBottleneck() const;
+	// ------------------------------------ writeReport --------------------------------------
+
+// purpose: show how the last video went through the pipeline
+// preconditions: run has been called
+// postconditions: the frame rates, whether the run kept up with the video, one line per stage
+//	and per queue, and the bottleneck are written to out
+
+// --------------------------------------------------------------------------------------
+	void writeReport(ostream& out) const;
+
+private:
+	typedef unique_ptr<VideoFrame> FramePtr;
+
+	// the queues joining the stages, and the one returning finished frames to the decoder
+	struct Queues
+	{
+		BoundedQueue<FramePtr> decoded;
+		BoundedQueue<FramePtr> thresholded;
+		BoundedQueue<FramePtr> recognized;
+		BoundedQueue<FramePtr> recycled;
+
+		Queues(int capacity);
+		void cancel();
+	};
+
+	int queueCapacity;
+	RecognitionParams params;
+	PipelineStats stats;
+	// the first error raised by a stage, reported by run once every stage has stopped
+	mutex errorLock;
+	string error;
+
+	// ------------------------------------ decodeStage --------------------------------------
+
+// purpose: read the frames of the video
+// preconditions: capture is open
+// postconditions: every frame was pushed to queues.decoded in order, in reused frames when
+//	there were any, and the queue is closed
+
+// --------------------------------------------------------------------------------------
+	void decodeStage(VideoCapture& capture, Queues& queues);
+	// ------------------------------------ thresholdStage --------------------------------------
+
+// purpose: threshold the decoded frames
+// preconditions: none
+// postconditions: every frame of queues.decoded has its threshold and was pushed to
+//	queues.thresholded, which is closed
+
+// --------------------------------------------------------------------------------------
+	void thresholdStage(Queues& queues);
+	// ------------------------------------ recognizeStage --------------------------------------
+
+// purpose: find and classify the shapes of the thresholded frames
+// preconditions: none
+// postconditions: every frame of queues.thresholded has its shapes and was pushed to
+//	queues.recognized, which is closed
+
+// --------------------------------------------------------------------------------------
+	void recognizeStage(Queues& queues);
+	// ------------------------------------ renderStage --------------------------------------
+
+// purpose: draw the shapes onto the recognized frames and encode them
+// preconditions: outName is empty or a writable video path
+// postconditions: every frame of queues.recognized was rendered, written to outName if given,
+//	logged to frameLog if given, and returned to queues.recycled
+
+// --------------------------------------------------------------------------------------
+	void renderStage(Queues& queues, const string& outName, double fps, ostream* frameLog);
+	// ------------------------------------ runStage --------------------------------------
+
+// purpose: run one stage on the calling thread and time it
+// preconditions: stageFunction runs the stage
+// postconditions: the total time of stage is stored; if it raised a cv::Exception, the error is
+//	kept and every queue cancelled so the other stages stop
+
+// --------------------------------------------------------------------------------------
+	template <typename StageFunction>
+	void runStage(PipelineStage stage, Queues& queues, StageFunction stageFunction);
+};
+
+// ------------------------------------ pipelineStageName --------------------------------------
+
+// purpose: get the name used for a stage in the report
+// preconditions: none
+// postconditions: returns the lower case name of stage (e.g. "threshold")
+
+// --------------------------------------------------------------------------------------
+const char* pipelineStageName(PipelineStage stage);
+
+#endif
@@ -0,0 +1,151 @@
+// WorkStealingScheduler.cpp
+// Purpose: run a fixed set of independent tasks on every core
+// Functionality: tasks are dealt out to one deque per worker thread; a worker pops from the
+//	back of its own deque and, once it runs dry, steals from the front of another worker's
+//	deque so that slow tasks (large or noisy images) do not leave the other cores idle
+// Assumptions:
+//	Tasks are independent of each other and identified only by their index
+//	Tasks do not throw (any error must be handled inside the task)
+// Authors: Allan Genari Gaarden, Tommy Ni, Joshua Medvinsky
+
+#include "WorkStealingScheduler.h"
+
+// ------------------------------------ parameter constructor --------------------------------------
+
+// purpose: create a scheduler that runs tasks on the given number of threads
+// preconditions: none
+// postconditions: numThreads is stored, values less than 1 are replaced by the number of cores
+
+// --------------------------------------------------------------------------------------
+WorkStealingScheduler::WorkStealingScheduler(int numThreads) :
+	numThreads(numThreads > 0 ? numThreads : max(1, (int)thread::hardware_concurrency())),
+	queues(numThreads > 0 ? numThreads : max(1, (int)thread::hardware_concurrency())),
+	numSteals(0)
+{
+}
+
+// ------------------------------------ run --------------------------------------
+
+// purpose: run task(0) .. task(numTasks - 1) across all worker threads
+// preconditions: task is safe to call concurrently with different indices
+// postconditions: every index has been passed to task exactly once; returns once all are done
+
+// --------------------------------------------------------------------------------------
+void WorkStealingScheduler::run(int numTasks, const function<void(int)>& task)
+{
+	numSteals = 0;
+
+	// deal out contiguous blocks so neighbouring tasks start on the same worker
+	for (int w = 0; w < numThreads; w++)
+	{
+		int begin = (int)((long long)numTasks * w / numThreads);
+		int end = (int)((long long)numTasks * (w + 1) / numThreads);
+		for (int i = begin; i < end; i++)
+		{
+			queues[w].tasks.push_back(i);
+		}
+	}
+
+	// the calling thread acts as worker 0
+	vector<thread> workers;
+	for (int w = 1; w < numThreads; w++)
+	{
+		workers.emplace_back(&WorkStealingScheduler::workerLoop, this, w, cref(task));
+	}
+	workerLoop(0, task);
+
+	for (size_t i = 0; i < workers.size(); i++)
+	{
+		workers[i].join();
+	}
+}
+
+// ------------------------------------ workerLoop --------------------------------------
+
+// purpose: run tasks from the worker's own queue, then steal from the others until all are empty
+// preconditions: queues have been filled by run
+// postconditions: returns once no queue has any task left
+
+// --------------------------------------------------------------------------------------
+void WorkStealingScheduler::workerLoop(int workerId, const function<void(int)>& task)
+{
+	int taskId;
+	while (true)
+	{
+		if (popOwn(workerId, taskId) || steal(workerId, taskId))
+		{
+			task(taskId);
+		}
+		else
+		{
+			// no task is ever added after run starts, so empty queues mean we are done
+			return;
+		}
+	}
+}
+
+// ------------------------------------ popOwn --------------------------------------
+
+// purpose: take the most recently queued task from the worker's own queue
+// preconditions: workerId is a valid worker
+// postconditions: returns true and sets taskId if a task was available, false otherwise
+
+// --------------------------------------------------------------------------------------
+bool WorkStealingScheduler::popOwn(int workerId, int& taskId)
+{
+	WorkerQueue& own = queues[workerId];
+	lock_guard<mutex> guard(own.lock);
+	if (own.tasks.empty()) return false;
+	taskId = own.tasks.back();
+	own.tasks.pop_back();
+	return true;
+}
+
+// ------------------------------------ steal --------------------------------------
+
+// purpose: take the oldest task from another worker's queue
+// preconditions: workerId is a valid worker
+// postconditions: returns true and sets taskId if any other queue had a task, false otherwise
+
+// --------------------------------------------------------------------------------------
+bool WorkStealingScheduler::steal(int workerId, int& taskId)
+{
+	// visit the other workers starting from the next one so thieves spread out over victims
+	for (int offset = 1; offset < numThreads; offset++)
+	{
+		WorkerQueue& victim = queues[(workerId + offset) % numThreads];
+		lock_guard<mutex> guard(victim.lock);
+		if (!victim.tasks.empty())
+		{
+			taskId = victim.tasks.front();
+			victim.tasks.pop_front();
+			numSteals++;
+			return true;
+		}
+	}
+	return false;
+}
+
+// ------------------------------------ getNumThreads --------------------------------------
+
+// purpose: get the number of worker threads used by run
+// preconditions: none
+// postconditions: returns the number of worker threads
+
+// --------------------------------------------------------------------------------------
+int WorkStealingScheduler::getNumThreads()
+{
+	return numThreads;
+}
+
+// ------------------------------------ getNumSteals --------------------------------------
+
+// purpose: get how many tasks were stolen from another worker during the last run
+// preconditions: none
+// postconditions: returns the number of stolen tasks
+
+// --------------------------------------------------------------------------------------
+int WorkStealingScheduler::getNumSteals()
+{
+	return numSteals;
+}
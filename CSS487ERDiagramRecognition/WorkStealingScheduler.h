@@ -0,0 +1,99 @@
+// WorkStealingScheduler.h
+// Purpose: run a fixed set of independent tasks on every core
+// Functionality: tasks are dealt out to one deque per worker thread; a worker pops from the
+//	back of its own deque and, once it runs dry, steals from the front of another worker's
+//	deque so that slow tasks (large or noisy images) do not leave the other cores idle
+// Assumptions:
+//	Tasks are independent of each other and identified only by their index
+//	Tasks do not throw (any error must be handled inside the task)
+// Authors: Allan Genari Gaarden, Tommy Ni, Joshua Medvinsky
+
+#ifndef WORK_STEALING_SCHEDULER_H
+#define WORK_STEALING_SCHEDULER_H
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+using namespace std;
+
+class WorkStealingScheduler
+{
+public:
+	// default constructor not allowed
+	WorkStealingScheduler() = delete;
+	// ------------------------------------ parameter constructor --------------------------------------
+
+// purpose: create a scheduler that runs tasks on the given number of threads
+// preconditions: none
+// postconditions: numThreads is stored, values less than 1 are replaced by the number of cores
+
+// --------------------------------------------------------------------------------------
+	WorkStealingScheduler(int numThreads);
+	// ------------------------------------ run --------------------------------------
+
+// purpose: run task(0) .. task(numTasks - 1) across all worker threads
+// preconditions: task is safe to call concurrently with different indices
+// postconditions: every index has been passed to task exactly once; returns once all are done
+
+// --------------------------------------------------------------------------------------
+	void run(int numTasks, const function<void(int)>& task);
+	// ------------------------------------ getNumThreads --------------------------------------
+
+// purpose: get the number of worker threads used by run
+// preconditions: none
+// postconditions: returns the number of worker threads
+
+// --------------------------------------------------------------------------------------
+	int getNumThreads();
+	// ------------------------------------ getNumSteals --------------------------------------
+
+// purpose: get how many tasks were stolen from another worker during the last run
+// preconditions: none
+// postconditions: returns the number of stolen tasks
+
+// --------------------------------------------------------------------------------------
+	int getNumSteals();
+
+private:
+	// one deque of task indices per worker, each guarded by its own lock
+	struct WorkerQueue
+	{
+		mutex lock;
+		deque<int> tasks;
+	};
+
+	int numThreads;
+	vector<WorkerQueue> queues;
+	atomic<int> numSteals;
+
+	// ------------------------------------ workerLoop --------------------------------------
+
+// purpose: run tasks from the worker's own queue, then steal from the others until all are empty
+// preconditions: queues have been filled by run
+// postconditions: returns once no queue has any task left
+
+// --------------------------------------------------------------------------------------
+	void workerLoop(int workerId, const function<void(int)>& task);
+	// ------------------------------------ popOwn --------------------------------------
+
+// purpose: take the most recently queued task from the worker's own queue
+// preconditions: workerId is a valid worker
+// postconditions: returns true and sets taskId if a task was available, false otherwise
+
+// --------------------------------------------------------------------------------------
+	bool popOwn(int workerId, int& taskId);
+	// ------------------------------------ steal --------------------------------------
+
+// purpose: take the oldest task from another worker's queue
+// preconditions: workerId is a valid worker
+// postconditions: returns true and sets taskId if any other queue had a task, false otherwise
+
+// --------------------------------------------------------------------------------------
+	bool steal(int workerId, int& taskId);
+};
+
+#endif
@@ -6,18 +6,10 @@
 // Authors: Allan Genari Gaarden, Tommy Ni, Joshua Medvinsky
 
 #include "RecognizeERDiagram.h"
-
-// test structure for ease of adding tests
-struct Test
-{
-	string imageName;
-	int expectedAttributes;
-	int expectedEntities;
-	int expectedRelationships;
-	int expectedWeakEntities;
-	int expectedWeakRelationships;
-	int expectedMultivaluedAttributes;
-};
+#include "OutputCommands.h"
+#include "MemoryCommands.h"
+#include "BenchmarkCommands.h"
+#include "StreamCommands.h"
 
 // ------------------------------------ testCase --------------------------------------
 
@@ -53,33 +45,131 @@ void testCase(Test test, bool draw)
 	}
 }
 
-// ------------------------------------ main --------------------------------------
+// ------------------------------------ runTests --------------------------------------
 
 // purpose: to run all tests
-// preconditions: the tests that are added in main must be in the directory
+// preconditions: the tests that are added in bundledTests must be in the directory
 // postconditions: gives the corresponding outputs for each test
 
 // --------------------------------------------------------------------------------------
-int main()
+int runTests()
 {
 	bool drawTests = true;
-	vector<Test> testCases;
-
-	//Test Structure is: {"imageName.png", attribute, entity, relationship, weak entity,
-	//					  weak relationship, multivalue attribute}
-	testCases.push_back(Test{ "paintTestSimple1.png", 0, 2, 1, 0, 0, 0 });
-	testCases.push_back(Test{ "paintTestSimple2.png", 4, 2, 1, 0, 0, 1 });
-	testCases.push_back(Test{ "paintTestIntermediate1.png", 3, 2, 1, 1, 1, 1 });
-	testCases.push_back(Test{ "paintTestIntermediate2.png", 3, 2, 1, 1, 1, 0 });
-	testCases.push_back(Test{ "paintTestIntermediate3.png", 5, 2, 1, 0, 0, 0 });
-	testCases.push_back(Test{ "paintTestIntermediate4.png", 5, 1, 0, 1, 1, 0 });
-	testCases.push_back(Test{ "paintTestAdvance2.png", 11, 2, 1, 1, 1, 1 });
-	testCases.push_back(Test{ "paintTestAdvance3.png", 10, 3, 2, 2, 2, 1 });
-	testCases.push_back(Test{ "paintTestAdvance1.png", 13, 3, 3, 1, 1, 0 });
+	vector<Test> testCases = bundledTests();
 
 	// runs each test
 	for (int i = 0; i < testCases.size(); i++)
 	{
 		testCase(testCases[i], drawTests);
 	}
-}
\ No newline at end of file
+	return 0;
+}
+
+// every mode of the program, in the order the usage lists them
+static const Command COMMANDS[] =
+{
+	{ "batch", 1, "<directory | file list> [threads] [--archive <file>]",
+		"recognizes a whole batch", batchCommand },
+	{ "cli", 1, "[--out <directory>] [--pyramid <levels>] [--cache <directory>] [--cache-size <MB>] "
+		"[--archive <file>] [--svg <directory>] [--low-memory] [--profile digital | photo | scan] "
+		"[--backend findcontours | components] <image> [image ...]",
+		"prints JSON, no windows", cliCommand },
+	{ "tiled", 1, "[--tile <pixels>] [--overlap <pixels>] <image> [image ...]",
+		"JSON for very large scans", tiledCommand },
+	{ "allocations", 1, "<image> [repetitions]",
+		"allocations per reused run", allocationsCommand },
+	{ "memory", 1, "[--low] [--no-image] <image> [image ...]",
+		"peak and held memory per image", memoryCommand },
+	{ "reentrant", 1, "[--threads <n>] [--runs <n>] <image> [image ...]",
+		"stateless API from many threads", reentrantCommand },
+	{ "graycheck", 0, "[image ...]",
+		"checks the threshold kernels", graycheckCommand },
+	{ "graybench", 1, "<image> [repetitions]",
+		"times the threshold kernels", graybenchCommand },
+	{ "profilebench", 1, "[--runs <n>] <image> [image ...]",
+		"specialized against generic profiles", profilebenchCommand },
+	{ "components", 0, "[--runs <n>] [--noise <fraction>] [image ...]",
+		"component extractor against findContours", componentsCommand },
+	{ "cascade", 1, "<image> [image ...]",
+		"contours dropped per stage", cascadeCommand },
+	{ "instrument", 1, "[--json] [--pyramid <levels>] [--backend findcontours | components] <image> "
+		"[image ...]",
+		"stage times and counts per image", instrumentCommand },
+	{ "incremental", 1, "[--block <pixels>] [--margin <pixels>] [--tolerance <n>] [--check] <frame> "
+		"[frame ...]",
+		"recognizes only what changed", incrementalCommand },
+	{ "video", 1, "[--out <directory>] [--queue <frames>] [--frames] <video> [video ...]",
+		"pipelined, reports the stalls", videoCommand },
+	{ "serve", 1, "[--workers <n>] [--queue <requests>] [--connections <n>] [--group <requests>] "
+		"[--group-window <ms>] [--small <KB>] [--pyramid <levels>] [--low-memory] "
+		"[--profile digital | photo | scan] [--backend findcontours | components] <socket>",
+		"warm daemon on a Unix socket", serveCommand },
+	{ "request", 1, "[--repeat <n>] [--stats] <socket> [image ...]",
+		"sends images to the daemon", requestCommand },
+	{ "archive", 2, "json <file> | scan [--min <type> <n>] [--max <type> <n>] <file>",
+		"JSON lines of an archive, or the images whose counts are in range", archiveCommand },
+	{ "graph", 1, "<image> [image ...]",
+		"JSON graph of shapes and connectors", graphCommand },
+	{ "graphbench", 0, "[--runs <n>] [shapes ...]",
+		"times connectors on generated pages", graphbenchCommand },
+	{ "bench", 0, "[--runs <n>] [--mosaic <n>] [--generated <n>] [--out <file>] [image ...]",
+		"times every stage as JSON", benchCommand },
+	{ "gate", 0, "[--runs <n>] [--baseline <file>] [--save <file>] [--tolerance <fraction>] "
+		"[--slack <ms>] [--profile digital | photo | scan] [--backend findcontours | components] "
+		"[manifest ...]",
+		"fails on accuracy or latency regressions", gateCommand },
+	{ "generate", 1, "[--entities <n>] [--relationships <n>] [--attributes <n>] "
+		"[--weak-entities <n>] [--weak-relationships <n>] [--multivalued <n>] [--shapes <n>] "
+		"[--size <pixels>] [--stroke <pixels>] [--noise <fraction>] [--page <width>x<height>] "
+		"[--seed <n>] [--check] <image>",
+		"draws a diagram with known counts", generateCommand }
+};
+
+const int NUM_COMMANDS = sizeof(COMMANDS) / sizeof(COMMANDS[0]);
+
+// ------------------------------------ printUsage --------------------------------------
+
+// purpose: tell how the program is run
+// preconditions: program is the name the program was run as
+// postconditions: the usage and summary of every mode of COMMANDS are written to cerr
+
+// --------------------------------------------------------------------------------------
+void printUsage(const char* program)
+{
+	cerr << "usage: " << program << endl;
+	cerr << "           runs the bundled tests, showing each image" << endl;
+	for (int i = 0; i < NUM_COMMANDS; i++)
+	{
+		cerr << "       " << program << " " << COMMANDS[i].name << " " << COMMANDS[i].usage << endl;
+		cerr << "           " << COMMANDS[i].summary << endl;
+	}
+}
+
+// ------------------------------------ main --------------------------------------
+
+// purpose: to run all tests, or the mode named by the first argument
+// preconditions: the tests that are added in bundledTests must be in the directory
+// postconditions: gives the corresponding outputs for the chosen mode of COMMANDS; for a mode
+//	that is not there, or too few or wrong arguments, the usage is printed and 1 is returned
+
+// --------------------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+	if (argc < 2) return runTests();
+
+	string mode = argv[1];
+	for (int i = 0; i < NUM_COMMANDS; i++)
+	{
+		if (mode != COMMANDS[i].name) continue;
+
+		if (argc - 2 >= COMMANDS[i].minArguments)
+		{
+			int exitCode = COMMANDS[i].run(argc, argv);
+			if (exitCode != USAGE_ERROR) return exitCode;
+		}
+		break;
+	}
+
+	printUsage(argv[0]);
+	return 1;
+}